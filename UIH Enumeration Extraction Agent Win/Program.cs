@@ -26,6 +26,10 @@ namespace EnumerationExtractionAgent
         public static int rescheduleCount = 0;
         private static System.Timers.Timer aTimer;
         private static System.Timers.Timer refreshTimer;        
+        private static UsbTopologyIndex usbTopology = new UsbTopologyIndex();
+        private static List<UsbDeviceNode.ExternalDriveInfo> externalDrives = null;
+        private const double TopologyDebounceMs = 50;   //coalesces the burst of events of one replug
+        private const double StorageDebounceMs = 500;   //drive letters are assigned after the disk shows up
 
         public class CompanionHub
         {
@@ -193,14 +197,18 @@ namespace EnumerationExtractionAgent
 
             // Build the tree
 
-            var builder = new UsbDeviceTreeBuilder();            
-            var roots = builder.BuildTree();
+            var builder = new UsbDeviceTreeBuilder();
+            bool fullWalk = usbTopology.Update();
+            var roots = usbTopology.GetUsbTree();
 
-            Console.WriteLine("Full USB Device Tree:");
+            if (fullWalk)
+                Console.WriteLine("Full USB Device Tree:");
+            else
+                Console.WriteLine($"USB Device Tree updated incrementally [{usbTopology.Count} nodes indexed]");
 
             foreach (var root in roots)
             {
-                root.PrintTree(); // Recursively prints each device and its children
+                if (fullWalk) root.PrintTree(); // Recursively prints each device and its children
                 //assign a level to each node from the root. Used to identify companion hubs in level 0
                 UsbDeviceTreeBuilder.AssignLevelsRecursive(root,-2); 
             }
@@ -212,7 +220,9 @@ namespace EnumerationExtractionAgent
             List<UsbDeviceNode> uniquehubs3 = new List<UsbDeviceNode>();
             List<UsbDeviceNode> duplicatehubs3 = new List<UsbDeviceNode>();
             int rootDuplicates = 0;
-            var ExternalDriveInfo = builder.GetDriveLetterByPNPDeviceId();
+            if (externalDrives == null || usbTopology.StorageChanged)
+                externalDrives = builder.GetDriveLetterByPNPDeviceId();
+            var ExternalDriveInfo = externalDrives;
 
             hubs3nodes.ForEach(p => p.PrintTree());
 
@@ -322,10 +332,11 @@ namespace EnumerationExtractionAgent
 
         static void Main(string[] args)
         {
+            UsbEventLogQuery.Start();
             updateUSBDevices();
             //when there is an usb event, a delay is created to wait until the usb tree is updated
             aTimer = new System.Timers.Timer();
-            aTimer.Interval = 500;
+            aTimer.Interval = TopologyDebounceMs;
             aTimer.Elapsed += OnTimedEvent;
             aTimer.AutoReset = false;
 
@@ -350,6 +361,7 @@ namespace EnumerationExtractionAgent
 
             // Stop monitoring USB device events before exiting
             win32UsbControllerDevices.StopWatcher();
+            UsbEventLogQuery.Stop();
         }
 
         private static void OnWin32UsbControllerDevicesDeviceConnected(Object sender, Win32UsbControllerDeviceEventArgs e)
@@ -357,8 +369,7 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device connected: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Connected");
-            aTimer.Stop();
-            aTimer.Start();
+            QueueTopologyChange(UsbTopologyChange.Added, e.Device?.DeviceId);
 
         }
 
@@ -367,8 +378,7 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device disconnected: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Disconnected");
-            aTimer.Stop();
-            aTimer.Start();
+            QueueTopologyChange(UsbTopologyChange.Removed, e.Device?.DeviceId);
 
         }
 
@@ -377,7 +387,14 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device modified: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Modified");
+            QueueTopologyChange(UsbTopologyChange.Modified, e.Device?.DeviceId);
+        }
+
+        private static void QueueTopologyChange(UsbTopologyChange kind, string deviceId)
+        {
+            usbTopology.Queue(kind, deviceId);
             aTimer.Stop();
+            aTimer.Interval = usbTopology.PendingStorage ? StorageDebounceMs : TopologyDebounceMs;
             aTimer.Start();
         }
 
@@ -6,34 +6,107 @@ using System.Diagnostics.Eventing.Reader;
 
 namespace EnumerationExtractionAgent
 {
+    //Last connect time of every device seen by the UMDF host (EventID 2003).
+    //The log is read once, newest first and bounded, then a subscription keeps the
+    //map current. Device ids come straight from the event data, descriptions are
+    //never rendered. Every instance is kept as logged and, for WPD/storage, as its
+    //embedded USB device id. Start() when the agent starts, Stop() when it stops.
     internal class UsbEventLogQuery
     {
-        public static DateTime? GetLastUsbConnectTime(string deviceIdFilter)
+        const string LogName = "Microsoft-Windows-DriverFrameworks-UserMode/Operational";
+        const string ConnectQuery = "*[System[Provider[@Name='Microsoft-Windows-DriverFrameworks-UserMode'] and (EventID=2003)]]";
+        const int BackfillMaxEvents = 2000;
+
+        private static readonly Dictionary<string, DateTime> lastConnect = new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+        private static readonly EventLogPropertySelector instanceSelector =
+            new EventLogPropertySelector(new[] { "Event/UserData/UMDFHostDeviceArrivalBegin/@instance" });
+        private static readonly object startLock = new object();
+        private static EventLogWatcher watcher;
+        private static bool started = false;
+
+        public static int Count
         {
-            string query = "*[System[Provider[@Name='Microsoft-Windows-DriverFrameworks-UserMode'] and (EventID=2003)]]";
-            var logQuery = new EventLogQuery("Microsoft-Windows-DriverFrameworks-UserMode/Operational", PathType.LogName, query);
+            get { lock (lastConnect) { return lastConnect.Count; } }
+        }
 
-            DateTime? latestTime = null;
+        //Subscribes first so nothing written during the backfill is lost
+        public static void Start()
+        {
+            lock (startLock)
+            {
+                if (started) return;
+                started = true;
 
-            try
+                try
+                {
+                    watcher = new EventLogWatcher(new EventLogQuery(LogName, PathType.LogName, ConnectQuery));
+                    watcher.EventRecordWritten += OnEventRecordWritten;
+                    watcher.Enabled = true;
+                }
+                catch (Exception e)
+                {
+                    Console.WriteLine("Event log subscription failed: " + e.Message);
+                    watcher = null;
+                }
+
+                Backfill();
+            }
+        }
+
+        public static void Stop()
+        {
+            lock (startLock)
             {
-                var reader = new EventLogReader(logQuery);
+                if (watcher != null)
+                {
+                    watcher.Enabled = false;
+                    watcher.EventRecordWritten -= OnEventRecordWritten;
+                    watcher.Dispose();
+                    watcher = null;
+                }
+                started = false;
+            }
+        }
+
+        //Newest connect of the devices whose id contains deviceIdFilter, as the
+        //description match of the old log scan did. A full id is a direct lookup.
+        public static DateTime? GetLastUsbConnectTime(string deviceIdFilter)
+        {
+            if (string.IsNullOrEmpty(deviceIdFilter)) return null;
+            Start();
+
+            lock (lastConnect)
+            {
+                if (lastConnect.TryGetValue(NormalizeDeviceId(deviceIdFilter), out DateTime time))
+                    return time;
 
-                for (EventRecord eventInstance = reader.ReadEvent();
-                     eventInstance != null;
-                     eventInstance = reader.ReadEvent())
+                DateTime? latest = null;
+                foreach (var entry in lastConnect)
                 {
-                    string description = eventInstance.FormatDescription();
+                    if (entry.Key.IndexOf(deviceIdFilter, StringComparison.OrdinalIgnoreCase) >= 0 &&
+                        (!latest.HasValue || entry.Value > latest.Value))
+                        latest = entry.Value;
+                }
+                return latest;
+            }
+        }
 
-                    if (description != null &&
-                        description.Contains(deviceIdFilter))
+        private static void Backfill()
+        {
+            var logQuery = new EventLogQuery(LogName, PathType.LogName, ConnectQuery) { ReverseDirection = true };
+            int read = 0;
+
+            try
+            {
+                using (var reader = new EventLogReader(logQuery))
+                {
+                    for (EventRecord eventInstance = reader.ReadEvent();
+                         eventInstance != null && read < BackfillMaxEvents;
+                         eventInstance = reader.ReadEvent(), read++)
                     {
-                        if (eventInstance.TimeCreated.HasValue)
+                        using (eventInstance)
                         {
-                            if (!latestTime.HasValue || eventInstance.TimeCreated > latestTime)
-                            {
-                                latestTime = eventInstance.TimeCreated;
-                            }
+                            Record(eventInstance);
                         }
                     }
                 }
@@ -42,8 +115,71 @@ namespace EnumerationExtractionAgent
             {
                 Console.WriteLine("Event log not found: " + e.Message);
             }
+            catch (UnauthorizedAccessException e)
+            {
+                Console.WriteLine("Event log not accessible: " + e.Message);
+            }
+
+            Console.WriteLine($"Event log backfill: {read} events, {Count} ids");
+        }
+
+        private static void OnEventRecordWritten(object sender, EventRecordWrittenEventArgs e)
+        {
+            if (e.EventRecord == null) return;
+
+            using (e.EventRecord)
+            {
+                Record(e.EventRecord);
+            }
+        }
+
+        private static void Record(EventRecord eventInstance)
+        {
+            var logRecord = eventInstance as EventLogRecord;
+            if (logRecord == null || !eventInstance.TimeCreated.HasValue) return;
 
-            return latestTime;
+            IList<object> values;
+            try
+            {
+                values = logRecord.GetPropertyValues(instanceSelector);
+            }
+            catch (EventLogException)
+            {
+                return;
+            }
+
+            string instance = values.Count > 0 ? values[0] as string : null;
+            if (string.IsNullOrEmpty(instance)) return;
+
+            DateTime time = eventInstance.TimeCreated.Value;
+
+            lock (lastConnect)
+            {
+                Update(instance.ToUpperInvariant(), time);
+                Update(NormalizeDeviceId(instance), time);
+            }
+        }
+
+        //backfill and subscription may overlap, the newest time wins
+        private static void Update(string key, DateTime time)
+        {
+            if (!lastConnect.TryGetValue(key, out DateTime known) || time > known)
+                lastConnect[key] = time;
+        }
+
+        //UMDF instances of storage and WPD devices embed the USB device id as
+        //"SWD\WPDBUSENUM\_??_USBSTOR#DISK&...#{guid}", reduce them to "USBSTOR\DISK&..."
+        private static string NormalizeDeviceId(string id)
+        {
+            int embedded = id.IndexOf("_??_", StringComparison.Ordinal);
+            if (embedded >= 0)
+            {
+                id = id.Substring(embedded + 4);
+                int guid = id.IndexOf("#{", StringComparison.Ordinal);
+                if (guid >= 0) id = id.Substring(0, guid);
+                id = id.Replace('#', '\\');
+            }
+            return id.ToUpperInvariant();
         }
     }
 }
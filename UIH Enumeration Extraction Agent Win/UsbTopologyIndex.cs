@@ -0,0 +1,374 @@
+﻿/**
+ *   USB Insight Hub Enumeration Extraction Agent
+ *
+ *   Works in tandem with USB Insight Hub hardware
+ *
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License.
+ **/
+
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using System.Text;
+
+
+namespace UEnumerationExtractionAgent
+{
+    public enum UsbTopologyChange
+    {
+        Added,
+        Removed,
+        Modified
+    }
+
+    //Device tree kept between USB events. The whole devnode tree is walked once,
+    //after that every WMI event only reads the subtree of the device it names.
+    public class UsbTopologyIndex
+    {
+        const int CR_SUCCESS = 0;
+        const int CR_BUFFER_SMALL = 0x1A;
+        const int CM_DRP_LOCATION_PATHS = 0x24;
+
+        [StructLayout(LayoutKind.Sequential)]
+        struct DEVPROPKEY
+        {
+            public Guid fmtid;
+            public uint pid;
+        }
+
+        //Same property Win32_PnPEntity reports as Name
+        private static DEVPROPKEY DEVPKEY_NAME = new DEVPROPKEY
+        {
+            fmtid = new Guid("b725f130-47ef-101a-a5f1-02608c9eebac"),
+            pid = 10
+        };
+
+        //-------------------
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode)]
+        private static extern int CM_Locate_DevNode(out uint devInst, string pDeviceID, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode)]
+        private static extern int CM_Get_Parent(out uint parent, uint child, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode)]
+        private static extern int CM_Get_Child(out uint child, uint parent, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode)]
+        private static extern int CM_Get_Sibling(out uint sibling, uint devInst, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode)]
+        private static extern int CM_Get_Device_ID(uint devInst, StringBuilder buffer, int bufferLen, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode, EntryPoint = "CM_Get_DevNode_PropertyW")]
+        private static extern int CM_Get_DevNode_Property(uint devInst, ref DEVPROPKEY propertyKey, out uint propertyType,
+            byte[] buffer, ref uint bufferSize, int flags);
+
+        [DllImport("cfgmgr32.dll", CharSet = CharSet.Unicode, EntryPoint = "CM_Get_DevNode_Registry_PropertyW")]
+        private static extern int CM_Get_DevNode_Registry_Property(uint devInst, int property, out uint regDataType,
+            byte[] buffer, ref uint length, int flags);
+
+        //-------------------------
+
+        private struct PendingChange
+        {
+            public UsbTopologyChange Kind;
+            public string DeviceId;
+        }
+
+        private readonly Dictionary<string, UsbDeviceNode> nodes = new Dictionary<string, UsbDeviceNode>(StringComparer.OrdinalIgnoreCase);
+        private readonly List<UsbDeviceNode> roots = new List<UsbDeviceNode>();
+        private readonly List<PendingChange> pending = new List<PendingChange>();
+        private readonly object pendingLock = new object();
+        private bool rebuildRequested = true;
+        private bool pendingStorage = false;
+
+        public int Count { get { return nodes.Count; } }
+
+        //Set by Update() when drive letters may have changed
+        public bool StorageChanged { get; private set; } = true;
+
+        public bool PendingStorage
+        {
+            get { lock (pendingLock) { return pendingStorage; } }
+        }
+
+        public void Queue(UsbTopologyChange kind, string deviceId)
+        {
+            lock (pendingLock)
+            {
+                if (string.IsNullOrEmpty(deviceId))
+                {
+                    rebuildRequested = true;
+                    return;
+                }
+                pending.Add(new PendingChange { Kind = kind, DeviceId = deviceId });
+                if (IsStorage(deviceId)) pendingStorage = true;
+            }
+        }
+
+        public void RequestRebuild()
+        {
+            lock (pendingLock) { rebuildRequested = true; }
+        }
+
+        //Applies the queued changes. Returns true if a full walk was done, either
+        //requested or because a change could not be placed in the index.
+        public bool Update()
+        {
+            List<PendingChange> changes;
+            bool full;
+
+            lock (pendingLock)
+            {
+                changes = new List<PendingChange>(pending);
+                pending.Clear();
+                full = rebuildRequested || roots.Count == 0;
+                rebuildRequested = false;
+                StorageChanged = full || pendingStorage;
+                pendingStorage = false;
+            }
+
+            lock (nodes)
+            {
+                if (!full)
+                {
+                    foreach (var change in changes)
+                    {
+                        Console.WriteLine($"Topology {change.Kind}: {change.DeviceId}");
+                        if (!ApplyChange(change))
+                        {
+                            Console.WriteLine("Topology change not resolved - full walk");
+                            full = true;
+                            StorageChanged = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (full) Rebuild();
+            }
+
+            return full;
+        }
+
+        //Same trimming as UsbDeviceTreeBuilder.BuildTree, on copies of the index nodes
+        public List<UsbDeviceNode> GetUsbTree()
+        {
+            lock (nodes)
+            {
+                return TreeTrimer.ExtractTopLevelMatchingSubtrees(roots, node => node.Description.ToLower().Contains("usb"));
+            }
+        }
+
+        private void Rebuild()
+        {
+            nodes.Clear();
+            roots.Clear();
+
+            if (CM_Locate_DevNode(out uint rootInst, null, 0) != CR_SUCCESS)
+                return;
+
+            var root = BuildSubtree(rootInst, null);
+            if (root == null) return;
+
+            roots.Add(root);
+            root.InheritParentProp();
+        }
+
+        private bool ApplyChange(PendingChange change)
+        {
+            nodes.TryGetValue(change.DeviceId, out UsbDeviceNode node);
+
+            //a deletion event can arrive after the device is back, so the live state decides
+            if (CM_Locate_DevNode(out uint devInst, change.DeviceId, 0) != CR_SUCCESS)
+            {
+                if (node != null) Detach(node);
+                return true;
+            }
+
+            if (node == null)
+                return Attach(devInst);
+
+            var fresh = ReadNode(devInst);
+            if (fresh == null) return false;
+
+            if (fresh.Description != node.Description || fresh.LocationPath != node.LocationPath)
+            {
+                //inherited port info of the children would be stale, read the subtree again
+                Detach(node);
+                return Attach(devInst);
+            }
+
+            SyncChildren(node, devInst);
+            return true;
+        }
+
+        //Walks up to the first indexed ancestor and reads only the new branch
+        private bool Attach(uint devInst)
+        {
+            uint top = devInst;
+
+            while (CM_Get_Parent(out uint parentInst, top, 0) == CR_SUCCESS)
+            {
+                string parentId = GetDeviceId(parentInst);
+                if (parentId == null) return false;
+
+                if (nodes.TryGetValue(parentId, out UsbDeviceNode parent))
+                {
+                    var branch = BuildSubtree(top, parent);
+                    if (branch == null) return false;
+                    AddChild(parent, branch);
+                    return true;
+                }
+                top = parentInst;
+            }
+
+            return false;
+        }
+
+        private void SyncChildren(UsbDeviceNode node, uint devInst)
+        {
+            var live = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+
+            for (int cr = CM_Get_Child(out uint child, devInst, 0); cr == CR_SUCCESS; cr = CM_Get_Sibling(out child, child, 0))
+            {
+                string childId = GetDeviceId(child);
+                if (childId == null) continue;
+                live.Add(childId);
+
+                if (nodes.TryGetValue(childId, out UsbDeviceNode existing))
+                {
+                    if (existing.Parent == node)
+                    {
+                        SyncChildren(existing, child);
+                        continue;
+                    }
+                    Detach(existing);
+                }
+
+                var branch = BuildSubtree(child, node);
+                if (branch != null) AddChild(node, branch);
+            }
+
+            for (int i = node.Children.Count - 1; i >= 0; i--)
+            {
+                if (!live.Contains(node.Children[i].InstanceId))
+                    Detach(node.Children[i]);
+            }
+        }
+
+        private UsbDeviceNode BuildSubtree(uint devInst, UsbDeviceNode parent)
+        {
+            var node = ReadNode(devInst);
+            if (node == null || nodes.ContainsKey(node.InstanceId)) return null;
+
+            node.Parent = parent;
+            nodes[node.InstanceId] = node;
+
+            for (int cr = CM_Get_Child(out uint child, devInst, 0); cr == CR_SUCCESS; cr = CM_Get_Sibling(out child, child, 0))
+            {
+                var childNode = BuildSubtree(child, node);
+                if (childNode != null) node.Children.Add(childNode);
+            }
+
+            return node;
+        }
+
+        //Same inheritance InheritParentProp applies on a full build
+        private static void AddChild(UsbDeviceNode parent, UsbDeviceNode branch)
+        {
+            parent.Children.Add(branch);
+
+            if (string.IsNullOrEmpty(branch.Port))
+            {
+                branch.Port = parent.Port;
+                branch.PortPath = parent.PortPath;
+                branch.LastLocableInstanceId = parent.InstanceId;
+            }
+            branch.InheritParentProp();
+        }
+
+        private void Detach(UsbDeviceNode node)
+        {
+            if (node.Parent != null)
+                node.Parent.Children.Remove(node);
+            else
+                roots.Remove(node);
+
+            Forget(node);
+        }
+
+        private void Forget(UsbDeviceNode node)
+        {
+            nodes.Remove(node.InstanceId);
+            foreach (var child in node.Children)
+                Forget(child);
+        }
+
+        private static UsbDeviceNode ReadNode(uint devInst)
+        {
+            string instanceId = GetDeviceId(devInst);
+            if (instanceId == null) return null;
+
+            string description = GetDeviceName(devInst);
+            string locationPath = GetLocationPath(devInst);
+
+            return UsbDeviceTreeBuilder.CreateNode(instanceId, description, locationPath);
+        }
+
+        private static string GetDeviceId(uint devInst)
+        {
+            var idBuilder = new StringBuilder(512);
+            return CM_Get_Device_ID(devInst, idBuilder, idBuilder.Capacity, 0) == CR_SUCCESS ? idBuilder.ToString() : null;
+        }
+
+        private static string GetDeviceName(uint devInst)
+        {
+            uint size = 512;
+            var buffer = new byte[size];
+            int cr = CM_Get_DevNode_Property(devInst, ref DEVPKEY_NAME, out _, buffer, ref size, 0);
+            if (cr == CR_BUFFER_SMALL)
+            {
+                buffer = new byte[size];
+                cr = CM_Get_DevNode_Property(devInst, ref DEVPKEY_NAME, out _, buffer, ref size, 0);
+            }
+
+            return cr == CR_SUCCESS ? FirstString(buffer, size) : null;
+        }
+
+        private static string GetLocationPath(uint devInst)
+        {
+            uint size = 1024;
+            var buffer = new byte[size];
+            int cr = CM_Get_DevNode_Registry_Property(devInst, CM_DRP_LOCATION_PATHS, out _, buffer, ref size, 0);
+            if (cr == CR_BUFFER_SMALL)
+            {
+                buffer = new byte[size];
+                cr = CM_Get_DevNode_Registry_Property(devInst, CM_DRP_LOCATION_PATHS, out _, buffer, ref size, 0);
+            }
+
+            return cr == CR_SUCCESS ? FirstString(buffer, size) : "";
+        }
+
+        //First entry of a string or multi-string property
+        private static string FirstString(byte[] buffer, uint size)
+        {
+            string value = Encoding.Unicode.GetString(buffer, 0, (int)Math.Min(size, (uint)buffer.Length));
+            int end = value.IndexOf('\0');
+            return end >= 0 ? value.Substring(0, end) : value;
+        }
+
+        private static bool IsStorage(string deviceId)
+        {
+            return deviceId.StartsWith("USBSTOR\\", StringComparison.OrdinalIgnoreCase) ||
+                   deviceId.StartsWith("UASPSTOR\\", StringComparison.OrdinalIgnoreCase) ||
+                   deviceId.StartsWith("SCSI\\", StringComparison.OrdinalIgnoreCase);
+        }
+    }
+}
@@ -26,6 +26,10 @@ namespace EnumerationExtractionAgent
         public static int rescheduleCount = 0;
         private static System.Timers.Timer aTimer;
         private static System.Timers.Timer refreshTimer;        
+        private static UsbTopologyIndex usbTopology = new UsbTopologyIndex();
+        private static List<UsbDeviceNode.ExternalDriveInfo> externalDrives = null;
+        private const double TopologyDebounceMs = 50;   //coalesces the burst of events of one replug
+        private const double StorageDebounceMs = 500;   //drive letters are assigned after the disk shows up
         private static Win32UsbControllerDevices win32UsbControllerDevices = new Win32UsbControllerDevices(); // Create a USB device watcher
         public static bool devicesUpdatedFlag { get; set; } = false;
 
@@ -195,14 +199,18 @@ namespace EnumerationExtractionAgent
 
             // Build the tree
 
-            var builder = new UsbDeviceTreeBuilder();            
-            var roots = builder.BuildTree();
+            var builder = new UsbDeviceTreeBuilder();
+            bool fullWalk = usbTopology.Update();
+            var roots = usbTopology.GetUsbTree();
 
-            Console.WriteLine("Full USB Device Tree:");
+            if (fullWalk)
+                Console.WriteLine("Full USB Device Tree:");
+            else
+                Console.WriteLine($"USB Device Tree updated incrementally [{usbTopology.Count} nodes indexed]");
 
             foreach (var root in roots)
             {
-                root.PrintTree(); // Recursively prints each device and its children
+                if (fullWalk) root.PrintTree(); // Recursively prints each device and its children
                 //assign a level to each node from the root. Used to identify companion hubs in level 0
                 UsbDeviceTreeBuilder.AssignLevelsRecursive(root,-2); 
             }
@@ -214,7 +222,9 @@ namespace EnumerationExtractionAgent
             List<UsbDeviceNode> uniquehubs3 = new List<UsbDeviceNode>();
             List<UsbDeviceNode> duplicatehubs3 = new List<UsbDeviceNode>();
             int rootDuplicates = 0;
-            var ExternalDriveInfo = builder.GetDriveLetterByPNPDeviceId();
+            if (externalDrives == null || usbTopology.StorageChanged)
+                externalDrives = builder.GetDriveLetterByPNPDeviceId();
+            var ExternalDriveInfo = externalDrives;
 
             hubs3nodes.ForEach(p => p.PrintTree());
 
@@ -324,10 +334,11 @@ namespace EnumerationExtractionAgent
 
         public void Start()
         {
+            UsbEventLogQuery.Start();
             updateUSBDevices();
             //when there is an usb event, a delay is created to wait until the usb tree is updated
             aTimer = new System.Timers.Timer();
-            aTimer.Interval = 500;
+            aTimer.Interval = TopologyDebounceMs;
             aTimer.Elapsed += OnTimedEvent;
             aTimer.AutoReset = false;
 
@@ -362,6 +373,7 @@ namespace EnumerationExtractionAgent
             refreshTimer.Stop();
             refreshTimer.Dispose();
             win32UsbControllerDevices.StopWatcher();
+            UsbEventLogQuery.Stop();
         }
 
         public bool getUpdatedFlag()
@@ -384,8 +396,7 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device connected: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Connected");
-            aTimer.Stop();
-            aTimer.Start();
+            QueueTopologyChange(UsbTopologyChange.Added, e.Device?.DeviceId);
 
         }
 
@@ -394,8 +405,7 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device disconnected: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Disconnected");
-            aTimer.Stop();
-            aTimer.Start();
+            QueueTopologyChange(UsbTopologyChange.Removed, e.Device?.DeviceId);
 
         }
 
@@ -404,7 +414,14 @@ namespace EnumerationExtractionAgent
             //Console.WriteLine($"USB device modified: {e.Device.DeviceId}");
             //aTimer.Enabled = true;
             Console.WriteLine("Device Modified");
+            QueueTopologyChange(UsbTopologyChange.Modified, e.Device?.DeviceId);
+        }
+
+        private static void QueueTopologyChange(UsbTopologyChange kind, string deviceId)
+        {
+            usbTopology.Queue(kind, deviceId);
             aTimer.Stop();
+            aTimer.Interval = usbTopology.PendingStorage ? StorageDebounceMs : TopologyDebounceMs;
             aTimer.Start();
         }
 
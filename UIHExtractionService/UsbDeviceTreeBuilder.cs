@@ -241,35 +241,10 @@ namespace UEnumerationExtractionAgent
             foreach (ManagementObject device in searcher.Get())
             {                
                 string instanceId = (string)device["PNPDeviceID"];
-                string portHubInfo = ExtractPortHubInfo(instanceId);
                 string description = (string)device["Name"];
                 string locationPath = GetDeviceLocationPath(instanceId);
-                string portPath = ParseUsbPortPath(locationPath);                
-                string port = "";
-                string containerID = "";
-                string companionHub = "";
-                //Guid? contID = ContainerIdFetcher.GetContainerIdFromPnpDeviceId(instanceId);
-                //if (contID.HasValue) containerID = contID.ToString();
-
-                string lastLocableInstanceId = "";
-                if (!string.IsNullOrEmpty(portPath))
-                {
-                    var portparts = portPath.Split('-');
-                    port = portparts[portparts.Length-1];
-                    lastLocableInstanceId = instanceId;
-                }
 
-                var node = new UsbDeviceNode
-                {
-                    InstanceId = instanceId,
-                    Description = description ?? "Unknown Device",
-                    LocationPath = locationPath,
-                    PortPath = portPath,
-                    Port = port,
-                    ContainerID = containerID,
-                    CompanionHub = companionHub,
-                    LastLocableInstanceId = lastLocableInstanceId
-                };
+                var node = CreateNode(instanceId, description, locationPath);
 
                 nodes[instanceId] = node;
             }
@@ -306,6 +281,37 @@ namespace UEnumerationExtractionAgent
             return test;
         }
 
+        //Node fields derived from the instance ID and location path, shared with UsbTopologyIndex
+        internal static UsbDeviceNode CreateNode(string instanceId, string description, string locationPath)
+        {
+            string portPath = ParseUsbPortPath(locationPath);
+            string port = "";
+            string containerID = "";
+            string companionHub = "";
+            //Guid? contID = ContainerIdFetcher.GetContainerIdFromPnpDeviceId(instanceId);
+            //if (contID.HasValue) containerID = contID.ToString();
+
+            string lastLocableInstanceId = "";
+            if (!string.IsNullOrEmpty(portPath))
+            {
+                var portparts = portPath.Split('-');
+                port = portparts[portparts.Length-1];
+                lastLocableInstanceId = instanceId;
+            }
+
+            return new UsbDeviceNode
+            {
+                InstanceId = instanceId,
+                Description = description ?? "Unknown Device",
+                LocationPath = locationPath,
+                PortPath = portPath,
+                Port = port,
+                ContainerID = containerID,
+                CompanionHub = companionHub,
+                LastLocableInstanceId = lastLocableInstanceId
+            };
+        }
+
         public static void AssignLevelsRecursive(UsbDeviceNode node, int currentLevel = 0)
         {
             node.Level = currentLevel;
@@ -28,6 +28,15 @@ namespace EnumerationExtractionAgent
         public string COMName = "";
         public bool serialConnected = false;
         List<DeviceOnPort>[] PortsInfo = new List<DeviceOnPort>[4];
+
+        //Only changed channels are sent. Between changes a bare newline keeps the
+        //hub pcConnected timeout (2.5 s) alive, and a full frame is resent from time
+        //to time in case the hub lost its state without the port closing.
+        const int KeepAlivePeriodMs = 1000;
+        const int FullSyncPeriodMs = 30000;
+        String[] AckedChannels = new String[3];
+        DateTime LastSendTime = DateTime.MinValue;
+        DateTime LastFullSyncTime = DateTime.MinValue;
         public UsbInsightHub()
         {
             ClearPortsInfo();
@@ -62,6 +71,7 @@ namespace EnumerationExtractionAgent
                     _serialPort.Open();
                     _serialPort.DtrEnable = true; //use DTR if serial is read back. Disable if only is written
                     serialConnected = true;
+                    AckedChannels = new String[3]; //new connection, everything is sent again
                     //Console.WriteLine($"Connected to port:{COMName}");
                 }
                 catch (Exception ex)
@@ -175,10 +185,17 @@ namespace EnumerationExtractionAgent
             for (int i=0; i<3; i++)
             {
                 Console.Write($"Port {i+1}:");
-                PortsInfo[i].ForEach(x => Console.Write($"[{x.ShortName}-USB{x.HubType}]"));
+                PortsInfo[i].ForEach(x => Console.Write($"[{x.ShortName}-USB{x.HubType}{ConnectTime(x)}]"));
             }
         }
 
+        //Last connect logged by the UMDF host, only UMDF devices (WPD, storage) have one
+        private static String ConnectTime(DeviceOnPort device)
+        {
+            DateTime? time = UsbEventLogQuery.GetLastUsbConnectTime(device.PortNode?.InstanceId);
+            return time.HasValue ? " " + time.Value.ToString("HH:mm:ss") : "";
+        }
+
         private String Truncate(String s)
         {
             s = s.Length > 6 ? s.Substring(0, 6) : s;
@@ -186,138 +203,144 @@ namespace EnumerationExtractionAgent
             return s; 
         }
 
-        public void SendEnumeratorsToUIH()
+        //Builds the "CHn":{...} fragment of every channel
+        private String[] BuildChannelFrames()
         {
-            if(serialConnected && _serialPort.IsOpen)
-            {
-                string controllerFrameJSON = "";
+            //translation to old format
+            String[][] tr = new String[4][];
 
-                if (PortsInfo.Length != 0)
+            for (int i = 0; i<4; i++)
+            {
+                tr[i] = new String[] { String.Format("\"-\""), String.Format("\"-\""), "0", "0"};
+            }
+            
+            for(int j =0 ; j<4; j++)
+            {                        
+                if (PortsInfo[j].Count>0 && PortsInfo[j].Count <= 2)
                 {
-                    //translation to old format
-                    String[][] tr = new String[4][];
-
-                    for (int i = 0; i<4; i++)
+                    for (int k = 0; k < PortsInfo[j].Count; k++)
                     {
-                        tr[i] = new String[] { String.Format("\"-\""), String.Format("\"-\""), "0", "0"};
+                        var s = PortsInfo[j][k].ShortName;
+                        s = s.Length > 7 ? s.Substring(0, 7) : s;
+                        tr[j][k] = String.Format("\"{0}\"", s);  
                     }
-                    
-                    for(int j =0 ; j<4; j++)
-                    {                        
-                        if (PortsInfo[j].Count>0 && PortsInfo[j].Count <= 2)
-                        {
-                            for (int k = 0; k < PortsInfo[j].Count; k++)
-                            {
-                                var s = PortsInfo[j][k].ShortName;
-                                s = s.Length > 7 ? s.Substring(0, 7) : s;
-                                tr[j][k] = String.Format("\"{0}\"", s);  
-                            }
-
-                            tr[j][2] = PortsInfo[j].Count.ToString();
-                            tr[j][3] = PortsInfo[j][0].HubType;
-                        }
-                        if (PortsInfo[j].Count >= 3)
-                        {
-                            if (PortsInfo[j].Count == 3)
-                            {
-                                tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\"{0}\",\"align\":\"center\"}}," +
-                                                           "\"T2\":{{\"txt\":\"{1}\",\"align\":\"center\"}}," +
-                                                           "\"T3\":{{\"txt\":\"{2}\",\"align\":\"center\"}}}}",
-                                                           PortsInfo[j][0].ShortName, PortsInfo[j][1].ShortName, PortsInfo[j][2].ShortName
-                                                           );
-
-                            }
-                            if (PortsInfo[j].Count == 4)
-                            {
-                                tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\"{0},{2}\",\"align\":\"center\"}}," +
-                                                           "\"T2\":{{\"txt\":\"{1},{3}\",\"align\":\"center\"}}}}",                                                           
-                                                           Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
-                                                           Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName)
-                                                           );
-                            }
-                            if (PortsInfo[j].Count == 5)
-                            {
-                                tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"left\"}}," +
-                                                           "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"left\"}}," +
-                                                           "\"T3\":{{\"txt\":\" {2}\",\"align\":\"left\"}}}}",
-                                                           Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
-                                                           Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
-                                                           Truncate(PortsInfo[j][4].ShortName)
-                                                           );
-                            }
-                            if (PortsInfo[j].Count == 6)
-                            {
-                                tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"center\"}}," +
-                                                           "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"center\"}}," +
-                                                           "\"T3\":{{\"txt\":\" {2},{5}\",\"align\":\"center\"}}}}",
-                                                           Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
-                                                           Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
-                                                           Truncate(PortsInfo[j][4].ShortName), Truncate(PortsInfo[j][5].ShortName)
-                                                           );
-                            }
-                            if (PortsInfo[j].Count > 6)
-                            {
-                                tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"center\"}}," +
-                                                           "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"center\"}}," +
-                                                           "\"T3\":{{\"txt\":\" {2}, +{5}\",\"align\":\"center\"}}}}",
-                                                           Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
-                                                           Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
-                                                           Truncate(PortsInfo[j][4].ShortName), PortsInfo[j].Count-5
-                                                           );
-                            }
-
-
-                            tr[j][2] = "10";
-                            tr[j][3] = PortsInfo[j][0].HubType;
-                        }
 
+                    tr[j][2] = PortsInfo[j].Count.ToString();
+                    tr[j][3] = PortsInfo[j][0].HubType;
+                }
+                if (PortsInfo[j].Count >= 3)
+                {
+                    if (PortsInfo[j].Count == 3)
+                    {
+                        tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\"{0}\",\"align\":\"center\"}}," +
+                                                   "\"T2\":{{\"txt\":\"{1}\",\"align\":\"center\"}}," +
+                                                   "\"T3\":{{\"txt\":\"{2}\",\"align\":\"center\"}}}}",
+                                                   PortsInfo[j][0].ShortName, PortsInfo[j][1].ShortName, PortsInfo[j][2].ShortName
+                                                   );
 
+                    }
+                    if (PortsInfo[j].Count == 4)
+                    {
+                        tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\"{0},{2}\",\"align\":\"center\"}}," +
+                                                   "\"T2\":{{\"txt\":\"{1},{3}\",\"align\":\"center\"}}}}",                                                           
+                                                   Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
+                                                   Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName)
+                                                   );
+                    }
+                    if (PortsInfo[j].Count == 5)
+                    {
+                        tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"left\"}}," +
+                                                   "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"left\"}}," +
+                                                   "\"T3\":{{\"txt\":\" {2}\",\"align\":\"left\"}}}}",
+                                                   Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
+                                                   Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
+                                                   Truncate(PortsInfo[j][4].ShortName)
+                                                   );
+                    }
+                    if (PortsInfo[j].Count == 6)
+                    {
+                        tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"center\"}}," +
+                                                   "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"center\"}}," +
+                                                   "\"T3\":{{\"txt\":\" {2},{5}\",\"align\":\"center\"}}}}",
+                                                   Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
+                                                   Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
+                                                   Truncate(PortsInfo[j][4].ShortName), Truncate(PortsInfo[j][5].ShortName)
+                                                   );
+                    }
+                    if (PortsInfo[j].Count > 6)
+                    {
+                        tr[j][0] = String.Format("{{\"T1\":{{\"txt\":\" {0},{3}\",\"align\":\"center\"}}," +
+                                                   "\"T2\":{{\"txt\":\" {1},{4}\",\"align\":\"center\"}}," +
+                                                   "\"T3\":{{\"txt\":\" {2}, +{5}\",\"align\":\"center\"}}}}",
+                                                   Truncate(PortsInfo[j][0].ShortName), Truncate(PortsInfo[j][1].ShortName),
+                                                   Truncate(PortsInfo[j][2].ShortName), Truncate(PortsInfo[j][3].ShortName),
+                                                   Truncate(PortsInfo[j][4].ShortName), PortsInfo[j].Count-5
+                                                   );
+                    }
 
-                        if (PortsInfo[j].Count >= 4 && PortsInfo[j].Count <= 6)
-                        {
-                            String[][] line = new String[3][];
-                            for (int k = 0 ; k< 3; k++)
-                            {
-                                line[k] = new String [] { "-", "-" };
-                            }
+                    tr[j][2] = "10";
+                    tr[j][3] = PortsInfo[j][0].HubType;
+                }
+            }
 
-                        }
+            String[] frames = new String[3];
+            for (int j = 0; j < 3; j++)
+            {
+                frames[j] = String.Format("\"CH{0}\":{{\"Dev1_name\":{1},\"Dev2_name\":{2},\"numDev\":\"{3}\",\"usbType\":\"{4}\"}}",
+                    j + 1, tr[j][0], tr[j][1], tr[j][2], tr[j][3]);
+            }
+            return frames;
+        }
 
-                    }
+        public void SendEnumeratorsToUIH()
+        {
+            if(serialConnected && _serialPort.IsOpen)
+            {
+                DateTime now = DateTime.Now;
+                String[] frames = BuildChannelFrames();
+                bool fullSync = (now - LastFullSyncTime).TotalMilliseconds >= FullSyncPeriodMs;
 
-                    controllerFrameJSON = String.Format("{{\"action\":\"set\",\"params\":{{" +
-                        "\"CH1\":{{\"Dev1_name\":{0},\"Dev2_name\":{1},\"numDev\":\"{2}\",\"usbType\":\"{3}\"}}," +
-                        "\"CH2\":{{\"Dev1_name\":{4},\"Dev2_name\":{5},\"numDev\":\"{6}\",\"usbType\":\"{7}\"}}," +
-                        "\"CH3\":{{\"Dev1_name\":{8},\"Dev2_name\":{9},\"numDev\":\"{10}\",\"usbType\":\"{11}\"}}" +
-                        "}}}}",
-                        tr[0][0], tr[0][1], tr[0][2], tr[0][3],
-                        tr[1][0], tr[1][1], tr[1][2], tr[1][3],
-                        tr[2][0], tr[2][1], tr[2][2], tr[2][3]
-                        );
+                List<int> changed = new List<int>();
+                for (int j = 0; j < frames.Length; j++)
+                {
+                    if (fullSync || frames[j] != AckedChannels[j]) changed.Add(j);
                 }
-                else
-                    controllerFrameJSON = String.Format("{{ \"action\":\"set\",\"params\":{{ \"ledState\":\"false\"}}}}");
 
                 try
                 {
-                    //Console.WriteLine(controllerFrameJSON);
-                    _serialPort.WriteLine(controllerFrameJSON);
+                    if (changed.Count > 0)
+                    {
+                        String controllerFrameJSON = "{\"action\":\"set\",\"params\":{" +
+                            String.Join(",", changed.Select(j => frames[j])) + "}}";
+                        //Console.WriteLine(controllerFrameJSON);
+                        _serialPort.WriteLine(controllerFrameJSON);
+                        LastSendTime = now;
+                        if (fullSync) LastFullSyncTime = now;
+
+                        //channels are acknowledged only when the hub answers, otherwise they are sent again
+                        try
+                        {
+                            var res = _serialPort.ReadLine();
+                            //Console.WriteLine(res);
+                            if (res.Contains("\"status\":\"ok\""))
+                                changed.ForEach(j => AckedChannels[j] = frames[j]);
+                        }
+                        catch (TimeoutException)
+                        {
+                        }
+                    }
+                    else if ((now - LastSendTime).TotalMilliseconds >= KeepAlivePeriodMs)
+                    {
+                        //the firmware takes an empty line as activity without parsing it
+                        _serialPort.Write("\n");
+                        LastSendTime = now;
+                    }
                 }
                 catch(Exception ex)
                 {
                     Console.WriteLine($"Port {COMName} error:{ex.ToString()}");
                     serialConnected = false;
                 }
-                try
-                {                                        
-                    var res = _serialPort.ReadLine();
-                    //Console.WriteLine(res);
-                }
-                catch (Exception ex)
-                {
-
-                }
-
             }
             else
             {   
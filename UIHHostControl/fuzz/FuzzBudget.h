@@ -0,0 +1,49 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Per input time budget of the fuzz targets: an input slower than the budget
+//aborts, so the fuzzer keeps it as a crash like any other finding. libFuzzer's
+//-timeout only goes down to whole seconds, far above what the hub can afford.
+//UIH_FUZZ_BUDGET_US overrides the default of the target.
+
+#ifndef UIH_FUZZ_BUDGET_H
+#define UIH_FUZZ_BUDGET_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+class FuzzBudget {
+public:
+    explicit FuzzBudget(long defaultUs) : _start(std::chrono::steady_clock::now()) {
+        static long budgetUs = 0;
+        if (budgetUs == 0) {
+            const char* env = getenv("UIH_FUZZ_BUDGET_US");
+            budgetUs = env ? atol(env) : defaultUs;
+        }
+        _budgetUs = budgetUs;
+    }
+
+    ~FuzzBudget() {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+        if (_budgetUs > 0 && us > _budgetUs) {
+            fprintf(stderr, "input took %lld us, budget %ld us\n", (long long)us, _budgetUs);
+            abort();
+        }
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+    long _budgetUs;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Runs the files given (or every file of the directories given) through a fuzz
+//target once, for compilers without libFuzzer. The sanitizers and the time
+//budget still apply, so a corpus or a crash input can be checked with GCC.
+
+#include <cstdint>
+#include <cstdio>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static int runFile(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        perror(path.c_str());
+        return 0;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf.data(), buf.size());
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            DIR* dir = opendir(argv[i]);
+            if (!dir) continue;
+            while (struct dirent* e = readdir(dir)) {
+                std::string path = std::string(argv[i]) + "/" + e->d_name;
+                if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) count += runFile(path);
+            }
+            closedir(dir);
+        } else {
+            count += runFile(argv[i]);
+        }
+    }
+    printf("%d inputs ok\n", count);
+    return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Fuzz target of the firmware CDC framer (CdcProtocol.cpp): request lines, image
+//mode with any bits per pixel byte, line overflow and the inter chunk timeout.
+//The image buffers are handled as Extercomms does, so ASan sees every pixel
+//write. The same input is also read as a capture file, as cdcreplay does.
+//Input: byte 0 sets the chunk size (1 to 64), byte 1 the time between chunks
+//(8 ms steps, past the framer timeout from 126), the rest is the CDC stream.
+
+#include "CdcProtocol.h"
+#include "FuzzBudget.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#define FRAMER_BUDGET_US 20000
+
+struct Hub {
+    uint8_t* img[CDC_IMAGE_PORTS];
+    uint8_t imgBpp[CDC_IMAGE_PORTS];
+    size_t imgLen[CDC_IMAGE_PORTS];
+};
+
+static uint8_t* hubImageStart(void* ctx, uint8_t port, uint8_t bpp, size_t len) {
+    Hub* h = (Hub*)ctx;
+    if (port >= CDC_IMAGE_PORTS || !CDC_IMAGE_BPP_OK(bpp)) abort();
+    if (h->img[port] == nullptr || h->imgBpp[port] != bpp) {
+        free(h->img[port]);
+        h->img[port] = (uint8_t*)malloc(len);
+        h->imgLen[port] = len;
+    }
+    h->imgBpp[port] = 0;
+    return h->img[port];
+}
+
+static void hubImageDone(void* ctx, uint8_t port, uint8_t bpp, bool stored) {
+    Hub* h = (Hub*)ctx;
+    if (port >= CDC_IMAGE_PORTS) abort();
+    if (bpp == 0) {
+        free(h->img[port]);
+        h->img[port] = nullptr;
+        h->imgBpp[port] = 0;
+    } else if (stored) {
+        //what the renderer reads, 226 x 90 pixels at bpp
+        if (h->imgLen[port] < (size_t)CDC_IMAGE_PIXELS * bpp / 8) abort();
+        volatile uint8_t last = h->img[port][h->imgLen[port] - 1];
+        (void)last;
+        h->imgBpp[port] = bpp;
+    }
+}
+
+static void hubLine(void* ctx, const char* line, size_t len) {
+    (void)ctx;
+    if (len == 0 || len >= CDC_LINE_MAX || line[len] != '\0' || line[len - 1] != '\n') abort();
+    if (strlen(line) > len) abort();
+}
+
+static void hubOverflow(void* ctx) {
+    (void)ctx;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 2) return 0;
+    FuzzBudget budget(FRAMER_BUDGET_US);
+
+    size_t chunk = 1 + data[0] % 64;
+    uint32_t stepMs = data[1] * 8;
+    Hub hub = {};
+    CdcFramerOps ops = {hubImageStart, hubImageDone, hubLine, hubOverflow, &hub};
+    static CdcFramer framer;
+    cdcFramerReset(&framer);
+
+    uint32_t now = 0;
+    for (size_t pos = 2; pos < size; pos += chunk) {
+        size_t n = size - pos < chunk ? size - pos : chunk;
+        //the capture elides the pending pixels, they can't be more than the image
+        size_t pending = cdcFramerImagePending(&framer, now);
+        if (pending > (size_t)CDC_IMAGE_PIXELS * 255 / 8 + 1) abort();
+        cdcFramerFeed(&framer, data + pos, n, now, &ops);
+        now += stepMs;
+    }
+    for (int p = 0; p < CDC_IMAGE_PORTS; p++) free(hub.img[p]);
+
+    size_t pos = 0;
+    CdcCapRecord rec;
+    while (cdcCapNext(data, size, &pos, &rec)) {
+        if (pos > size) abort();
+        if (rec.data && (rec.data < data || rec.data + rec.len > data + size)) abort();
+    }
+    return 0;
+}
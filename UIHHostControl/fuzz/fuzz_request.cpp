@@ -0,0 +1,105 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Fuzz target of a serial JSON request as processJsonRpcMessage reads it: the
+//document, the "set" values through CdcParams.cpp, the channel objects and the
+//flex labels through FlexLayout.cpp, into a mocked port state. The request
+//handler itself needs the whole firmware; everything it takes from the host goes
+//through these functions.
+//Input: one request line.
+
+#include "CdcParams.h"
+#include "FlexLayout.h"
+#include "FuzzBudget.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#define REQUEST_BUDGET_US 20000
+
+static const char* const boolNames[] = {"false", "true"};
+static const char* const hubModeNames[] = {"usb2&3", "usb2", "usb3"};
+
+//the part of GlobalState a set request writes
+struct MockPort {
+    uint32_t numDev;
+    uint32_t usbType;
+    uint32_t limit[6];
+    int flags[6];
+    FlexLayout flex;
+};
+
+static void setChannel(JsonObjectConst ch, MockPort& port) {
+    static const char* const enumKeys[] = {"powerEn", "dataEn", "fwdAlert", "backAlert", "shortAlert"};
+    static const char* const rangeKeys[] = {"startup_tmr", "fwdLimit", "backLimit", "uvLimit", "ovLimit", "opLimit"};
+    static const uint32_t rangeMin[] = {1, 100, 1, 3000, 5000, 500};
+    static const uint32_t rangeMax[] = {100, 2000, 200, 5000, 6000, 15000};
+    uint32_t val;
+
+    for (int k = 0; k < 5; k++) {
+        int inx = cdcEnumParam(ch[enumKeys[k]], boolNames, 2);
+        if (inx < -1 || inx > 1) abort();
+        if (inx != -1) port.flags[k] = inx;
+    }
+    for (int k = 0; k < 6; k++) {
+        if (cdcRangeParam(ch[rangeKeys[k]], rangeMin[k], rangeMax[k], &val)) {
+            if (val < rangeMin[k] || val > rangeMax[k]) abort();
+            port.limit[k] = val;
+        }
+    }
+    if (cdcRangeParam(ch["numDev"], 0, 11, &val)) {
+        if (val > 11) abort();
+        port.numDev = val;
+    }
+    if (cdcRangeParam(ch["usbType"], 0, 3, &val)) {
+        if (val > 3) abort();
+        port.usbType = val;
+    }
+    if (!ch["Dev1_name"].isNull()) {
+        flexLayoutParse(ch["Dev1_name"], &port.flex);
+        if (port.flex.numLines > FLEX_MAX_LINES) abort();
+        for (int l = 0; l < port.flex.numLines; l++)
+            if (strnlen(port.flex.line[l].txt, FLEX_LINE_CHARS + 1) > FLEX_LINE_CHARS) abort();
+        uint8_t top = flexLayoutTop(&port.flex, 123456);
+        if (port.flex.numLines > FLEX_VISIBLE_LINES && top > port.flex.numLines - FLEX_VISIBLE_LINES) abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzBudget budget(REQUEST_BUDGET_US);
+    static MockPort ports[3];
+
+    JsonDocument doc;
+    if (deserializeJson(doc, (const char*)data, size)) return 0;
+    if (!doc["action"] || !doc["params"]) return 0;
+
+    const char* action = doc["action"];
+    if (action && strcmp(action, "set") == 0) {
+        JsonObjectConst params = doc["params"].as<JsonObjectConst>();
+        uint32_t val;
+        cdcEnumParam(params["hubMode"], hubModeNames, 3);
+        cdcEnumParam(params["ledState"], boolNames, 2);
+        cdcRangeParam(params["brightness"], 10, 100, &val);
+        char key[4] = "CH";
+        for (int i = 0; i < 3; i++) {
+            key[2] = '1' + i;
+            JsonObjectConst ch = params[key].as<JsonObjectConst>();
+            if (!ch.isNull()) setChannel(ch, ports[i]);
+        }
+    } else if (action && strcmp(action, "get") == 0) {
+        //names are only compared, a non string one reads as null
+        for (JsonVariantConst v : doc["params"].as<JsonArrayConst>())
+            if (v.as<const char*>() == nullptr && v.is<const char*>()) abort();
+    }
+    return 0;
+}
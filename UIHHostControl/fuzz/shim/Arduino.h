@@ -0,0 +1,38 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//The few Arduino definitions the firmware parsers use, to build them on the host.
+//ARDUINO stays undefined so ArduinoJson keeps to the standard library.
+
+#ifndef UIH_FUZZ_ARDUINO_SHIM_H
+#define UIH_FUZZ_ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+//not in every libc
+static inline size_t uihStrlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#define strlcpy uihStrlcpy
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Request builders and answer readers for the Extercomms "get"/"set" actions
+
+#ifndef UIH_COMMANDS_H
+#define UIH_COMMANDS_H
+
+#include "uih/Json.h"
+
+#include <string>
+#include <vector>
+
+namespace uih {
+
+#define UIH_NUM_CHANNELS 3
+
+struct ChannelMeter {
+    double voltage = 0;     //mV
+    double current = 0;     //mA
+    bool powerEn = false;
+    bool dataEn = false;
+    bool fwdAlert = false;
+    bool backAlert = false;
+    bool shortAlert = false;
+    bool sagAlert = false;  //VBUS went under the UV limit since the port was switched on
+    bool ovAlert = false;
+    bool opAlert = false;
+};
+
+//{"action":"get","params":[...]}
+std::string cmdGet(const std::vector<std::string>& params);
+//{"action":"set","params":{...}}
+std::string cmdSet(const JsonValue& params);
+//{"action":"set","params":{"CHn":{key:value}}}, booleans go as "true"/"false" like t_bool
+std::string cmdSetChannel(int ch, const std::string& key, const std::string& value);
+std::string cmdPower(int ch, bool on);
+std::string cmdData(int ch, bool on);
+//get CH1..CH3, answer is read with readMeters()
+std::string cmdMeters();
+
+//Fill ch[0..2] from a cmdMeters() answer, false when the answer has no channel data
+bool readMeters(const JsonValue& answer, ChannelMeter ch[UIH_NUM_CHANNELS]);
+
+} // namespace uih
+
+#endif
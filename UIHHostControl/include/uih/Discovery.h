@@ -0,0 +1,40 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Finds the ESP32 CDC ports of all connected hubs through sysfs
+
+#ifndef UIH_DISCOVERY_H
+#define UIH_DISCOVERY_H
+
+#include <string>
+#include <vector>
+
+namespace uih {
+
+//Same identification used by the Windows agent (EnumerationExtractionAgent.cs)
+#define UIH_CONTROLLER_VID      "303a"
+#define UIH_CONTROLLER_PID      "1001"
+#define UIH_CONTROLLER_PRODUCT  "InsightHUB Controller"
+
+struct HubInfo {
+    std::string devPath;    //ex. /dev/ttyACM0
+    std::string serial;     //USB iSerial, usually the ESP32 MAC
+    std::string usbPath;    //sysfs bus path, ex. 1-1.4 (stable per physical port)
+};
+
+//Scan /sys/class/tty for CDC-ACM ports that belong to an InsightHUB Controller.
+//sysRoot can be changed to point to a fake tree.
+std::vector<HubInfo> discoverHubs(const std::string& sysRoot = "/sys");
+
+} // namespace uih
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Non-blocking serial session with one hub speaking the Extercomms JSON protocol
+
+#ifndef UIH_HUBCONNECTION_H
+#define UIH_HUBCONNECTION_H
+
+#include "uih/Json.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace uih {
+
+using Clock = std::chrono::steady_clock;
+
+#define UIH_DEFAULT_TIMEOUT_MS   1000
+//The firmware keeps a single line buffer that is consumed every SERIAL_CHECK_PERIOD (50 ms),
+//a second line sent before the first one is answered overwrites it. Keep one in flight.
+#define UIH_DEFAULT_IN_FLIGHT    1
+//Quiet time after a timeout before the next request, late answers received here are dropped
+#define UIH_RESYNC_QUIET_MS      150
+#define UIH_LATENCY_WINDOW       1024
+
+struct Response {
+    bool ok = false;            //"status":"ok" received
+    bool timedOut = false;
+    bool disconnected = false;
+    std::string raw;            //line as received, without line ending
+    JsonValue json;
+    double latencyMs = 0;
+};
+
+class HubConnection;
+using ResponseHandler = std::function<void(HubConnection&, const Response&)>;
+
+//Running latency figures, percentiles are computed over the last UIH_LATENCY_WINDOW samples
+class LatencyStats {
+public:
+    void add(double ms);
+    void addTimeout() { timeouts_++; }
+    void addError() { errors_++; }
+
+    uint64_t count() const { return count_; }
+    uint64_t timeouts() const { return timeouts_; }
+    uint64_t errors() const { return errors_; }
+    double min() const { return count_ ? min_ : 0; }
+    double max() const { return max_; }
+    double mean() const { return count_ ? sum_ / count_ : 0; }
+    double percentile(double p) const;
+
+private:
+    uint64_t count_ = 0;
+    uint64_t timeouts_ = 0;
+    uint64_t errors_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+    double sum_ = 0;
+    std::vector<double> window_;
+    size_t next_ = 0;
+};
+
+class HubConnection {
+public:
+    explicit HubConnection(std::string devPath, std::string label = "");
+    ~HubConnection();
+
+    HubConnection(const HubConnection&) = delete;
+    HubConnection& operator=(const HubConnection&) = delete;
+
+    bool open(std::string* err = nullptr);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+
+    const std::string& path() const { return path_; }
+    const std::string& label() const { return label_; }
+
+    //Queue a request line (newline is appended). Requests are written back to back as soon
+    //as the in-flight window allows; answers are matched in order since the firmware has no ids.
+    uint64_t submit(const std::string& line, ResponseHandler cb, int timeoutMs = UIH_DEFAULT_TIMEOUT_MS);
+
+    void setMaxInFlight(size_t n) { maxInFlight_ = n ? n : 1; }
+    size_t pending() const { return queued_.size() + inFlight_.size(); }
+    const LatencyStats& stats() const { return stats_; }
+
+    //Event loop hooks, used by HubPool
+    bool wantsWrite() const { return !txBuf_.empty(); }
+    bool onReadable();                  //false when the device went away
+    bool onWritable();
+    void onTick(Clock::time_point now);
+    bool nextDeadline(Clock::time_point& when) const;
+    void failAll();                     //answer every pending request as disconnected
+
+private:
+    struct Request {
+        uint64_t id;
+        std::string line;
+        ResponseHandler cb;
+        int timeoutMs;
+        Clock::time_point sentAt;
+        Clock::time_point deadline;
+    };
+
+    std::string path_;
+    std::string label_;
+    int fd_ = -1;
+    size_t maxInFlight_ = UIH_DEFAULT_IN_FLIGHT;
+    uint64_t nextId_ = 1;
+    std::deque<Request> queued_;
+    std::deque<Request> inFlight_;
+    std::string txBuf_;
+    std::string rxBuf_;
+    Clock::time_point quietUntil_{};
+    LatencyStats stats_;
+
+    void pump();
+    void handleLine(const std::string& line);
+};
+
+} // namespace uih
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Set of hub connections driven by a single epoll loop, with fan-out helpers
+
+#ifndef UIH_HUBPOOL_H
+#define UIH_HUBPOOL_H
+
+#include "uih/Discovery.h"
+#include "uih/HubConnection.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uih {
+
+struct FanOutResult {
+    HubConnection* hub;
+    Response response;
+};
+
+class HubPool {
+public:
+    HubPool();
+    ~HubPool();
+
+    HubPool(const HubPool&) = delete;
+    HubPool& operator=(const HubPool&) = delete;
+
+    //Open a port and register it in the loop. Returns nullptr and fills err on failure
+    HubConnection* add(const std::string& devPath, const std::string& label = "", std::string* err = nullptr);
+    //Add every hub found by discoverHubs(), returns the number of hubs opened
+    size_t addDiscovered(std::vector<std::string>* errors = nullptr);
+
+    const std::vector<std::unique_ptr<HubConnection>>& hubs() const { return hubs_; }
+    size_t pending() const;
+
+    //Wait up to maxWaitMs for I/O or a deadline and dispatch it
+    void runOnce(int maxWaitMs);
+    //Loop until no request is pending or maxMs elapsed. Returns true when idle
+    bool runUntilIdle(int maxMs);
+    //Keep the loop (and the hub sessions) running for a fixed time
+    void runFor(int ms);
+
+    //Send the same line to every hub and wait for all answers
+    std::vector<FanOutResult> fanOut(const std::string& line, int timeoutMs = UIH_DEFAULT_TIMEOUT_MS);
+
+private:
+    int epfd_ = -1;
+    std::vector<std::unique_ptr<HubConnection>> hubs_;
+
+    void updateInterest(HubConnection* hub);
+    void drop(HubConnection* hub);
+};
+
+} // namespace uih
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Minimal JSON value used to build requests and read hub responses
+
+#ifndef UIH_JSON_H
+#define UIH_JSON_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uih {
+
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+    JsonValue(bool b) : type_(Type::Bool), bool_(b) {}
+    JsonValue(double n) : type_(Type::Number), num_(n) {}
+    JsonValue(int n) : type_(Type::Number), num_(n) {}
+    JsonValue(const char* s) : type_(Type::String), str_(s) {}
+    JsonValue(std::string s) : type_(Type::String), str_(std::move(s)) {}
+
+    static JsonValue array();
+    static JsonValue object();
+
+    //Parse a complete JSON text. Returns false and fills err on malformed input
+    static bool parse(const std::string& text, JsonValue& out, std::string* err = nullptr);
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isBool() const { return type_ == Type::Bool; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+
+    bool asBool(bool def = false) const;
+    double asNumber(double def = 0) const;      //also converts numeric strings, the firmware sends "5012.3"
+    std::string asString(const std::string& def = "") const;
+
+    //Lookup, returns a shared null value when the key/index is not present
+    const JsonValue& operator[](const std::string& key) const;
+    const JsonValue& operator[](size_t index) const;
+    bool has(const std::string& key) const;
+    size_t size() const;
+
+    //Builders
+    JsonValue& set(const std::string& key, JsonValue value);
+    JsonValue& push(JsonValue value);
+
+    const std::vector<std::pair<std::string, JsonValue>>& members() const { return obj_; }
+    const std::vector<JsonValue>& items() const { return arr_; }
+
+    std::string dump() const;
+
+private:
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double num_ = 0;
+    std::string str_;
+    std::vector<JsonValue> arr_;
+    std::vector<std::pair<std::string, JsonValue>> obj_;    //keeps insertion order like ArduinoJson
+
+    void dumpTo(std::string& out) const;
+};
+
+void jsonEscape(const std::string& in, std::string& out);
+
+} // namespace uih
+
+#endif
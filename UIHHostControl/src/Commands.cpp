@@ -0,0 +1,73 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Request builders and answer readers for the Extercomms "get"/"set" actions
+
+#include "uih/Commands.h"
+
+namespace uih {
+
+std::string cmdGet(const std::vector<std::string>& params) {
+    JsonValue req = JsonValue::object();
+    req.set("action", "get");
+    JsonValue& p = req.set("params", JsonValue::array());
+    for (const auto& s : params) p.push(s);
+    return req.dump();
+}
+
+std::string cmdSet(const JsonValue& params) {
+    JsonValue req = JsonValue::object();
+    req.set("action", "set");
+    req.set("params", params);
+    return req.dump();
+}
+
+std::string cmdSetChannel(int ch, const std::string& key, const std::string& value) {
+    JsonValue params = JsonValue::object();
+    params.set("CH" + std::to_string(ch), JsonValue::object()).set(key, value);
+    return cmdSet(params);
+}
+
+std::string cmdPower(int ch, bool on) {
+    return cmdSetChannel(ch, "powerEn", on ? "true" : "false");
+}
+
+std::string cmdData(int ch, bool on) {
+    return cmdSetChannel(ch, "dataEn", on ? "true" : "false");
+}
+
+std::string cmdMeters() {
+    return cmdGet({"CH1", "CH2", "CH3"});
+}
+
+bool readMeters(const JsonValue& answer, ChannelMeter ch[UIH_NUM_CHANNELS]) {
+    const JsonValue& data = answer["data"];
+    bool any = false;
+    for (int i = 0; i < UIH_NUM_CHANNELS; i++) {
+        const JsonValue& c = data["CH" + std::to_string(i + 1)];
+        if (!c.isObject()) continue;
+        ch[i].voltage = c["voltage"].asNumber();
+        ch[i].current = c["current"].asNumber();
+        ch[i].powerEn = c["powerEn"].asBool();
+        ch[i].dataEn = c["dataEn"].asBool();
+        ch[i].fwdAlert = c["fwdAlert"].asBool();
+        ch[i].backAlert = c["backAlert"].asBool();
+        ch[i].shortAlert = c["shortAlert"].asBool();
+        ch[i].sagAlert = c["sagAlert"].asBool();
+        ch[i].ovAlert = c["ovAlert"].asBool();
+        ch[i].opAlert = c["opAlert"].asBool();
+        any = true;
+    }
+    return any;
+}
+
+} // namespace uih
@@ -0,0 +1,85 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Finds the ESP32 CDC ports of all connected hubs through sysfs
+
+#include "uih/Discovery.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <strings.h>
+
+namespace uih {
+
+static std::string readAttr(const std::string& dir, const char* name) {
+    std::ifstream f(dir + "/" + name);
+    std::string s;
+    std::getline(f, s);
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' || s.back() == ' '))
+        s.pop_back();
+    return s;
+}
+
+static std::string parentDir(const std::string& path) {
+    size_t p = path.find_last_of('/');
+    return p == std::string::npos ? std::string() : path.substr(0, p);
+}
+
+static std::string baseName(const std::string& path) {
+    size_t p = path.find_last_of('/');
+    return p == std::string::npos ? path : path.substr(p + 1);
+}
+
+std::vector<HubInfo> discoverHubs(const std::string& sysRoot) {
+    std::vector<HubInfo> hubs;
+    std::string ttyDir = sysRoot + "/class/tty";
+    DIR* d = opendir(ttyDir.c_str());
+    if (!d) return hubs;
+
+    while (dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.rfind("ttyACM", 0) != 0) continue;
+
+        //device -> usb interface (x-y:1.0), its parent is the usb device holding the descriptors
+        char resolved[PATH_MAX];
+        std::string link = ttyDir + "/" + name + "/device";
+        if (!realpath(link.c_str(), resolved)) continue;
+        std::string usbDev = parentDir(resolved);
+
+        std::string vid = readAttr(usbDev, "idVendor");
+        std::string pid = readAttr(usbDev, "idProduct");
+        std::string product = readAttr(usbDev, "product");
+
+        bool match = product == UIH_CONTROLLER_PRODUCT ||
+                     (strcasecmp(vid.c_str(), UIH_CONTROLLER_VID) == 0 &&
+                      strcasecmp(pid.c_str(), UIH_CONTROLLER_PID) == 0);
+        if (!match) continue;
+
+        HubInfo info;
+        info.devPath = "/dev/" + name;
+        info.serial = readAttr(usbDev, "serial");
+        info.usbPath = baseName(usbDev);
+        hubs.push_back(info);
+    }
+    closedir(d);
+
+    //Stable order so fan-out output lines up between runs
+    std::sort(hubs.begin(), hubs.end(), [](const HubInfo& a, const HubInfo& b) {
+        return a.usbPath < b.usbPath;
+    });
+    return hubs;
+}
+
+} // namespace uih
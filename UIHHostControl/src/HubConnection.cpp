@@ -0,0 +1,239 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Non-blocking serial session with one hub speaking the Extercomms JSON protocol
+
+#include "uih/HubConnection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace uih {
+
+#define RX_CHUNK        512
+#define MAX_LINE_LEN    4096   //anything longer is garbage, firmware answers fit in 1 KB
+
+void LatencyStats::add(double ms) {
+    if (count_ == 0 || ms < min_) min_ = ms;
+    if (ms > max_) max_ = ms;
+    sum_ += ms;
+    count_++;
+    if (window_.size() < UIH_LATENCY_WINDOW) {
+        window_.push_back(ms);
+    } else {
+        window_[next_] = ms;
+        next_ = (next_ + 1) % UIH_LATENCY_WINDOW;
+    }
+}
+
+double LatencyStats::percentile(double p) const {
+    if (window_.empty()) return 0;
+    std::vector<double> sorted(window_);
+    std::sort(sorted.begin(), sorted.end());
+    size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+HubConnection::HubConnection(std::string devPath, std::string label)
+    : path_(std::move(devPath)), label_(std::move(label)) {
+    if (label_.empty()) label_ = path_;
+}
+
+HubConnection::~HubConnection() {
+    close();
+}
+
+bool HubConnection::open(std::string* err) {
+    if (fd_ >= 0) return true;
+    int fd = ::open(path_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        if (err) *err = path_ + ": " + strerror(errno);
+        return false;
+    }
+
+    //Raw 8N1, the CDC ignores the baud rate but a tty in cooked mode would mangle image bytes
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B115200);
+        cfsetospeed(&tio, B115200);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 1;     //with O_NONBLOCK an empty read gives EAGAIN instead of 0
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    fd_ = fd;
+    rxBuf_.clear();
+    txBuf_.clear();
+    return true;
+}
+
+void HubConnection::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t HubConnection::submit(const std::string& line, ResponseHandler cb, int timeoutMs) {
+    Request r;
+    r.id = nextId_++;
+    r.line = line;
+    if (r.line.empty() || r.line.back() != '\n') r.line += '\n';
+    r.cb = std::move(cb);
+    r.timeoutMs = timeoutMs;
+    uint64_t id = r.id;
+    queued_.push_back(std::move(r));
+    pump();
+    return id;
+}
+
+//Move queued requests to the wire while the window allows
+void HubConnection::pump() {
+    if (fd_ < 0) return;
+    Clock::time_point now = Clock::now();
+    if (now < quietUntil_) return;
+
+    while (!queued_.empty() && inFlight_.size() < maxInFlight_) {
+        Request r = std::move(queued_.front());
+        queued_.pop_front();
+        r.sentAt = now;
+        r.deadline = now + std::chrono::milliseconds(r.timeoutMs);
+        txBuf_ += r.line;
+        inFlight_.push_back(std::move(r));
+    }
+    if (!txBuf_.empty()) onWritable();
+}
+
+bool HubConnection::onWritable() {
+    while (!txBuf_.empty()) {
+        ssize_t n = ::write(fd_, txBuf_.data(), txBuf_.size());
+        if (n > 0) {
+            txBuf_.erase(0, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return true;
+}
+
+bool HubConnection::onReadable() {
+    char buf[RX_CHUNK];
+    for (;;) {
+        ssize_t n = ::read(fd_, buf, sizeof(buf));
+        if (n > 0) {
+            rxBuf_.append(buf, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || errno == EAGAIN || errno == EWOULDBLOCK) break;
+        return false;   //EIO: device unplugged
+    }
+
+    size_t start = 0;
+    for (;;) {
+        size_t nl = rxBuf_.find('\n', start);
+        if (nl == std::string::npos) break;
+        std::string line = rxBuf_.substr(start, nl - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        start = nl + 1;
+        if (!line.empty()) handleLine(line);
+    }
+    rxBuf_.erase(0, start);
+    if (rxBuf_.size() > MAX_LINE_LEN) rxBuf_.clear();
+
+    pump();
+    return true;
+}
+
+void HubConnection::handleLine(const std::string& line) {
+    //Only JSON objects are answers, anything else is boot noise
+    if (line[0] != '{') return;
+
+    Clock::time_point now = Clock::now();
+    if (now < quietUntil_ || inFlight_.empty()) {
+        //late answer of a timed out request, keep draining before sending again
+        quietUntil_ = now + std::chrono::milliseconds(UIH_RESYNC_QUIET_MS);
+        return;
+    }
+
+    Request r = std::move(inFlight_.front());
+    inFlight_.pop_front();
+
+    Response resp;
+    resp.raw = line;
+    resp.latencyMs = std::chrono::duration<double, std::milli>(now - r.sentAt).count();
+    std::string perr;
+    if (JsonValue::parse(line, resp.json, &perr))
+        resp.ok = resp.json["status"].asString() == "ok";
+
+    if (resp.ok)
+        stats_.add(resp.latencyMs);
+    else
+        stats_.addError();
+
+    if (r.cb) r.cb(*this, resp);
+}
+
+void HubConnection::onTick(Clock::time_point now) {
+    while (!inFlight_.empty() && inFlight_.front().deadline <= now) {
+        Request r = std::move(inFlight_.front());
+        inFlight_.pop_front();
+        stats_.addTimeout();
+        //set before the callback so a request queued from it waits for the drain too
+        quietUntil_ = now + std::chrono::milliseconds(UIH_RESYNC_QUIET_MS);
+
+        Response resp;
+        resp.timedOut = true;
+        resp.latencyMs = std::chrono::duration<double, std::milli>(now - r.sentAt).count();
+        if (r.cb) r.cb(*this, resp);
+    }
+    pump();
+}
+
+bool HubConnection::nextDeadline(Clock::time_point& when) const {
+    bool any = false;
+    if (!inFlight_.empty()) {
+        when = inFlight_.front().deadline;
+        any = true;
+    }
+    if (!queued_.empty() && inFlight_.size() < maxInFlight_) {
+        if (!any || quietUntil_ < when) when = quietUntil_;
+        any = true;
+    }
+    return any;
+}
+
+void HubConnection::failAll() {
+    std::deque<Request> all;
+    all.swap(inFlight_);
+    for (auto& r : queued_) all.push_back(std::move(r));
+    queued_.clear();
+    txBuf_.clear();
+
+    for (auto& r : all) {
+        stats_.addError();
+        Response resp;
+        resp.disconnected = true;
+        if (r.cb) r.cb(*this, resp);
+    }
+}
+
+} // namespace uih
@@ -0,0 +1,163 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Set of hub connections driven by a single epoll loop, with fan-out helpers
+
+#include "uih/HubPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace uih {
+
+#define MAX_EVENTS 64
+
+HubPool::HubPool() {
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+}
+
+HubPool::~HubPool() {
+    for (auto& h : hubs_) h->failAll();
+    hubs_.clear();
+    if (epfd_ >= 0) ::close(epfd_);
+}
+
+HubConnection* HubPool::add(const std::string& devPath, const std::string& label, std::string* err) {
+    if (epfd_ < 0) {
+        if (err) *err = "epoll not available";
+        return nullptr;
+    }
+    std::unique_ptr<HubConnection> hub(new HubConnection(devPath, label));
+    if (!hub->open(err)) return nullptr;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = hub.get();
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, hub->fd(), &ev) != 0) {
+        if (err) *err = devPath + ": " + strerror(errno);
+        return nullptr;
+    }
+    hubs_.push_back(std::move(hub));
+    return hubs_.back().get();
+}
+
+size_t HubPool::addDiscovered(std::vector<std::string>* errors) {
+    size_t added = 0;
+    for (const HubInfo& info : discoverHubs()) {
+        std::string err;
+        std::string label = info.usbPath + (info.serial.empty() ? "" : " (" + info.serial + ")");
+        if (add(info.devPath, label, &err))
+            added++;
+        else if (errors)
+            errors->push_back(err);
+    }
+    return added;
+}
+
+size_t HubPool::pending() const {
+    size_t n = 0;
+    for (const auto& h : hubs_) n += h->pending();
+    return n;
+}
+
+void HubPool::updateInterest(HubConnection* hub) {
+    if (!hub->isOpen()) return;
+    epoll_event ev{};
+    ev.events = (uint32_t)(EPOLLIN | EPOLLRDHUP) | (hub->wantsWrite() ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.ptr = hub;
+    epoll_ctl(epfd_, EPOLL_CTL_MOD, hub->fd(), &ev);
+}
+
+//Device went away: answer its requests and stop polling it. The object is kept so
+//callers holding the pointer (and its stats) stay valid until the pool is destroyed.
+void HubPool::drop(HubConnection* hub) {
+    if (!hub->isOpen()) return;
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, hub->fd(), nullptr);
+    hub->close();
+    hub->failAll();
+}
+
+void HubPool::runOnce(int maxWaitMs) {
+    //Sleep until the closest request deadline at most
+    Clock::time_point now = Clock::now();
+    int waitMs = maxWaitMs;
+    for (const auto& h : hubs_) {
+        Clock::time_point when;
+        if (h->isOpen() && h->nextDeadline(when)) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(when - now).count() + 1;
+            waitMs = std::max(0, std::min<int>(waitMs, (int)ms));
+        }
+        updateInterest(h.get());
+    }
+
+    epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epfd_, events, MAX_EVENTS, waitMs);
+    for (int i = 0; i < n; i++) {
+        HubConnection* hub = static_cast<HubConnection*>(events[i].data.ptr);
+        bool alive = true;
+        if (events[i].events & EPOLLIN)
+            alive = hub->onReadable();
+        if (alive && (events[i].events & EPOLLOUT))
+            alive = hub->onWritable();
+        if (events[i].events & (EPOLLHUP | EPOLLERR))
+            alive = false;
+        if (!alive) drop(hub);
+    }
+
+    now = Clock::now();
+    for (const auto& h : hubs_)
+        if (h->isOpen()) h->onTick(now);
+}
+
+bool HubPool::runUntilIdle(int maxMs) {
+    Clock::time_point end = Clock::now() + std::chrono::milliseconds(maxMs);
+    while (pending() > 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()).count();
+        if (left <= 0) return false;
+        runOnce((int)left);
+    }
+    return true;
+}
+
+void HubPool::runFor(int ms) {
+    Clock::time_point end = Clock::now() + std::chrono::milliseconds(ms);
+    for (;;) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()).count();
+        if (left <= 0) break;
+        runOnce((int)left);
+    }
+}
+
+std::vector<FanOutResult> HubPool::fanOut(const std::string& line, int timeoutMs) {
+    //shared so a request still queued when we give up cannot write into a dead vector
+    auto results = std::make_shared<std::vector<FanOutResult>>();
+    results->reserve(hubs_.size());
+    for (const auto& h : hubs_) {
+        results->push_back({h.get(), Response()});
+        if (!h->isOpen()) {
+            results->back().response.disconnected = true;
+            continue;
+        }
+        size_t slot = results->size() - 1;
+        h->submit(line, [results, slot](HubConnection&, const Response& r) {
+            (*results)[slot].response = r;
+        }, timeoutMs);
+    }
+    //every request either answers or expires, the margin covers requests queued behind others
+    runUntilIdle(timeoutMs * 2 + UIH_RESYNC_QUIET_MS);
+    return *results;
+}
+
+} // namespace uih
@@ -0,0 +1,337 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Minimal JSON value used to build requests and read hub responses
+
+#include "uih/Json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace uih {
+
+namespace {
+
+const JsonValue kNull;
+
+class Parser {
+public:
+    Parser(const std::string& t) : text(t) {}
+
+    bool run(JsonValue& out, std::string* err) {
+        skipWs();
+        if (!value(out)) {
+            if (err) *err = error + " at offset " + std::to_string(pos);
+            return false;
+        }
+        skipWs();
+        if (pos != text.size()) {
+            if (err) *err = "trailing characters at offset " + std::to_string(pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const std::string& text;
+    size_t pos = 0;
+    int depth = 0;
+    std::string error;
+
+    bool fail(const char* msg) {
+        error = msg;
+        return false;
+    }
+
+    void skipWs() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n'))
+            pos++;
+    }
+
+    bool literal(const char* word) {
+        size_t n = 0;
+        while (word[n]) n++;
+        if (text.compare(pos, n, word) != 0) return fail("invalid literal");
+        pos += n;
+        return true;
+    }
+
+    bool value(JsonValue& out) {
+        if (pos >= text.size()) return fail("unexpected end");
+        if (++depth > 32) return fail("nesting too deep");
+        bool ok;
+        char c = text[pos];
+        if (c == '{') ok = object(out);
+        else if (c == '[') ok = array(out);
+        else if (c == '"') {
+            std::string s;
+            ok = string(s);
+            out = JsonValue(std::move(s));
+        }
+        else if (c == 't') { ok = literal("true"); out = JsonValue(true); }
+        else if (c == 'f') { ok = literal("false"); out = JsonValue(false); }
+        else if (c == 'n') { ok = literal("null"); out = JsonValue(); }
+        else ok = number(out);
+        depth--;
+        return ok;
+    }
+
+    bool number(JsonValue& out) {
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        double d = std::strtod(start, &end);
+        if (end == start) return fail("invalid value");
+        pos += end - start;
+        out = JsonValue(d);
+        return true;
+    }
+
+    static void appendUtf8(std::string& s, unsigned cp) {
+        if (cp < 0x80) s += (char)cp;
+        else if (cp < 0x800) {
+            s += (char)(0xC0 | (cp >> 6));
+            s += (char)(0x80 | (cp & 0x3F));
+        } else {
+            s += (char)(0xE0 | (cp >> 12));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool string(std::string& s) {
+        pos++; //opening quote
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                s += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char e = text[pos++];
+            switch (e) {
+                case '"': s += '"'; break;
+                case '\\': s += '\\'; break;
+                case '/': s += '/'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) return fail("bad escape");
+                    unsigned cp = std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    appendUtf8(s, cp);
+                    break;
+                }
+                default: return fail("bad escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool array(JsonValue& out) {
+        out = JsonValue::array();
+        pos++;
+        skipWs();
+        if (pos < text.size() && text[pos] == ']') { pos++; return true; }
+        for (;;) {
+            JsonValue item;
+            skipWs();
+            if (!value(item)) return false;
+            out.push(std::move(item));
+            skipWs();
+            if (pos >= text.size()) return fail("unexpected end");
+            if (text[pos] == ',') { pos++; continue; }
+            if (text[pos] == ']') { pos++; return true; }
+            return fail("expected , or ]");
+        }
+    }
+
+    bool object(JsonValue& out) {
+        out = JsonValue::object();
+        pos++;
+        skipWs();
+        if (pos < text.size() && text[pos] == '}') { pos++; return true; }
+        for (;;) {
+            skipWs();
+            if (pos >= text.size() || text[pos] != '"') return fail("expected key");
+            std::string key;
+            if (!string(key)) return false;
+            skipWs();
+            if (pos >= text.size() || text[pos] != ':') return fail("expected :");
+            pos++;
+            skipWs();
+            JsonValue item;
+            if (!value(item)) return false;
+            out.set(key, std::move(item));
+            skipWs();
+            if (pos >= text.size()) return fail("unexpected end");
+            if (text[pos] == ',') { pos++; continue; }
+            if (text[pos] == '}') { pos++; return true; }
+            return fail("expected , or }");
+        }
+    }
+};
+
+} // namespace
+
+JsonValue JsonValue::array() {
+    JsonValue v;
+    v.type_ = Type::Array;
+    return v;
+}
+
+JsonValue JsonValue::object() {
+    JsonValue v;
+    v.type_ = Type::Object;
+    return v;
+}
+
+bool JsonValue::parse(const std::string& text, JsonValue& out, std::string* err) {
+    Parser p(text);
+    return p.run(out, err);
+}
+
+bool JsonValue::asBool(bool def) const {
+    if (type_ == Type::Bool) return bool_;
+    if (type_ == Type::Number) return num_ != 0;
+    if (type_ == Type::String) return str_ == "true" || str_ == "1";
+    return def;
+}
+
+double JsonValue::asNumber(double def) const {
+    if (type_ == Type::Number) return num_;
+    if (type_ == Type::Bool) return bool_ ? 1 : 0;
+    if (type_ == Type::String) {
+        char* end = nullptr;
+        double d = std::strtod(str_.c_str(), &end);
+        if (end != str_.c_str()) return d;
+    }
+    return def;
+}
+
+std::string JsonValue::asString(const std::string& def) const {
+    if (type_ == Type::String) return str_;
+    if (type_ == Type::Null) return def;
+    return dump();
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    for (const auto& m : obj_)
+        if (m.first == key) return m.second;
+    return kNull;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    return index < arr_.size() ? arr_[index] : kNull;
+}
+
+bool JsonValue::has(const std::string& key) const {
+    for (const auto& m : obj_)
+        if (m.first == key) return true;
+    return false;
+}
+
+size_t JsonValue::size() const {
+    if (type_ == Type::Array) return arr_.size();
+    if (type_ == Type::Object) return obj_.size();
+    return 0;
+}
+
+JsonValue& JsonValue::set(const std::string& key, JsonValue value) {
+    if (type_ != Type::Object) *this = object();
+    for (auto& m : obj_) {
+        if (m.first == key) {
+            m.second = std::move(value);
+            return m.second;
+        }
+    }
+    obj_.emplace_back(key, std::move(value));
+    return obj_.back().second;
+}
+
+JsonValue& JsonValue::push(JsonValue value) {
+    if (type_ != Type::Array) *this = array();
+    arr_.push_back(std::move(value));
+    return arr_.back();
+}
+
+std::string JsonValue::dump() const {
+    std::string out;
+    dumpTo(out);
+    return out;
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+    switch (type_) {
+        case Type::Null: out += "null"; break;
+        case Type::Bool: out += bool_ ? "true" : "false"; break;
+        case Type::Number: {
+            char buf[32];
+            if (std::floor(num_) == num_ && std::fabs(num_) < 1e15)
+                std::snprintf(buf, sizeof(buf), "%.0f", num_);
+            else
+                std::snprintf(buf, sizeof(buf), "%.6g", num_);
+            out += buf;
+            break;
+        }
+        case Type::String:
+            out += '"';
+            jsonEscape(str_, out);
+            out += '"';
+            break;
+        case Type::Array:
+            out += '[';
+            for (size_t i = 0; i < arr_.size(); i++) {
+                if (i) out += ',';
+                arr_[i].dumpTo(out);
+            }
+            out += ']';
+            break;
+        case Type::Object:
+            out += '{';
+            for (size_t i = 0; i < obj_.size(); i++) {
+                if (i) out += ',';
+                out += '"';
+                jsonEscape(obj_[i].first, out);
+                out += "\":";
+                obj_[i].second.dumpTo(out);
+            }
+            out += '}';
+            break;
+    }
+}
+
+void jsonEscape(const std::string& in, std::string& out) {
+    for (char c : in) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+} // namespace uih
@@ -0,0 +1,435 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Replays a CDC capture of the hub (or one of the canonical sessions generated
+//here) through the firmware framer, CdcProtocol.cpp compiled as is with the USB
+//side left out. Per message kind it reports the framing time, the JSON parse time
+//when the ArduinoJson of the PlatformIO build is available, the allocations and,
+//for device captures, the response bytes and the device answer latency.
+
+#include "CdcProtocol.h"
+#ifndef CDCREPLAY_ARDUINOJSON
+#define CDCREPLAY_ARDUINOJSON 0
+#endif
+#if CDCREPLAY_ARDUINOJSON
+#include <ArduinoJson.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+//----------------------------- allocations --------------------------------
+
+//operator new ends in malloc too; glibc only, which is what this tool targets
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+
+static bool allocCounting = false;
+static uint64_t allocCount = 0;
+
+extern "C" void* malloc(size_t n) {
+    if (allocCounting) allocCount++;
+    return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t n, size_t s) {
+    if (allocCounting) allocCount++;
+    return __libc_calloc(n, s);
+}
+extern "C" void* realloc(void* p, size_t n) {
+    if (allocCounting) allocCount++;
+    return __libc_realloc(p, n);
+}
+
+//------------------------------- sessions ---------------------------------
+
+struct Record {
+    uint32_t us;
+    uint8_t flags;
+    std::string data; //len zero bytes for elided records
+};
+
+static bool loadCapture(const char* path, std::vector<Record>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+    fclose(f);
+
+    if (buf.size() < CDC_CAP_MAGIC_LEN || memcmp(buf.data(), CDC_CAP_MAGIC, CDC_CAP_MAGIC_LEN) != 0) {
+        fprintf(stderr, "%s: not a hub capture\n", path);
+        return false;
+    }
+    size_t pos = CDC_CAP_MAGIC_LEN;
+    CdcCapRecord rec;
+    while (cdcCapNext(buf.data(), buf.size(), &pos, &rec)) {
+        Record r{rec.us, rec.flags, rec.data ? std::string((const char*)rec.data, rec.len) : std::string(rec.len, '\0')};
+        out.push_back(std::move(r));
+    }
+    if (pos != buf.size()) fprintf(stderr, "%s: truncated after %zu records\n", path, out.size());
+    return true;
+}
+
+static bool saveCapture(const char* path, const std::vector<Record>& recs) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fwrite(CDC_CAP_MAGIC, 1, CDC_CAP_MAGIC_LEN, f);
+    for (const auto& r : recs) {
+        uint8_t h[CDC_CAP_HEADER_LEN];
+        cdcCapHeader(h, r.us, r.flags, (uint16_t)r.data.size());
+        fwrite(h, 1, sizeof(h), f);
+        if (!(r.flags & CDC_CAP_ELIDED)) fwrite(r.data.data(), 1, r.data.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+//Inbound bytes as the hub RX event sees them, 64 byte USB packets
+static void addIn(std::vector<Record>& recs, uint32_t& us, const std::string& bytes) {
+    for (size_t i = 0; i < bytes.size(); i += 64) {
+        recs.push_back({us, CDC_CAP_IN, bytes.substr(i, 64)});
+        us += 64;
+    }
+}
+
+static std::string agentFrame(int ch, int numDev, const std::string& dev1, int usbType) {
+    return "\"CH" + std::to_string(ch) + "\":{\"Dev1_name\":" + dev1 + ",\"Dev2_name\":\"\",\"numDev\":\"" +
+           std::to_string(numDev) + "\",\"usbType\":\"" + std::to_string(usbType) + "\"}";
+}
+
+//One minute of the agent with nothing changing: an empty line every second and
+//the full sync of the 3 ports every 30 s
+static std::vector<Record> sessionHeartbeat() {
+    std::vector<Record> recs;
+    for (uint32_t s = 0; s < 60; s++) {
+        uint32_t us = s * 1000000;
+        if (s % 30 == 0) {
+            std::string set = "{\"action\":\"set\",\"params\":{";
+            for (int ch = 1; ch <= 3; ch++) {
+                if (ch > 1) set += ",";
+                set += agentFrame(ch, 1, "\"Keyboard\"", 2);
+            }
+            addIn(recs, us, set + "}}\n");
+        } else {
+            addIn(recs, us, "\n");
+        }
+    }
+    return recs;
+}
+
+//Images to the 3 ports at 4, 8 and 16 bits per pixel, then a clear of each,
+//pixels elided as the hub records them
+static std::vector<Record> sessionImage() {
+    static const uint8_t bpps[] = {4, 8, 16};
+    std::vector<Record> recs;
+    uint32_t us = 0;
+    for (uint8_t bpp : bpps)
+        for (uint8_t port = 1; port <= CDC_IMAGE_PORTS; port++) {
+            addIn(recs, us, std::string{(char)port, (char)bpp});
+            uint32_t bits = (uint32_t)CDC_IMAGE_PIXELS * bpp;
+            size_t len = bits / 8 + (bits % 8 ? 1 : 0);
+            for (size_t i = 0; i < len; i += 64) {
+                recs.push_back({us, CDC_CAP_IN | CDC_CAP_ELIDED, std::string(std::min<size_t>(64, len - i), '\0')});
+                us += 64;
+            }
+            us += 50000;
+        }
+    for (uint8_t port = 1; port <= CDC_IMAGE_PORTS; port++) {
+        addIn(recs, us, std::string{(char)port, 0});
+        us += 50000;
+    }
+    return recs;
+}
+
+//Ports with 7 to 11 devices, the 3 line flex layout the agent builds for them,
+//rewritten every 500 ms for 30 s
+static std::vector<Record> sessionFlex() {
+    std::vector<Record> recs;
+    srand(1);
+    for (uint32_t t = 0; t < 60; t++) {
+        uint32_t us = t * 500000;
+        std::string set = "{\"action\":\"set\",\"params\":{";
+        for (int ch = 1; ch <= 3; ch++) {
+            int devs = 7 + rand() % 5;
+            char name[6][8];
+            for (int d = 0; d < 6; d++) snprintf(name[d], sizeof(name[d]), "Dev%04X", rand() & 0xFFFF);
+            char layout[256];
+            snprintf(layout, sizeof(layout),
+                     "{\"T1\":{\"txt\":\" %s,%s\",\"align\":\"center\"},"
+                     "\"T2\":{\"txt\":\" %s,%s\",\"align\":\"center\"},"
+                     "\"T3\":{\"txt\":\" %s, +%d\",\"align\":\"center\"}}",
+                     name[0], name[3], name[1], name[4], name[2], devs - 5);
+            if (ch > 1) set += ",";
+            set += agentFrame(ch, 10, layout, 3);
+        }
+        addIn(recs, us, set + "}}\n");
+    }
+    return recs;
+}
+
+//-------------------------------- replay ----------------------------------
+
+enum Kind { K_GET, K_SET, K_OTHER, K_IMAGE, K_CLEAR, K_OVERFLOW, K_COUNT };
+static const char* kindName[K_COUNT] = {"get", "set", "other", "image", "clear", "overflow"};
+
+struct Message {
+    Kind kind;
+    size_t inBytes = 0;
+    uint32_t us = 0;        //capture time of the record that completed it
+    double frameNs = 1e300; //best of the runs
+    double jsonNs = 1e300;
+    uint64_t allocs = 0;
+    size_t outBytes = 0;
+    int64_t answerUs = -1;  //first hub line after it
+};
+
+struct Replay {
+    CdcFramer framer;
+    std::vector<Message> msgs;
+    size_t next = 0;         //message index of this run
+    size_t pending = 0;      //inbound bytes of the message in progress
+    uint32_t us = 0;
+    uint8_t* img[CDC_IMAGE_PORTS] = {};
+    uint8_t imgBpp[CDC_IMAGE_PORTS] = {};
+    bool json = false;
+    std::vector<double> callJson; //per message completed in the current feed call
+};
+
+static Message& completed(Replay* r, Kind kind) {
+    if (r->next == r->msgs.size()) r->msgs.push_back(Message{kind});
+    Message& m = r->msgs[r->next++];
+    m.us = r->us;
+    m.inBytes = r->pending;
+    r->pending = 0;
+    return m;
+}
+
+//the same buffer handling as the firmware, so allocations match
+static uint8_t* replayImageStart(void* ctx, uint8_t port, uint8_t bpp, size_t len) {
+    Replay* r = (Replay*)ctx;
+    if (r->img[port] == nullptr || r->imgBpp[port] != bpp) {
+        free(r->img[port]);
+        r->img[port] = (uint8_t*)malloc(len);
+        r->imgBpp[port] = bpp;
+    }
+    return r->img[port];
+}
+
+static void replayImageDone(void* ctx, uint8_t port, uint8_t bpp, bool stored) {
+    Replay* r = (Replay*)ctx;
+    (void)stored;
+    if (bpp == 0) {
+        free(r->img[port]);
+        r->img[port] = nullptr;
+        r->imgBpp[port] = 0;
+    }
+    bool counting = allocCounting;
+    allocCounting = false;
+    completed(r, bpp ? K_IMAGE : K_CLEAR);
+    r->callJson.push_back(0);
+    allocCounting = counting;
+}
+
+static void replayLine(void* ctx, const char* line, size_t len) {
+    Replay* r = (Replay*)ctx;
+    double ns = 0;
+    Kind kind = K_OTHER;
+    (void)len;
+#if CDCREPLAY_ARDUINOJSON
+    if (r->json) {
+        auto t0 = std::chrono::steady_clock::now();
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, line, len);
+        auto t1 = std::chrono::steady_clock::now();
+        ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        const char* action = err ? nullptr : doc["action"].as<const char*>();
+        if (action && strcmp(action, "get") == 0) kind = K_GET;
+        if (action && strcmp(action, "set") == 0) kind = K_SET;
+    }
+#endif
+    bool counting = allocCounting;
+    allocCounting = false;
+    if (!r->json) {
+        if (strstr(line, "\"get\"")) kind = K_GET;
+        else if (strstr(line, "\"set\"")) kind = K_SET;
+    }
+    completed(r, kind);
+    r->callJson.push_back(ns);
+    allocCounting = counting;
+}
+
+static void replayOverflow(void* ctx) {
+    Replay* r = (Replay*)ctx;
+    bool counting = allocCounting;
+    allocCounting = false;
+    completed(r, K_OVERFLOW);
+    r->callJson.push_back(0);
+    allocCounting = counting;
+}
+
+static void runOnce(Replay& r, const std::vector<Record>& recs) {
+    static const CdcFramerOps ops = {replayImageStart, replayImageDone, replayLine, replayOverflow, nullptr};
+    CdcFramerOps o = ops;
+    o.ctx = &r;
+    cdcFramerReset(&r.framer);
+    for (int p = 0; p < CDC_IMAGE_PORTS; p++) { //every run starts from a hub without images
+        free(r.img[p]);
+        r.img[p] = nullptr;
+        r.imgBpp[p] = 0;
+    }
+    r.next = 0;
+    r.pending = 0;
+    double openNs = 0;
+    uint64_t openAllocs = 0;
+    size_t lastMsg = SIZE_MAX;
+
+    for (const auto& rec : recs) {
+        if (rec.flags & CDC_CAP_OUT) {
+            if (lastMsg == SIZE_MAX) continue;
+            Message& m = r.msgs[lastMsg];
+            m.outBytes += rec.data.size() + 2; //println line end
+            if (m.answerUs < 0) m.answerUs = (int64_t)rec.us - m.us;
+            continue;
+        }
+
+        size_t first = r.next;
+        r.us = rec.us;
+        r.pending += rec.data.size();
+        r.callJson.clear();
+        allocCount = 0;
+        allocCounting = true;
+        auto t0 = std::chrono::steady_clock::now();
+        cdcFramerFeed(&r.framer, (const uint8_t*)rec.data.data(), rec.data.size(), rec.us / 1000, &o);
+        auto t1 = std::chrono::steady_clock::now();
+        allocCounting = false;
+
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        size_t done = r.next - first;
+        if (done == 0) {
+            openNs += ns;
+            openAllocs += allocCount;
+            continue;
+        }
+        //a chunk completing several messages shares its time between them
+        double json = 0;
+        for (double j : r.callJson) json += j;
+        double share = (openNs + ns - json) / done;
+        for (size_t i = 0; i < done; i++) {
+            Message& m = r.msgs[first + i];
+            m.frameNs = std::min(m.frameNs, share);
+            m.jsonNs = std::min(m.jsonNs, r.callJson[i]);
+            m.allocs = (i == 0 ? openAllocs + allocCount : 0);
+            m.outBytes = 0;
+            m.answerUs = -1;
+        }
+        openNs = 0;
+        openAllocs = 0;
+        lastMsg = r.next - 1;
+    }
+}
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1))];
+}
+
+static void report(const Replay& r, bool json) {
+    printf("%-9s %6s %9s %9s %9s %7s %9s %8s %8s\n", "kind", "count", "in B", "frame ns", "json ns", "allocs",
+           "out B", "dev p50", "dev max");
+    for (int k = 0; k < K_COUNT; k++) {
+        size_t count = 0, in = 0, out = 0;
+        uint64_t allocs = 0;
+        double frame = 0, js = 0;
+        std::vector<double> dev;
+        for (const auto& m : r.msgs) {
+            if (m.kind != k) continue;
+            count++;
+            in += m.inBytes;
+            out += m.outBytes;
+            allocs += m.allocs;
+            frame += m.frameNs;
+            js += m.jsonNs;
+            if (m.answerUs >= 0) dev.push_back(m.answerUs / 1000.0);
+        }
+        if (count == 0) continue;
+        printf("%-9s %6zu %9zu %9.0f ", kindName[k], count, in, frame / count);
+        if (json && (k == K_GET || k == K_SET || k == K_OTHER)) printf("%9.0f ", js / count);
+        else printf("%9s ", "-");
+        printf("%7.1f %9zu ", (double)allocs / count, out);
+        if (dev.empty()) printf("%8s %8s\n", "-", "-");
+        else {
+            double max = *std::max_element(dev.begin(), dev.end());
+            printf("%8.1f %8.1f\n", percentile(dev, 0.5), max);
+        }
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-r runs] [-o out.cap] [-n] <capture file | heartbeat | image | flex>\n"
+        "  -r  replays of the session, the best time of each message is kept (default 20)\n"
+        "  -o  writes the session as a capture file, to keep a generated session\n"
+        "  -n  no JSON parsing even if ArduinoJson was found\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int runs = 20;
+    const char* outPath = nullptr;
+    bool json = CDCREPLAY_ARDUINOJSON;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:o:nh")) != -1) {
+        switch (opt) {
+            case 'r': runs = atoi(optarg); break;
+            case 'o': outPath = optarg; break;
+            case 'n': json = false; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1 || runs < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string src = argv[optind];
+    std::vector<Record> recs;
+    if (src == "heartbeat") recs = sessionHeartbeat();
+    else if (src == "image") recs = sessionImage();
+    else if (src == "flex") recs = sessionFlex();
+    else if (!loadCapture(src.c_str(), recs)) {
+        perror(src.c_str());
+        return 1;
+    }
+    if (outPath && !saveCapture(outPath, recs)) {
+        perror(outPath);
+        return 1;
+    }
+
+    size_t inBytes = 0, outBytes = 0;
+    for (const auto& rec : recs) (rec.flags & CDC_CAP_OUT ? outBytes : inBytes) += rec.data.size();
+    printf("%s: %zu records, %zu bytes in, %zu bytes out, %.1f s, %d runs%s\n", src.c_str(), recs.size(), inBytes,
+           outBytes, recs.empty() ? 0 : recs.back().us / 1e6, runs, json ? "" : ", no JSON parsing");
+
+    Replay* r = new Replay();
+    r->json = json;
+    for (int i = 0; i < runs; i++) runOnce(*r, recs);
+    report(*r, json);
+    return 0;
+}
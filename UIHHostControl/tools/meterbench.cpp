@@ -0,0 +1,200 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Host benchmark of the firmware meter pipeline: PAC1943 codes of 3 channels to
+//filtered values and display text, per Intercomms sample. The float path is the
+//previous PAC194x/ScreenDefaultRender code, the integer path is the firmware
+//MeterMath.h compiled as is.
+
+#include "MeterMath.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+#define CHANNELS        3
+#define FULLSCALE_MA    2500 //20 mOhm shunt
+
+struct RawSample {
+    uint16_t vbus[CHANNELS];
+    uint16_t vsense[CHANNELS];
+};
+
+//----------------------------- float path ---------------------------------
+
+struct FloatChannel {
+    float vBuf[METER_MAX_WINDOW] = {};
+    float iBuf[METER_MAX_WINDOW] = {};
+    float v = 0;
+    float i = 0;
+};
+
+static float floatMovingAverage(float arr[], int n) {
+    float sum = 0;
+    for (int i = 0; i < n; i++) sum = sum + arr[i];
+    return sum / n;
+}
+
+//sorted in place, as the previous driver did
+static float floatMedian(float arr[], int n) {
+    for (int i = 0; i < n - 1; i++)
+        for (int j = 0; j < n - i - 1; j++)
+            if (arr[j] > arr[j + 1]) {
+                float temp = arr[j];
+                arr[j] = arr[j + 1];
+                arr[j + 1] = temp;
+            }
+    if (n % 2 == 0) return (arr[n / 2] + arr[n / 2 + 1]) / 2;
+    return arr[n / 2 + 1];
+}
+
+static uint32_t floatSample(FloatChannel* ch, const RawSample& s, int idx, int window, bool median) {
+    char text[2][16];
+    uint32_t check = 0;
+    for (int c = 0; c < CHANNELS; c++) {
+        float v = ((float)s.vbus[c] / 65536.0f) * 9000.0f;
+        uint16_t aux16;
+        int sign;
+        if (s.vsense[c] & 0x8000) {
+            aux16 = (uint16_t)(~(s.vsense[c] - 1));
+            sign = 1;
+        } else {
+            aux16 = s.vsense[c];
+            sign = -1;
+        }
+        float i = sign * ((float)aux16 / 32768.0f) * FULLSCALE_MA;
+
+        ch[c].vBuf[idx] = v;
+        ch[c].iBuf[idx] = i;
+        ch[c].v = median ? floatMedian(ch[c].vBuf, window) : floatMovingAverage(ch[c].vBuf, window);
+        ch[c].i = median ? floatMedian(ch[c].iBuf, window) : floatMovingAverage(ch[c].iBuf, window);
+
+        snprintf(text[0], sizeof(text[0]), "%.3f V", ch[c].v / 1000);
+        snprintf(text[1], sizeof(text[1]), "%.3f A", ch[c].i / 1000);
+        check += (uint8_t)text[0][0] + (uint8_t)text[1][0];
+    }
+    return check;
+}
+
+//---------------------------- integer path --------------------------------
+
+struct IntChannel {
+    int32_t vBuf[METER_MAX_WINDOW] = {};
+    int32_t iBuf[METER_MAX_WINDOW] = {};
+    int32_t uV = 0;
+    int32_t uA = 0;
+    int32_t uW = 0;
+};
+
+static uint32_t intSample(IntChannel* ch, const RawSample& s, int idx, int window, bool median) {
+    char text[2][16];
+    uint32_t check = 0;
+    for (int c = 0; c < CHANNELS; c++) {
+        ch[c].vBuf[idx] = meterVbusToUv(s.vbus[c]);
+        ch[c].iBuf[idx] = meterVsenseToUa(s.vsense[c], FULLSCALE_MA);
+        ch[c].uV = median ? meterMedian(ch[c].vBuf, window) : meterMovingAverage(ch[c].vBuf, window);
+        ch[c].uA = median ? meterMedian(ch[c].iBuf, window) : meterMovingAverage(ch[c].iBuf, window);
+        ch[c].uW = meterPowerUw(ch[c].uV, ch[c].uA);
+
+        size_t n = meterFormat(text[0], sizeof(text[0]) - 2, ch[c].uV, 3);
+        memcpy(text[0] + n, " V", 3);
+        n = meterFormat(text[1], sizeof(text[1]) - 2, ch[c].uA, 3);
+        memcpy(text[1] + n, " A", 3);
+        check += (uint8_t)text[0][0] + (uint8_t)text[1][0];
+    }
+    return check;
+}
+
+//--------------------------------------------------------------------------
+
+static std::vector<RawSample> makeSamples(size_t count) {
+    std::vector<RawSample> v(count);
+    srand(1);
+    for (auto& s : v)
+        for (int c = 0; c < CHANNELS; c++) {
+            s.vbus[c] = (uint16_t)(36400 + rand() % 200);              //~5 V
+            s.vsense[c] = (uint16_t)(int16_t)(-(rand() % 8000) + 20);   //0 to ~600 mA forward
+        }
+    return v;
+}
+
+template <typename Fn>
+static double nsPerSample(const std::vector<RawSample>& samples, int window, Fn fn, uint32_t& check) {
+    auto t0 = std::chrono::steady_clock::now();
+    int idx = 0;
+    for (const auto& s : samples) {
+        check += fn(s, idx);
+        idx = (idx + 1) % window;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / samples.size();
+}
+
+//Converts the same codes both ways and reports the largest unfiltered difference
+static void compare(const std::vector<RawSample>& samples) {
+    double dv = 0, di = 0;
+    for (const auto& s : samples)
+        for (int c = 0; c < CHANNELS; c++) {
+            float v = ((float)s.vbus[c] / 65536.0f) * 9000.0f;
+            float i = -(float)(int16_t)s.vsense[c] / 32768.0f * FULLSCALE_MA;
+            dv = std::fmax(dv, std::fabs(v - meterVbusToUv(s.vbus[c]) / 1000.0));
+            di = std::fmax(di, std::fabs(i - meterVsenseToUa(s.vsense[c], FULLSCALE_MA) / 1000.0));
+        }
+    printf("max conversion difference: %.4f mV, %.4f mA\n", dv, di);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-n samples] [-w window]\n"
+        "  -n  samples per run (default 200000)\n"
+        "  -w  filter window, 1 to %d (default 10)\n", prog, METER_MAX_WINDOW);
+}
+
+int main(int argc, char** argv) {
+    size_t count = 200000;
+    int window = 10;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:w:h")) != -1) {
+        switch (opt) {
+            case 'n': count = strtoul(optarg, nullptr, 10); break;
+            case 'w': window = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (count == 0 || window < 1 || window > METER_MAX_WINDOW) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<RawSample> samples = makeSamples(count);
+    uint32_t check = 0;
+
+    printf("%zu samples, %d channels, window %d\n", count, CHANNELS, window);
+    printf("%-8s %12s %12s %8s\n", "filter", "float ns", "int ns", "ratio");
+    for (int median = 0; median < 2; median++) {
+        FloatChannel fch[CHANNELS];
+        IntChannel ich[CHANNELS];
+        double f = nsPerSample(samples, window,
+            [&](const RawSample& s, int idx) { return floatSample(fch, s, idx, window, median); }, check);
+        double i = nsPerSample(samples, window,
+            [&](const RawSample& s, int idx) { return intSample(ich, s, idx, window, median); }, check);
+        printf("%-8s %12.1f %12.1f %7.2fx\n", median ? "median" : "average", f, i, f / i);
+    }
+    compare(samples);
+    if (check == 0) printf("\n"); //keeps the results alive
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Command line client to control every connected hub at once
+
+#include "uih/Commands.h"
+#include "uih/Discovery.h"
+#include "uih/HubPool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace uih;
+
+static int timeoutMs = UIH_DEFAULT_TIMEOUT_MS;
+static bool showStats = false;
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-d device]... [-t timeout_ms] [-s] <command> [args]\n"
+        "\n"
+        "  -d  use this port instead of auto discovery (repeatable)\n"
+        "  -t  answer timeout in ms (default %d)\n"
+        "  -s  print per hub latency statistics at the end\n"
+        "\n"
+        "commands:\n"
+        "  list                       list discovered hubs\n"
+        "  get <param>...             get parameters (all, config, state, CH1, CH2_all...)\n"
+        "  set '<json params>'        raw set, ex. '{\"brightness\":50}'\n"
+        "  raw '<json line>'          send a line as is\n"
+        "  power <ch> on|off          switch port power\n"
+        "  power <ch> cycle [ms]      power off, wait (default 1000 ms), power on\n"
+        "  data <ch> on|off           switch port USB2 data lines\n"
+        "  meters                     snapshot voltage/current of every port\n"
+        "  bench [count]              pipeline count meter reads per hub (default 100)\n",
+        prog, UIH_DEFAULT_TIMEOUT_MS);
+}
+
+static int parseChannel(const char* s) {
+    int ch = atoi(s);
+    if (ch < 1 || ch > UIH_NUM_CHANNELS) {
+        fprintf(stderr, "channel must be 1..%d\n", UIH_NUM_CHANNELS);
+        exit(2);
+    }
+    return ch;
+}
+
+static bool parseOnOff(const char* s) {
+    if (!strcmp(s, "on") || !strcmp(s, "true") || !strcmp(s, "1")) return true;
+    if (!strcmp(s, "off") || !strcmp(s, "false") || !strcmp(s, "0")) return false;
+    fprintf(stderr, "expected on/off, got %s\n", s);
+    exit(2);
+}
+
+static const char* failReason(const Response& r) {
+    if (r.disconnected) return "disconnected";
+    if (r.timedOut) return "timeout";
+    return "error";
+}
+
+//One line per hub, returns the number of hubs that failed
+static int printResults(const std::vector<FanOutResult>& results) {
+    int failed = 0;
+    for (const auto& r : results) {
+        if (r.response.ok) {
+            printf("%-24s %6.1f ms  %s\n", r.hub->label().c_str(), r.response.latencyMs,
+                   r.response.json["data"].dump().c_str());
+        } else {
+            failed++;
+            printf("%-24s %s %s\n", r.hub->label().c_str(), failReason(r.response), r.response.raw.c_str());
+        }
+    }
+    return failed;
+}
+
+static void printStats(const HubPool& pool) {
+    printf("\n%-24s %6s %5s %5s %8s %8s %8s %8s %8s\n",
+           "hub", "ok", "tmo", "err", "min", "mean", "p50", "p95", "max");
+    for (const auto& h : pool.hubs()) {
+        const LatencyStats& s = h->stats();
+        printf("%-24s %6llu %5llu %5llu %8.1f %8.1f %8.1f %8.1f %8.1f\n",
+               h->label().c_str(), (unsigned long long)s.count(), (unsigned long long)s.timeouts(),
+               (unsigned long long)s.errors(), s.min(), s.mean(), s.percentile(50),
+               s.percentile(95), s.max());
+    }
+}
+
+static int cmdMetersSnapshot(HubPool& pool) {
+    auto results = pool.fanOut(cmdMeters(), timeoutMs);
+    int failed = 0;
+    printf("%-24s %4s %9s %9s %4s %4s %s\n", "hub", "port", "mV", "mA", "pwr", "data", "alerts");
+    for (const auto& r : results) {
+        ChannelMeter ch[UIH_NUM_CHANNELS];
+        if (!r.response.ok || !readMeters(r.response.json, ch)) {
+            failed++;
+            printf("%-24s %s\n", r.hub->label().c_str(), failReason(r.response));
+            continue;
+        }
+        for (int i = 0; i < UIH_NUM_CHANNELS; i++) {
+            std::string alerts;
+            if (ch[i].fwdAlert) alerts += "fwd ";
+            if (ch[i].backAlert) alerts += "back ";
+            if (ch[i].shortAlert) alerts += "short ";
+            if (ch[i].sagAlert) alerts += "sag ";
+            if (ch[i].ovAlert) alerts += "ov ";
+            if (ch[i].opAlert) alerts += "op";
+            printf("%-24s %4d %9.1f %9.1f %4s %4s %s\n", i ? "" : r.hub->label().c_str(), i + 1,
+                   ch[i].voltage, ch[i].current, ch[i].powerEn ? "on" : "off",
+                   ch[i].dataEn ? "on" : "off", alerts.c_str());
+        }
+    }
+    return failed;
+}
+
+//Queue count requests on every hub up front and let the loop stream them
+static int cmdBench(HubPool& pool, int count) {
+    std::string line = cmdMeters();
+    int failed = 0;
+    for (const auto& h : pool.hubs()) {
+        if (!h->isOpen()) continue;
+        for (int i = 0; i < count; i++)
+            h->submit(line, [&failed](HubConnection&, const Response& r) {
+                if (!r.ok) failed++;
+            }, timeoutMs);
+    }
+    Clock::time_point start = Clock::now();
+    pool.runUntilIdle((timeoutMs + UIH_RESYNC_QUIET_MS) * count);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t total = count * pool.hubs().size();
+    printf("%zu requests to %zu hubs in %.2f s (%.1f req/s), %d failed\n",
+           total, pool.hubs().size(), secs, secs > 0 ? total / secs : 0.0, failed);
+    showStats = true;
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> devices;
+    int opt;
+    while ((opt = getopt(argc, argv, "+d:t:sh")) != -1) {
+        switch (opt) {
+            case 'd': devices.push_back(optarg); break;
+            case 't': timeoutMs = atoi(optarg); break;
+            case 's': showStats = true; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::string cmd = argv[optind];
+    std::vector<const char*> args(argv + optind + 1, argv + argc);
+
+    if (cmd == "list") {
+        for (const HubInfo& h : discoverHubs())
+            printf("%-14s %-12s %s\n", h.devPath.c_str(), h.usbPath.c_str(), h.serial.c_str());
+        return 0;
+    }
+
+    HubPool pool;
+    std::vector<std::string> errors;
+    if (devices.empty()) {
+        pool.addDiscovered(&errors);
+    } else {
+        for (const auto& d : devices) {
+            std::string err;
+            if (!pool.add(d, "", &err)) errors.push_back(err);
+        }
+    }
+    for (const auto& e : errors) fprintf(stderr, "%s\n", e.c_str());
+    if (pool.hubs().empty()) {
+        fprintf(stderr, "no hub found\n");
+        return 1;
+    }
+
+    int failed = 0;
+    if (cmd == "get") {
+        std::vector<std::string> params(args.begin(), args.end());
+        if (params.empty()) params.push_back("all");
+        failed = printResults(pool.fanOut(cmdGet(params), timeoutMs));
+    } else if (cmd == "set" && args.size() == 1) {
+        JsonValue params;
+        std::string err;
+        if (!JsonValue::parse(args[0], params, &err) || !params.isObject()) {
+            fprintf(stderr, "invalid params: %s\n", err.c_str());
+            return 2;
+        }
+        failed = printResults(pool.fanOut(cmdSet(params), timeoutMs));
+    } else if (cmd == "raw" && args.size() == 1) {
+        failed = printResults(pool.fanOut(args[0], timeoutMs));
+    } else if (cmd == "power" && args.size() >= 2) {
+        int ch = parseChannel(args[0]);
+        if (!strcmp(args[1], "cycle")) {
+            int offMs = args.size() > 2 ? atoi(args[2]) : 1000;
+            failed = printResults(pool.fanOut(cmdPower(ch, false), timeoutMs));
+            pool.runFor(offMs);
+            failed += printResults(pool.fanOut(cmdPower(ch, true), timeoutMs));
+        } else {
+            failed = printResults(pool.fanOut(cmdPower(ch, parseOnOff(args[1])), timeoutMs));
+        }
+    } else if (cmd == "data" && args.size() == 2) {
+        failed = printResults(pool.fanOut(cmdData(parseChannel(args[0]), parseOnOff(args[1])), timeoutMs));
+    } else if (cmd == "meters") {
+        failed = cmdMetersSnapshot(pool);
+    } else if (cmd == "bench") {
+        failed = cmdBench(pool, args.empty() ? 100 : atoi(args[0]));
+    } else {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (showStats) printStats(pool);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,395 @@
+/**
+ *   USB Insight Hub Host Control
+ *
+ *   Linux host library and tools to drive one or many USB Insight Hubs
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//pty based simulator of the hub side of the Extercomms protocol.
+//Each simulated hub is a pseudo terminal; point uihctl at the printed paths with -d.
+
+#include "uih/Json.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+using uih::JsonValue;
+
+//Same timing and limits as Extercomms.h
+#define SERIAL_CHECK_PERIOD     50
+#define MAX_BUFFER_SIZE         1024
+#define IMAGE_SIZE_PIXELS       (226*90)
+
+static const char* t_bool[] = {"false","true"};
+
+struct SimChannel {
+    bool powerEn = true;
+    bool dataEn = true;
+    bool fwdAlert = false;
+    bool backAlert = false;
+    bool shortAlert = false;
+    int fwdLimit = 2000;
+    int backLimit = 10;
+    int uvLimit = 4400;
+    int ovLimit = 5500;
+    int opLimit = 10000;
+    int numDev = 0;
+    std::string dev1Name;
+    std::string dev2Name;
+    int usbType = 0;
+    double loadmA = 0;
+};
+
+struct SimHub {
+    int master = -1;
+    int slave = -1;     //kept open so the master does not report a hangup between clients
+    std::string path;
+    std::string mac;
+    std::string lineBuf;
+    std::string inputBuffer;    //single line waiting for the next check period, like the firmware
+    bool dataReceived = false;
+    int imgRemaining = -1;      //image bytes still to swallow, -1 when not in image mode
+    int imgPort = -1;
+    SimChannel ch[3];
+    int brightness = 80;
+    std::string hubMode = "usb2&3";
+    bool ledState = true;
+};
+
+static volatile sig_atomic_t running = 1;
+static bool verbose = false;
+static bool lossless = false;
+static int extraDelayMs = 0;
+
+static void onSignal(int) { running = 0; }
+
+static void reply(SimHub& hub, const std::string& line) {
+    std::string out = line + "\r\n";   //Serial.println
+    if (write(hub.master, out.data(), out.size()) < 0 && verbose)
+        fprintf(stderr, "%s: write failed: %s\n", hub.path.c_str(), strerror(errno));
+    if (verbose) fprintf(stderr, "%s < %s\n", hub.path.c_str(), line.c_str());
+}
+
+static void replyOk(SimHub& hub, const JsonValue& data) {
+    JsonValue doc = JsonValue::object();
+    doc.set("status", "ok");
+    doc.set("data", data);
+    reply(hub, doc.dump());
+}
+
+static int boolIndex(const JsonValue& v) {
+    std::string s = v.asString();
+    for (int i = 0; i < 2; i++)
+        if (s == t_bool[i]) return i;
+    return -1;
+}
+
+static double noise(double amplitude) {
+    return amplitude * ((rand() % 2001) - 1000) / 1000.0;
+}
+
+static void fillChannel(const SimHub& hub, int i, JsonValue& out, bool all) {
+    const SimChannel& c = hub.ch[i];
+    char buf[16];
+    JsonValue& o = out.set("CH" + std::to_string(i + 1), JsonValue::object());
+    snprintf(buf, sizeof(buf), "%.1f", c.powerEn ? 5050 + noise(15) : 0.0);
+    o.set("voltage", buf);
+    snprintf(buf, sizeof(buf), "%.1f", c.powerEn ? c.loadmA + noise(2) : 0.0);
+    o.set("current", buf);
+    o.set("fwdAlert", c.fwdAlert);
+    o.set("backAlert", c.backAlert);
+    o.set("shortAlert", c.shortAlert);
+    o.set("sagAlert", false);
+    o.set("ovAlert", false);
+    o.set("opAlert", c.powerEn && c.opLimit && 5.05 * c.loadmA > c.opLimit);
+    o.set("dataEn", c.dataEn);
+    o.set("powerEn", c.powerEn);
+    if (!all) return;
+    snprintf(buf, sizeof(buf), "%.1f", c.powerEn ? 5.05 * c.loadmA : 0.0);
+    o.set("power", buf);
+    o.set("ilim", 3);
+    o.set("startup_cnt", 0);
+    o.set("startup_tmr", 1);
+    o.set("fwdLimit", c.fwdLimit);
+    o.set("backLimit", c.backLimit);
+    o.set("uvLimit", c.uvLimit);
+    o.set("ovLimit", c.ovLimit);
+    o.set("opLimit", c.opLimit);
+    o.set("numDev", c.numDev);
+    o.set("Dev1_name", c.dev1Name);
+    o.set("Dev2_name", c.dev2Name);
+    o.set("usbType", c.usbType);
+}
+
+static void processJsonRpcMessage(SimHub& hub, const std::string& text) {
+    JsonValue doc;
+    std::string err;
+    if (!JsonValue::parse(text, doc, &err)) {
+        reply(hub, "{\"status\": \"error\", \"data\": {\"code\": -32700, \"message\": \"Parse error InvalidInput\"}}");
+        return;
+    }
+    if (doc["action"].isNull() || doc["params"].isNull()) {
+        reply(hub, "{\"status\": \"error\", \"data\": {\"code\": -32600, \"message\": \"Invalid request\"}}");
+        return;
+    }
+
+    std::string action = doc["action"].asString();
+    const JsonValue& params = doc["params"];
+    JsonValue result = JsonValue::object();
+
+    if (action == "set") {
+        if (params.has("brightness")) {
+            int b = (int)params["brightness"].asNumber();
+            if (b >= 10 && b <= 100) hub.brightness = b;
+            else result.set("brightness", "fail");
+        }
+        if (params.has("ledState")) {
+            int inx = boolIndex(params["ledState"]);
+            inx != -1 ? (void)(hub.ledState = inx) : (void)result.set("ledState", "fail");
+        }
+        if (params.has("hubMode")) hub.hubMode = params["hubMode"].asString();
+
+        for (int i = 0; i < 3; i++) {
+            std::string key = "CH" + std::to_string(i + 1);
+            const JsonValue& p = params[key];
+            if (!p.isObject()) continue;
+            SimChannel& c = hub.ch[i];
+            if (p.has("powerEn")) {
+                int inx = boolIndex(p["powerEn"]);
+                if (inx != -1) c.powerEn = inx;
+                else result.set(key, JsonValue::object()).set("powerEn", "fail");
+            }
+            if (p.has("dataEn")) {
+                int inx = boolIndex(p["dataEn"]);
+                if (inx != -1) c.dataEn = inx;
+                else result.set(key, JsonValue::object()).set("dataEn", "fail");
+            }
+            if (p.has("fwdLimit")) {
+                int v = (int)p["fwdLimit"].asNumber();
+                if (v >= 100 && v <= 2000) c.fwdLimit = v;
+                else result.set(key, JsonValue::object()).set("fwdLimit", "out of range");
+            }
+            if (p.has("backLimit")) {
+                int v = (int)p["backLimit"].asNumber();
+                if (v >= 1 && v <= 200) c.backLimit = v;
+                else result.set(key, JsonValue::object()).set("backLimit", "out of range");
+            }
+            if (p.has("uvLimit")) {
+                int v = (int)p["uvLimit"].asNumber();
+                if (v == 0 || (v >= 3000 && v <= 5000)) c.uvLimit = v;
+                else result.set(key, JsonValue::object()).set("uvLimit", "out of range");
+            }
+            if (p.has("ovLimit")) {
+                int v = (int)p["ovLimit"].asNumber();
+                if (v == 0 || (v >= 5000 && v <= 6000)) c.ovLimit = v;
+                else result.set(key, JsonValue::object()).set("ovLimit", "out of range");
+            }
+            if (p.has("opLimit")) {
+                int v = (int)p["opLimit"].asNumber();
+                if (v == 0 || (v >= 500 && v <= 15000)) c.opLimit = v;
+                else result.set(key, JsonValue::object()).set("opLimit", "out of range");
+            }
+            if (p.has("numDev")) c.numDev = (int)p["numDev"].asNumber();
+            if (p.has("Dev1_name")) c.dev1Name = p["Dev1_name"].asString();
+            if (p.has("Dev2_name")) c.dev2Name = p["Dev2_name"].asString();
+            if (p.has("usbType")) c.usbType = (int)p["usbType"].asNumber();
+        }
+        result.set("valid", std::to_string(params.size() - result.size()) + " of " + std::to_string(params.size()));
+        replyOk(hub, result);
+        return;
+    }
+
+    if (action == "get") {
+        for (const JsonValue& v : params.items()) {
+            std::string pName = v.asString();
+            bool all = pName == "all";
+            bool state = pName == "state";
+            bool conf = pName == "config";
+            if (pName == "hubMode" || all || conf) result.set("hubMode", hub.hubMode);
+            if (pName == "brightness" || all || conf) result.set("brightness", hub.brightness);
+            if (pName == "pcConnected" || all || state) result.set("pcConnected", true);
+            if (pName == "vbus" || all || state) result.set("vbus", "5100");
+            if (pName == "esp32_ver" || all || state) result.set("cpu_ver", "sim");
+            if (pName == "mac" || all || state) result.set("mac", hub.mac);
+            if (pName == "ledState" || all || state) result.set("ledState", hub.ledState);
+            for (int i = 0; i < 3; i++) {
+                std::string key = "CH" + std::to_string(i + 1);
+                if (pName == key || pName == key + "_all")
+                    fillChannel(hub, i, result, pName == key + "_all");
+            }
+        }
+        replyOk(hub, result);
+    }
+    //unknown actions get no answer, same as the firmware
+}
+
+//Byte state machine of Extercomms onSerialDataReceived
+static void onSerialData(SimHub& hub, const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (hub.imgRemaining >= 0) {
+            if (hub.imgRemaining == 0 && hub.imgPort >= 0) {
+                //bpp byte
+                if (c == 0) {
+                    hub.imgRemaining = -1;
+                    reply(hub, "{\"status\": \"ok\", \"data\": {\"message\": \"image complete\"}}");
+                } else {
+                    unsigned long bits = (unsigned long)IMAGE_SIZE_PIXELS * (unsigned char)c;
+                    hub.imgRemaining = bits / 8 + (bits % 8 ? 1 : 0);
+                    hub.imgPort = -1;
+                }
+                continue;
+            }
+            if (--hub.imgRemaining == 0) {
+                hub.imgRemaining = -1;
+                reply(hub, "{\"status\": \"ok\", \"data\": {\"message\": \"image complete\"}}");
+            }
+            continue;
+        }
+        if (c >= 1 && c <= 3) {
+            hub.lineBuf.clear();
+            hub.imgPort = c - 1;
+            hub.imgRemaining = 0;
+            continue;
+        }
+        //empty line = agent keepalive, activity only
+        if ((c == '\n' || c == '\r') && hub.lineBuf.empty()) continue;
+        if (hub.lineBuf.size() >= MAX_BUFFER_SIZE - 1) {
+            hub.lineBuf.clear();
+            continue;
+        }
+        hub.lineBuf += c;
+        if (c == '\n') {
+            if (hub.dataReceived && verbose)
+                fprintf(stderr, "%s: line overwritten before processing\n", hub.path.c_str());
+            //the firmware overwrites the pending line, -l keeps every line instead
+            if (lossless && hub.dataReceived) hub.inputBuffer += hub.lineBuf;
+            else hub.inputBuffer = hub.lineBuf;
+            hub.dataReceived = true;
+            hub.lineBuf.clear();
+        }
+    }
+}
+
+static bool openHub(SimHub& hub, int index) {
+    hub.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (hub.master < 0 || grantpt(hub.master) != 0 || unlockpt(hub.master) != 0) return false;
+    const char* name = ptsname(hub.master);
+    if (!name) return false;
+    hub.path = name;
+
+    hub.slave = open(name, O_RDWR | O_NOCTTY);
+    if (hub.slave < 0) return false;
+    termios tio;
+    tcgetattr(hub.slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(hub.slave, TCSANOW, &tio);
+
+    fcntl(hub.master, F_SETFL, fcntl(hub.master, F_GETFL) | O_NONBLOCK);
+
+    char mac[24];
+    snprintf(mac, sizeof(mac), "24:58:7C:00:00:%02X", index);
+    hub.mac = mac;
+    for (int i = 0; i < 3; i++) hub.ch[i].loadmA = 50.0 * (i + 1) + index;
+    return true;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-n hubs] [-d extra_delay_ms] [-l] [-v]\n"
+        "  -n  number of simulated hubs (default 1)\n"
+        "  -d  extra processing delay added to every answer\n"
+        "  -l  lossless line buffer (the real firmware keeps only the last line)\n"
+        "  -v  log traffic to stderr\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int numHubs = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:lvh")) != -1) {
+        switch (opt) {
+            case 'n': numHubs = atoi(optarg); break;
+            case 'd': extraDelayMs = atoi(optarg); break;
+            case 'l': lossless = true; break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (numHubs < 1) numHubs = 1;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    std::vector<SimHub> hubs(numHubs);
+    int epfd = epoll_create1(0);
+    for (int i = 0; i < numHubs; i++) {
+        if (!openHub(hubs[i], i)) {
+            fprintf(stderr, "could not create pty: %s\n", strerror(errno));
+            return 1;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, hubs[i].master, &ev);
+        printf("%s\n", hubs[i].path.c_str());
+    }
+    fflush(stdout);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextCheck = Clock::now() + std::chrono::milliseconds(SERIAL_CHECK_PERIOD);
+
+    while (running) {
+        int waitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(nextCheck - Clock::now()).count();
+        epoll_event events[16];
+        int n = epoll_wait(epfd, events, 16, waitMs > 0 ? waitMs : 0);
+        for (int i = 0; i < n; i++) {
+            SimHub& hub = hubs[events[i].data.u32];
+            char buf[256];
+            ssize_t r;
+            while ((r = read(hub.master, buf, sizeof(buf))) > 0) {
+                if (verbose) fprintf(stderr, "%s > %.*s", hub.path.c_str(), (int)r, buf);
+                onSerialData(hub, buf, r);
+            }
+        }
+
+        if (Clock::now() >= nextCheck) {
+            //taskExterCheckActivity: one pending buffer per period
+            for (auto& hub : hubs) {
+                if (!hub.dataReceived) continue;
+                if (extraDelayMs) usleep(extraDelayMs * 1000);
+                std::string pending;
+                pending.swap(hub.inputBuffer);
+                hub.dataReceived = false;
+                size_t start = 0, nl;
+                while ((nl = pending.find('\n', start)) != std::string::npos) {
+                    processJsonRpcMessage(hub, pending.substr(start, nl - start));
+                    start = nl + 1;
+                }
+            }
+            nextCheck += std::chrono::milliseconds(SERIAL_CHECK_PERIOD);
+        }
+    }
+
+    for (auto& hub : hubs) {
+        close(hub.master);
+        close(hub.slave);
+    }
+    close(epfd);
+    return 0;
+}
@@ -12,6 +12,8 @@
  **/
 
  //various graphical artifacts used in the interface
+ //RGB565 source of the icon atlas: scripts/generate_icon_atlas.py converts it into
+ //src/iconAtlas.h at build time. This file is not compiled into the firmware.
 
 #ifndef ICONS_H
 #define ICONS_H
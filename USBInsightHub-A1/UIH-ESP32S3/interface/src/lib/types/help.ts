@@ -5,6 +5,9 @@ export const Help = {
         POWER: "Hub is powered by the HOST or the AUX power supply",
         OVER_CURRENT: "Forward current limit. From the Hub to the load",
         BACK_CURRENT: "Reverse current limit. From the load to the Hub",
+        UNDER_VOLTAGE: "VBUS sag alert level. The sag is logged and the channel shows SAG until it is turned off. 0 disables it, otherwise 3000 to 5000 mV",
+        OVER_VOLTAGE: "VBUS over voltage alert level. 0 disables it, otherwise 5000 to 6000 mV",
+        OVER_POWER: "Power alert level, the channel stays on. 0 disables it, otherwise 500 to 15000 mW",
         STARTUP_DELAY: "Delay time after power-on to turn on the channel power. Settings->Startup Mode->Timed must be selected",
     },
     SETTINGS: {
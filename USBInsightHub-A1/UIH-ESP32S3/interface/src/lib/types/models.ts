@@ -169,6 +169,8 @@ export type MasterState = {
 	BaseMCU_usb3_mux_sel_pos: boolean;
 	BaseMCU_base_ver: number;
 	system_resetToDefault: number;
+	system_updateState: number;
+	system_updateProgress: number;
 
 //--------------------------------------------
 
@@ -181,6 +183,12 @@ export type MasterState = {
 	c1_meter_backAlertSet: boolean;
 	c1_meter_conf_fwdCLim: number;
 	c1_meter_conf_backCLim: number;
+	c1_meter_sagAlert: boolean;
+	c1_meter_ovAlert: boolean;
+	c1_meter_opAlert: boolean;
+	c1_meter_conf_uvLim: number;
+	c1_meter_conf_ovLim: number;
+	c1_meter_conf_opLim: number;
 
 	c1_USBInfo_numDev: number;
 	c1_USBInfo_Dev1_Name: string;
@@ -203,6 +211,12 @@ export type MasterState = {
 	c2_meter_backAlertSet: boolean;
 	c2_meter_conf_fwdCLim: number;
 	c2_meter_conf_backCLim: number;
+	c2_meter_sagAlert: boolean;
+	c2_meter_ovAlert: boolean;
+	c2_meter_opAlert: boolean;
+	c2_meter_conf_uvLim: number;
+	c2_meter_conf_ovLim: number;
+	c2_meter_conf_opLim: number;
 
 	c2_USBInfo_numDev: number;
 	c2_USBInfo_Dev1_Name: string;
@@ -225,6 +239,12 @@ export type MasterState = {
 	c3_meter_backAlertSet: boolean;
 	c3_meter_conf_fwdCLim: number;
 	c3_meter_conf_backCLim: number;
+	c3_meter_sagAlert: boolean;
+	c3_meter_ovAlert: boolean;
+	c3_meter_opAlert: boolean;
+	c3_meter_conf_uvLim: number;
+	c3_meter_conf_ovLim: number;
+	c3_meter_conf_opLim: number;
 
 	c3_USBInfo_numDev: number;
 	c3_USBInfo_Dev1_Name: string;
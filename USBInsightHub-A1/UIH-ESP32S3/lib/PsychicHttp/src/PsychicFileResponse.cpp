@@ -1,6 +1,7 @@
 #include "PsychicFileResponse.h"
 #include "PsychicResponse.h"
 #include "PsychicRequest.h"
+#include "http_status.h"
 
 
 PsychicFileResponse::PsychicFileResponse(PsychicRequest *request, FS &fs, const String& path, const String& contentType, bool download)
@@ -69,6 +70,18 @@ PsychicFileResponse::~PsychicFileResponse()
     _content.close();
 }
 
+//send only bytes start..end (inclusive) of the file as a 206 partial response
+void PsychicFileResponse::setRange(size_t start, size_t end)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "bytes %u-%u/%u", (unsigned)start, (unsigned)end, (unsigned)_content.size());
+  addHeader("Content-Range", buf);
+
+  _content.seek(start);
+  _contentLength = end - start + 1;
+  setCode(206);
+}
+
 void PsychicFileResponse::_setContentType(const String& path){
   const char *_contentType;
 	
@@ -122,21 +135,27 @@ esp_err_t PsychicFileResponse::send()
       return ESP_FAIL;
     }
 
+    //status is only set by PsychicResponse::send(), partial responses need it here too
+    sprintf(_status, "%u %s", _code, http_status_reason(_code));
+    httpd_resp_set_status(this->_request->request(), _status);
+
     this->sendHeaders();
 
     size_t chunksize;
+    size_t remaining = size;
     do {
-        /* Read file in chunks into the scratch buffer */
-        chunksize = _content.readBytes(chunk, FILE_CHUNK_SIZE);
+        /* Read file in chunks into the scratch buffer, never past the requested length */
+        chunksize = _content.readBytes(chunk, remaining < FILE_CHUNK_SIZE ? remaining : FILE_CHUNK_SIZE);
         if (chunksize > 0)
         {
+          remaining -= chunksize;
           err = this->sendChunk((uint8_t *)chunk, chunksize);
           if (err != ESP_OK)
             break;
         }
 
         /* Keep looping till the whole file is sent */
-    } while (chunksize != 0);
+    } while (chunksize != 0 && remaining > 0);
 
     //keep track of our memory
     free(chunk);
@@ -17,6 +17,7 @@ class PsychicFileResponse: public PsychicResponse
     PsychicFileResponse(PsychicRequest *request, FS &fs, const String& path, const String& contentType=String(), bool download=false);
     PsychicFileResponse(PsychicRequest *request, File content, const String& path, const String& contentType=String(), bool download=false);
     ~PsychicFileResponse();
+    void setRange(size_t start, size_t end);
     esp_err_t send();
 };
 
@@ -137,14 +137,59 @@ uint8_t PsychicStaticFileHandler::_countBits(const uint8_t value) const
   return n;
 }
 
+// Single "bytes=" range, returns 1 if usable, 0 to ignore it and send the whole file, -1 if unsatisfiable
+int PsychicStaticFileHandler::_parseRange(const String& range, size_t size, size_t& start, size_t& end) const
+{
+  if (!range.startsWith("bytes=") || range.indexOf(',') >= 0)
+    return 0;
+
+  int dash = range.indexOf('-');
+  if (dash < 0)
+    return 0;
+
+  String first = range.substring(6, dash);
+  String last = range.substring(dash + 1);
+  first.trim();
+  last.trim();
+
+  if (first.length() == 0)
+  {
+    //suffix range, the last n bytes
+    long suffix = last.toInt();
+    if (suffix <= 0 || size == 0)
+      return -1;
+    start = (size_t)suffix >= size ? 0 : size - suffix;
+    end = size - 1;
+    return 1;
+  }
+
+  long from = first.toInt();
+  if (from < 0 || (size_t)from >= size)
+    return -1;
+  start = from;
+
+  long to = last.length() ? last.toInt() : (long)size - 1;
+  if (to < from)
+    return 0;
+  end = (size_t)to >= size ? size - 1 : to;
+  return 1;
+}
+
 esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
 {
   if (_file == true)
   {
     DUMP(_filename);
 
+    //strong validator from the stored bytes, size and last write time change with every upload.
+    //Without a recorded write time two versions of the same size would share it, send none then
+    size_t size = _file.size();
+    time_t lastWrite = _file.getLastWrite();
+    char etag[32] = "";
+    if (lastWrite != 0)
+      snprintf(etag, sizeof(etag), "\"%x-%lx\"", (unsigned)size, (unsigned long)lastWrite);
+
     //is it not modified?
-    String etag = String(_file.size());
     if (_last_modified.length() && _last_modified == request->header("If-Modified-Since"))
     {
       DUMP("Last Modified Hit");
@@ -153,7 +198,7 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
       request->reply(304); // Not modified
     }
     //does our Etag match?
-    else if (_cache_control.length() && request->hasHeader("If-None-Match") && request->header("If-None-Match").equals(etag))
+    else if (request->hasHeader("If-None-Match") && ((etag[0] && request->header("If-None-Match").indexOf(etag) >= 0) || request->header("If-None-Match").equals("*")))
     {
       DUMP("Etag Hit");
       DUMP(etag);
@@ -162,8 +207,10 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
       _file.close();
 
       PsychicResponse response(request);
-      response.addHeader("Cache-Control", _cache_control.c_str());
-      response.addHeader("ETag", etag.c_str());
+      if (_cache_control.length())
+        response.addHeader("Cache-Control", _cache_control.c_str());
+      if (etag[0])
+        response.addHeader("ETag", etag);
       response.setCode(304);
       response.send();
     }
@@ -178,13 +225,32 @@ esp_err_t PsychicStaticFileHandler::handleRequest(PsychicRequest *request)
 
       if (_last_modified.length())
         response.addHeader("Last-Modified", _last_modified.c_str());
-      if (_cache_control.length()) {
+      if (_cache_control.length())
         response.addHeader("Cache-Control", _cache_control.c_str());
-        response.addHeader("ETag", etag.c_str());
-      }
+      if (etag[0])
+        response.addHeader("ETag", etag);
+      response.addHeader("Accept-Ranges", "bytes");
 
       _file.close();
-      
+
+      //a range is only honored for the same version of the file (If-Range), unknown without an ETag
+      if (request->hasHeader("Range") && (!request->hasHeader("If-Range") || (etag[0] && request->header("If-Range").equals(etag))))
+      {
+        size_t start, end;
+        int range = _parseRange(request->header("Range"), size, start, end);
+        if (range > 0)
+          response.setRange(start, end);
+        else if (range < 0)
+        {
+          char buf[32];
+          snprintf(buf, sizeof(buf), "bytes */%u", (unsigned)size);
+          PsychicResponse notSatisfiable(request);
+          notSatisfiable.addHeader("Content-Range", buf);
+          notSatisfiable.setCode(416);
+          return notSatisfiable.send();
+        }
+      }
+
       return response.send();
     }
   } else {
@@ -14,6 +14,7 @@ class PsychicStaticFileHandler : public PsychicWebHandler {
     bool _getFile(PsychicRequest *request);
     bool _fileExists(const String& path);
     uint8_t _countBits(const uint8_t value) const;
+    int _parseRange(const String& range, size_t size, size_t& start, size_t& end) const;
   protected:
     FS _fs;
     File _file;
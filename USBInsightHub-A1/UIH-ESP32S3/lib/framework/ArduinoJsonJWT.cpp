@@ -35,19 +35,22 @@ String ArduinoJsonJWT::getSecret()
  *
  * No need to pull in additional crypto libraries - lets use what we already have.
  */
+void ArduinoJsonJWT::hmac(const char *data, size_t length, unsigned char *result)
+{
+    mbedtls_md_context_t ctx;
+    mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
+    mbedtls_md_hmac_starts(&ctx, (unsigned char *)_secret.c_str(), _secret.length());
+    mbedtls_md_hmac_update(&ctx, (const unsigned char *)data, length);
+    mbedtls_md_hmac_finish(&ctx, result);
+    mbedtls_md_free(&ctx);
+}
+
 String ArduinoJsonJWT::sign(String &payload)
 {
     unsigned char hmacResult[32];
-    {
-        mbedtls_md_context_t ctx;
-        mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
-        mbedtls_md_init(&ctx);
-        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
-        mbedtls_md_hmac_starts(&ctx, (unsigned char *)_secret.c_str(), _secret.length());
-        mbedtls_md_hmac_update(&ctx, (unsigned char *)payload.c_str(), payload.length());
-        mbedtls_md_hmac_finish(&ctx, hmacResult);
-        mbedtls_md_free(&ctx);
-    }
+    hmac(payload.c_str(), payload.length(), hmacResult);
     return encode((char *)hmacResult, 32);
 }
 
@@ -105,6 +108,78 @@ void ArduinoJsonJWT::parseJWT(String jwt, JsonDocument &jsonDocument)
     }
 }
 
+static const char base64UrlChars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static int base64UrlValue(char c)
+{
+    const char *p = c ? strchr(base64UrlChars, c) : nullptr;
+    return p ? p - base64UrlChars : -1;
+}
+
+int ArduinoJsonJWT::verifyJWT(const char *jwt, size_t length, char *payload, size_t payloadSize)
+{
+    // must have the correct header and delimiter
+    if (length <= (size_t)JWT_HEADER_SIZE || strncmp(jwt, JWT_HEADER.c_str(), JWT_HEADER_SIZE) != 0 || jwt[JWT_HEADER_SIZE] != '.')
+    {
+        return -1;
+    }
+
+    // the signature follows the last delimiter, 32 bytes in 43 unpadded characters
+    size_t signatureDelimiterIndex = length - 1;
+    while (jwt[signatureDelimiterIndex] != '.')
+    {
+        signatureDelimiterIndex--;
+    }
+    if (signatureDelimiterIndex == (size_t)JWT_HEADER_SIZE || length - signatureDelimiterIndex - 1 != 43)
+    {
+        return -1;
+    }
+
+    // check the signature is valid, in constant time
+    unsigned char hmacResult[32];
+    hmac(jwt, signatureDelimiterIndex, hmacResult);
+    const char *signature = jwt + signatureDelimiterIndex + 1;
+    uint8_t diff = 0;
+    for (int i = 0; i < 43; i++)
+    {
+        int bit = i * 6;
+        int value = (hmacResult[bit / 8] << 8 | (bit / 8 + 1 < 32 ? hmacResult[bit / 8 + 1] : 0)) >> (10 - bit % 8);
+        diff |= signature[i] ^ base64UrlChars[value & 0x3f];
+    }
+    if (diff != 0)
+    {
+        return -1;
+    }
+
+    // decode the payload into the buffer
+    const char *encoded = jwt + JWT_HEADER_SIZE + 1;
+    size_t encodedLength = signatureDelimiterIndex - JWT_HEADER_SIZE - 1;
+    if (encodedLength * 3 / 4 >= payloadSize)
+    {
+        return -1;
+    }
+    uint32_t bits = 0;
+    int bitCount = 0;
+    int len = 0;
+    for (size_t i = 0; i < encodedLength; i++)
+    {
+        int value = base64UrlValue(encoded[i]);
+        if (value < 0)
+        {
+            return -1;
+        }
+        bits = bits << 6 | value;
+        bitCount += 6;
+        if (bitCount >= 8)
+        {
+            bitCount -= 8;
+            payload[len++] = (char)(bits >> bitCount);
+        }
+    }
+    payload[len] = '\0';
+    return len;
+}
+
 String ArduinoJsonJWT::encode(const char *cstr, int inputLen)
 {
     // prepare encoder
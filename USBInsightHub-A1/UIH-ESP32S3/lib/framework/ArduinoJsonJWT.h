@@ -30,6 +30,7 @@ private:
     const int JWT_HEADER_SIZE = JWT_HEADER.length();
 
     String sign(String &value);
+    void hmac(const char *data, size_t length, unsigned char *result);
 
     static String encode(const char *cstr, int len);
     static String decode(String value);
@@ -42,6 +43,11 @@ public:
 
     String buildJWT(JsonObject &payload);
     void parseJWT(String jwt, JsonDocument &jsonDocument);
+
+    // Checks the header and signature of a token and decodes its payload into
+    // buffer, without using the heap. Returns the payload length, -1 if the token
+    // is invalid or its payload does not fit.
+    int verifyJWT(const char *jwt, size_t length, char *payload, size_t payloadSize);
 };
 
 #endif
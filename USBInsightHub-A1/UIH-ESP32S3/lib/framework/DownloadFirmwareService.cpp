@@ -51,56 +51,143 @@ void update_finished()
     vTaskDelay(100 / portTICK_PERIOD_MS);
 }
 
-void updateTask(void *param)
+void update_error(const char *error)
 {
-    WiFiClientSecure client;
-    client.setCACertBundle(rootca_crt_bundle_start);
-    client.setTimeout(10);
+    doc["status"] = "error";
+    doc["error"] = error;
+    JsonObject jsonObject = doc.as<JsonObject>();
+    _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
 
-    httpUpdate.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-    httpUpdate.rebootOnUpdate(true);
+    ESP_LOGE("Download OTA", "HTTP Update failed with error: %s", error);
+#ifdef SERIAL_INFO
+    Serial.printf("HTTP Update failed with error: %s\n", error);
+#endif
+}
 
-    String url = *((String *)param);
-    String output;
-    // httpUpdate.onStart(update_started);
-    // httpUpdate.onProgress(update_progress);
-    // httpUpdate.onEnd(update_finished);
+// the task owns and deletes the job
+struct DownloadJob
+{
+    String url;
+    char sha256[65]; // expected hash of the image, empty if not given
+};
 
-    t_httpUpdate_return ret = httpUpdate.update(client, url.c_str());
-    JsonObject jsonObject;
+// Streams one GET into the OTA pipeline, a retry continues with a Range request
+// from the bytes already received. Returns true once the whole image is in.
+bool streamImage(WiFiClientSecure &client, const DownloadJob &job, uint8_t *buffer, bool &fatal)
+{
+    HTTPClient http;
+    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
+    if (!http.begin(client, job.url))
+    {
+        return false;
+    }
 
-    switch (ret)
+    size_t offset = OTAPipeline::isActive() && OTAPipeline::owner() == OTA_OWNER_DOWNLOAD ? OTAPipeline::received() : 0;
+    if (offset > 0)
     {
-    case HTTP_UPDATE_FAILED:
+        http.addHeader("Range", "bytes=" + String(offset) + "-");
+    }
 
-        doc["status"] = "error";
-        doc["error"] = httpUpdate.getLastErrorString().c_str();
-        jsonObject = doc.as<JsonObject>();
-        _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    int code = http.GET();
+    if (code != (offset > 0 ? HTTP_CODE_PARTIAL_CONTENT : HTTP_CODE_OK))
+    {
+        ESP_LOGW("Download OTA", "Unexpected HTTP code %d at offset %u", code, offset);
+        http.end();
+        return false;
+    }
 
-        ESP_LOGE("Download OTA", "HTTP Update failed with error (%d): %s", httpUpdate.getLastError(), httpUpdate.getLastErrorString().c_str());
-#ifdef SERIAL_INFO
-        Serial.printf("HTTP Update failed with error (%d): %s\n", httpUpdate.getLastError(), httpUpdate.getLastErrorString().c_str());
-#endif
-        break;
-    case HTTP_UPDATE_NO_UPDATES:
+    if (offset == 0)
+    {
+        int size = http.getSize();
+        if (size <= 0 || !OTAPipeline::begin(size, OTA_OWNER_DOWNLOAD, nullptr, job.sha256))
+        {
+            fatal = true;
+            http.end();
+            return false;
+        }
+    }
 
-        doc["status"] = "error";
-        doc["error"] = "Update failed, has same firmware version";
-        jsonObject = doc.as<JsonObject>();
-        _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
+    WiFiClient *stream = http.getStreamPtr();
+    unsigned long lastData = millis();
+    while (OTAPipeline::received() < OTAPipeline::total())
+    {
+        size_t available = stream->available();
+        if (!available)
+        {
+            if (!stream->connected() || millis() - lastData > OTA_DOWNLOAD_STALL_TIMEOUT)
+            {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
 
-        ESP_LOGE("Download OTA", "HTTP Update failed, has same firmware version");
-#ifdef SERIAL_INFO
-        Serial.println("HTTP Update failed, has same firmware version");
-#endif
-        break;
-    case HTTP_UPDATE_OK:
+        int n = stream->read(buffer, min(available, (size_t)OTA_DOWNLOAD_CHUNK));
+        if (n <= 0)
+        {
+            break;
+        }
+        lastData = millis();
+
+        if (OTAPipeline::received() == 0 && !OTAPipeline::validHeader(buffer, n))
+        {
+            fatal = true;
+            break;
+        }
+        if (!OTAPipeline::push(buffer, n))
+        {
+            fatal = true;
+            break;
+        }
+        update_progress(OTAPipeline::received(), OTAPipeline::total());
+    }
+    http.end();
+
+    return !fatal && OTAPipeline::received() >= OTAPipeline::total();
+}
+
+void updateTask(void *param)
+{
+    DownloadJob *job = (DownloadJob *)param;
+
+    WiFiClientSecure client;
+    client.setCACertBundle(rootca_crt_bundle_start);
+    client.setTimeout(10);
+
+    previousProgress = 0;
+    uint8_t *buffer = (uint8_t *)malloc(OTA_DOWNLOAD_CHUNK);
+    bool fatal = buffer == nullptr;
+    bool done = false;
+
+    for (int attempt = 0; !done && !fatal && attempt < OTA_DOWNLOAD_RETRIES; attempt++)
+    {
+        if (attempt > 0)
+        {
+            ESP_LOGW("Download OTA", "Download interrupted at %u bytes, retry %d", OTAPipeline::received(), attempt);
+            vTaskDelay(pdMS_TO_TICKS(1000 << attempt));
+        }
+        done = streamImage(client, *job, buffer, fatal);
+    }
+    free(buffer);
+    delete job;
+
+    if (done && OTAPipeline::finish())
+    {
+        update_finished();
         ESP_LOGI("Download OTA", "HTTP Update successful - Restarting");
 #ifdef SERIAL_INFO
         Serial.println("HTTP Update successful - Restarting");
 #endif
-        break;
+        RestartService::restartNow();
+    }
+    else
+    {
+        // begin() may have failed against an upload, that session is not ours to drop
+        if (OTAPipeline::isActive() && OTAPipeline::owner() == OTA_OWNER_DOWNLOAD)
+        {
+            OTAPipeline::abort();
+        }
+        update_error(strlen(OTAPipeline::lastError()) ? OTAPipeline::lastError() : "Download failed");
     }
     vTaskDelete(NULL);
 }
@@ -134,11 +221,22 @@ esp_err_t DownloadFirmwareService::downloadUpdate(PsychicRequest *request, JsonV
     }
 
     String downloadURL = json["download_url"];
+    // optional, the image is not committed if its SHA-256 differs
+    String sha256 = json["sha256"] | "";
+    if (sha256.length() != 0 && sha256.length() != 64)
+    {
+        return request->reply(400);
+    }
     ESP_LOGI("Download OTA", "Starting OTA from: %s", downloadURL.c_str());
 #ifdef SERIAL_INFO
     Serial.println("Starting OTA from: " + downloadURL);
 #endif
 
+    if (OTAPipeline::isActive())
+    {
+        return request->reply(409); // another update is running
+    }
+
     doc["status"] = "preparing";
     doc["progress"] = 0;
     doc["error"] = "";
@@ -146,16 +244,20 @@ esp_err_t DownloadFirmwareService::downloadUpdate(PsychicRequest *request, JsonV
     JsonObject jsonObject = doc.as<JsonObject>();
     _socket->emitEvent(EVENT_DOWNLOAD_OTA, jsonObject);
 
+    DownloadJob *job = new DownloadJob();
+    job->url = downloadURL;
+    strlcpy(job->sha256, sha256.c_str(), sizeof(job->sha256));
     if (xTaskCreatePinnedToCore(
-            &updateTask,                // Function that should be called
-            "Update",                   // Name of the task (for debugging)
-            OTA_TASK_STACK_SIZE,        // Stack size (bytes)
-            &downloadURL,               // Pass reference to this class instance
-            (configMAX_PRIORITIES - 1), // Pretty high task priority
-            NULL,                       // Task handle
-            1                           // Have it on application core
+            &updateTask,            // Function that should be called
+            "Update",               // Name of the task (for debugging)
+            OTA_TASK_STACK_SIZE,    // Stack size (bytes)
+            job,                    // Pass the URL and hash to download
+            (tskIDLE_PRIORITY + 1), // Network side only, the pipeline writer does the flash work
+            NULL,                   // Task handle
+            1                       // Have it on application core
             ) != pdPASS)
     {
+        delete job;
         ESP_LOGE("Download OTA", "Couldn't create download OTA task");
         return request->reply(500);
     }
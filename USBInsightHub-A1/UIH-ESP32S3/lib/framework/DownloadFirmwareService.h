@@ -23,12 +23,16 @@
 #include <SecurityManager.h>
 
 #include <HTTPClient.h>
-#include <HTTPUpdate.h>
+#include <OTAPipeline.h>
+#include <RestartService.h>
 // #include <SSLCertBundle.h>
 
 #define GITHUB_FIRMWARE_PATH "/rest/downloadUpdate"
 #define EVENT_DOWNLOAD_OTA "otastatus"
 #define OTA_TASK_STACK_SIZE 9216
+#define OTA_DOWNLOAD_CHUNK 4096
+#define OTA_DOWNLOAD_RETRIES 5
+#define OTA_DOWNLOAD_STALL_TIMEOUT 10000
 
 class DownloadFirmwareService
 {
@@ -74,15 +74,26 @@ void ESP32SvelteKit::begin()
     // Serve static resources from PROGMEM
     ESP_LOGV("ESP32SvelteKit", "Registering routes from PROGMEM static resources");
     WWWData::registerRoutes(
-        [&](const String &uri, const String &contentType, const uint8_t *content, size_t len)
+        [&](const String &uri, const String &contentType, const uint8_t *content, size_t len, const String &etag)
         {
-            PsychicHttpRequestCallback requestHandler = [contentType, content, len](PsychicRequest *request)
+            // hashed build output never changes under the same name, everything else (index.html) is revalidated
+            const char *cacheControl = uri.startsWith("/_app/immutable/") ? WWW_CACHE_IMMUTABLE : WWW_CACHE_REVALIDATE;
+            PsychicHttpRequestCallback requestHandler = [contentType, content, len, etag, cacheControl](PsychicRequest *request)
             {
                 PsychicResponse response(request);
+                response.addHeader("Cache-Control", cacheControl);
+                response.addHeader("ETag", etag.c_str());
+
+                // the build content hash is the ETag, a match means the browser copy is current
+                if (request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) >= 0)
+                {
+                    response.setCode(304);
+                    return response.send();
+                }
+
                 response.setCode(200);
                 response.setContentType(contentType.c_str());
                 response.addHeader("Content-Encoding", "gzip");
-                response.addHeader("Cache-Control", "public, immutable, max-age=31536000");
                 response.setContent(content, len);
                 return response.send();
             };
@@ -100,13 +111,15 @@ void ESP32SvelteKit::begin()
 #else
     // Serve static resources from /www/
     ESP_LOGV("ESP32SvelteKit", "Registering routes from FS /www/ static resources");
-    _server->serveStatic("/_app/", ESPFS, "/www/_app/");
-    _server->serveStatic("/favicon.png", ESPFS, "/www/favicon.png");
+    _server->serveStatic("/_app/immutable/", ESPFS, "/www/_app/immutable/", WWW_CACHE_IMMUTABLE);
+    _server->serveStatic("/_app/", ESPFS, "/www/_app/", WWW_CACHE_REVALIDATE);
+    _server->serveStatic("/favicon.png", ESPFS, "/www/favicon.png", WWW_CACHE_REVALIDATE);
     //  Serving all other get requests with "/www/index.htm"
     _server->onNotFound([](PsychicRequest *request)
                         {
         if (request->method() == HTTP_GET) {
             PsychicFileResponse response(request, ESPFS, "/www/index.html", "text/html");
+            response.addHeader("Cache-Control", WWW_CACHE_REVALIDATE);
             return response.send();
             // String url = "http://" + request->host() + "/index.html";
             // request->redirect(url.c_str());
@@ -209,6 +222,9 @@ void ESP32SvelteKit::_loop()
 #if FT_ENABLED(FT_ANALYTICS)
         _analyticsService.loop();
 #endif
+#if FT_ENABLED(FT_UPLOAD_FIRMWARE)
+        _uploadFirmwareService.loop();
+#endif
 
         // Query the connectivity status
         wifi = _wifiStatus.isConnected();
@@ -70,6 +70,10 @@
 #define ESP32SVELTEKIT_LOOP_INTERVAL 10
 #endif
 
+// Cache policies of the web UI, hashed assets are kept forever, the rest is revalidated by ETag
+#define WWW_CACHE_IMMUTABLE "public, immutable, max-age=31536000"
+#define WWW_CACHE_REVALIDATE "no-cache"
+
 // define callback function to include into the main loop
 typedef std::function<void()> loopCallback;
 
@@ -203,7 +207,14 @@ public:
 
     uint8_t getUpdateState()
     {
-        return _uploadFirmwareService.getUploadState();
+        // a download runs the pipeline without an upload state
+        uint8_t state = _uploadFirmwareService.getUploadState();
+        return state ? state : (OTAPipeline::isActive() ? 1 : 0);
+    }
+
+    uint8_t getUpdateProgress()
+    {
+        return OTAPipeline::progress();
     }
 
 private:
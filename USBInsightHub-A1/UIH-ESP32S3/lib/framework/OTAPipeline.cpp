@@ -0,0 +1,354 @@
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2018 - 2023 rjwats
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <OTAPipeline.h>
+
+StreamBufferHandle_t OTAPipeline::_ring = nullptr;
+SemaphoreHandle_t OTAPipeline::_mutex = nullptr;
+mbedtls_md_context_t OTAPipeline::_shaCtx;
+
+volatile bool OTAPipeline::_active = false;
+volatile bool OTAPipeline::_suspended = false;
+volatile bool OTAPipeline::_writerStop = false;
+volatile bool OTAPipeline::_writerDone = true;
+volatile bool OTAPipeline::_writeFailed = false;
+volatile size_t OTAPipeline::_received = 0;
+volatile size_t OTAPipeline::_written = 0;
+size_t OTAPipeline::_total = 0;
+unsigned long OTAPipeline::_suspendedAt = 0;
+uint32_t OTAPipeline::_owner = 0;
+char OTAPipeline::_sha256[65] = "";
+char OTAPipeline::_expectedSha256[65] = "";
+const char *OTAPipeline::_lastError = "";
+
+bool OTAPipeline::validHeader(const uint8_t *data, size_t len)
+{
+    // Check firmware header, 0xE9 magic offset 0 indicates esp bin, chip offset 12: esp32:0, S2:2, C3:5, S3:9
+    if (len <= 12)
+    {
+        return true;
+    }
+#if CONFIG_IDF_TARGET_ESP32 // ESP32/PICO-D4
+    return data[0] == 0xE9 && data[12] == 0;
+#elif CONFIG_IDF_TARGET_ESP32S2
+    return data[0] == 0xE9 && data[12] == 2;
+#elif CONFIG_IDF_TARGET_ESP32C3
+    return data[0] == 0xE9 && data[12] == 5;
+#elif CONFIG_IDF_TARGET_ESP32S3
+    return data[0] == 0xE9 && data[12] == 9;
+#else
+    return data[0] == 0xE9;
+#endif
+}
+
+bool OTAPipeline::begin(size_t size, uint32_t owner, const char *md5, const char *sha256)
+{
+    if (_mutex == nullptr)
+    {
+        _mutex = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    // the other producer would keep pushing into the new image, its owner aborts it first
+    if (_active)
+    {
+        ESP_LOGW("OTAPipeline", "Session already running at %u of %u bytes", _received, _total);
+        _lastError = "Another update is running";
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+
+    _received = 0;
+    _written = 0;
+    _total = size;
+    _owner = owner;
+    _sha256[0] = '\0';
+    _expectedSha256[0] = '\0';
+    if (sha256 != nullptr && strlen(sha256) == 64)
+    {
+        strlcpy(_expectedSha256, sha256, sizeof(_expectedSha256));
+    }
+    _lastError = "";
+    _suspended = false;
+    _writeFailed = false;
+    _writerStop = false;
+
+    if (!Update.begin(size))
+    {
+        _lastError = Update.errorString();
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+    if (md5 != nullptr && strlen(md5) == 32)
+    {
+        Update.setMD5(md5);
+    }
+
+    _ring = xStreamBufferCreate(OTA_RING_SIZE, 1);
+    mbedtls_md_init(&_shaCtx);
+    if (_ring == nullptr ||
+        mbedtls_md_setup(&_shaCtx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0) != 0 ||
+        mbedtls_md_starts(&_shaCtx) != 0)
+    {
+        _lastError = "Out of memory";
+        Update.abort();
+        release();
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+
+    _writerDone = false;
+    if (xTaskCreatePinnedToCore(
+            &OTAPipeline::writerTask, // Function that should be called
+            "OTA Writer",             // Name of the task (for debugging)
+            OTA_WRITER_STACK_SIZE,    // Stack size (bytes)
+            nullptr,                  // Pass reference to this class instance
+            OTA_WRITER_PRIORITY,      // Below the display and intercomms tasks
+            NULL,                     // Task handle
+            1                         // Have it on application core
+            ) != pdPASS)
+    {
+        _writerDone = true;
+        _lastError = "Couldn't create writer task";
+        Update.abort();
+        release();
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+
+    _active = true;
+    ESP_LOGI("OTAPipeline", "Session started for %u bytes, sha256 %s", size, _expectedSha256[0] ? _expectedSha256 : "not given");
+    xSemaphoreGive(_mutex);
+    return true;
+}
+
+// Only called by the owner of the session, one producer at a time
+bool OTAPipeline::push(const uint8_t *data, size_t len)
+{
+    if (!_active || _suspended)
+    {
+        return false;
+    }
+
+    size_t sent = 0;
+    while (sent < len)
+    {
+        if (_writeFailed)
+        {
+            return false;
+        }
+        size_t n = xStreamBufferSend(_ring, data + sent, len - sent, pdMS_TO_TICKS(OTA_PUSH_TIMEOUT));
+        if (n == 0)
+        {
+            _lastError = "Flash writer stalled";
+            return false;
+        }
+        sent += n;
+    }
+    _received += len;
+    return true;
+}
+
+bool OTAPipeline::finish()
+{
+    if (_mutex == nullptr)
+    {
+        return false;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (!_active)
+    {
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+
+    // writer exits once the ring is drained
+    stopWriter();
+
+    uint8_t digest[32];
+    mbedtls_md_finish(&_shaCtx, digest);
+    for (int i = 0; i < 32; i++)
+    {
+        sprintf(&_sha256[i * 2], "%02x", digest[i]);
+    }
+    release();
+    _active = false;
+
+    bool ok = false;
+    if (_writeFailed)
+    {
+        Update.abort();
+    }
+    else if (_expectedSha256[0] && strcasecmp(_expectedSha256, _sha256) != 0)
+    {
+        // checked before Update.end(), the boot partition is not switched
+        _lastError = "SHA-256 mismatch";
+        Update.abort();
+    }
+    else if (!Update.end(true))
+    {
+        _lastError = Update.errorString();
+        Update.printError(Serial);
+    }
+    else
+    {
+        ok = true;
+    }
+
+    ESP_LOGI("OTAPipeline", "Session %s, %u bytes, sha256 %s", ok ? "done" : "failed", _written, _sha256);
+    xSemaphoreGive(_mutex);
+    return ok;
+}
+
+void OTAPipeline::abort()
+{
+    if (_mutex == nullptr)
+    {
+        return;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (_active)
+    {
+        // let the writer drain without touching the flash
+        _writeFailed = true;
+        stopWriter();
+        Update.abort();
+        release();
+        _active = false;
+        ESP_LOGW("OTAPipeline", "Session aborted at %u of %u bytes", _received, _total);
+    }
+    xSemaphoreGive(_mutex);
+}
+
+void OTAPipeline::suspend()
+{
+    if (_active && !_suspended)
+    {
+        _suspendedAt = millis();
+        _suspended = true;
+        ESP_LOGI("OTAPipeline", "Session suspended at %u of %u bytes", _received, _total);
+    }
+}
+
+bool OTAPipeline::resume(size_t offset, uint32_t owner, size_t size, const char *sha256)
+{
+    if (_mutex == nullptr)
+    {
+        return false;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    // a session without an expected hash can't be told apart from another image
+    bool sameImage = size == _total && _expectedSha256[0] && sha256 != nullptr && strcasecmp(sha256, _expectedSha256) == 0;
+    bool ok = _active && !_writeFailed && sameImage && offset == _received && (_suspended || owner == _owner);
+    if (ok)
+    {
+        _owner = owner;
+        _suspended = false;
+        ESP_LOGI("OTAPipeline", "Session resumed at %u of %u bytes", _received, _total);
+    }
+    xSemaphoreGive(_mutex);
+    return ok;
+}
+
+bool OTAPipeline::loop()
+{
+    if (!isSuspended() || millis() - _suspendedAt < OTA_RESUME_TIMEOUT)
+    {
+        return false;
+    }
+
+    // checked again under the lock, the client may be resuming right now
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool expired = isSuspended() && millis() - _suspendedAt >= OTA_RESUME_TIMEOUT;
+    if (expired)
+    {
+        _writeFailed = true;
+        stopWriter();
+        Update.abort();
+        release();
+        _active = false;
+        _lastError = "Resume timeout";
+        ESP_LOGW("OTAPipeline", "Suspended session expired at %u of %u bytes", _received, _total);
+    }
+    xSemaphoreGive(_mutex);
+    return expired;
+}
+
+uint8_t OTAPipeline::progress()
+{
+    if (!_total)
+    {
+        return 0;
+    }
+    size_t written = _written;
+    return written >= _total ? 100 : (uint8_t)((uint64_t)written * 100 / _total);
+}
+
+void OTAPipeline::writerTask(void *param)
+{
+    uint8_t *block = (uint8_t *)malloc(OTA_WRITE_BLOCK);
+    if (block == nullptr)
+    {
+        _lastError = "Out of memory";
+        _writeFailed = true;
+    }
+
+    while (block != nullptr)
+    {
+        size_t n = xStreamBufferReceive(_ring, block, OTA_WRITE_BLOCK, pdMS_TO_TICKS(100));
+        if (n == 0)
+        {
+            if (_writerStop)
+            {
+                break;
+            }
+            continue;
+        }
+        if (_writeFailed)
+        {
+            continue;
+        }
+        mbedtls_md_update(&_shaCtx, block, n);
+        if (Update.write(block, n) != n)
+        {
+            _lastError = Update.errorString();
+            _writeFailed = true;
+            continue;
+        }
+        _written += n;
+    }
+
+    free(block);
+    _writerDone = true;
+    vTaskDelete(NULL);
+}
+
+void OTAPipeline::stopWriter()
+{
+    _writerStop = true;
+    while (!_writerDone)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void OTAPipeline::release()
+{
+    if (_ring != nullptr)
+    {
+        vStreamBufferDelete(_ring);
+        _ring = nullptr;
+    }
+    mbedtls_md_free(&_shaCtx);
+}
@@ -0,0 +1,98 @@
+#ifndef OTAPipeline_h
+#define OTAPipeline_h
+
+/**
+ *   ESP32 SvelteKit
+ *
+ *   A simple, secure and extensible framework for IoT projects for ESP32 platforms
+ *   with responsive Sveltekit front-end built with TailwindCSS and DaisyUI.
+ *   https://github.com/theelims/ESP32-sveltekit
+ *
+ *   Copyright (C) 2018 - 2023 rjwats
+ *   Copyright (C) 2023 - 2024 theelims
+ *
+ *   All Rights Reserved. This software may be modified and distributed under
+ *   the terms of the LGPL v3 license. See the LICENSE file for details.
+ **/
+
+#include <Arduino.h>
+
+#include <Update.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/stream_buffer.h>
+#include <mbedtls/md.h>
+
+#define OTA_RING_SIZE 16384
+#define OTA_WRITE_BLOCK 4096
+#define OTA_WRITER_STACK_SIZE 4096
+#define OTA_WRITER_PRIORITY (tskIDLE_PRIORITY + 2)
+#define OTA_PUSH_TIMEOUT 10000
+#define OTA_RESUME_TIMEOUT (1000 * 60 * 5)
+// session owner of the URL download, uploads are owned by the client IPv4
+#define OTA_OWNER_DOWNLOAD 0xFFFFFFFF
+
+/*
+ * Firmware image pipeline used by the upload and download services.
+ * The network side pushes into a bounded ring and a writer task hashes and
+ * writes the flash, so erase stalls no longer block the HTTP task.
+ * The SHA-256 expected by the client is checked before the image is
+ * committed, a mismatch leaves the running firmware in place.
+ * A session interrupted by the network is kept for OTA_RESUME_TIMEOUT and
+ * continues from received() when the client comes back.
+ * Only one session exists at a time, begin() fails while one is active.
+ */
+class OTAPipeline
+{
+public:
+    static bool validHeader(const uint8_t *data, size_t len);
+
+    // sha256 is the expected hash of the image as 64 hex digits, or nullptr
+    static bool begin(size_t size, uint32_t owner, const char *md5 = nullptr, const char *sha256 = nullptr);
+    static bool push(const uint8_t *data, size_t len);
+    static bool finish();
+    static void abort();
+
+    static void suspend();
+    // continues a suspended session or one of the same owner, only for the
+    // image size and expected SHA-256 given at begin()
+    static bool resume(size_t offset, uint32_t owner, size_t size, const char *sha256);
+
+    // expires a suspended session, true if one was dropped
+    static bool loop();
+
+    static bool isActive() { return _active; }
+    static bool isSuspended() { return _active && _suspended; }
+    static uint32_t owner() { return _owner; }
+    static size_t received() { return _received; }
+    static size_t total() { return _total; }
+    static uint8_t progress();
+    static const char *sha256() { return _sha256; }
+    static const char *expectedSha256() { return _expectedSha256; }
+    static const char *lastError() { return _lastError; }
+
+private:
+    static void writerTask(void *param);
+    static void stopWriter();
+    static void release();
+
+    static StreamBufferHandle_t _ring;
+    static SemaphoreHandle_t _mutex;
+    static mbedtls_md_context_t _shaCtx;
+
+    static volatile bool _active;
+    static volatile bool _suspended;
+    static volatile bool _writerStop;
+    static volatile bool _writerDone;
+    static volatile bool _writeFailed;
+    static volatile size_t _received;
+    static volatile size_t _written;
+    static size_t _total;
+    static uint32_t _owner;
+    static unsigned long _suspendedAt;
+    static char _sha256[65];
+    static char _expectedSha256[65];
+    static const char *_lastError;
+};
+
+#endif // end OTAPipeline_h
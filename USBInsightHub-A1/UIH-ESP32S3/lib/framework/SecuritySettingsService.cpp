@@ -19,7 +19,8 @@
 SecuritySettingsService::SecuritySettingsService(PsychicHttpServer *server, FS *fs) : _server(server),
                                                                                       _httpEndpoint(SecuritySettings::read, SecuritySettings::update, this, server, SECURITY_SETTINGS_PATH, this),
                                                                                       _fsPersistence(SecuritySettings::read, SecuritySettings::update, this, fs, SECURITY_SETTINGS_FILE),
-                                                                                      _jwtHandler(FACTORY_JWT_SECRET)
+                                                                                      _jwtHandler(FACTORY_JWT_SECRET),
+                                                                                      _jwtCacheMutex(nullptr)
 {
     addUpdateHandler([&](const String &originId)
                      { configureJWTHandler(); },
@@ -28,6 +29,10 @@ SecuritySettingsService::SecuritySettingsService(PsychicHttpServer *server, FS *
 
 void SecuritySettingsService::begin()
 {
+    // not in the constructor, it runs during static initialization
+    _jwtCacheMutex = xSemaphoreCreateMutex();
+    clearJWTCache();
+
     _server->on(GENERATE_TOKEN_PATH,
                 HTTP_GET,
                 wrapRequest(std::bind(&SecuritySettingsService::generateToken, this, std::placeholders::_1),
@@ -43,21 +48,32 @@ void SecuritySettingsService::begin()
 Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *request)
 {
     // Load the parameters from the request, as they are only loaded later with the regular handler
-    if (request->hasHeader(AUTHORIZATION_HEADER))
+    size_t headerLength = httpd_req_get_hdr_value_len(request->request(), AUTHORIZATION_HEADER);
+    if (headerLength && headerLength < JWT_CACHE_TOKEN_LEN + AUTHORIZATION_HEADER_PREFIX_LEN)
+    {
+        // read the header in place, no String on the way to the cache
+        char value[JWT_CACHE_TOKEN_LEN + AUTHORIZATION_HEADER_PREFIX_LEN];
+        if (httpd_req_get_hdr_value_str(request->request(), AUTHORIZATION_HEADER, value, sizeof(value)) == ESP_OK &&
+            strncmp(value, AUTHORIZATION_HEADER_PREFIX, AUTHORIZATION_HEADER_PREFIX_LEN) == 0)
+        {
+            return authenticateJWT(value + AUTHORIZATION_HEADER_PREFIX_LEN, headerLength - AUTHORIZATION_HEADER_PREFIX_LEN);
+        }
+    }
+    else if (headerLength)
     {
         auto value = request->header(AUTHORIZATION_HEADER);
         // ESP_LOGV("SecuritySettingsService", "Authorization header: %s", value.c_str());
         if (value.startsWith(AUTHORIZATION_HEADER_PREFIX))
         {
             value = value.substring(AUTHORIZATION_HEADER_PREFIX_LEN);
-            return authenticateJWT(value);
+            return authenticateJWT(value.c_str(), value.length());
         }
     }
     else if (request->hasParam(ACCESS_TOKEN_PARAMATER))
     {
         String value = request->getParam(ACCESS_TOKEN_PARAMATER)->value();
         // ESP_LOGV("SecuritySettingsService", "Access token parameter: %s", value.c_str());
-        return authenticateJWT(value);
+        return authenticateJWT(value.c_str(), value.length());
     }
     return Authentication();
 }
@@ -65,27 +81,136 @@ Authentication SecuritySettingsService::authenticateRequest(PsychicRequest *requ
 void SecuritySettingsService::configureJWTHandler()
 {
     _jwtHandler.setSecret(_state.jwtSecret);
+    clearJWTCache();
 }
 
-Authentication SecuritySettingsService::authenticateJWT(String &jwt)
+Authentication SecuritySettingsService::authenticateJWT(const char *jwt, size_t length)
 {
-    JsonDocument payloadDocument;
-    _jwtHandler.parseJWT(jwt, payloadDocument);
-    if (payloadDocument.is<JsonObject>())
+    char cachedUsername[JWT_CACHE_USERNAME_LEN];
+    bool cachedAdmin;
+    if (lookupJWTCache(jwt, length, cachedUsername, cachedAdmin))
     {
-        JsonObject parsedPayload = payloadDocument.as<JsonObject>();
-        String username = parsedPayload["username"];
-        for (User _user : _state.users)
+        for (User &_user : _state.users)
         {
-            if (_user.username == username && validatePayload(parsedPayload, &_user))
+            if (_user.admin == cachedAdmin && _user.username.equals(cachedUsername))
             {
                 return Authentication(_user);
             }
         }
+        return Authentication();
+    }
+
+    // verified and decoded in place, a miss allocates nothing either
+    char payload[JWT_PAYLOAD_LEN];
+    int payloadLength = _jwtHandler.verifyJWT(jwt, length, payload, sizeof(payload));
+    if (payloadLength < 0)
+    {
+        return Authentication();
+    }
+    for (User &_user : _state.users)
+    {
+        if (validatePayload(payload, payloadLength, &_user))
+        {
+            storeJWTCache(jwt, length, _user.username, _user.admin);
+            return Authentication(_user);
+        }
     }
     return Authentication();
 }
 
+// Constant time compare, a cached token must not leak through response timing
+static bool tokenEquals(const char *a, const char *b, size_t length)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+bool SecuritySettingsService::lookupJWTCache(const char *jwt, size_t length, char *username, bool &admin)
+{
+    if (_jwtCacheMutex == nullptr)
+    {
+        return false;
+    }
+    bool found = false;
+    unsigned long now = millis();
+
+    xSemaphoreTake(_jwtCacheMutex, portMAX_DELAY);
+    for (auto &entry : _jwtCache)
+    {
+        if (entry.length == 0)
+        {
+            continue;
+        }
+        if (now - entry.verifiedAt >= JWT_CACHE_TTL)
+        {
+            entry.length = 0;
+            continue;
+        }
+        if (entry.length == length && tokenEquals(entry.token, jwt, length))
+        {
+            entry.lastUsed = now;
+            strcpy(username, entry.username);
+            admin = entry.admin;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_jwtCacheMutex);
+
+    return found;
+}
+
+void SecuritySettingsService::storeJWTCache(const char *jwt, size_t length, const String &username, bool admin)
+{
+    if (_jwtCacheMutex == nullptr || length >= JWT_CACHE_TOKEN_LEN || username.length() >= JWT_CACHE_USERNAME_LEN)
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+
+    xSemaphoreTake(_jwtCacheMutex, portMAX_DELAY);
+    // free or expired slot first, else the least recently used one
+    jwt_cache_entry_t *slot = &_jwtCache[0];
+    for (auto &entry : _jwtCache)
+    {
+        if (entry.length == 0 || now - entry.verifiedAt >= JWT_CACHE_TTL)
+        {
+            slot = &entry;
+            break;
+        }
+        if (now - entry.lastUsed > now - slot->lastUsed)
+        {
+            slot = &entry;
+        }
+    }
+    memcpy(slot->token, jwt, length);
+    slot->length = length;
+    strcpy(slot->username, username.c_str());
+    slot->admin = admin;
+    slot->verifiedAt = now;
+    slot->lastUsed = now;
+    xSemaphoreGive(_jwtCacheMutex);
+}
+
+void SecuritySettingsService::clearJWTCache()
+{
+    if (_jwtCacheMutex == nullptr)
+    {
+        return;
+    }
+    xSemaphoreTake(_jwtCacheMutex, portMAX_DELAY);
+    for (auto &entry : _jwtCache)
+    {
+        entry.length = 0;
+    }
+    xSemaphoreGive(_jwtCacheMutex);
+}
+
 Authentication SecuritySettingsService::authenticate(const String &username, const String &password)
 {
     for (User _user : _state.users)
@@ -104,12 +229,44 @@ inline void populateJWTPayload(JsonObject &payload, User *user)
     payload["admin"] = user->admin;
 }
 
-boolean SecuritySettingsService::validatePayload(JsonObject &parsedPayload, User *user)
+// Byte for byte against the payload serializeJson() writes for the user, with its
+// escapes, only this device signs tokens so no other form is valid
+boolean SecuritySettingsService::validatePayload(const char *payload, size_t length, User *user)
 {
-    JsonDocument jsonDocument;
-    JsonObject payload = jsonDocument.to<JsonObject>();
-    populateJWTPayload(payload, user);
-    return payload == parsedPayload;
+    size_t pos = 0;
+    auto expect = [&](const char *text, size_t n)
+    {
+        if (pos + n > length || memcmp(payload + pos, text, n) != 0)
+        {
+            return false;
+        }
+        pos += n;
+        return true;
+    };
+
+    if (!expect("{\"username\":\"", 13))
+    {
+        return false;
+    }
+    // character and its escape letter, as in ArduinoJson
+    static const char escapes[] = "\"\"\\\\\bb\ff\nn\rr\tt";
+    for (const char *c = user->username.c_str(); *c; c++)
+    {
+        char escaped[2] = {'\\', 0};
+        for (int e = 0; escapes[e]; e += 2)
+        {
+            if (escapes[e] == *c)
+            {
+                escaped[1] = escapes[e + 1];
+            }
+        }
+        if (escaped[1] ? !expect(escaped, 2) : !expect(c, 1))
+        {
+            return false;
+        }
+    }
+    const char *tail = user->admin ? "\",\"admin\":true}" : "\",\"admin\":false}";
+    return expect(tail, strlen(tail)) && pos == length;
 }
 
 String SecuritySettingsService::generateJWT(User *user)
@@ -46,8 +46,25 @@
 
 #define GENERATE_TOKEN_PATH "/rest/generateToken"
 
+#define JWT_CACHE_SIZE 4
+#define JWT_CACHE_TOKEN_LEN 256
+#define JWT_CACHE_USERNAME_LEN 32
+#define JWT_CACHE_TTL 1000 * 60 * 10
+#define JWT_PAYLOAD_LEN 192 // decoded payload of a token up to JWT_CACHE_TOKEN_LEN
+
 #if FT_ENABLED(FT_SECURITY)
 
+// Recently verified token and the claims it carried, a hit skips the HMAC
+typedef struct
+{
+    char token[JWT_CACHE_TOKEN_LEN];
+    uint16_t length;
+    char username[JWT_CACHE_USERNAME_LEN];
+    bool admin;
+    unsigned long verifiedAt;
+    unsigned long lastUsed;
+} jwt_cache_entry_t;
+
 class SecuritySettings
 {
 public:
@@ -115,6 +132,8 @@ private:
     HttpEndpoint<SecuritySettings> _httpEndpoint;
     FSPersistence<SecuritySettings> _fsPersistence;
     ArduinoJsonJWT _jwtHandler;
+    jwt_cache_entry_t _jwtCache[JWT_CACHE_SIZE];
+    SemaphoreHandle_t _jwtCacheMutex;
 
     esp_err_t generateToken(PsychicRequest *request);
 
@@ -123,12 +142,19 @@ private:
     /*
      * Lookup the user by JWT
      */
-    Authentication authenticateJWT(String &jwt);
+    Authentication authenticateJWT(const char *jwt, size_t length);
+
+    /*
+     * Verified token cache, cleared whenever the secret or the users change
+     */
+    bool lookupJWTCache(const char *jwt, size_t length, char *username, bool &admin);
+    void storeJWTCache(const char *jwt, size_t length, const String &username, bool admin);
+    void clearJWTCache();
 
     /*
-     * Verify the payload is correct
+     * Verify the payload is the one generateJWT() issues for the user
      */
-    boolean validatePayload(JsonObject &parsedPayload, User *user);
+    boolean validatePayload(const char *payload, size_t length, User *user);
 };
 
 #else
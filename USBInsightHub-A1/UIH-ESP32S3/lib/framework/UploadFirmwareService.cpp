@@ -36,13 +36,27 @@ void UploadFirmwareService::begin()
 
     uploadHandler->onUpload(std::bind(&UploadFirmwareService::handleUpload, this, _1, _2, _3, _4, _5, _6));
     uploadHandler->onRequest(std::bind(&UploadFirmwareService::uploadComplete, this, _1));  // gets called after upload has been handled
-    uploadHandler->onClose(std::bind(&UploadFirmwareService::handleEarlyDisconnect, this)); // gets called if client disconnects
+    uploadHandler->onClose(std::bind(&UploadFirmwareService::handleEarlyDisconnect, this, _1)); // gets called if client disconnects
     _server->on(UPLOAD_FIRMWARE_PATH, HTTP_POST, uploadHandler);
+    _server->on(UPLOAD_FIRMWARE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&UploadFirmwareService::uploadStatus, this, _1),
+                                              AuthenticationPredicates::IS_ADMIN));
     uploadState = 0;
     //ESP_LOGI("UL: ","%d", uploadState);
     ESP_LOGV("UploadFirmwareService", "Registered POST endpoint: %s", UPLOAD_FIRMWARE_PATH);
 }
 
+void UploadFirmwareService::loop()
+{
+    // a suspended upload that was never resumed is dropped
+    if (OTAPipeline::loop())
+    {
+        uploadState = 0;
+        _uploadSocket = -1;
+    }
+}
+
 esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
                                               const String &filename,
                                               uint64_t index,
@@ -66,6 +80,19 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
         std::string extension = fname.substr(position + 1);
         size_t fsize = request->contentLength();
 
+        // size, offset and sha256 are sent by clients able to resume an upload
+        bool exactSize = request->hasParam("size");
+        if (exactSize)
+        {
+            fsize = request->getParam("size")->value().toInt();
+        }
+        size_t offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+        char sha256[65] = "";
+        if (request->hasParam("sha256"))
+        {
+            strlcpy(sha256, request->getParam("sha256")->value().c_str(), sizeof(sha256));
+        }
+
         fileType = ft_none;
         if ((extension == "bin") && (fsize > 1000000))
         {
@@ -89,41 +116,45 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
 
         if (fileType == ft_firmware)
         {
-            // Check firmware header, 0xE9 magic offset 0 indicates esp bin, chip offset 12: esp32:0, S2:2, C3:5
-#if CONFIG_IDF_TARGET_ESP32 // ESP32/PICO-D4
-            if (len > 12 && (data[0] != 0xE9 || data[12] != 0))
-            {
-                return handleError(request, 503); // service unavailable
-            }
-#elif CONFIG_IDF_TARGET_ESP32S2
-            if (len > 12 && (data[0] != 0xE9 || data[12] != 2))
-            {
-                return handleError(request, 503); // service unavailable
-            }
-#elif CONFIG_IDF_TARGET_ESP32C3
-            if (len > 12 && (data[0] != 0xE9 || data[12] != 5))
-            {
-                return handleError(request, 503); // service unavailable
-            }
-#elif CONFIG_IDF_TARGET_ESP32S3
-            if (len > 12 && (data[0] != 0xE9 || data[12] != 9))
-            {
-                return handleError(request, 503); // service unavailable
-            }
-#endif
-            // it's firmware - initialize the ArduinoOTA updater
-            if (Update.begin(fsize - sizeof(esp_image_header_t)))
+            // uploads are owned by the client address, a download by the download task
+            uint32_t owner = (uint32_t)request->client()->remoteIP();
+            if (offset > 0)
             {
-                if (strlen(md5) == 32)
+                // continue an interrupted upload of the same image, the client asks GET for the offset on a conflict
+                if (!exactSize || !OTAPipeline::resume(offset, owner, fsize, sha256))
                 {
-                    Update.setMD5(md5);
-                    md5[0] = '\0';
+                    return handleConflict(request); // offset, size or hash do not match or not our session
                 }
             }
             else
             {
-                return handleError(request, 507); // failed to begin, send an error response Insufficient Storage
+                // a restart replaces a suspended session or our own, never a running download
+                // or another client's upload
+                if (OTAPipeline::isActive())
+                {
+                    if (!OTAPipeline::isSuspended() && OTAPipeline::owner() != owner)
+                    {
+                        return handleConflict(request);
+                    }
+                    OTAPipeline::abort();
+                }
+                if (!OTAPipeline::validHeader(data, len))
+                {
+                    return handleError(request, 503); // service unavailable
+                }
+                // it's firmware - start the OTA pipeline, the form overhead was the old size estimate
+                if (!OTAPipeline::begin(exactSize ? fsize : fsize - sizeof(esp_image_header_t), owner, md5, sha256))
+                {
+                    // lost the race against a download starting
+                    if (OTAPipeline::isActive())
+                    {
+                        return handleConflict(request);
+                    }
+                    return handleError(request, 507); // failed to begin, send an error response Insufficient Storage
+                }
+                md5[0] = '\0';
             }
+            _uploadSocket = request->client()->socket();
         }
     }
 
@@ -132,15 +163,17 @@ esp_err_t UploadFirmwareService::handleUpload(PsychicRequest *request,
     {
         uploadState = 1;
         //ESP_LOGI("UL: ","%d", uploadState);
-        if (Update.write(data, len) != len)
+        if (!OTAPipeline::push(data, len))
         {
-            handleError(request, 500);
+            OTAPipeline::abort();
+            return handleError(request, 500);
         }
         if (final)
         {
             uploadState = 2;
             ESP_LOGI("UL: ","%d", uploadState);
-            if (!Update.end(true))
+            // fails on a SHA-256 mismatch, the running firmware stays
+            if (!OTAPipeline::finish())
             {
                 handleError(request, 500);
             }
@@ -179,13 +212,28 @@ esp_err_t UploadFirmwareService::uploadComplete(PsychicRequest *request)
     if (Update.hasError())
     {
         Update.printError(Serial);
-        Update.abort();
+        OTAPipeline::abort();
         handleError(request, 500);
     }
 
     return ESP_OK;
 }
 
+esp_err_t UploadFirmwareService::uploadStatus(PsychicRequest *request)
+{
+    PsychicJsonResponse response = PsychicJsonResponse(request, false);
+    JsonObject root = response.getRoot();
+    root["active"] = OTAPipeline::isActive();
+    root["suspended"] = OTAPipeline::isSuspended();
+    root["offset"] = OTAPipeline::received();
+    root["size"] = OTAPipeline::total();
+    root["progress"] = OTAPipeline::progress();
+    root["sha256"] = OTAPipeline::sha256();
+    root["expected_sha256"] = OTAPipeline::expectedSha256();
+    root["error"] = OTAPipeline::lastError();
+    return response.send();
+}
+
 esp_err_t UploadFirmwareService::handleError(PsychicRequest *request, int code)
 {
     // if we have had an error already, do nothing
@@ -201,14 +249,25 @@ esp_err_t UploadFirmwareService::handleError(PsychicRequest *request, int code)
     return request->reply(code);
 }
 
-esp_err_t UploadFirmwareService::handleEarlyDisconnect()
+// 409 without touching uploadState, it still describes the running session
+esp_err_t UploadFirmwareService::handleConflict(PsychicRequest *request)
 {
-    // if updated has not ended on connection close, abort it
-    if (!Update.end(true))
+    if (request->_tempObject)
     {
-        Update.printError(Serial);
-        Update.abort();
         return ESP_OK;
     }
+    request->_tempObject = new int(409);
+    return request->reply(409); // Conflict
+}
+
+esp_err_t UploadFirmwareService::handleEarlyDisconnect(PsychicClient *client)
+{
+    // keep an interrupted image for a resume, it expires in loop() if the client does not come back.
+    // Only the connection feeding the session suspends it, not a rejected one
+    if (OTAPipeline::isActive() && uploadState == 1 && client->socket() == _uploadSocket)
+    {
+        _uploadSocket = -1;
+        OTAPipeline::suspend();
+    }
     return ESP_OK;
 }
@@ -23,6 +23,7 @@
 #include <PsychicHttp.h>
 #include <SecurityManager.h>
 #include <RestartService.h>
+#include <OTAPipeline.h>
 
 #define UPLOAD_FIRMWARE_PATH "/rest/uploadFirmware"
 
@@ -38,12 +39,15 @@ class UploadFirmwareService
 public:
     UploadFirmwareService(PsychicHttpServer *server, SecurityManager *securityManager);
     uint8_t getUploadState() const { return uploadState; }
+    uint8_t getUploadProgress() const { return OTAPipeline::progress(); }
     void begin();
+    void loop();
 
 private:
     PsychicHttpServer *_server;
     SecurityManager *_securityManager;
     uint8_t uploadState;
+    int _uploadSocket = -1; // connection pushing into the session
 
     esp_err_t handleUpload(PsychicRequest *request,
                            const String &filename,
@@ -52,8 +56,10 @@ private:
                            size_t len,
                            bool final);
     esp_err_t uploadComplete(PsychicRequest *request);
+    esp_err_t uploadStatus(PsychicRequest *request);
     esp_err_t handleError(PsychicRequest *request, int code);
-    esp_err_t handleEarlyDisconnect();
+    esp_err_t handleConflict(PsychicRequest *request);
+    esp_err_t handleEarlyDisconnect(PsychicClient *client);
 };
 
 #endif // end UploadFirmwareService_h
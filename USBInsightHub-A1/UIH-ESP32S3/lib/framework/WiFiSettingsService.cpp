@@ -21,8 +21,13 @@ WiFiSettingsService::WiFiSettingsService(PsychicHttpServer *server,
                                                                 _securityManager(securityManager),
                                                                 _httpEndpoint(WiFiSettings::read, WiFiSettings::update, this, server, WIFI_SETTINGS_SERVICE_PATH, securityManager,
                                                                               AuthenticationPredicates::IS_ADMIN),
-                                                                _fsPersistence(WiFiSettings::read, WiFiSettings::update, this, fs, WIFI_SETTINGS_FILE), _lastConnectionAttempt(0),
-                                                                _socket(socket)
+                                                                _fsPersistence(WiFiSettings::read, WiFiSettings::update, this, fs, WIFI_SETTINGS_FILE), _nextConnectionAttempt(0),
+                                                                _socket(socket),
+                                                                _fs(fs),
+                                                                _connectFailures(0),
+                                                                _connectPending(false),
+                                                                _staConnected(false),
+                                                                _cacheDirty(false)
 {
     addUpdateHandler([&](const String &originId)
                      { reconfigureWiFiConnection(); },
@@ -42,7 +47,10 @@ void WiFiSettingsService::initWiFi()
         WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
     WiFi.onEvent(std::bind(&WiFiSettingsService::onStationModeStop, this, std::placeholders::_1, std::placeholders::_2),
                  WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_STOP);
+    WiFi.onEvent(std::bind(&WiFiSettingsService::onStationModeGotIP, this, std::placeholders::_1, std::placeholders::_2),
+                 WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_GOT_IP);
 
+    readCache();
     _fsPersistence.readFromFS();
     reconfigureWiFiConnection();
 }
@@ -56,8 +64,10 @@ void WiFiSettingsService::begin()
 
 void WiFiSettingsService::reconfigureWiFiConnection()
 {
-    // reset last connection attempt to force loop to reconnect immediately
-    _lastConnectionAttempt = 0;
+    // reset next connection attempt and backoff to force loop to reconnect immediately
+    _nextConnectionAttempt = millis();
+    _connectFailures = 0;
+    _connectPending = false;
 
     String connectionMode;
 
@@ -89,12 +99,25 @@ void WiFiSettingsService::reconfigureWiFiConnection()
 void WiFiSettingsService::loop()
 {
     unsigned long currentMillis = millis();
-    if (!_lastConnectionAttempt || (unsigned long)(currentMillis - _lastConnectionAttempt) >= WIFI_RECONNECTION_DELAY)
+    if (_connectPending && (unsigned long)(currentMillis - _connectionStarted) >= WIFI_CONNECT_TIMEOUT)
     {
-        _lastConnectionAttempt = currentMillis;
+        ESP_LOGW("WiFiSettingsService", "Connection attempt timed out.");
+        connectionFailed();
+        WiFi.disconnect(true);
+    }
+
+    if (!_connectPending && (long)(currentMillis - _nextConnectionAttempt) >= 0)
+    {
+        _nextConnectionAttempt = currentMillis + WIFI_RECONNECTION_DELAY;
         manageSTA();
     }
 
+    if (_cacheDirty)
+    {
+        _cacheDirty = false;
+        writeCache();
+    }
+
     if (!_lastRssiUpdate || (unsigned long)(currentMillis - _lastRssiUpdate) >= RSSI_EVENT_DELAY)
     {
         _lastRssiUpdate = currentMillis;
@@ -121,11 +144,24 @@ void WiFiSettingsService::manageSTA()
 #ifdef SERIAL_INFO
         Serial.println("Connecting to WiFi...");
 #endif
-        connectToWiFi();
+        startConnection();
     }
 }
 
+// External requests follow the same schedule and backoff as the loop
 void WiFiSettingsService::connectToWiFi()
+{
+    unsigned long currentMillis = millis();
+    if (WiFi.isConnected() || _state.wifiSettings.empty() || _state.staConnectionMode == (u_int8_t)STAConnectionMode::OFFLINE ||
+        _connectPending || (long)(currentMillis - _nextConnectionAttempt) < 0)
+    {
+        return;
+    }
+    _nextConnectionAttempt = currentMillis + WIFI_RECONNECTION_DELAY;
+    startConnection();
+}
+
+void WiFiSettingsService::startConnection()
 {
     // reset availability flag for all stored networks
     for (auto &network : _state.wifiSettings)
@@ -133,15 +169,38 @@ void WiFiSettingsService::connectToWiFi()
         network.available = false;
     }
 
-    // scanning for available networks
-    int scanResult = WiFi.scanNetworks();
+    // first attempt goes straight to the last good access point, no scan
+    wifi_settings_t *cached = cachedNetwork();
+    if (cached && _connectFailures == 0)
+    {
+        ESP_LOGI("WiFiSettingsService", "Connecting to cached network: %s, BSSID: " MACSTR ", Channel: %d", cached->ssid.c_str(), MAC2STR(_cache.bssid), _cache.channel);
+        cached->channel = _cache.channel;
+        memcpy(cached->bssid, _cache.bssid, 6);
+        configureNetwork(*cached);
+        return;
+    }
+
+    // then only its channel, then every channel
+    int scanResult;
+    if (cached && _connectFailures == 1)
+    {
+        ESP_LOGI("WiFiSettingsService", "Scanning channel %d", _cache.channel);
+        scanResult = WiFi.scanNetworks(false, false, false, WIFI_SCAN_MS_PER_CHANNEL, _cache.channel);
+    }
+    else
+    {
+        scanResult = WiFi.scanNetworks(false, false, false, WIFI_SCAN_MS_PER_CHANNEL);
+    }
+
     if (scanResult == WIFI_SCAN_FAILED)
     {
         ESP_LOGE("WiFiSettingsService", "WiFi scan failed.");
+        connectionFailed();
     }
     else if (scanResult == 0)
     {
         ESP_LOGW("WiFiSettingsService", "No networks found.");
+        connectionFailed();
     }
     else
     {
@@ -210,6 +269,11 @@ void WiFiSettingsService::connectToWiFi()
             ESP_LOGI("WiFiSettingsService", "No known networks found.");
         }
 
+        if (!_connectPending)
+        {
+            connectionFailed();
+        }
+
         // delete scan results
         WiFi.scanDelete();
     }
@@ -230,6 +294,8 @@ void WiFiSettingsService::configureNetwork(wifi_settings_t &network)
     WiFi.setHostname(_state.hostname.c_str());
 
     // attempt to connect to the network
+    _connectPending = true;
+    _connectionStarted = millis();
     WiFi.begin(network.ssid.c_str(), network.password.c_str(), network.channel, network.bssid);
     // WiFi.begin(network.ssid.c_str(), network.password.c_str());
 
@@ -247,16 +313,140 @@ void WiFiSettingsService::updateRSSI()
     _socket->emitEvent(EVENT_RSSI, jsonObject);
 }
 
+void WiFiSettingsService::connectionFailed()
+{
+    _connectPending = false;
+    if (_connectFailures < 255)
+    {
+        _connectFailures++;
+    }
+
+    unsigned long backoff = WIFI_BACKOFF_MIN;
+    for (uint8_t i = 1; i < _connectFailures && backoff < WIFI_BACKOFF_MAX; i++)
+    {
+        backoff *= 2;
+    }
+    if (backoff > WIFI_BACKOFF_MAX)
+    {
+        backoff = WIFI_BACKOFF_MAX;
+    }
+    _nextConnectionAttempt = millis() + backoff;
+
+    ESP_LOGI("WiFiSettingsService", "Connection attempt %u failed, next in %lu ms", _connectFailures, backoff);
+}
+
+// Configured network matching the cached one, NULL if there is none
+wifi_settings_t *WiFiSettingsService::cachedNetwork()
+{
+    if (!_cache.valid)
+    {
+        return NULL;
+    }
+    for (auto &network : _state.wifiSettings)
+    {
+        if (network.ssid.equals(_cache.ssid))
+        {
+            return &network;
+        }
+    }
+    return NULL;
+}
+
+void WiFiSettingsService::readCache()
+{
+    _cache.valid = false;
+
+    File cacheFile = _fs->open(WIFI_CACHE_FILE, "r");
+    if (!cacheFile)
+    {
+        return;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, cacheFile);
+    cacheFile.close();
+    if (error != DeserializationError::Ok || !doc["bssid"].is<JsonArray>())
+    {
+        return;
+    }
+
+    JsonArray bssid = doc["bssid"];
+    if (bssid.size() != 6)
+    {
+        return;
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        _cache.bssid[i] = bssid[i];
+    }
+    _cache.ssid = doc["ssid"] | "";
+    _cache.channel = doc["channel"] | 0;
+    _cache.valid = _cache.ssid.length() > 0 && _cache.channel > 0;
+
+    ESP_LOGV("WiFiSettingsService", "Cached network: %s, BSSID: " MACSTR ", Channel: %d", _cache.ssid.c_str(), MAC2STR(_cache.bssid), _cache.channel);
+}
+
+void WiFiSettingsService::writeCache()
+{
+    JsonDocument doc;
+    doc["ssid"] = _cache.ssid;
+    doc["channel"] = _cache.channel;
+    JsonArray bssid = doc["bssid"].to<JsonArray>();
+    for (int i = 0; i < 6; i++)
+    {
+        bssid.add(_cache.bssid[i]);
+    }
+
+    File cacheFile = _fs->open(WIFI_CACHE_FILE, "w", true);
+    if (!cacheFile)
+    {
+        ESP_LOGE("WiFiSettingsService", "Failed to write %s", WIFI_CACHE_FILE);
+        return;
+    }
+    serializeJson(doc, cacheFile);
+    cacheFile.close();
+}
+
 void WiFiSettingsService::onStationModeDisconnected(WiFiEvent_t event, WiFiEventInfo_t info)
 {
+    if (_connectPending)
+    {
+        connectionFailed();
+    }
+    else if (_staConnected)
+    {
+        // link lost, retry the same access point right away
+        _nextConnectionAttempt = millis();
+    }
+    _staConnected = false;
     WiFi.disconnect(true);
 }
 
+void WiFiSettingsService::onStationModeGotIP(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    _connectPending = false;
+    _staConnected = true;
+    _connectFailures = 0;
+
+    // only touch the flash when the access point changed
+    uint8_t *bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    String ssid = WiFi.SSID();
+    if (bssid && (!_cache.valid || _cache.channel != channel || memcmp(_cache.bssid, bssid, 6) != 0 || !_cache.ssid.equals(ssid)))
+    {
+        _cache.ssid = ssid;
+        _cache.channel = channel;
+        memcpy(_cache.bssid, bssid, 6);
+        _cache.valid = true;
+        _cacheDirty = true;
+    }
+}
+
 void WiFiSettingsService::onStationModeStop(WiFiEvent_t event, WiFiEventInfo_t info)
 {
     if (_stopping)
     {
-        _lastConnectionAttempt = 0;
+        _nextConnectionAttempt = millis();
         _stopping = false;
     }
 }
@@ -44,9 +44,14 @@
 #endif
 
 #define WIFI_SETTINGS_FILE "/config/wifiSettings.json"
+#define WIFI_CACHE_FILE "/config/wifiCache.json"
 #define WIFI_SETTINGS_SERVICE_PATH "/rest/wifiSettings"
 
 #define WIFI_RECONNECTION_DELAY 1000 * 30
+#define WIFI_CONNECT_TIMEOUT 1000 * 10
+#define WIFI_BACKOFF_MIN 2000
+#define WIFI_BACKOFF_MAX 1000 * 120
+#define WIFI_SCAN_MS_PER_CHANNEL 120
 #define RSSI_EVENT_DELAY 500
 
 #define EVENT_RSSI "rssi"
@@ -67,6 +72,16 @@ typedef struct
     bool available;
 } wifi_settings_t;
 
+// Last network the station got an IP from, kept apart from the settings so that
+// saving it does not trigger a reconfiguration
+typedef struct
+{
+    String ssid;
+    uint8_t bssid[6];
+    int32_t channel;
+    bool valid;
+} wifi_cache_t;
+
 enum class STAConnectionMode
 {
     OFFLINE = 0,
@@ -223,15 +238,30 @@ private:
     HttpEndpoint<WiFiSettings> _httpEndpoint;
     FSPersistence<WiFiSettings> _fsPersistence;
     EventSocket *_socket;
-    unsigned long _lastConnectionAttempt;
+    FS *_fs;
+    unsigned long _nextConnectionAttempt;
+    unsigned long _connectionStarted;
     unsigned long _lastRssiUpdate;
 
+    // connection attempts: direct to the cached BSSID, cached channel scan, full scan
+    wifi_cache_t _cache;
+    uint8_t _connectFailures;
+    volatile bool _connectPending;
+    volatile bool _staConnected;
+    volatile bool _cacheDirty;
+
     bool _stopping;
     void onStationModeDisconnected(WiFiEvent_t event, WiFiEventInfo_t info);
     void onStationModeStop(WiFiEvent_t event, WiFiEventInfo_t info);
+    void onStationModeGotIP(WiFiEvent_t event, WiFiEventInfo_t info);
 
     void reconfigureWiFiConnection();
     void manageSTA();
+    void startConnection();
+    void connectionFailed();
+    wifi_settings_t *cachedNetwork();
+    void readCache();
+    void writeCache();
 
     void configureNetwork(wifi_settings_t &network);
     void updateRSSI();
@@ -17,6 +17,7 @@ from shutil import copytree, rmtree, copyfileobj
 from os.path import exists, getmtime
 import os
 import gzip
+import hashlib
 import mimetypes
 import glob
 from datetime import datetime
@@ -28,6 +29,7 @@ buildFlags = env.ParseFlags(env["BUILD_FLAGS"])
 
 interface_dir = project_dir + "/interface"
 output_file = project_dir + "/lib/framework/WWWData.h"
+script_file = project_dir + "/scripts/build_interface.py"
 source_www_dir = interface_dir + "/src"
 build_dir = interface_dir + "/build"
 filesystem_dir = project_dir + "/data/www"
@@ -42,7 +44,8 @@ def find_latest_timestamp_for_app():
 def should_regenerate_output_file():
     if not flag_exists("EMBED_WWW") or not exists(output_file):
         return True
-    last_source_change = find_latest_timestamp_for_app()
+    # the generated header layout also depends on this script
+    last_source_change = max(find_latest_timestamp_for_app(), getmtime(script_file))
     last_build = getmtime(output_file)
 
     print(
@@ -114,7 +117,8 @@ def build_progmem():
             asset_var = f"ESP_SVELTEKIT_DATA_{idx}"
             progmem.write(f"// {asset_path}\n")
             progmem.write(f"const uint8_t {asset_var}[] = {{\n\t")
-            file_data = gzip.compress(path.read_bytes())
+            # fixed gzip header time so an unchanged asset keeps its bytes and its ETag
+            file_data = gzip.compress(path.read_bytes(), mtime=0)
 
             for i, byte in enumerate(file_data):
                 if i and not (i % 16):
@@ -126,10 +130,11 @@ def build_progmem():
                 "name": asset_var,
                 "mime": asset_mime,
                 "size": len(file_data),
+                "etag": hashlib.sha256(file_data).hexdigest()[:16],
             }
 
         progmem.write(
-            "typedef std::function<void(const String& uri, const String& contentType, const uint8_t * content, size_t len)> RouteRegistrationHandler;\n\n"
+            "typedef std::function<void(const String& uri, const String& contentType, const uint8_t * content, size_t len, const String& etag)> RouteRegistrationHandler;\n\n"
         )
         progmem.write("class WWWData {\n")
         progmem.write("\tpublic:\n")
@@ -139,7 +144,7 @@ def build_progmem():
 
         for asset_path, asset in assetMap.items():
             progmem.write(
-                f'\t\t\thandler("/{asset_path}", "{asset["mime"]}", {asset["name"]}, {asset["size"]});\n'
+                f'\t\t\thandler("/{asset_path}", "{asset["mime"]}", {asset["name"]}, {asset["size"]}, "\\"{asset["etag"]}\\"");\n'
             )
 
         progmem.write("\t\t}\n")
@@ -0,0 +1,174 @@
+#!/usr/bin/env python
+#
+# Icon atlas generator
+#
+# Converts the RGB565 icon arrays in icons/icons_rgb565.h into src/iconAtlas.h: every icon
+# is stored in the RGB332 format of the 8 bit frame sprite and run length encoded with
+# transparent (skip) runs, so Screen::iconDraw() can decode it straight into the sprite.
+#
+# Stream opcodes (one byte, followed by its data):
+#   00nnnnnn            skip n+1 transparent pixels
+#   01nnnnnn c          repeat color c n+1 times
+#   1nnnnnnn c0..cn     n+1 literal colors
+# Runs continue on the next row when they reach the icon width.
+#
+# Can be run standalone: python scripts/generate_icon_atlas.py
+
+import os
+import re
+import sys
+
+source_file = os.path.join("icons", "icons_rgb565.h")
+output_file = os.path.join("src", "iconAtlas.h")
+
+# name in source, width, height, transparent RGB565 color (same keys used by the old pushToSprite calls)
+ICONS = [
+    ("PC",            33, 29, 0xFFFF),
+    ("NOPC",          33, 29, 0xFFFF),
+    ("WIFI0_",        33, 30, 0x0000),
+    ("WIFIE",         33, 30, 0x0000),
+    ("WIFI1_",        33, 30, 0x0000),
+    ("WIFI2_",        33, 30, 0x0000),
+    ("WIFI3_",        33, 30, 0x0000),
+    ("AP0",           33, 30, 0x0000),
+    ("AP1",           33, 30, 0x0000),
+    ("AP2",           33, 30, 0x0000),
+    ("AP3",           33, 30, 0x0000),
+    ("NOWIFI",        33, 30, 0x0000),
+    ("NARROW2",       12, 19, 0x0000),
+    ("NARROW3",       12, 19, 0x0000),
+    ("COMARROW",      19, 21, 0x0000),
+    ("NOSWITCH",      11, 26, 0x0000),
+    ("CSWITCH",       11, 26, 0x0000),
+    ("ONSTART_OFF",   33, 30, 0x0000),
+    ("ONSTART_ON",    33, 30, 0x0000),
+    ("ONSTART_TIMER", 33, 30, 0x0000),
+    ("AUXPWR",        33, 30, 0x0000),
+]
+
+TRANSPARENT = -1
+
+
+def color16to8(c):
+    # same conversion as TFT_eSPI::color16to8
+    return ((c & 0xE000) >> 8) | ((c & 0x0700) >> 6) | ((c & 0x0018) >> 3)
+
+
+def parse_arrays(text):
+    arrays = {}
+    for m in re.finditer(r"const\s+unsigned\s+short\s+(\w+)\s*\[\s*(\d+)\s*\]\s*PROGMEM\s*=\s*\{(.*?)\};", text, re.S):
+        body = re.sub(r"//[^\n]*", "", m.group(3))
+        values = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]+", body)]
+        if len(values) != int(m.group(2)):
+            sys.exit("icon %s: expected %s values, found %d" % (m.group(1), m.group(2), len(values)))
+        arrays[m.group(1)] = values
+    return arrays
+
+
+def encode(pixels):
+    out = []
+    i = 0
+    n = len(pixels)
+    while i < n:
+        p = pixels[i]
+        run = 1
+        while i + run < n and pixels[i + run] == p:
+            run += 1
+        if p == TRANSPARENT:
+            run = min(run, 64)
+            out.append(run - 1)
+            i += run
+        elif run >= 3:
+            run = min(run, 64)
+            out += [0x40 | (run - 1), p]
+            i += run
+        else:
+            # literal block until the next transparent pixel or repeat of 3
+            start = i
+            while i < n and i - start < 128:
+                q = pixels[i]
+                if q == TRANSPARENT:
+                    break
+                if i + 2 < n and pixels[i + 1] == q and pixels[i + 2] == q:
+                    break
+                i += 1
+            out.append(0x80 | (i - start - 1))
+            out += pixels[start:i]
+    return out
+
+
+def icon_id(name):
+    return "ICON_" + name.strip("_").upper()
+
+
+def generate():
+    with open(source_file, "r") as f:
+        arrays = parse_arrays(f.read())
+
+    data = []
+    table = []
+    raw_size = 0
+    for name, w, h, transp in ICONS:
+        if name not in arrays:
+            sys.exit("icon %s not found in %s" % (name, source_file))
+        src = arrays[name]
+        if len(src) != w * h:
+            sys.exit("icon %s: %d pixels do not match %dx%d" % (name, len(src), w, h))
+        pixels = [TRANSPARENT if c == transp else color16to8(c) for c in src]
+        stream = encode(pixels)
+        table.append((icon_id(name), w, h, len(data), len(stream)))
+        data += stream
+        raw_size += len(src) * 2
+
+    lines = []
+    lines.append("//Generated by scripts/generate_icon_atlas.py from %s. Do not edit." % source_file.replace(os.sep, "/"))
+    lines.append("//%d icons, %d bytes (RGB565 source: %d bytes)" % (len(table), len(data), raw_size))
+    lines.append("")
+    lines.append("#ifndef ICONATLAS_H")
+    lines.append("#define ICONATLAS_H")
+    lines.append("")
+    lines.append("#include <Arduino.h>")
+    lines.append("")
+    for i, (ident, w, h, off, size) in enumerate(table):
+        lines.append("#define %-20s %d" % (ident, i))
+    lines.append("#define %-20s %d" % ("ICON_COUNT", len(table)))
+    lines.append("")
+    lines.append("struct IconDesc {")
+    lines.append("  uint8_t w;")
+    lines.append("  uint8_t h;")
+    lines.append("  uint16_t offset;")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const IconDesc iconAtlas[ICON_COUNT] = {")
+    for ident, w, h, off, size in table:
+        lines.append("  {%d, %d, %d}, //%s, %d bytes" % (w, h, off, ident, size))
+    lines.append("};")
+    lines.append("")
+    lines.append("static const uint8_t iconAtlasData[%d] PROGMEM = {" % len(data))
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif //ICONATLAS_H")
+    lines.append("")
+
+    if len(data) > 0xFFFF:
+        sys.exit("icon atlas larger than 64 KB, widen IconDesc.offset")
+
+    content = "\n".join(lines)
+    if os.path.exists(output_file):
+        with open(output_file, "r") as f:
+            if f.read() == content:
+                return
+    with open(output_file, "w") as f:
+        f.write(content)
+    print("Icon atlas: %d icons, %d bytes (was %d)" % (len(table), len(data), raw_size))
+
+
+try:
+    Import("env")
+    os.chdir(env.subst("$PROJECT_DIR"))
+except NameError:
+    os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+generate()
@@ -54,16 +54,13 @@ bool BaseMCU::readStart(int address, int start, int numBytes){
     i2cwd_timer = millis();  //*probably this protection is not longer necessary
     err = I2C->requestFrom(address,numBytes); //*
     i2cwd_timer = millis()-i2cwd_timer;
-    if(i2cwd_timer > SLOWDOWN_TIMEOUT_MCU){ //*workaround for sudden drop in I2C speed, reported here https://github.com/espressif/arduino-esp32/issues/8480
-      //Serial.println("I2C Slow down on bMCU detected!!");//*
+    uint8_t res = i2cHealthRead(I2C_DEV_BMCU, err, numBytes, i2cwd_timer, SLOWDOWN_TIMEOUT_MCU);
+    if(res == I2C_RES_SLOW){ //*workaround for sudden drop in I2C speed, reported here https://github.com/espressif/arduino-esp32/issues/8480
       ESP_LOGV(TAG,"I2C Slow on bMCU: %u!!",i2cwd_timer);
-      I2C->flush(); //*
-      I2C->setClock(100000); //*
-      I2C->setClock(400000); //*
       return false; //*
     } 
 
-    if(err==0) {
+    if(res == I2C_RES_FAIL) {
       //Serial.println("BaseMCU Fail to read bytes");
       ESP_LOGW(TAG,"BaseMCU Fail to read bytes");
       return false;
@@ -82,7 +79,7 @@ void BaseMCU::readAll(){
   int err=0;
   unsigned long i2cwd_timer = 0;
 
-  if(readStart(BASEMCU_ADDR,CH1REG,5)){  
+  if(readStart(BASEMCU_ADDR,CH1REG,6)){  
 
     while(I2C->available()){
       data=I2C->read();
@@ -107,6 +104,12 @@ void BaseMCU::readAll(){
         firstboot = (data & 0x10) == 0 ? false : true;
         //ESP_LOGI(TAG, "PS: %u, MOE: %u, MSEL: %u, FB: %u",pwrsource,muxoe,muxsel,firstboot);        
       }
+
+      if(byteCnt==5){
+        evtPending  = data & ~EVT_FIFO_OVF;
+        evtOverflow = (data & EVT_FIFO_OVF) == 0 ? false : true;
+        if(evtPending > EVT_FIFO_SIZE) evtPending = EVT_FIFO_SIZE;
+      }
       byteCnt++;
      }
   }
@@ -139,6 +142,7 @@ void BaseMCU::writeAll(){
     }
 
     err = I2C->endTransmission();
+    i2cHealthWrite(I2C_DEV_BMCU, err);
   } 
   else {
     //if not initiated, all output values must be reset to defaults
@@ -179,6 +183,39 @@ void BaseMCU::setUSB3Enable(bool set){
     set ? data = 0x01 : data = 0x00;  
     I2C->write(data);  
     err = I2C->endTransmission();
+    i2cHealthWrite(I2C_DEV_BMCU, err);
   }
     
 }
+
+//Burst read of the pending events (evtPending from the last readAll) and the
+//current BaseMCU tick, then acknowledge them so the FIFO drops them.
+//Returns the number of events copied to evt (EVT_FIFO_SIZE max)
+uint8_t BaseMCU::readEvents(BaseMCUEvent *evt, uint16_t *now){
+  uint8_t raw[2 + 4*EVT_FIFO_SIZE];
+  uint8_t n = evtPending;
+  int cnt = 0;
+
+  if(!initiated || n == 0) return 0;
+
+  if(!readStart(BASEMCU_ADDR,EVTFIFO,2 + 4*n)) return 0;
+  while(I2C->available() && cnt < (int)sizeof(raw)) raw[cnt++] = I2C->read();
+  if(cnt < 2 + 4*n) return 0;
+
+  *now = raw[0] | (raw[1] << 8);
+  for(int i=0; i<n; i++){
+    uint8_t *r = &raw[2 + 4*i];
+    evt[i].type = r[0] >> 4;
+    evt[i].ch   = r[0] & 0x0F;
+    evt[i].data = r[1];
+    evt[i].tick = r[2] | (r[3] << 8);
+  }
+
+  I2C->beginTransmission(BASEMCU_ADDR);
+  I2C->write(EVTCNT);
+  I2C->write(n);
+  i2cHealthWrite(I2C_DEV_BMCU, I2C->endTransmission());
+
+  evtPending = 0;
+  return n;
+}
@@ -18,6 +18,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "I2CHealth.h"
 
 #define BASEMCU_ADDR 0x51
 #define WHOAMI_ID    0x35
@@ -32,11 +33,16 @@
 #define CH3REG   0x22  //CH3 Fault, Power enable and current settings
 #define CCSUM    0x23  //VEXT and VOST CC lines summary
 #define AUXREG   0x24  //USB3 and Power Muxer values
+#define EVTCNT   0x25  //Pending events in the FIFO, bit 7 overflow. Write n to drop n events
 #define MUXOECTR 0x26  //Control muxer signal enable to work as USB 2.0 or USB 3.0 Hub
 #define VEXTCC1  0x30  //VEXT CC1 voltage reading: 30-L byte 31-H byte
 #define VEXTCC2  0x32  //VEXT CC2 voltage reading: 32-L byte 33-H byte
 #define VHOSTCC1 0x34  //VHOST CC1 voltage reading: 34-L byte 35-H byte
 #define VHOSTCC2 0x36  //VHOST CC2 voltage reading: 36-L byte 37-H byte
+#define EVTFIFO  0x40  //Event FIFO: 2 bytes current tick, then 4 bytes per event
+
+#define EVT_FIFO_SIZE 8
+#define EVT_FIFO_OVF  0x80
 
 //Current limit definition on CHREG
 #define ILIM_0_5 0
@@ -63,6 +69,14 @@ struct Channel {
   uint8_t ilim;
 };
 
+//Change detected by the BaseMCU, tick is its millis() lower 16 bits
+struct BaseMCUEvent {
+  uint8_t type;
+  uint8_t ch;
+  uint8_t data;
+  uint16_t tick;
+};
+
 class BaseMCU {
   public:
     bool begin(TwoWire *theWire);
@@ -70,6 +84,7 @@ class BaseMCU {
     void writeAll();
     void readVersion();
     void setUSB3Enable(bool set);
+    uint8_t readEvents(BaseMCUEvent *evt, uint16_t *now);
     bool initiated = false;
 
     Channel chArr[3]={{false, false,false,ILIM_0_5},{false, false,false,ILIM_0_5},{false, false,false,ILIM_0_5}};
@@ -83,6 +98,8 @@ class BaseMCU {
     bool muxoe     = false; //false disabled, true enabled
     bool muxsel    = false; //false pos 1, true pos 2  
     bool firstboot = false; //first boot
+    uint8_t evtPending = 0;  //events waiting in the BaseMCU FIFO
+    bool evtOverflow = false; //BaseMCU discarded events
   
   private: 
     TwoWire *I2C;
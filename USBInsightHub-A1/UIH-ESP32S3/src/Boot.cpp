@@ -0,0 +1,117 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+#include "Boot.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+
+static const char* TAG = "Boot";
+
+struct bootTiming {
+  int64_t startUs;
+  int64_t endUs;
+};
+
+static const BootStage* bStages = NULL;
+static uint8_t bCount = 0;
+static EventGroupHandle_t bootEvents = NULL;
+static bootTiming bTiming[BOOT_MAX_STAGES];
+static volatile int64_t markUs[BOOT_MARK_COUNT];
+static int64_t totalUs = 0;
+
+static const char* t_bootMark[BOOT_MARK_COUNT] = {"firstFrame","firstCdc"};
+
+static void bootStageTask(void *pvParameters){
+  uint8_t i = (uint8_t)(uintptr_t)pvParameters;
+  const BootStage &s = bStages[i];
+
+  if(s.deps)
+    xEventGroupWaitBits(bootEvents, s.deps, pdFALSE, pdTRUE, portMAX_DELAY);
+
+  bTiming[i].startUs = esp_timer_get_time();
+  s.fn();
+  bTiming[i].endUs = esp_timer_get_time();
+
+  xEventGroupSetBits(bootEvents, BOOT_DEP(i));
+  vTaskDelete(NULL);
+}
+
+void bootRun(const BootStage* stages, uint8_t count){
+  if(count > BOOT_MAX_STAGES) count = BOOT_MAX_STAGES;
+  bStages = stages;
+  bCount = count;
+  memset(bTiming, 0, sizeof(bTiming));
+
+  bootEvents = xEventGroupCreate();
+  if(bootEvents == NULL){
+    //no way to order them, run in table order
+    ESP_LOGE(TAG, "Event group creation failed, serial boot");
+    for(int i=0; i<count; i++){
+      bTiming[i].startUs = esp_timer_get_time();
+      stages[i].fn();
+      bTiming[i].endUs = esp_timer_get_time();
+    }
+    totalUs = esp_timer_get_time();
+    return;
+  }
+
+  for(int i=0; i<count; i++){
+    BaseType_t core = stages[i].core < 0 ? tskNO_AFFINITY : stages[i].core;
+    if(xTaskCreatePinnedToCore(bootStageTask, stages[i].name, stages[i].stack, (void*)(uintptr_t)i,
+                               BOOT_STAGE_PRIORITY, NULL, core) != pdPASS){
+      //run it here once its dependencies are done
+      ESP_LOGE(TAG, "Couldn't create stage %s task", stages[i].name);
+      if(stages[i].deps)
+        xEventGroupWaitBits(bootEvents, stages[i].deps, pdFALSE, pdTRUE, pdMS_TO_TICKS(BOOT_TIMEOUT_MS));
+      bTiming[i].startUs = esp_timer_get_time();
+      stages[i].fn();
+      bTiming[i].endUs = esp_timer_get_time();
+      xEventGroupSetBits(bootEvents, BOOT_DEP(i));
+    }
+  }
+
+  EventBits_t all = BOOT_DEP(count) - 1;
+  EventBits_t done = xEventGroupWaitBits(bootEvents, all, pdFALSE, pdTRUE, pdMS_TO_TICKS(BOOT_TIMEOUT_MS));
+  totalUs = esp_timer_get_time();
+
+  for(int i=0; i<count; i++){
+    if(done & BOOT_DEP(i))
+      ESP_LOGI(TAG, "%-12s %6.1f -> %6.1f ms", stages[i].name, bTiming[i].startUs / 1000.0, bTiming[i].endUs / 1000.0);
+    else
+      ESP_LOGE(TAG, "%-12s not finished", stages[i].name);
+  }
+  ESP_LOGI(TAG, "Boot done in %.1f ms", totalUs / 1000.0);
+}
+
+void bootMark(uint8_t mark){
+  if(mark < BOOT_MARK_COUNT && markUs[mark] == 0)
+    markUs[mark] = esp_timer_get_time();
+}
+
+void bootDelayUntil(uint32_t ms){
+  int32_t rest = (int32_t)(ms - millis());
+  if(rest > 0) delay(rest);
+}
+
+void bootToJson(JsonObject obj){
+  JsonArray arr = obj["stages"].to<JsonArray>();
+  for(int i=0; i<bCount; i++){
+    JsonObject s = arr.add<JsonObject>();
+    s["name"]  = bStages[i].name;
+    s["start"] = serialized(String(bTiming[i].startUs / 1000.0, 1));
+    s["end"]   = serialized(String(bTiming[i].endUs / 1000.0, 1));
+  }
+  for(int m=0; m<BOOT_MARK_COUNT; m++)
+    obj[t_bootMark[m]] = serialized(String(markUs[m] / 1000.0, 1));
+  obj["total"] = serialized(String(totalUs / 1000.0, 1));
+}
@@ -0,0 +1,54 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Boot orchestrator: every stage runs in its own task as soon as the stages it
+//depends on are done, so display, I2C peripherals, USB CDC and Wi-Fi come up
+//concurrently. The first frame waits for both the panels and the I2C peripherals. Start/end of every stage and the first frame / first CDC answer
+//are kept for {"action":"get","params":["boot"]}.
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define BOOT_MAX_STAGES     16
+#define BOOT_STAGE_PRIORITY 2
+#define BOOT_TIMEOUT_MS     10000
+
+#define BOOT_DEP(stage) (1UL << (stage))
+
+//milestones
+#define BOOT_MARK_FIRST_FRAME 0
+#define BOOT_MARK_FIRST_CDC   1
+#define BOOT_MARK_COUNT       2
+
+typedef void (*bootStageFn)(void);
+
+struct BootStage {
+  const char* name;
+  bootStageFn fn;
+  uint32_t deps;  //BOOT_DEP() of the stages that must finish first
+  uint32_t stack;
+  int8_t core;    //-1 for any core
+};
+
+//Runs the stages and returns when all of them are done or BOOT_TIMEOUT_MS expires
+void bootRun(const BootStage* stages, uint8_t count);
+//Records the first time a milestone is reached
+void bootMark(uint8_t mark);
+//Waits until the given time since power up, power up delays do not stack on boot work
+void bootDelayUntil(uint32_t ms);
+void bootToJson(JsonObject obj);
+
+#endif
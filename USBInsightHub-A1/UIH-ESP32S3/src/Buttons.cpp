@@ -11,155 +11,187 @@
  * MIT License. Check full description on LICENSE file.
  **/
 
-//Button interrupt handler and resolve functions
+//Button edge capture and gesture recognition
 
 #include "Buttons.h"
-
-//Button variables and Interupt functions
-Button ButtonArray[4] = { {BUTTON_1,false,true,0,0,0,0,false},
-                          {BUTTON_2,false,true,0,0,0,0,false},
-                          {BUTTON_3,false,true,0,0,0,0,false},
-                          {SETUP,false,true,0,0,0,0,false}
-                        };
-
-//Button Setup_Button = {SETUP,false,true,0,0,0,0,false};
-
-ButtonsState buttonsFlags;
+#include "driver/gpio.h"
+#include "esp_timer.h"
+
+struct btnEdge {
+  uint8_t btn;
+  uint8_t down;
+  int64_t us;
+};
+
+struct btnState {
+  bool    down;
+  bool    longFired;
+  bool    inChord;    //part of a chord, no short/long/repeat until released
+  int64_t edgeUs;     //last accepted edge
+  int64_t checkUs;    //pin level check once the bounce window is over, 0 = none
+  int64_t nextUs;     //next long or repeat deadline while held
+  int64_t lastShortUs;
+};
+
+//read from the interrupt, must not live in flash
+static DRAM_ATTR const uint8_t btnPins[BTN_COUNT] = {BUTTON_1, BUTTON_2, BUTTON_3, SETUP};
+
+static QueueHandle_t btnEdgeQueue  = NULL;
+static QueueHandle_t btnEventQueue = NULL;
+static btnState bState[BTN_COUNT];
+static uint8_t chordMask = 0;
 
 static const char* TAG = "Buttons";
 
-void iniButtons(void){
+static void IRAM_ATTR btnIsr(void *arg);
+static void taskButtonRecognizer(void *pvParameters);
 
-  for (int i=0; i<4; i++) {
-    buttonsFlags.shortPress[i]=false;
-    buttonsFlags.longPress[i]=false;
-  } 
+void iniButtons(void){
 
-  pinMode(BUTTON_1,INPUT_PULLUP);
-  pinMode(BUTTON_2,INPUT_PULLUP);
-  pinMode(BUTTON_3,INPUT_PULLUP);
-  pinMode(SETUP,INPUT_PULLUP);    
+  memset(bState, 0, sizeof(bState));
+  btnEdgeQueue  = xQueueCreate(BTN_EDGE_QUEUE_LEN, sizeof(btnEdge));
+  btnEventQueue = xQueueCreate(BTN_EVENT_QUEUE_LEN, sizeof(BtnEvent));
+  if(btnEdgeQueue == NULL || btnEventQueue == NULL){
+    ESP_LOGE(TAG, "Couldn't create button queues");
+    return;
+  }
 
-  attachInterrupt(ButtonArray[0].PIN, ch1_btn_isr, FALLING);
-  attachInterrupt(ButtonArray[1].PIN, ch2_btn_isr, FALLING);
-  attachInterrupt(ButtonArray[2].PIN, ch3_btn_isr, FALLING);
-  attachInterrupt(ButtonArray[3].PIN, setup_btn_isr, FALLING);
+  for (int i=0; i<BTN_COUNT; i++){
+    pinMode(btnPins[i],INPUT_PULLUP);
+    attachInterruptArg(btnPins[i], btnIsr, (void*)(uintptr_t)i, CHANGE);
+  }
 
-  xTaskCreate(taskScanLoop, "Button Scan", 1024, NULL, 3, NULL);   
+  xTaskCreatePinnedToCore(taskButtonRecognizer, "Button Events", 2048, NULL, BTN_TASK_PRIORITY, NULL, APP_CORE);
 }
 
-void taskScanLoop(void *pvParameters)
-{ 
-  TickType_t xLastWakeTime = xTaskGetTickCount();
-  int tot = 0;
-  for(;;){    
-    for (int i=0; i<4; i++){
-      
-      tot=resolveButton(&ButtonArray[i]);
-      if(tot==1){
-        buttonsFlags.shortPress[i] = true;
-      }
-      if(tot==2){
-        buttonsFlags.longPress[i] = true;
-      }
-    }
-    
-    //vTaskDelay(pdMS_TO_TICKS(BUTTON_CHECK_PERIOD));
-    vTaskDelayUntil(&xLastWakeTime,pdMS_TO_TICKS(BUTTON_CHECK_PERIOD));
+bool btnWaitEvent(BtnEvent *evt, TickType_t timeout){
+  if(btnEventQueue == NULL){
+    vTaskDelay(timeout);
+    return false;
   }
+  return xQueueReceive(btnEventQueue, evt, timeout) == pdTRUE;
 }
 
-bool btnShortCheck(int index){
-  if(buttonsFlags.shortPress[index]){
-    buttonsFlags.shortPress[index] = false;
-    return true;
-  }
-  
-  return false;
+void btnClearAll(){
+  if(btnEventQueue != NULL)
+    xQueueReset(btnEventQueue);
 }
 
-bool btnLongCheck(int index){
-  if(buttonsFlags.longPress[index]){
-    buttonsFlags.longPress[index] = false;
-    return true;
-  }
-  
-  return false;
+//Both edges, buttons are active low
+static void IRAM_ATTR btnIsr(void *arg){
+  uint8_t i = (uint8_t)(uintptr_t)arg;
+  btnEdge e = {i, (uint8_t)(gpio_get_level((gpio_num_t)btnPins[i]) == 0), esp_timer_get_time()};
+  BaseType_t woken = pdFALSE;
+  xQueueSendFromISR(btnEdgeQueue, &e, &woken);
+  if(woken) portYIELD_FROM_ISR();
 }
 
-void btnClearAll(){
-  for(int i=0; i<4; i++)
-  {
-    buttonsFlags.shortPress[i] = false;
-    buttonsFlags.longPress[i] = false;
-  }
+static void btnEmit(uint8_t type, uint8_t btn, uint8_t mask, int64_t us){
+  BtnEvent evt = {type, btn, mask, us};
+  if(xQueueSend(btnEventQueue, &evt, 0) != pdTRUE)
+    ESP_LOGW(TAG, "Event queue full, button %u event %u dropped", btn, type);
 }
 
-//Handler for button interruption
-void btnDebounce(Button *button)
-{
-  button->button_time = millis();
-  if ((button->button_time - button->last_button_time > DEBOUNCE_TIME) && button->high_again){          
-        button->pressed = true;
-        button->last_button_time = button->button_time;        
-  }   
+static uint8_t btnDownMask(){
+  uint8_t mask = 0;
+  for(int i=0; i<BTN_COUNT; i++)
+    if(bState[i].down) mask |= 1 << i;
+  return mask;
 }
 
-//check if a button was pressed and the debounce time is finished
-int resolveButton(Button *button)
-{
-  int ret=0;
-  
-  if(button->counter > BACK_TO_HIGH){
-    button->counter      = 0;
-    button->high_again   = true;
-    button->long_pressed = false;
-  }
+static void btnOnEdge(const btnEdge &e){
+  btnState &b = bState[e.btn];
 
-  if(button->pressed && button->high_again)
-  {
-    button->pressed    = false;
-    button->high_again = false;
-  }
+  //bounce: same level again or too close to the last accepted edge, the level
+  //is checked again once the window is over
+  if((bool)e.down == b.down || e.us - b.edgeUs < BTN_DEBOUNCE_US) return;
 
-  if(button->high_again)
-  {
+  b.down    = e.down;
+  b.edgeUs  = e.us;
+  b.checkUs = e.us + BTN_DEBOUNCE_US;
 
-    if(button->low_counter >= BUTTON_SHORT_LOW && button->low_counter < BUTTON_SHORT_HIGH) {   
-      ret=1;
-    }    
-    button->low_counter = 0;
-  }
+  if(b.down){
+    b.longFired = false;
+    b.nextUs    = e.us + BTN_LONG_US;
 
-  if(button->low_counter >= BUTTON_LONG && !button->long_pressed)
-  {
-    button->long_pressed = true;
-    ret = 2;
+    uint8_t held = btnDownMask();
+    if(held & (held - 1)){
+      chordMask |= held;
+      for(int i=0; i<BTN_COUNT; i++)
+        if(held & (1 << i)) bState[i].inChord = true;
+    }
+    return;
   }
 
-  if(!digitalRead(button->PIN) && !button->high_again){
-    button->counter = 0;
-    button->low_counter++;
-  } 
-  if(digitalRead(button->PIN) && !button->high_again){
-    button->counter++;
-  }  
+  if(b.inChord){
+    b.inChord = false;
+    if(chordMask){
+      btnEmit(BTN_CHORD, e.btn, chordMask, e.us);
+      chordMask = 0;
+    }
+    return;
+  }
 
-	return ret;
+  if(!b.longFired){
+    btnEmit(BTN_SHORT, e.btn, 0, e.us);
+    if(b.lastShortUs && e.us - b.lastShortUs <= BTN_DOUBLE_US){
+      btnEmit(BTN_DOUBLE, e.btn, 0, e.us);
+      b.lastShortUs = 0;
+    }
+    else {
+      b.lastShortUs = e.us;
+    }
+  }
 }
 
-void IRAM_ATTR ch1_btn_isr() {
-    btnDebounce(&ButtonArray[0]);
-}
+static void btnOnTime(int64_t now){
+  for(int i=0; i<BTN_COUNT; i++){
+    btnState &b = bState[i];
+
+    //an edge lost in the bounce window leaves the state wrong, resync with the pin
+    if(b.checkUs && now >= b.checkUs){
+      b.checkUs = 0;
+      bool down = digitalRead(btnPins[i]) == LOW;
+      if(down != b.down){
+        btnEdge e = {(uint8_t)i, (uint8_t)down, now};
+        btnOnEdge(e);
+      }
+    }
 
-void IRAM_ATTR ch2_btn_isr() {
-    btnDebounce(&ButtonArray[1]);
+    if(b.down && !b.inChord && now >= b.nextUs){
+      btnEmit(b.longFired ? BTN_REPEAT : BTN_LONG, i, 0, now);
+      b.longFired = true;
+      b.nextUs += BTN_REPEAT_US;
+      if(b.nextUs <= now) b.nextUs = now + BTN_REPEAT_US;
+    }
+  }
 }
 
-void IRAM_ATTR ch3_btn_isr() {
-    btnDebounce(&ButtonArray[2]);
+//Closest pending deadline, -1 when idle
+static int64_t btnNextDeadline(){
+  int64_t next = -1;
+  for(int i=0; i<BTN_COUNT; i++){
+    const btnState &b = bState[i];
+    if(b.checkUs && (next < 0 || b.checkUs < next)) next = b.checkUs;
+    if(b.down && !b.inChord && (next < 0 || b.nextUs < next)) next = b.nextUs;
+  }
+  return next;
 }
 
-void IRAM_ATTR setup_btn_isr() {
-    btnDebounce(&ButtonArray[3]);
-}
\ No newline at end of file
+static void taskButtonRecognizer(void *pvParameters){
+  ESP_LOGI(TAG,"Recognizer on Core %u",xPortGetCoreID());
+  btnEdge e;
+  for(;;){
+    TickType_t wait = portMAX_DELAY;
+    int64_t next = btnNextDeadline();
+    if(next >= 0){
+      int64_t rest = next - esp_timer_get_time();
+      wait = rest > 0 ? pdMS_TO_TICKS((rest + 999) / 1000) : 0;
+      if(rest > 0 && wait == 0) wait = 1;
+    }
+
+    if(xQueueReceive(btnEdgeQueue, &e, wait) == pdTRUE)
+      btnOnEdge(e);
+    btnOnTime(esp_timer_get_time());
+  }
+}
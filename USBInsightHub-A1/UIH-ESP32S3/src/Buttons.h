@@ -11,7 +11,10 @@
  * MIT License. Check full description on LICENSE file.
  **/
 
-//Button interrupt handler and resolve functions
+//Button edge capture and gesture recognition. The interrupts only timestamp the
+//edges into a queue, a recognizer task turns them into typed events that the views
+//block on, so a press is handled as soon as it is released instead of on the next
+//scan period.
 
 #ifndef BUTTONS_H
 #define BUTTONS_H
@@ -21,45 +24,38 @@
 
 //pin definitions in datatypes.h
 
-#define BUTTON_CHECK_PERIOD            40 //in ms
+#define BTN_COUNT            4   //CH1, CH2, CH3 and Setup
 
-//Buttons timing calibration
-#define DEBOUNCE_TIME     250
-#define BACK_TO_HIGH        2 //number of BUTTON_CHECK_PERIODs
-#define BUTTON_SHORT_LOW    1
-#define BUTTON_SHORT_HIGH  10
-#define BUTTON_LONG        20
+//Buttons timing calibration, in us
+#define BTN_DEBOUNCE_US   30000  //edges closer than this to the last accepted one are bounce
+#define BTN_LONG_US      800000  //held this long is a long press
+#define BTN_REPEAT_US    150000  //repeat period while still held after the long press
+#define BTN_DOUBLE_US    350000  //second short press within this of the first one
 
-struct Button {
-  const uint8_t PIN;
-  bool pressed;
-  bool high_again;
-  unsigned long button_time;
-  unsigned long last_button_time; //variables to keep track of the timing of recent interrupts
-  unsigned long counter;
-  unsigned long low_counter;
-  bool long_pressed;
-};
+#define BTN_EDGE_QUEUE_LEN   32
+#define BTN_EVENT_QUEUE_LEN  16
+#define BTN_TASK_PRIORITY     5
 
-struct ButtonsState {
-  bool shortPress[4];
-  bool longPress[4];
+enum btnEventType {
+  BTN_SHORT = 1,  //released before BTN_LONG_US
+  BTN_LONG,       //still held at BTN_LONG_US
+  BTN_DOUBLE,     //second short press, the two BTN_SHORT are sent as well
+  BTN_REPEAT,     //every BTN_REPEAT_US after BTN_LONG while held
+  BTN_CHORD       //two or more buttons held together, sent on the first release
 };
 
-void btnDebounce(Button *button);
-
-void IRAM_ATTR ch1_btn_isr();
-void IRAM_ATTR ch2_btn_isr(); 
-void IRAM_ATTR ch3_btn_isr(); 
-void IRAM_ATTR setup_btn_isr(); 
+struct BtnEvent {
+  uint8_t type;   //btnEventType
+  uint8_t btn;    //0-2 channel buttons, 3 setup
+  uint8_t mask;   //BTN_CHORD: one bit per button held together
+  int64_t us;     //esp_timer time of the edge or deadline that produced it
+};
 
 extern void iniButtons();
-void taskScanLoop(void *pvParameters);
-
-extern int resolveButton(Button *button);
 
-bool btnShortCheck(int index);
-bool btnLongCheck(int index);
+//Waits up to timeout for the next button event
+bool btnWaitEvent(BtnEvent *evt, TickType_t timeout);
+//Drops the pending events, used on view changes
 void btnClearAll();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+#include "CdcCapture.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+
+static const char* TAG = "CdcCapture";
+
+#define CAPTURE_LOCK_MS 5
+
+static uint8_t* capBuf = NULL;
+static size_t capLen = 0;
+static uint32_t capRecords = 0;
+static uint32_t capDropped = 0; //records lost to a full buffer or a busy lock
+static int64_t capStartUs = 0;
+static volatile bool capActive = false;
+static SemaphoreHandle_t capMutex = NULL;
+
+bool cdcCaptureStart(){
+  if (capMutex == NULL) {
+    capMutex = xSemaphoreCreateMutex();
+    if (capMutex == NULL) return false;
+  }
+  if (capBuf == NULL) {
+    capBuf = (uint8_t*)malloc(CDC_CAPTURE_SIZE);
+    if (capBuf == NULL) {
+      ESP_LOGE(TAG, "No memory for a %u bytes capture", CDC_CAPTURE_SIZE);
+      return false;
+    }
+  }
+
+  xSemaphoreTake(capMutex, portMAX_DELAY);
+  memcpy(capBuf, CDC_CAP_MAGIC, CDC_CAP_MAGIC_LEN);
+  capLen = CDC_CAP_MAGIC_LEN;
+  capRecords = 0;
+  capDropped = 0;
+  capStartUs = esp_timer_get_time();
+  capActive = true;
+  xSemaphoreGive(capMutex);
+  ESP_LOGI(TAG, "Capture started");
+  return true;
+}
+
+void cdcCaptureStop(){
+  if (!capActive) return;
+  capActive = false;
+  ESP_LOGI(TAG, "Capture stopped, %u records, %u bytes, %u dropped", capRecords, capLen, capDropped);
+}
+
+bool cdcCaptureActive(){
+  return capActive;
+}
+
+void cdcCaptureAdd(uint8_t flags, const void* data, size_t len){
+  if (!capActive) return;
+  uint32_t us = (uint32_t)(esp_timer_get_time() - capStartUs);
+  if (len > UINT16_MAX) len = UINT16_MAX;
+  size_t stored = (flags & CDC_CAP_ELIDED) ? 0 : len;
+
+  if (xSemaphoreTake(capMutex, pdMS_TO_TICKS(CAPTURE_LOCK_MS)) != pdTRUE) {
+    capDropped++;
+    return;
+  }
+  if (capActive) {
+    if (capLen + CDC_CAP_HEADER_LEN + stored > CDC_CAPTURE_SIZE) {
+      //a partial session replays wrong from the first missing record, stop here
+      capDropped++;
+      capActive = false;
+      ESP_LOGW(TAG, "Capture full, stopped");
+    } else {
+      cdcCapHeader(capBuf + capLen, us, flags, (uint16_t)len);
+      memcpy(capBuf + capLen + CDC_CAP_HEADER_LEN, data, stored);
+      capLen += CDC_CAP_HEADER_LEN + stored;
+      capRecords++;
+    }
+  }
+  xSemaphoreGive(capMutex);
+}
+
+bool cdcCaptureLock(const uint8_t** data, size_t* len){
+  if (capMutex == NULL || capActive || capBuf == NULL) return false;
+  xSemaphoreTake(capMutex, portMAX_DELAY);
+  if (capActive) {
+    xSemaphoreGive(capMutex);
+    return false;
+  }
+  *data = capBuf;
+  *len = capLen;
+  return true;
+}
+
+void cdcCaptureUnlock(){
+  xSemaphoreGive(capMutex);
+}
+
+void cdcCaptureToJson(JsonObject obj){
+  obj["active"]  = (bool)capActive;
+  obj["records"] = capRecords;
+  obj["bytes"]   = capLen;
+  obj["size"]    = CDC_CAPTURE_SIZE;
+  obj["dropped"] = capDropped;
+}
@@ -0,0 +1,40 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Capture of the USB CDC traffic with microsecond timestamps, in the format of
+//CdcProtocol.h, for the host replay tool. The buffer is allocated on the first
+//start and recording stops when it is full.
+//Started and stopped with {"action":"set","params":{"capture":"true|false"}},
+//status with {"action":"get","params":["capture"]}, the file is downloaded from
+///rest/cdcCapture once stopped.
+
+#ifndef CDCCAPTURE_H
+#define CDCCAPTURE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "CdcProtocol.h"
+
+#define CDC_CAPTURE_SIZE  32768
+
+//Clears the previous capture, false if the buffer can't be allocated
+bool cdcCaptureStart();
+void cdcCaptureStop();
+bool cdcCaptureActive();
+void cdcCaptureAdd(uint8_t flags, const void* data, size_t len);
+//Locks the stopped capture for reading, false while recording or empty
+bool cdcCaptureLock(const uint8_t** data, size_t* len);
+void cdcCaptureUnlock();
+void cdcCaptureToJson(JsonObject obj);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Download of the stopped CDC capture
+
+#include "CdcCaptureService.h"
+
+CdcCaptureService::CdcCaptureService(PsychicHttpServer *server,
+                                     SecurityManager *securityManager) : _server(server),
+                                                                         _securityManager(securityManager)
+{
+}
+
+void CdcCaptureService::begin()
+{
+    _server->on(CDC_CAPTURE_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&CdcCaptureService::cdcCapture, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+
+    ESP_LOGV("CdcCaptureService", "Registered GET endpoint: %s", CDC_CAPTURE_SERVICE_PATH);
+}
+
+//Capture file as described in CdcProtocol.h, 409 while recording or before the first capture
+esp_err_t CdcCaptureService::cdcCapture(PsychicRequest *request)
+{
+    const uint8_t *data;
+    size_t len;
+    if (!cdcCaptureLock(&data, &len))
+        return request->reply(409);
+
+    PsychicResponse response = PsychicResponse(request);
+    response.setCode(200);
+    response.setContentType("application/octet-stream");
+    response.addHeader("Content-Disposition", "attachment; filename=\"uih-cdc.cap\"");
+    response.setContent(data, len);
+    esp_err_t err = response.send();
+    cdcCaptureUnlock();
+    return err;
+}
@@ -0,0 +1,38 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Download of the stopped CDC capture. GET /rest/cdcCapture
+
+#ifndef CdcCaptureService_h
+#define CdcCaptureService_h
+
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+#include "CdcCapture.h"
+
+#define CDC_CAPTURE_SERVICE_PATH "/rest/cdcCapture"
+
+class CdcCaptureService
+{
+public:
+    CdcCaptureService(PsychicHttpServer *server, SecurityManager *securityManager);
+
+    void begin();
+
+private:
+    PsychicHttpServer *_server;
+    SecurityManager *_securityManager;
+    esp_err_t cdcCapture(PsychicRequest *request);
+};
+
+#endif
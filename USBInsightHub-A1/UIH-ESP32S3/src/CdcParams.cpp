@@ -0,0 +1,34 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Checks of the host supplied values of the serial "set" requests
+
+#include "CdcParams.h"
+#include <string.h>
+
+int cdcEnumParam(JsonVariantConst v, const char* const* names, int count){
+  const char* name = v.as<const char*>();
+  if (name == nullptr) return -1;
+  for (int i = 0; i < count; i++) {
+    if (strcmp(names[i], name) == 0) return i;
+  }
+  return -1;
+}
+
+bool cdcRangeParam(JsonVariantConst v, uint32_t min, uint32_t max, uint32_t* out){
+  if (!v.is<double>() && !v.is<const char*>()) return false;
+  double d = v.as<double>(); //numeric strings too, anything else is 0
+  if (!(d >= min && d < (double)max + 1)) return false; //NaN fails as well
+  *out = (uint32_t)d;
+  return true;
+}
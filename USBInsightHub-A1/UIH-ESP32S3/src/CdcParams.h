@@ -0,0 +1,28 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Checks of the host supplied values of the serial "set" requests. Only needs
+//ArduinoJson, the fuzz targets in UIHHostControl/fuzz build it on the host.
+
+#ifndef CDCPARAMS_H
+#define CDCPARAMS_H
+
+#include <ArduinoJson.h>
+
+//Index of v in names, -1 when v is missing, not a string or not one of them
+int cdcEnumParam(JsonVariantConst v, const char* const* names, int count);
+//v as a number or numeric string in [min, max], fractions cut. False otherwise,
+//values that don't fit in the target type never wrap into the range
+bool cdcRangeParam(JsonVariantConst v, uint32_t min, uint32_t max, uint32_t* out);
+
+#endif
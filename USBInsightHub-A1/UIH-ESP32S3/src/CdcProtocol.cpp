@@ -0,0 +1,131 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Byte level framing of the USB CDC link and the capture file format
+
+#include "CdcProtocol.h"
+#include <string.h>
+
+static void framerRestart(CdcFramer* f){
+  f->index = 0;
+  f->imgPort = -1;
+  f->imgBpp = 0;
+  f->imgLen = 0;
+  f->img = NULL;
+}
+
+void cdcFramerReset(CdcFramer* f){
+  framerRestart(f);
+  f->lastMs = 0;
+}
+
+void cdcFramerFeed(CdcFramer* f, const uint8_t* data, size_t len, uint32_t nowMs, const CdcFramerOps* ops){
+  if (nowMs - f->lastMs > CDC_FRAME_TIMEOUT_MS)
+    framerRestart(f);
+  f->lastMs = nowMs;
+
+  for (size_t i = 0; i < len; i++) {
+    uint8_t c = data[i];
+
+    if (f->imgPort >= 0) {
+      uint8_t port = f->imgPort;
+
+      if (f->imgBpp == 0) {
+        // First byte indicates bits per pixel
+        if (c == 0) {
+          framerRestart(f);
+          ops->imageDone(ops->ctx, port, 0, true);
+          continue;
+        }
+        const uint32_t imageBits = (uint32_t)CDC_IMAGE_PIXELS * c;
+        f->imgBpp = c;
+        f->imgLen = (imageBits / 8) + (imageBits % 8 ? 1 : 0);
+        //the sender still sends the pixels, they are counted so framing holds
+        f->img = CDC_IMAGE_BPP_OK(c) ? ops->imageStart(ops->ctx, port, c, f->imgLen) : NULL;
+        continue;
+      }
+
+      //whole run of pixels of this chunk at once
+      size_t n = len - i;
+      if (n > f->imgLen - f->index) n = f->imgLen - f->index;
+      if (f->img) memcpy(f->img + f->index, data + i, n);
+      f->index += n;
+      i += n - 1;
+
+      if (f->index >= f->imgLen) {
+        uint8_t bpp = f->imgBpp;
+        bool stored = f->img != NULL;
+        framerRestart(f);
+        ops->imageDone(ops->ctx, port, bpp, stored);
+      }
+      continue;
+    }
+
+    if (c >= 1 && c <= CDC_IMAGE_PORTS) {
+      framerRestart(f);
+      f->imgPort = c - 1;
+      continue;
+    }
+
+    // Empty line = agent keepalive, the RX event already counted it as activity
+    if ((c == '\n' || c == '\r') && f->index == 0)
+      continue;
+
+    if (f->index >= CDC_LINE_MAX - 1) {
+      framerRestart(f);
+      ops->overflow(ops->ctx);
+      return;
+    }
+
+    f->line[f->index++] = c;
+
+    if (c == '\n') {
+      f->line[f->index] = '\0';
+      size_t n = f->index;
+      framerRestart(f);
+      ops->line(ops->ctx, f->line, n);
+    }
+  }
+}
+
+size_t cdcFramerImagePending(const CdcFramer* f, uint32_t nowMs){
+  if (nowMs - f->lastMs > CDC_FRAME_TIMEOUT_MS || f->imgPort < 0 || f->imgBpp == 0)
+    return 0;
+  return f->imgLen - f->index;
+}
+
+void cdcCapHeader(uint8_t* out, uint32_t us, uint8_t flags, uint16_t len){
+  out[0] = us;
+  out[1] = us >> 8;
+  out[2] = us >> 16;
+  out[3] = us >> 24;
+  out[4] = flags;
+  out[5] = 0;
+  out[6] = len;
+  out[7] = len >> 8;
+}
+
+bool cdcCapNext(const uint8_t* buf, size_t size, size_t* pos, CdcCapRecord* rec){
+  if (*pos > size || size - *pos < CDC_CAP_HEADER_LEN)
+    return false;
+  const uint8_t* h = buf + *pos;
+  rec->us = (uint32_t)h[0] | (uint32_t)h[1] << 8 | (uint32_t)h[2] << 16 | (uint32_t)h[3] << 24;
+  rec->flags = h[4];
+  rec->len = (uint16_t)(h[6] | h[7] << 8);
+  size_t stored = (rec->flags & CDC_CAP_ELIDED) ? 0 : rec->len;
+  if (size - *pos - CDC_CAP_HEADER_LEN < stored)
+    return false;
+  rec->data = stored ? h + CDC_CAP_HEADER_LEN : NULL;
+  *pos += CDC_CAP_HEADER_LEN + stored;
+  return true;
+}
@@ -0,0 +1,89 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Byte level framing of the USB CDC link and the capture file format. No Arduino
+//dependencies, the host replay tool (UIHHostControl/tools/cdcreplay.cpp) builds
+//this file as is.
+//
+//Framing: a request is a JSON line ended by '\n', an empty line is a keepalive.
+//A byte 1 to 3 outside a line starts an image for that port, followed by one
+//bits per pixel byte (0 clears the image) and the pixels. Pixels of a depth the
+//screen can't draw are read and dropped. Nothing received for
+//CDC_FRAME_TIMEOUT_MS restarts the framer.
+//
+//Capture: CDC_CAP_MAGIC followed by records of an 8 byte little endian header
+//{u32 us since start, u8 flags, u8 0, u16 len} and len bytes, except for
+//CDC_CAP_ELIDED records (image pixels) that keep only the length.
+
+#ifndef CDCPROTOCOL_H
+#define CDCPROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CDC_LINE_MAX          1024
+#define CDC_FRAME_TIMEOUT_MS  1000
+#define CDC_IMAGE_PIXELS      (226*90) //Width*Height
+#define CDC_IMAGE_PORTS       3
+//depths FrameSprite::pushImageMapped draws
+#define CDC_IMAGE_BPP_OK(bpp) ((bpp) == 4 || (bpp) == 8 || (bpp) == 16)
+
+#define CDC_CAP_MAGIC         "UIHCAP01"
+#define CDC_CAP_MAGIC_LEN     8
+#define CDC_CAP_HEADER_LEN    8
+//record flags
+#define CDC_CAP_IN            0x00 //host to hub
+#define CDC_CAP_OUT           0x01 //hub to host, one line without its line end
+#define CDC_CAP_ELIDED        0x02 //image pixels, only the length is stored
+
+struct CdcFramerOps {
+  //bits per pixel byte of an image, returns where its len pixel bytes go (NULL drops them)
+  uint8_t* (*imageStart)(void* ctx, uint8_t port, uint8_t bpp, size_t len);
+  //all pixels received, bpp 0 when the image was cleared; stored is false when
+  //they were dropped (unsupported depth or no buffer)
+  void (*imageDone)(void* ctx, uint8_t port, uint8_t bpp, bool stored);
+  //request line including its '\n', null terminated
+  void (*line)(void* ctx, const char* line, size_t len);
+  //line longer than CDC_LINE_MAX, the rest of the chunk is dropped
+  void (*overflow)(void* ctx);
+  void* ctx;
+};
+
+struct CdcFramer {
+  char line[CDC_LINE_MAX];
+  size_t index;
+  int8_t imgPort;  //-1 outside an image
+  uint8_t imgBpp;  //0 until the bits per pixel byte arrives
+  size_t imgLen;
+  uint8_t* img;
+  uint32_t lastMs;
+};
+
+struct CdcCapRecord {
+  uint32_t us;
+  uint8_t flags;
+  uint16_t len;
+  const uint8_t* data; //NULL for CDC_CAP_ELIDED
+};
+
+void cdcFramerReset(CdcFramer* f);
+void cdcFramerFeed(CdcFramer* f, const uint8_t* data, size_t len, uint32_t nowMs, const CdcFramerOps* ops);
+//Image pixel bytes the framer expects next, what a capture can elide
+size_t cdcFramerImagePending(const CdcFramer* f, uint32_t nowMs);
+
+//Record header, out must hold CDC_CAP_HEADER_LEN bytes
+void cdcCapHeader(uint8_t* out, uint32_t us, uint8_t flags, uint16_t len);
+//Reads the record at *pos and moves past it, false at the end or on a truncated record
+bool cdcCapNext(const uint8_t* buf, size_t size, size_t* pos, CdcCapRecord* rec);
+
+#endif
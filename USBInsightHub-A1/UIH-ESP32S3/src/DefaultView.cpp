@@ -14,6 +14,8 @@
  //Logic for the default view (Devices metadata, voltage/current meter, etc.)
 
 #include "DefaultView.h"
+#include <atomic>
+#include "TaskProfiler.h"
 
 GlobalState *gState;
 GlobalConfig *gConfig;
@@ -22,12 +24,17 @@ Screen *iScreen;
 static const char* TAG = "DefaultView";
 
 chScreenData ScreenArr[3];
-chScreenData prevScreenArr[3];
 
-txtProp prevDevInfo[3];
+uint64_t prevDevHash[3];
+
+//Copy of ScreenArr for other tasks. The screen loop is the only writer, an odd
+//sequence means a copy is in progress and readers retry
+static chScreenData screenPub[3];
+static std::atomic<uint32_t> screenPubSeq(0);
 
 void defaultScreenFastDataUpdate();
 void defaultScreenSlowDataUpdate();
+void defaultScreenPublish();
 uint8_t getRssiBars(int8_t rssi);
 
 void taskDefaultViewLoop(void *pvParameters);
@@ -42,7 +49,8 @@ uint16_t brightnessTestValue = 0;
 bool brightnessTestActive = false;
 bool prevLedState = false; 
 
-void iniDefaultView(GlobalState* globalState, GlobalConfig* globalConfig,  Screen *screen){
+//Panel reset and init, needs nothing from the I2C peripherals
+void iniDisplay(GlobalState* globalState, GlobalConfig* globalConfig,  Screen *screen){
 
   gState = globalState;
   gConfig = globalConfig;
@@ -60,17 +68,29 @@ void iniDefaultView(GlobalState* globalState, GlobalConfig* globalConfig,  Scree
   ScreenArr[0].dProp = {DISPLAY_CS_1, DLIT_1, ROT_180_DEG, 800};
   ScreenArr[1].dProp = {DISPLAY_CS_2, DLIT_2, ROT_180_DEG, 800};
   ScreenArr[2].dProp = {DISPLAY_CS_3, DLIT_3, ROT_180_DEG, 800};
-  
+
+  if(xSemaphoreTake(screen_Semaphore,( TickType_t ) 20 ) == pdTRUE){
+    iScreen->start();
+    xSemaphoreGive(screen_Semaphore);
+  }
+  else {
+    ESP_LOGE(TAG, "Screen resource taken, could not initialize");
+  }
+}
+
+//First frame and view tasks, after iniDisplay and iniIntercomms: the frame shows
+//meterInit and internalErrFlags and the screen loop paces Intercomms
+void iniDefaultView(){
+
   defaultScreenFastDataUpdate();
   prevRefreshRate = gConfig->features.refreshRate;
 
-    
   if(xSemaphoreTake(screen_Semaphore,( TickType_t ) 20 ) == pdTRUE){
     
-    iScreen->start();
     for (int i=0; i<3; i++) {
       iScreen->screenDefaultRender(ScreenArr[i]);
     }
+    bootMark(BOOT_MARK_FIRST_FRAME);
     
     //iScreen->screenSetBackLight(gConfig->screen[0].brightness);
 
@@ -94,12 +114,14 @@ void defaultViewStart(void){
 
 void taskDefaultViewLoop(void *pvParameters){  
   ESP_LOGI(TAG,"Loop Logic on Core %u",xPortGetCoreID());
+  BtnEvent evt;
   for(;;){
-    if(gState->system.currentView==DEFAULT_VIEW && defaultViewActive){
-      int tot = 0;
-      for (int i=0; i<3; i++){
-        //tot=resolveButton(&ButtonArray[i]);
-        if (btnShortCheck(i)) {
+    //wakes on every button event, DEFAULT_VIEW_PERIOD bounds the view switch check
+    bool got = btnWaitEvent(&evt, pdMS_TO_TICKS(DEFAULT_VIEW_PERIOD));
+    if(got && gState->system.currentView==DEFAULT_VIEW && defaultViewActive){
+      if(evt.btn < 3){
+        int i = evt.btn;
+        if (evt.type == BTN_SHORT) {
           ESP_LOGI(TAG,"Button %s short press",String(i+1));
 
           //If button pressed during startup timer, cancel the timer and leave off          
@@ -123,14 +145,14 @@ void taskDefaultViewLoop(void *pvParameters){
           }
 
         }
-        if (btnLongCheck(i)) {
+        if (evt.type == BTN_LONG) {
           ESP_LOGI(TAG,"Button %s long press",String(i+1));
           if(gConfig->features.hubMode == USB2_3 || gConfig->features.hubMode == USB2)
             gState->baseMCUOut[i].data_en = !gState->baseMCUOut[i].data_en;
         }
       }
       
-      if (btnShortCheck(3)) {
+      if (evt.btn == 3 && evt.type == BTN_SHORT) {
         
         ESP_LOGI(TAG,"Setup button short press");
         uint16_t oclimit=2000;
@@ -179,7 +201,7 @@ void taskDefaultViewLoop(void *pvParameters){
           }          
         } 
       }
-      if (btnLongCheck(3)){
+      if (evt.btn == 3 && evt.type == BTN_LONG){
         
         ESP_LOGI(TAG,"Setup button long press");
 
@@ -194,19 +216,16 @@ void taskDefaultViewLoop(void *pvParameters){
       ESP_LOGI(TAG,"Delete Default View Task Loop");
       vTaskDelete(NULL);
     }
-    vTaskDelay(pdMS_TO_TICKS(DEFAULT_VIEW_PERIOD));
   }   
 }
 
 void taskDefaultScreenLoop(void *pvParameters){
   
-  int iScnt = 0;
   int slowCnt = 0;
   int slowPeriod = 10;
   bool firstPass = false;
   uint16_t prevBrightness = 10; //this value is out of range 0-3 to force first update 
-  unsigned long timers=0;
-  unsigned long timere=0;
+  unsigned long lastRender[3] = {0, 0, 0};
   
   TickType_t xLastWakeTime = xTaskGetTickCount();
   ESP_LOGI(TAG,"Loop Screen on Core %u",xPortGetCoreID());
@@ -220,8 +239,13 @@ void taskDefaultScreenLoop(void *pvParameters){
   {
     for(;;){
       
-      xTaskNotifyGive(gState->system.taskIntercommHandle);
-      ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(20));
+      //not set when Intercomms couldn't take the I2C bus
+      if(gState->system.taskIntercommHandle != NULL){
+        taskProfNotifyGive(TASK_PROF_SCREEN_METER);
+        xTaskNotifyGive(gState->system.taskIntercommHandle);
+      }
+      if(ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(20)) > 0)
+        taskProfNotifyTaken(TASK_PROF_METER_SCREEN);
 
       //Brightness test mode
       if(USE_BRIGHTNESS_TEST_MODE > 0 && brightnessTestActive)
@@ -259,18 +283,25 @@ void taskDefaultScreenLoop(void *pvParameters){
         slowCnt=0;
         defaultScreenSlowDataUpdate();      
       }
-
-      //update screen only if something changed or on the first update cycle      
-      if(memcmp(&prevScreenArr[iScnt],&(ScreenArr[iScnt]),sizeof(prevScreenArr[iScnt])) != 0 || !firstPass){
-        timers=millis();
-        iScreen->screenDefaultRender(ScreenArr[iScnt]);
-        timere=millis();
-        prevScreenArr[iScnt] = ScreenArr[iScnt];
-        //ESP_LOGI(TAG,"%u",timere-timers);            
+      defaultScreenPublish();
+
+      //update the screens whose content changed, the one waiting the longest first.
+      //Stop when the render budget of the period is used, the rest goes first on the next period.
+      //On the first update cycle all three are drawn.
+      unsigned long tickStart = millis();
+      uint8_t order[3] = {0, 1, 2};
+      for (int a = 0; a < 2; a++)
+        for (int b = a + 1; b < 3; b++)
+          if (lastRender[order[b]] < lastRender[order[a]]) { uint8_t t = order[a]; order[a] = order[b]; order[b] = t; }
+
+      for (int k = 0; k < 3; k++){
+        uint8_t i = order[k];
+        if (!iScreen->screenDefaultChanged(ScreenArr[i])) continue;
+        if (firstPass && millis() - tickStart > DISPLAY_RENDER_BUDGET) break;
+        iScreen->screenDefaultRender(ScreenArr[i]);
+        lastRender[i] = millis();
       }
-
-      iScnt++;
-      if(iScnt==3) {iScnt=0;  firstPass = true;  }
+      firstPass = true;
 
       if(infoSplashTimer != 0){
         if(millis()-infoSplashTimer > MENU_INFO_SPLASH_TIMEOUT){
@@ -312,17 +343,25 @@ void defaultScreenFastDataUpdate(){
       ScreenArr[i].ilim    = gState->baseMCUOut[i].ilim;
       ScreenArr[i].mProp.fwdAlertSet  = gState->meter[i].fwdAlertSet;
       ScreenArr[i].mProp.backAlertSet = gState->meter[i].backAlertSet;
+      ScreenArr[i].mProp.sagAlert     = gState->meter[i].sagAlert;
+      ScreenArr[i].mProp.ovAlert      = gState->meter[i].ovAlert;
+      ScreenArr[i].mProp.opAlert      = gState->meter[i].opAlert;
       ScreenArr[i].mProp.fwdCLim      = gConfig->meter[i].fwdCLim;
       ScreenArr[i].mProp.backCLim     = gConfig->meter[i].backCLim;
       ScreenArr[i].tProp.numDev     = gState->usbInfo[i].numDev;
       if(gState->features.clearScreenText) ScreenArr[i].tProp.numDev = 0;
-      ScreenArr[i].tProp.Dev1_Name  = gState->usbInfo[i].Dev1_Name;
-      ScreenArr[i].tProp.Dev2_Name  = gState->usbInfo[i].Dev2_Name;
+      strlcpy(ScreenArr[i].tProp.Dev1_Name, gState->usbInfo[i].Dev1_Name.c_str(), SCREEN_NAME_LEN);
+      strlcpy(ScreenArr[i].tProp.Dev2_Name, gState->usbInfo[i].Dev2_Name.c_str(), SCREEN_NAME_LEN);
+      ScreenArr[i].tProp.flex       = gState->usbInfo[i].flex;
+      ScreenArr[i].tProp.flexTop    = flexLayoutTop(&gState->usbInfo[i].flex, millis());
       ScreenArr[i].tProp.imgBuffer  = gState->usbInfo[i].imgBuffer;
       ScreenArr[i].tProp.imgBPP     = gState->usbInfo[i].imgBPP;
+      ScreenArr[i].tProp.imgSeq     = gState->usbInfo[i].imgSeq;
       ScreenArr[i].tProp.usbType    = gState->usbInfo[i].usbType;
       if(gState->features.clearScreenText) ScreenArr[i].tProp.usbType = 0;      
       ScreenArr[i].pconnected       = gState->features.pcConnected;
+      strlcpy(ScreenArr[i].sigLabel, gState->powerSig[i].label, SCREEN_NAME_LEN);
+      ScreenArr[i].sigAnomaly       = gState->powerSig[i].anomaly;
       iScreen->dProp[i].brightness  = gConfig->screen[i].brightness;
       iScreen->dProp[i].rotation    = gConfig->screen[i].rotation;
       ScreenArr[i].dProp.brightness = gConfig->screen[i].brightness;
@@ -335,30 +374,81 @@ void defaultScreenFastDataUpdate(){
       ScreenArr[i].showMenuInfoSplash      = gState->system.showMenuInfoSplash;
       ScreenArr[i].showVersionChangeSplash = gState->system.showVersionChangeSplash;
       ScreenArr[i].updateState      = gState->system.updateState;
+      ScreenArr[i].updateProgress   = gState->system.updateProgress;
       ScreenArr[i].startUpmode      = gConfig->features.startUpmode;
       ScreenArr[i].pwr_source       = gState->baseMCUExtra.pwr_source; 
       ScreenArr[i].usbHostState     = gState->features.usbHostState;
       ScreenArr[i].internalErrFlags = gState->system.internalErrFlags;
 
-      if( memcmp(&prevDevInfo[i],&(ScreenArr[i].tProp),sizeof(prevDevInfo[i])) != 0 ){
-        ESP_LOGI(TAG, "CH %u: #d %u, D1: %s, D2: %s, t: %u",i,ScreenArr[i].tProp.numDev,
-        gState->usbInfo[i].Dev1_Name,
-        gState->usbInfo[i].Dev2_Name, 
+      ScreenHash dev;
+      dev.add(ScreenArr[i].tProp.numDev);
+      dev.text(ScreenArr[i].tProp.Dev1_Name, SCREEN_NAME_LEN);
+      dev.text(ScreenArr[i].tProp.Dev2_Name, SCREEN_NAME_LEN);
+      dev.add(ScreenArr[i].tProp.usbType);
+      if(dev.h != prevDevHash[i]){
+        ESP_LOGI(TAG, "CH %u: #d %d, D1: %s, D2: %s, t: %d",i,ScreenArr[i].tProp.numDev,
+        ScreenArr[i].tProp.Dev1_Name,
+        ScreenArr[i].tProp.Dev2_Name, 
         ScreenArr[i].tProp.usbType);    
         //save current state for later comparison    
-        memcpy(&prevDevInfo[i],&(ScreenArr[i].tProp),sizeof(prevDevInfo[i]));
+        prevDevHash[i] = dev.h;
       }       
     }  
 }
 
 void defaultScreenSlowDataUpdate(){
     for (int i=0; i<3 ; i++){     
-      ScreenArr[i].mProp.AvgCurrent = gState->meter[i].AvgCurrent;
-      ScreenArr[i].mProp.AvgVoltage = gState->meter[i].AvgVoltage;
+      ScreenArr[i].mProp.AvgCurrentUa = gState->meter[i].AvgCurrentUa;
+      ScreenArr[i].mProp.AvgVoltageUv = gState->meter[i].AvgVoltageUv;
     }  
     //ESP_LOGV(TAG, "CH 0 state: %s, screen: %s",gState->usbInfo[0].Dev1_Name, ScreenArr[0].tProp.Dev1_Name);    
 }
 
+void defaultScreenPublish(){
+  uint32_t seq = screenPubSeq.load(std::memory_order_relaxed);
+  screenPubSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(screenPub, ScreenArr, sizeof(screenPub));
+  screenPubSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool defaultViewSnapshot(uint8_t ch, chScreenData* out){
+  if(ch >= 3) return false;
+  for(int tries = 0; tries < SCREEN_SNAPSHOT_TRIES; tries++){
+    uint32_t seq = screenPubSeq.load(std::memory_order_acquire);
+    if(seq & 1){
+      taskYIELD();
+      continue;
+    }
+    memcpy(out, &screenPub[ch], sizeof(*out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(screenPubSeq.load(std::memory_order_relaxed) == seq) return seq != 0;
+  }
+  return false;
+}
+
+void defaultViewToJson(JsonArray arr){
+  chScreenData s;
+  uint64_t hash[BAND_COUNT];
+  char hex[17];
+  for(int i=0; i<3; i++){
+    JsonObject o = arr.add<JsonObject>();
+    if(!defaultViewSnapshot(i, &s)) continue;
+    o["numDev"]    = s.tProp.numDev;
+    o["Dev1_name"] = s.tProp.Dev1_Name;
+    o["Dev2_name"] = s.tProp.Dev2_Name;
+    o["sigLabel"]  = s.sigLabel;
+    o["voltage"]   = s.mProp.AvgVoltageUv / 1000; //mV
+    o["current"]   = s.mProp.AvgCurrentUa / 1000; //mA
+    iScreen->defaultBandHashes(s, hash);
+    JsonArray h = o["hash"].to<JsonArray>();
+    for(int b=0; b<BAND_COUNT; b++){
+      snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash[b]);
+      h.add(hex);
+    }
+  }
+}
+
 uint8_t getRssiBars(int8_t rssi){
   //copy values from RSSIIndicator.svelte
   if (rssi>= -55) return 3;
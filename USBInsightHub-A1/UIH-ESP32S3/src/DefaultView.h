@@ -25,11 +25,17 @@
 #define DEFAULT_VIEW_PERIOD      40 //in ms
 #define MENU_INFO_SPLASH_TIMEOUT 2000 //in ms
 #define VERSION_CHANGE_SPLASH_TIMEOUT 8000 //in ms
+#define SCREEN_SNAPSHOT_TRIES    8
 
 
 
-void iniDefaultView(GlobalState* globalState, GlobalConfig* globalConfig, Screen *screen);
+void iniDisplay(GlobalState* globalState, GlobalConfig* globalConfig, Screen *screen);
+void iniDefaultView();
 void defaultViewStart(void);
+//Consistent copy of what the default view shows on a channel, false if none yet
+bool defaultViewSnapshot(uint8_t ch, chScreenData* out);
+//{"action":"get","params":["screen"]}
+void defaultViewToJson(JsonArray arr);
 
 extern SemaphoreHandle_t screen_Semaphore;
 
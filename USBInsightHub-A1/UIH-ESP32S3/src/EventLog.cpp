@@ -0,0 +1,71 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Unified hardware event log shared by Intercomms, Extercomms and the web interface
+
+#include "EventLog.h"
+
+static const char* TAG = "EventLog";
+
+static LogEvent evtRing[EVENT_LOG_SIZE];
+static uint32_t evtSeq = 0; //sequence of the last added entry
+static SemaphoreHandle_t evtSemaphore = NULL;
+
+void eventLogInit(){
+  if(evtSemaphore == NULL) evtSemaphore = xSemaphoreCreateMutex();
+  if(evtSemaphore == NULL) ESP_LOGE(TAG, "Event log semaphore creation failed");
+}
+
+void eventLogAdd(uint8_t type, uint8_t ch, uint8_t data, uint32_t ms){
+  if(evtSemaphore == NULL) return;
+  if(xSemaphoreTake(evtSemaphore,pdMS_TO_TICKS(10)) == pdTRUE){
+    evtSeq++;
+    LogEvent &e = evtRing[evtSeq % EVENT_LOG_SIZE];
+    e.seq  = evtSeq;
+    e.ms   = ms;
+    e.type = type;
+    e.ch   = ch;
+    e.data = data;
+    xSemaphoreGive(evtSemaphore);
+    ESP_LOGI(TAG, "#%u %u ms %s ch %u data 0x%02X", evtSeq, ms,
+             type < EVT_TYPE_COUNT ? t_eventType[type] : "?", ch + 1, data);
+  }
+  else {
+    ESP_LOGE(TAG, "Timeout to add event");
+  }
+}
+
+uint32_t eventLogToJson(JsonArray arr, uint32_t since){
+  uint32_t last = since;
+  if(evtSemaphore == NULL) return last;
+  if(xSemaphoreTake(evtSemaphore,pdMS_TO_TICKS(10)) == pdTRUE){
+    //oldest entry still in the ring
+    uint32_t first = evtSeq >= EVENT_LOG_SIZE ? evtSeq - EVENT_LOG_SIZE + 1 : 1;
+    if(since + 1 > first) first = since + 1;
+
+    for(uint32_t s = first; s <= evtSeq; s++){
+      const LogEvent &e = evtRing[s % EVENT_LOG_SIZE];
+      JsonObject o = arr.add<JsonObject>();
+      o["seq"]  = e.seq;
+      o["ms"]   = e.ms;
+      o["type"] = e.type < EVT_TYPE_COUNT ? t_eventType[e.type] : "unknown";
+      if(e.type == EVT_FAULT || e.type == EVT_FWD_ALERT || e.type == EVT_BACK_ALERT ||
+         e.type == EVT_SAG || e.type == EVT_OVER_VOLT || e.type == EVT_OVER_POWER)
+        o["ch"] = e.ch + 1;
+      o["data"] = e.data;
+    }
+    last = evtSeq;
+    xSemaphoreGive(evtSemaphore);
+  }
+  return last;
+}
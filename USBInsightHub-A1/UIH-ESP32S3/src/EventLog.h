@@ -0,0 +1,58 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Unified hardware event log: BaseMCU fault, power source and CC changes (stamped
+//by the BaseMCU itself) and the PAC1943 current alerts. Fixed ring buffer, the
+//newest entries overwrite the oldest. Every entry gets an increasing sequence
+//number so readers can ask only for what they have not seen yet.
+//Read from serial with {"action":"get","params":["events"]} and from /rest/eventLog
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define EVENT_LOG_SIZE 64
+
+//type 1-3 are the BaseMCU event codes
+#define EVT_FAULT       1 //data: 1 short/fault asserted, 0 released
+#define EVT_PWRSRC      2 //data: bit0 VHOST present, bit1 VEXT present
+#define EVT_CCSUM       3 //data: CCSUM register
+#define EVT_LOST        4 //BaseMCU FIFO overflowed, some events before this one are missing
+#define EVT_FWD_ALERT   5 //PAC1943 forward over current, channel switched off
+#define EVT_BACK_ALERT  6 //PAC1943 backward current, channel switched off
+#define EVT_I2C_RECOVER 7 //board I2C bus freed, data: 1 SDA released, 0 still low
+#define EVT_I2C_CLOCK   8 //board I2C clock changed, data: clock / 10 kHz
+#define EVT_SAG         9 //PAC1943 VBUS under the UV limit, data: limit / 100 mV
+#define EVT_OVER_VOLT  10 //PAC1943 VBUS over the OV limit, data: limit / 100 mV
+#define EVT_OVER_POWER 11 //filtered power over the OP limit, data: power / 100 mW
+
+static const char* t_eventType[] = {"none","fault","pwr_source","cc_sum","lost","fwd_alert","back_alert","i2c_recover","i2c_clock",
+                                    "sag","over_voltage","over_power"};
+#define EVT_TYPE_COUNT (sizeof(t_eventType) / sizeof(t_eventType[0]))
+
+struct LogEvent {
+  uint32_t seq;
+  uint32_t ms;   //ESP32 millis() of the event
+  uint8_t type;
+  uint8_t ch;    //board channel 0-2, 0 when not channel related
+  uint8_t data;
+};
+
+void eventLogInit();
+void eventLogAdd(uint8_t type, uint8_t ch, uint8_t data, uint32_t ms);
+//Appends the entries with seq > since to arr, returns the last sequence number
+uint32_t eventLogToJson(JsonArray arr, uint32_t since);
+
+#endif
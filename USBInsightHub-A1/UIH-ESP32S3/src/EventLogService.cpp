@@ -0,0 +1,48 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//REST access to the hardware event log
+
+#include "EventLogService.h"
+
+EventLogService::EventLogService(PsychicHttpServer *server,
+                                 SecurityManager *securityManager) : _server(server),
+                                                                     _securityManager(securityManager)
+{
+}
+
+void EventLogService::begin()
+{
+    _server->on(EVENT_LOG_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&EventLogService::eventLog, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+
+    ESP_LOGV("EventLogService", "Registered GET endpoint: %s", EVENT_LOG_SERVICE_PATH);
+}
+
+//{"last":<seq>,"now":<ms>,"events":[{"seq","ms","type","ch","data"},...]}
+esp_err_t EventLogService::eventLog(PsychicRequest *request)
+{
+    uint32_t since = 0;
+    if (request->hasParam("since"))
+        since = request->getParam("since")->value().toInt();
+
+    PsychicJsonResponse response = PsychicJsonResponse(request, false);
+    JsonObject root = response.getRoot();
+
+    root["last"] = eventLogToJson(root["events"].to<JsonArray>(), since);
+    root["now"] = millis();
+
+    return response.send();
+}
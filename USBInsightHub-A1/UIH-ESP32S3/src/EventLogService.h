@@ -0,0 +1,38 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//REST access to the hardware event log. GET /rest/eventLog?since=<seq>
+
+#ifndef EventLogService_h
+#define EventLogService_h
+
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+#include "EventLog.h"
+
+#define EVENT_LOG_SERVICE_PATH "/rest/eventLog"
+
+class EventLogService
+{
+public:
+    EventLogService(PsychicHttpServer *server, SecurityManager *securityManager);
+
+    void begin();
+
+private:
+    PsychicHttpServer *_server;
+    SecurityManager *_securityManager;
+    esp_err_t eventLog(PsychicRequest *request);
+};
+
+#endif
@@ -14,6 +14,10 @@
 //Handlers for the communication with external devices through USB Serial
 
 #include "Extercomms.h"
+#include "DefaultView.h"
+#include "CdcCapture.h"
+#include "CdcParams.h"
+#include "TaskProfiler.h"
 
 //USB Serial and Harware Serial (Debug)
 #if ARDUINO_USB_CDC_ON_BOOT
@@ -26,8 +30,7 @@ USBCDC usbSerial;
 
 static const char* TAG = "Extercoms";
 
-#define IMAGE_SIZE_PIXELS (226*90) //Width*Height*1bpp
-#define SERIAL_BUFFER_TIMEOUT_MS 1000
+#define CDC_RX_CHUNK 64
 
 GlobalState *gloState;
 GlobalConfig *gloConfig;
@@ -36,31 +39,26 @@ bool USBSerialActivity = false;
 bool dataReceived = false; 
 
 
-char rawBuffer[80];
-size_t rawBufIndex = 0;
-char inputBuffer[MAX_BUFFER_SIZE];   //working array JSON-RPC
-size_t bufferIndex = 0;
-int8_t imgPortIndex = -1;
-uint8_t imgBufBpp = 0;
-size_t imgBufLen = 0;
-unsigned long long lastSerialTime = 0;
+char inputBuffer[CDC_LINE_MAX];   //working array JSON-RPC
+static CdcFramer framer;
 
 //Internal functions
 void parseDataPC();
 static void usbEventCallback(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 void taskExterCheckActivity(void *pvParameters);
 
-void onSerialDataReceived();
+void onSerialDataReceived(const uint8_t* data, size_t len);
 void processJsonRpcMessage(const char* jsonString);
 void sendJsonResponse(int id, JsonVariant result);
 void printErr(String err);
-int getEnumIndex(const char* name, const char* const* array, int size);
+static void cdcPrintln(const char* line, size_t len);
 
 
 void iniExtercomms(GlobalState* globalState, GlobalConfig* globalConfig){
 
     gloState = globalState;
     gloConfig = globalConfig;
+    cdcFramerReset(&framer);
 
     //Hardware Serial Ini
     //HWSerial.begin(115200); //Debug Serial
@@ -111,86 +109,57 @@ void taskExterCheckActivity(void *pvParameters){
 
 }
 
-static inline void serialReset() {
-  imgPortIndex = -1;
-  bufferIndex = 0;
-  imgBufBpp = 0;
-  imgBufLen = 0;
+static uint8_t* framerImageStart(void* ctx, uint8_t port, uint8_t bpp, size_t len){
+  USBInfoState &info = gloState->usbInfo[port];
+  const uint8_t oldBPP = info.imgBPP;
+  info.imgBPP = 0;
+  if (info.imgBuffer == nullptr || oldBPP != bpp) {
+    free(info.imgBuffer); // Free previous buffer if any
+    info.imgBuffer = (uint16_t*)malloc(len);
+  }
+  return (uint8_t*)info.imgBuffer;
 }
 
-//void onSerialDataReceived(const uint8_t* data, size_t length){
-void onSerialDataReceived(){
-  if (millis() - lastSerialTime > SERIAL_BUFFER_TIMEOUT_MS) {
-    serialReset();
+static void framerImageDone(void* ctx, uint8_t port, uint8_t bpp, bool stored){
+  USBInfoState &info = gloState->usbInfo[port];
+  if (bpp == 0) {
+    info.imgBPP = 0;
+    free(info.imgBuffer);
+    info.imgBuffer = nullptr;
+  } else if (!stored) {
+    printErr("{\"status\": \"error\", \"data\": {\"code\": -32602, \"message\": \"Image dropped, 4, 8 or 16 bpp\"}}");
+    return;
+  } else {
+    info.imgBPP = bpp;
   }
-  lastSerialTime = millis();
-
-  // Process each byte
-  for (size_t i = 0; i < rawBufIndex; i++) {
-    char c = (char)rawBuffer[i];
-
-    if (imgPortIndex >= 0) {
-      char* imgBufferRaw = (char*)gloState->usbInfo[imgPortIndex].imgBuffer;
-
-      if (imgBufBpp == 0) {
-        // First byte indicates bits per pixel
-        if (c == 0) {
-          gloState->usbInfo[imgPortIndex].imgBPP = 0;
-          free(gloState->usbInfo[imgPortIndex].imgBuffer);
-          gloState->usbInfo[imgPortIndex].imgBuffer = nullptr;
-          serialReset();
-          usbSerial.println("{\"status\": \"ok\", \"data\": {\"message\": \"image complete\"}}");
-          continue;
-        }
-
-        imgBufBpp = c;
-        const unsigned long long imageBits = IMAGE_SIZE_PIXELS * imgBufBpp;
-        imgBufLen = (imageBits / 8) + (imageBits % 8 ? 1 : 0);
-
-        const uint8_t oldBPP = gloState->usbInfo[imgPortIndex].imgBPP;
-        gloState->usbInfo[imgPortIndex].imgBPP = 0;
-        if (imgBufferRaw == nullptr || oldBPP != imgBufBpp) {
-          free(imgBufferRaw); // Free previous buffer if any
-          imgBufferRaw = (char*)malloc(imgBufLen);
-          gloState->usbInfo[imgPortIndex].imgBuffer = (uint16_t*)imgBufferRaw;
-        }
-        continue;
-      }
+  info.imgSeq++;
+  static const char done[] = "{\"status\": \"ok\", \"data\": {\"message\": \"image complete\"}}";
+  cdcPrintln(done, sizeof(done) - 1);
+}
 
-      imgBufferRaw[bufferIndex++] = c;
+static void framerLine(void* ctx, const char* line, size_t len){
+  memcpy(inputBuffer, line, len + 1);
+  dataReceived = true;
+}
 
-      if (bufferIndex >= imgBufLen) {
-        gloState->usbInfo[imgPortIndex].imgBPP = imgBufBpp;
-        serialReset();
-        usbSerial.println("{\"status\": \"ok\", \"data\": {\"message\": \"image complete\"}}");
-      }
-      continue;
-    }
+static void framerOverflow(void* ctx){
+  printErr("{\"status\": \"error\", \"data\": {\"code\": -32700, \"message\": \"Buffer overflow\"}}");
+}
 
-    if (c >= 1 && c <= 3) {
-      serialReset();
-      imgPortIndex = c - 1;
-      continue;
-    }
+static const CdcFramerOps framerOps = {framerImageStart, framerImageDone, framerLine, framerOverflow, NULL};
 
-    // Prevent buffer overflow
-    if (bufferIndex >= MAX_BUFFER_SIZE - 1) {
-        serialReset();
-        Serial.println("{\"jsonrpc\": \"2.0\", \"error\": {\"code\": -32700, \"message\": \"Buffer overflow\"}}");
-        return;
-    }
+void onSerialDataReceived(const uint8_t* data, size_t len){
+  uint32_t now = millis();
 
-    // Store character in buffer
-    inputBuffer[bufferIndex++] = c;
+  if (cdcCaptureActive()) {
+    //pixels are only counted, the replay fills them in
+    size_t pixels = cdcFramerImagePending(&framer, now);
+    if (pixels > len) pixels = len;
+    if (pixels) cdcCaptureAdd(CDC_CAP_IN | CDC_CAP_ELIDED, data, pixels);
+    if (len > pixels) cdcCaptureAdd(CDC_CAP_IN, data + pixels, len - pixels);
+  }
 
-    // Check for end of message (`\n`)
-    if (c == '\n') {
-        inputBuffer[bufferIndex] = '\0';  // Null-terminate string
-        dataReceived = true;        
-        //ESP_LOGI(TAG,"%s",inputBuffer);
-        serialReset();
-    }
-  }  
+  cdcFramerFeed(&framer, data, len, now, &framerOps);
 }
 
 // Function to process JSON-RPC message
@@ -221,29 +190,29 @@ void processJsonRpcMessage(const char* jsonString) {
     
   
     if(params["startUpmode"]){
-      int inx = getEnumIndex(params["startUpmode"].as<const char*>(),t_startupMode,ARR_SIZE(t_startupMode));
+      int inx = cdcEnumParam(params["startUpmode"],t_startupMode,ARR_SIZE(t_startupMode));
       inx != -1 ? gloConfig->features.startUpmode = inx : result["startUpmode"] = "fail";
     }
     if(params["wifi_enabled"]) {
-      int inx = getEnumIndex(params["wifi_enabled"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      int inx = cdcEnumParam(params["wifi_enabled"],t_bool,ARR_SIZE(t_bool));
       inx != -1 ? gloConfig->features.wifi_enabled = inx : result["wifi_enabled"] = "fail";
     }
     if(params["hubMode"]){
-      int inx = getEnumIndex(params["hubMode"].as<const char*>(),t_hubMode,ARR_SIZE(t_hubMode));
+      int inx = cdcEnumParam(params["hubMode"],t_hubMode,ARR_SIZE(t_hubMode));
       inx != -1 ? gloConfig->features.hubMode = inx : result["hubMode"] = "fail";
       //delay to allow other json elements downstream not to be overwritten
       vTaskDelay(pdMS_TO_TICKS(150)); 
     }        
     if(params["filterType"]){
-      int inx = getEnumIndex(params["filterType"].as<const char*>(),t_filterType,ARR_SIZE(t_filterType));
+      int inx = cdcEnumParam(params["filterType"],t_filterType,ARR_SIZE(t_filterType));
       inx != -1 ? gloConfig->features.filterType = inx : result["filterType"] = "fail";
     }
     if(params["refreshRate"]){
-      int inx = getEnumIndex(params["refreshRate"].as<const char*>(),t_refreshRate,ARR_SIZE(t_refreshRate));
+      int inx = cdcEnumParam(params["refreshRate"],t_refreshRate,ARR_SIZE(t_refreshRate));
       inx != -1 ? gloConfig->features.refreshRate = inx : result["refreshRate"] = "fail";
     }        
     if(params["rotation"]){
-      int inx = getEnumIndex(params["rotation"].as<const char*>(),t_rotation,ARR_SIZE(t_rotation));
+      int inx = cdcEnumParam(params["rotation"],t_rotation,ARR_SIZE(t_rotation));
       if(inx != -1) {
         gloConfig->screen[0].rotation = inx;
         gloConfig->screen[1].rotation = inx;
@@ -253,8 +222,8 @@ void processJsonRpcMessage(const char* jsonString) {
         result["rotation"] = "fail";
     }   
     if(params["brightness"]){
-      uint8_t inx = params["brightness"].as<unsigned int>();
-      if(inx >= 10 && inx <= 100) {
+      uint32_t inx;
+      if(cdcRangeParam(params["brightness"], 10, 100, &inx)) {
         gloConfig->screen[0].brightness = inx;
         gloConfig->screen[1].brightness = inx;
         gloConfig->screen[2].brightness = inx;
@@ -264,59 +233,75 @@ void processJsonRpcMessage(const char* jsonString) {
     } 
     
     if(params["ledState"]){
-      int inx = getEnumIndex(params["ledState"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      int inx = cdcEnumParam(params["ledState"],t_bool,ARR_SIZE(t_bool));
       inx != -1 ? gloState->system.ledState = inx : result["ledState"] = "fail";        
     }
+    if(params["capture"]){
+      int inx = cdcEnumParam(params["capture"],t_bool,ARR_SIZE(t_bool));
+      if(inx == 0)
+        cdcCaptureStop();
+      else if(inx == -1 || !cdcCaptureStart())
+        result["capture"] = "fail";
+    }
 
     for(int i = 0; i<3; i++){
+      JsonObject ch = params["CH"+String(i+1)].as<JsonObject>();
+      if(ch.isNull()) continue;
+      uint32_t val;
 
-      if(params["CH"+String(i+1)]["powerEn"]){
-        int inx = getEnumIndex(params["CH"+String(i+1)]["powerEn"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      if(ch["powerEn"]){
+        int inx = cdcEnumParam(ch["powerEn"],t_bool,ARR_SIZE(t_bool));
         inx != -1 ? gloState->baseMCUOut[i].pwr_en = inx : result["CH"+String(i+1)]["powerEn"] = "fail";        
       }
-      if(params["CH"+String(i+1)]["dataEn"]){
-        int inx = getEnumIndex(params["CH"+String(i+1)]["dataEn"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      if(ch["dataEn"]){
+        int inx = cdcEnumParam(ch["dataEn"],t_bool,ARR_SIZE(t_bool));
         inx != -1 ? gloState->baseMCUOut[i].data_en = inx :  result["CH"+String(i+1)]["dataEn"] = "fail";        
       }      
-      if(params["CH"+String(i+1)]["startup_tmr"]){
-        uint8_t inx = params["CH"+String(i+1)]["startup_tmr"].as<unsigned int>();
-        (inx >= 1 && inx <= 100) ? gloConfig->startup[i].startup_timer = inx :  result["CH"+String(i+1)]["startup_tmr"] = "out of range";
+      if(ch["startup_tmr"]){
+        cdcRangeParam(ch["startup_tmr"], 1, 100, &val) ? gloConfig->startup[i].startup_timer = val :  result["CH"+String(i+1)]["startup_tmr"] = "out of range";
+      }
+      if(ch["fwdLimit"]){
+        cdcRangeParam(ch["fwdLimit"], 100, 2000, &val) ? gloConfig->meter[i].fwdCLim = val : result["CH"+String(i+1)]["fwdLimit"] = "out of range";
+      }
+      if(ch["backLimit"]){
+        cdcRangeParam(ch["backLimit"], 1, 200, &val) ? gloConfig->meter[i].backCLim = val : result["CH"+String(i+1)]["backLimit"] = "out of range";
+      }
+      //0 disables the voltage and power alerts
+      if(!ch["uvLimit"].isNull()){
+        (cdcRangeParam(ch["uvLimit"], 0, 0, &val) || cdcRangeParam(ch["uvLimit"], UV_LIM_MIN, UV_LIM_MAX, &val)) ? gloConfig->meter[i].uvLim = val : result["CH"+String(i+1)]["uvLimit"] = "out of range";
       }
-      if(params["CH"+String(i+1)]["fwdLimit"]){
-        uint16_t inx = params["CH"+String(i+1)]["fwdLimit"].as<unsigned int>();
-        (inx >= 100 && inx <= 2000) ? gloConfig->meter[i].fwdCLim = inx : result["CH"+String(i+1)]["fwdLimit"] = "out of range";
+      if(!ch["ovLimit"].isNull()){
+        (cdcRangeParam(ch["ovLimit"], 0, 0, &val) || cdcRangeParam(ch["ovLimit"], OV_LIM_MIN, OV_LIM_MAX, &val)) ? gloConfig->meter[i].ovLim = val : result["CH"+String(i+1)]["ovLimit"] = "out of range";
       }
-      if(params["CH"+String(i+1)]["backLimit"]){
-        uint16_t inx = params["CH"+String(i+1)]["backLimit"].as<unsigned int>();
-        (inx >= 1 && inx <= 200) ? gloConfig->meter[i].backCLim = inx : result["CH"+String(i+1)]["backLimit"] = "out of range";
+      if(!ch["opLimit"].isNull()){
+        (cdcRangeParam(ch["opLimit"], 0, 0, &val) || cdcRangeParam(ch["opLimit"], OP_LIM_MIN, OP_LIM_MAX, &val)) ? gloConfig->meter[i].opLim = val : result["CH"+String(i+1)]["opLimit"] = "out of range";
       }
 
-      if(params["CH"+String(i+1)]["fwdAlert"]){
-        int inx = getEnumIndex(params["CH"+String(i+1)]["fwdAlert"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      if(ch["fwdAlert"]){
+        int inx = cdcEnumParam(ch["fwdAlert"],t_bool,ARR_SIZE(t_bool));
         inx != -1 ? gloState->meter[i].fwdAlertSet = inx : result["CH"+String(i+1)]["fwdAlert"] = "fail";        
       }
-      if(params["CH"+String(i+1)]["backAlert"]){
-        int inx = getEnumIndex(params["CH"+String(i+1)]["backAlert"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      if(ch["backAlert"]){
+        int inx = cdcEnumParam(ch["backAlert"],t_bool,ARR_SIZE(t_bool));
         inx != -1 ? gloState->meter[i].backAlertSet = inx : result["CH"+String(i+1)]["backAlert"] = "fail";        
       }
-      if(params["CH"+String(i+1)]["shortAlert"]){
-        int inx = getEnumIndex(params["CH"+String(i+1)]["shortAlert"].as<const char*>(),t_bool,ARR_SIZE(t_bool));
+      if(ch["shortAlert"]){
+        int inx = cdcEnumParam(ch["shortAlert"],t_bool,ARR_SIZE(t_bool));
         inx != -1 ? gloState->baseMCUIn[i].fault = inx : result["CH"+String(i+1)]["shortAlert"] = "fail";        
       }          
       
-      if(params["CH"+String(i+1)]["numDev"]){
-        uint8_t inx = params["CH"+String(i+1)]["numDev"].as<unsigned int>();
-        (inx >= 0 && inx <= 11) ? gloState->usbInfo[i].numDev = inx : result["CH"+String(i+1)]["numDev"] = "out of range";
+      if(ch["numDev"]){
+        cdcRangeParam(ch["numDev"], 0, 11, &val) ? gloState->usbInfo[i].numDev = val : result["CH"+String(i+1)]["numDev"] = "out of range";
       }
-      if(params["CH"+String(i+1)]["Dev1_name"]){
-        gloState->usbInfo[i].Dev1_Name = params["CH"+String(i+1)]["Dev1_name"].as<String>();        
+      if(ch["Dev1_name"]){
+        gloState->usbInfo[i].Dev1_Name = ch["Dev1_name"].as<String>();        
+        flexLayoutParse(ch["Dev1_name"], &gloState->usbInfo[i].flex);
       }
-      if(params["CH"+String(i+1)]["Dev2_name"]){
-        gloState->usbInfo[i].Dev2_Name = params["CH"+String(i+1)]["Dev2_name"].as<String>();        
+      if(ch["Dev2_name"]){
+        gloState->usbInfo[i].Dev2_Name = ch["Dev2_name"].as<String>();        
       }
-      if(params["CH"+String(i+1)]["usbType"]){
-        uint8_t inx = params["CH"+String(i+1)]["usbType"].as<unsigned int>();
-        (inx >= 0 && inx <= 3) ? gloState->usbInfo[i].usbType = inx : result["CH"+String(i+1)]["usbType"] = "out of range";
+      if(ch["usbType"]){
+        cdcRangeParam(ch["usbType"], 0, 3, &val) ? gloState->usbInfo[i].usbType = val : result["CH"+String(i+1)]["usbType"] = "out of range";
       }
 
     }
@@ -402,26 +387,51 @@ void processJsonRpcMessage(const char* jsonString) {
       if(pName == "pacRev"    || all || state)
         result["pacRev"]      = String(gloState->system.pacRevisionID);
 
+      //event log is only sent on explicit request, not with "all"
+      if(pName == "events")
+        eventLogToJson(result["events"].to<JsonArray>(), 0);
+      if(pName == "boot")
+        bootToJson(result["boot"].to<JsonObject>());
+      if(pName == "i2c")
+        i2cHealthToJson(result["i2c"].to<JsonObject>());
+      if(pName == "screen")
+        defaultViewToJson(result["screen"].to<JsonArray>());
+      if(pName == "capture")
+        cdcCaptureToJson(result["capture"].to<JsonObject>());
+      if(pName == "tasks")
+        taskProfToJson(result["tasks"].to<JsonObject>());
+      if(pName == "signatures")
+        powerSigToJson(result["signatures"].to<JsonObject>());
+
       for(int i = 0; i<3; i++){
         if (pName == "CH"+String(i+1) || pName == "CH"+String(i+1)+"_all"){
-          result["CH"+String(i+1)]["voltage"]     = String(gloState->meter[i].AvgVoltage,1);
-          result["CH"+String(i+1)]["current"]     = String(gloState->meter[i].AvgCurrent,1);
+          result["CH"+String(i+1)]["voltage"]     = String(gloState->meter[i].AvgVoltageUv / 1000.0f,1);
+          result["CH"+String(i+1)]["current"]     = String(gloState->meter[i].AvgCurrentUa / 1000.0f,1);
           result["CH"+String(i+1)]["fwdAlert"]    = gloState->meter[i].fwdAlertSet;
           result["CH"+String(i+1)]["backAlert"]   = gloState->meter[i].backAlertSet;
           result["CH"+String(i+1)]["shortAlert"]  = gloState->baseMCUIn[i].fault;          
+          result["CH"+String(i+1)]["sagAlert"]    = gloState->meter[i].sagAlert;
+          result["CH"+String(i+1)]["ovAlert"]     = gloState->meter[i].ovAlert;
+          result["CH"+String(i+1)]["opAlert"]     = gloState->meter[i].opAlert;
           result["CH"+String(i+1)]["dataEn"]      = gloState->baseMCUOut[i].data_en;
           result["CH"+String(i+1)]["powerEn"]     = gloState->baseMCUOut[i].pwr_en;
         }
         if(pName == "CH"+String(i+1)+"_all"){
+          result["CH"+String(i+1)]["power"]       = String(gloState->meter[i].AvgPowerUw / 1000.0f,1);
           result["CH"+String(i+1)]["ilim"]        = gloState->baseMCUOut[i].ilim;
           result["CH"+String(i+1)]["startup_cnt"] = gloState->startup[i].startup_cnt;
           result["CH"+String(i+1)]["startup_tmr"] = gloConfig->startup[i].startup_timer;
           result["CH"+String(i+1)]["fwdLimit"]    = gloConfig->meter[i].fwdCLim;
           result["CH"+String(i+1)]["backLimit"]   = gloConfig->meter[i].backCLim;
+          result["CH"+String(i+1)]["uvLimit"]     = gloConfig->meter[i].uvLim;
+          result["CH"+String(i+1)]["ovLimit"]     = gloConfig->meter[i].ovLim;
+          result["CH"+String(i+1)]["opLimit"]     = gloConfig->meter[i].opLim;
           result["CH"+String(i+1)]["numDev"]      = gloState->usbInfo[i].numDev;
           result["CH"+String(i+1)]["Dev1_name"]   = gloState->usbInfo[i].Dev1_Name;
           result["CH"+String(i+1)]["Dev2_name"]   = gloState->usbInfo[i].Dev2_Name;
           result["CH"+String(i+1)]["usbType"]     = gloState->usbInfo[i].usbType;
+          result["CH"+String(i+1)]["sigLabel"]    = gloState->powerSig[i].label;
+          result["CH"+String(i+1)]["sigAnomaly"]  = gloState->powerSig[i].anomaly;
         } 
 
       }
@@ -441,25 +451,22 @@ void sendJsonResponse(int id, JsonVariant result) {
 
   String response;
   serializeJson(doc, response);
-  usbSerial.println(response);
-  usbSerial.flush();
+  cdcPrintln(response.c_str(), response.length());
+  bootMark(BOOT_MARK_FIRST_CDC);
 }
 
 void printErr(String err){
   
-  usbSerial.println(err);
-  usbSerial.flush();
+  cdcPrintln(err.c_str(), err.length());
   ESP_LOGI(TAG," %s", err.c_str());
 }
 
-int getEnumIndex(const char* name, const char* const* array, int size) {
-  for (int i = 0; i < size; ++i) {
-      //ESP_LOGI(TAG,"size: %u, name: %s, array: %s, i: %u", size,name,array[i],i);
-      if (strcmp(array[i], name) == 0) {
-          return i;
-      }
-  }
-  return -1; // Return -1 if not found
+//Every line to the host goes through here so the capture sees it
+static void cdcPrintln(const char* line, size_t len){
+  cdcCaptureAdd(CDC_CAP_OUT, line, len);
+  usbSerial.write((const uint8_t*)line, len);
+  usbSerial.println();
+  usbSerial.flush();
 }
 
 //Handlers for TinyUSB events when working in CDC mode
@@ -512,10 +519,11 @@ static void usbEventCallback(void* arg, esp_event_base_t event_base, int32_t eve
       case ARDUINO_USB_CDC_RX_EVENT:
         //ESP_LOGV(TAG,"CDC RX [%u]:", data->rx.len);
         {
-            //uint8_t buf[data->rx.len]; //redundant- left for reference
-
-            rawBufIndex = usbSerial.read(rawBuffer,data->rx.len);
-            onSerialDataReceived();
+            //rx.len can be larger than one chunk, read everything available
+            uint8_t rx[CDC_RX_CHUNK];
+            size_t n;
+            while ((n = usbSerial.read(rx, sizeof(rx))) > 0)
+              onSerialDataReceived(rx, n);
 
             USBSerialActivity=true;
             gloState->features.pcConnected = true;
@@ -20,11 +20,14 @@
 #include <HardwareSerial.h>
 #include "USB.h"
 #include "datatypes.h"
+#include "EventLog.h"
+#include "PowerSignature.h"
+#include "Boot.h"
+#include "I2CHealth.h"
 #include <ArduinoJson.h>
 
 #define PC_CONNECTION_TIMEOUT   2500
 #define SERIAL_CHECK_PERIOD     50         
-#define MAX_BUFFER_SIZE         1024
 #define DISPLAY_CLEAR_AFTER_TIMEOUT  2000
 
 #define ARR_SIZE(arr) (sizeof(arr) / sizeof(arr[0]))
@@ -0,0 +1,128 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Rich text layout parsing and measuring
+
+#include "FlexLayout.h"
+#include "monofonto30.h"
+
+#define FLEX_FONT monofonto30
+
+static int flexEnumIndex(const char* name, const char* const* array, int size){
+  if (name == nullptr) return -1;
+  for (int i = 0; i < size; i++) {
+    if (strcmp(array[i], name) == 0) return i;
+  }
+  return -1;
+}
+
+//Fills layout from the Dev1_name value, either a nested object or a JSON string.
+//Anything else leaves an empty layout. seq only changes with the content, so
+//resending the same labels does not redraw the screen.
+bool flexLayoutParse(JsonVariantConst src, FlexLayout* layout){
+  JsonDocument doc;
+  JsonObjectConst root;
+  FlexLayout parsed;
+  bool ok = false;
+
+  memset(&parsed, 0, sizeof(parsed));
+
+  if (src.is<JsonObjectConst>()) {
+    root = src.as<JsonObjectConst>();
+  } else {
+    const char* str = src.as<const char*>();
+    if (str != nullptr && str[0] == '{' && !deserializeJson(doc, str))
+      root = doc.as<JsonObjectConst>();
+  }
+
+  if (!root.isNull()) {
+    uint8_t color = FLEX_COLOR_WHITE;
+    char key[4];
+
+    for (uint8_t n = 0; n < FLEX_MAX_LINES; n++) {
+      snprintf(key, sizeof(key), "T%u", n + 1);
+      JsonObjectConst t = root[key].as<JsonObjectConst>();
+      if (t.isNull()) break;
+
+      FlexLine &l = parsed.line[n];
+      strlcpy(l.txt, t["txt"] | "", sizeof(l.txt));
+
+      int c = flexEnumIndex(t["color"].as<const char*>(), t_flexColor, sizeof(t_flexColor) / sizeof(t_flexColor[0]));
+      if (c >= 0) color = c;
+      l.color = color;
+
+      int a = flexEnumIndex(t["align"].as<const char*>(), t_flexAlign, sizeof(t_flexAlign) / sizeof(t_flexAlign[0]));
+      l.align = a >= 0 ? a : FLEX_ALIGN_CENTER;
+
+      l.width = flexTextWidth(l.txt);
+      parsed.numLines = n + 1;
+    }
+    parsed.scrollMs = root["scroll"] | FLEX_SCROLL_PERIOD;
+    ok = parsed.numLines > 0;
+  }
+
+  parsed.seq = layout->seq;
+  if (memcmp(&parsed, layout, sizeof(parsed)) != 0) {
+    parsed.seq = layout->seq + 1;
+    *layout = parsed;
+  }
+  return ok;
+}
+
+//First visible line at time now
+uint8_t flexLayoutTop(const FlexLayout* layout, unsigned long now){
+  if (layout->numLines <= FLEX_VISIBLE_LINES || layout->scrollMs == 0) return 0;
+  return (now / layout->scrollMs) % (layout->numLines - FLEX_VISIBLE_LINES + 1);
+}
+
+static uint32_t fontRead32(const uint8_t* p){
+  return ((uint32_t)pgm_read_byte(p) << 24) | ((uint32_t)pgm_read_byte(p + 1) << 16) |
+         ((uint32_t)pgm_read_byte(p + 2) << 8) | pgm_read_byte(p + 3);
+}
+
+//Width of txt drawn with the flex font, same metrics TFT_eSPI uses for smooth
+//fonts (glyph advance, space and missing glyph widths). The vlw header is 24
+//bytes followed by 28 byte glyph records sorted by code point.
+uint16_t flexTextWidth(const char* txt){
+  const uint8_t* font = FLEX_FONT;
+  uint32_t gCount = fontRead32(font);
+  uint32_t space = (fontRead32(font + 16) + fontRead32(font + 20)) * 2 / 7;
+  uint16_t width = 0;
+  const uint8_t* s = (const uint8_t*)txt;
+
+  while (*s) {
+    uint32_t code = *s++;
+    //UTF-8 sequences of 2 and 3 bytes, as decoded by TFT_eSPI
+    if ((code & 0xE0) == 0xC0 && (*s & 0xC0) == 0x80) {
+      code = ((code & 0x1F) << 6) | (*s++ & 0x3F);
+    } else if ((code & 0xF0) == 0xE0 && (s[0] & 0xC0) == 0x80 && (s[1] & 0xC0) == 0x80) {
+      code = ((code & 0x0F) << 12) | ((s[0] & 0x3F) << 6) | (s[1] & 0x3F);
+      s += 2;
+    }
+
+    if (code == ' ') { width += space; continue; }
+
+    int32_t lo = 0, hi = (int32_t)gCount - 1;
+    int32_t advance = -1;
+    while (lo <= hi) {
+      int32_t mid = (lo + hi) / 2;
+      const uint8_t* g = font + 24 + mid * 28;
+      uint32_t u = fontRead32(g);
+      if (u == code) { advance = fontRead32(g + 12); break; }
+      if (u < code) lo = mid + 1;
+      else hi = mid - 1;
+    }
+    width += advance >= 0 ? advance : space + 1;
+  }
+  return width;
+}
@@ -0,0 +1,70 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Rich text layout of the ports with many devices (numDev 10). The JSON sent by the
+//Enumeration extraction agent in Dev1_name is parsed once when it arrives, the
+//screen only walks the preallocated lines.
+//
+//Schema: {"T1":{"txt":"..","align":"left|right|center","color":"YELLOW"},...,"T8":{..},"scroll":ms}
+//Lines are read from T1 up to the first missing one. When there are more lines than
+//fit in the device box they scroll, one line every "scroll" ms (0 = no scrolling).
+//A line without a known color keeps the color of the previous one.
+
+#ifndef FLEXLAYOUT_H
+#define FLEXLAYOUT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define FLEX_MAX_LINES      8
+#define FLEX_LINE_CHARS     14   //bytes per line, longer texts are cut
+#define FLEX_VISIBLE_LINES  3
+#define FLEX_SCROLL_PERIOD  2000 //ms per line by default
+
+#define FLEX_ALIGN_CENTER 0
+#define FLEX_ALIGN_LEFT   1
+#define FLEX_ALIGN_RIGHT  2
+
+static const char* t_flexAlign[] = {"center","left","right"};
+
+#define FLEX_COLOR_WHITE    0
+#define FLEX_COLOR_YELLOW   1
+#define FLEX_COLOR_ORANGE   2
+#define FLEX_COLOR_BLACK    3
+#define FLEX_COLOR_RED      4
+#define FLEX_COLOR_DARKGREY 5
+#define FLEX_COLOR_CYAN     6
+#define FLEX_COLOR_BLUE     7
+#define FLEX_COLOR_GREEN    8
+
+static const char* t_flexColor[] = {"WHITE","YELLOW","ORANGE","BLACK","RED","DARKGREY","CYAN","BLUE","GREEN"};
+
+struct FlexLine {
+  char txt[FLEX_LINE_CHARS + 1];
+  uint8_t color;   //FLEX_COLOR_x
+  uint8_t align;   //FLEX_ALIGN_x
+  uint16_t width;  //pixels with the flex font
+};
+
+struct FlexLayout {
+  uint8_t numLines;
+  uint16_t scrollMs;
+  uint16_t seq;    //incremented on every content change
+  FlexLine line[FLEX_MAX_LINES];
+};
+
+bool flexLayoutParse(JsonVariantConst src, FlexLayout* layout);
+uint8_t flexLayoutTop(const FlexLayout* layout, unsigned long now);
+uint16_t flexTextWidth(const char* txt);
+
+#endif //FLEXLAYOUT_H
@@ -0,0 +1,146 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//4 bit palettized frame sprite, RGB565 to palette mapping
+
+#include "FrameSprite.h"
+
+bool FrameSprite::begin(int16_t w, int16_t h, const uint16_t *pal){
+  setColorDepth(4);
+  if (createSprite(w, h) == nullptr) return false;
+  setPalette(pal);
+  fillSprite(TFT_BLACK);
+  return true;
+}
+
+void FrameSprite::setPalette(const uint16_t *pal){
+  createPalette(pal, FRAME_PALETTE_SIZE);
+  lastColor = _colorMap[0];
+  lastIndex = 0;
+  for (int i = 0; i < 256; i++) {
+    lut332[i] = colorIndex(RGB332_to_RGB565(i));
+  }
+}
+
+//Exact match first, otherwise the closest entry with a green weighted distance
+uint8_t FrameSprite::colorIndex(uint32_t color){
+  uint16_t c = (uint16_t)color;
+  if (c == lastColor) return lastIndex;
+
+  int32_t r = (c >> 8) & 0xF8;
+  int32_t g = (c >> 3) & 0xFC;
+  int32_t b = (c << 3) & 0xF8;
+  uint32_t best = UINT32_MAX;
+  uint8_t index = 0;
+
+  for (uint8_t i = 0; i < FRAME_PALETTE_SIZE; i++) {
+    uint16_t p = _colorMap[i];
+    if (p == c) { index = i; break; }
+    int32_t dr = r - ((p >> 8) & 0xF8);
+    int32_t dg = g - ((p >> 3) & 0xFC);
+    int32_t db = b - ((p << 3) & 0xF8);
+    uint32_t d = 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+    if (d < best) { best = d; index = i; }
+  }
+
+  lastColor = c;
+  lastIndex = index;
+  return index;
+}
+
+//Raw index write for the blitters, clipped to the sprite
+void FrameSprite::writeIndex(int32_t x, int32_t y, uint8_t index){
+  if (x < 0 || y < 0 || x >= _iwidth || y >= _iheight) return;
+  uint8_t *p = _img4 + ((x + y * _iwidth) >> 1);
+  if (x & 0x01) *p = (*p & 0xF0) | (index & 0x0F);
+  else          *p = (*p & 0x0F) | (index << 4);
+}
+
+//Images from the Enumeration extraction agent: 4 bpp are palette indexes,
+//8 bpp RGB332 and 16 bpp RGB565 (MSB first) are mapped to the palette
+void FrameSprite::pushImageMapped(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *data, uint8_t bpp){
+  if (data == nullptr) return;
+  for (int32_t j = 0; j < h; j++) {
+    for (int32_t i = 0; i < w; i++) {
+      int32_t n = i + j * w;
+      uint8_t index;
+      if (bpp == 4)       index = (n & 0x01) ? data[n >> 1] & 0x0F : data[n >> 1] >> 4;
+      else if (bpp == 8)  index = lut332[data[n]];
+      else if (bpp == 16) index = colorIndex((data[n * 2] << 8) | data[n * 2 + 1]);
+      else return;
+      writeIndex(x + i, y + j, index);
+    }
+  }
+}
+
+void FrameSprite::drawPixel(int32_t x, int32_t y, uint32_t color){
+  if (mapped) { TFT_eSprite::drawPixel(x, y, color); return; }
+  mapped = true;
+  TFT_eSprite::drawPixel(x, y, colorIndex(color));
+  mapped = false;
+}
+
+void FrameSprite::drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color){
+  if (mapped) { TFT_eSprite::drawLine(xs, ys, xe, ye, color); return; }
+  mapped = true;
+  TFT_eSprite::drawLine(xs, ys, xe, ye, colorIndex(color));
+  mapped = false;
+}
+
+void FrameSprite::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color){
+  if (mapped) { TFT_eSprite::drawFastVLine(x, y, h, color); return; }
+  mapped = true;
+  TFT_eSprite::drawFastVLine(x, y, h, colorIndex(color));
+  mapped = false;
+}
+
+void FrameSprite::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color){
+  if (mapped) { TFT_eSprite::drawFastHLine(x, y, w, color); return; }
+  mapped = true;
+  TFT_eSprite::drawFastHLine(x, y, w, colorIndex(color));
+  mapped = false;
+}
+
+void FrameSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color){
+  if (mapped) { TFT_eSprite::fillRect(x, y, w, h, color); return; }
+  mapped = true;
+  TFT_eSprite::fillRect(x, y, w, h, colorIndex(color));
+  mapped = false;
+}
+
+void FrameSprite::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size){
+  if (mapped) { TFT_eSprite::drawChar(x, y, c, color, bg, size); return; }
+  mapped = true;
+  TFT_eSprite::drawChar(x, y, c, colorIndex(color), colorIndex(bg), size);
+  mapped = false;
+}
+
+void FrameSprite::fillSprite(uint32_t color){
+  if (mapped) { TFT_eSprite::fillSprite(color); return; }
+  mapped = true;
+  TFT_eSprite::fillSprite(colorIndex(color));
+  mapped = false;
+}
+
+uint16_t FrameSprite::RGB332_to_RGB565(uint8_t rgb332) {
+    uint8_t r = (rgb332 >> 5) & 0x07;  // Extract 3-bit Red
+    uint8_t g = (rgb332 >> 2) & 0x07;  // Extract 3-bit Green
+    uint8_t b = (rgb332 >> 0) & 0x03;  // Extract 2-bit Blue
+
+    // Convert to full 8-bit values and then to RGB565 format
+    r = (r * 255) / 7;  
+    g = (g * 255) / 7;
+    b = (b * 255) / 3;
+
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
@@ -0,0 +1,56 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//4 bit palettized sprite used as the resident frame buffer of one display.
+//Drawing functions keep taking RGB565 colors, they are mapped to the closest
+//entry of the 16 color palette, so the rendering code works unchanged.
+
+#ifndef FRAMESPRITE_H
+#define FRAMESPRITE_H
+
+#include <Arduino.h>
+#include "TFT_eSPI.h"
+
+#define FRAME_PALETTE_SIZE 16
+
+class FrameSprite : public TFT_eSprite {
+  public:
+    FrameSprite(TFT_eSPI *tft) : TFT_eSprite(tft) {}
+
+    bool begin(int16_t w, int16_t h, const uint16_t *pal);
+    void setPalette(const uint16_t *pal);
+    uint8_t colorIndex(uint32_t color);
+    uint8_t color332Index(uint8_t color) { return lut332[color]; }
+    void writeIndex(int32_t x, int32_t y, uint8_t index);
+    void pushImageMapped(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *data, uint8_t bpp);
+
+    //RGB565 entry points of TFT_eSprite, remapped to palette indexes
+    using TFT_eSprite::drawChar;
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+    void drawLine(int32_t xs, int32_t ys, int32_t xe, int32_t ye, uint32_t color) override;
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override;
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size) override;
+    void fillSprite(uint32_t color);
+
+    static uint16_t RGB332_to_RGB565(uint8_t rgb332);
+
+  private:
+    uint8_t  lut332[256];    //RGB332 (icon atlas, 8 bit images) to palette index
+    uint16_t lastColor = 0;  //single entry cache, fills and text repeat the same color
+    uint8_t  lastIndex = 0;
+    bool     mapped = false; //set while TFT_eSprite runs, its internal calls already carry indexes
+};
+
+#endif //FRAMESPRITE_H
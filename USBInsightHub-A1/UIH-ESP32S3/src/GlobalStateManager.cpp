@@ -99,6 +99,7 @@ void globalStateInitializer(GlobalState *globalState, GlobalConfig *globalConfig
 
     globalState->system.currentView = globalConfig->features.startView;
     globalState->system.saveMCUState = false;
+    globalState->system.savePowerSig = false;
     globalState->system.APSSID = "";
     globalState->system.congigChangedToMenu = false;
     globalState->system.configChangedFromMenu = false;
@@ -113,6 +114,7 @@ void globalStateInitializer(GlobalState *globalState, GlobalConfig *globalConfig
     globalState->system.pacRevisionID = 0xFF; //means no revision ID available
     globalState->system.showVersionChangeSplash = false;
     globalState->system.updateState = 0; //default state is idle
+    globalState->system.updateProgress = 0;
     globalState->system.internalErrFlags = 0; //no internal errors
 
     //---Features
@@ -133,16 +135,25 @@ void globalStateInitializer(GlobalState *globalState, GlobalConfig *globalConfig
         globalState->startup[i].startup_cnt = 0;
         
         //---Meter
-        globalState->meter[i].AvgVoltage = 0;
-        globalState->meter[i].AvgCurrent = 0;
+        globalState->meter[i].AvgVoltageUv = 0;
+        globalState->meter[i].AvgCurrentUa = 0;
+        globalState->meter[i].AvgPowerUw = 0;
         globalState->meter[i].backAlertSet = false;
         globalState->meter[i].fwdAlertSet = false; 
+        globalState->meter[i].sagAlert = false;
+        globalState->meter[i].ovAlert = false;
+        globalState->meter[i].opAlert = false;
         
         //---USB Info
         globalState->usbInfo[i].numDev = 0;
         globalState->usbInfo[i].Dev1_Name ="-";
         globalState->usbInfo[i].Dev2_Name ="-";
         globalState->usbInfo[i].usbType = 0;
+        memset(&globalState->usbInfo[i].flex, 0, sizeof(FlexLayout));
+
+        globalState->powerSig[i].label[0] = '\0';
+        globalState->powerSig[i].distance = 0xFFFF;
+        globalState->powerSig[i].anomaly = false;
 
 
 
@@ -202,7 +213,10 @@ void setDefaultGlobalConfig(GlobalState *globalState, GlobalConfig *globalConfig
         globalConfig->screen[i].brightness = 800;  
 
         globalConfig->meter[i].backCLim = 20; //mA
-        globalConfig->meter[i].fwdCLim = 1000; //mA        
+        globalConfig->meter[i].fwdCLim = 1000; //mA
+        globalConfig->meter[i].uvLim = 4400; //mV
+        globalConfig->meter[i].ovLim = 5500; //mV
+        globalConfig->meter[i].opLim = 10000; //mW        
 
         globalState->baseMCUOut[i].ilim = ILIM_1_0;
         globalState->baseMCUOut[i].data_en = true;
@@ -241,6 +255,10 @@ void taskConfigAutoSave(void *pvParameters){
             saveMCUState();
             globlState->system.saveMCUState = false;
         }
+        if(globlState->system.savePowerSig){
+            globlState->system.savePowerSig = false;
+            powerSigSave();
+        }
 
         //check if it is needed to reset to defaults
         if(globlState->system.resetToDefault != 0){
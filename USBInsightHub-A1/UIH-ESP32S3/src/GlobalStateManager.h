@@ -27,6 +27,7 @@
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 #include "blobdata.h"
+#include "PowerSignature.h"
 
 #define UIH_NAMESPACE "uih-nvm-1"
 #define MEM_INITIALIZED_NUM 55
@@ -0,0 +1,236 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Board to board I2C bus statistics, recovery and clock management
+
+#include "I2CHealth.h"
+#include "EventLog.h"
+
+static const char* TAG = "I2CHealth";
+
+static const char* t_i2cDev[I2C_DEV_COUNT] = {"baseMCU","meter"};
+static const char* t_i2cBus[] = {"ok","degraded","stuck"};
+static const uint32_t i2cClocks[] = {400000, 100000, 50000};
+#define I2C_CLOCK_STEPS (sizeof(i2cClocks) / sizeof(i2cClocks[0]))
+
+static TwoWire *hWire = NULL;
+static uint8_t hSda = 0;
+static uint8_t hScl = 0;
+static uint8_t clockStep = 0;
+static uint8_t busState = I2C_BUS_OK;
+
+static I2CDevStats devStats[I2C_DEV_COUNT];
+static uint32_t recoveries = 0;
+static uint32_t recoverFails = 0;
+static uint32_t clockDowns = 0;
+static uint32_t clockUps = 0;
+
+//current window and failure run
+static uint32_t winStart = 0;
+static uint32_t winOps = 0;
+static uint32_t winErrs = 0;
+static uint8_t cleanWindows = 0;
+static uint8_t failRun = 0;
+static bool sdaStuck = false;
+
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+void i2cHealthInit(TwoWire *wire, uint8_t sda, uint8_t scl, uint32_t clock){
+  hWire = wire;
+  hSda  = sda;
+  hScl  = scl;
+  clockStep = 0;
+  for(int i=0; i<(int)I2C_CLOCK_STEPS; i++)
+    if(i2cClocks[i] >= clock) clockStep = i;
+  memset(devStats, 0, sizeof(devStats));
+  winStart = millis();
+}
+
+static void i2cCount(uint8_t dev, uint32_t I2CDevStats::*field){
+  if(dev >= I2C_DEV_COUNT) return;
+  portENTER_CRITICAL(&statsMux);
+  devStats[dev].*field += 1;
+  portEXIT_CRITICAL(&statsMux);
+}
+
+static void i2cOk(uint8_t dev){
+  i2cCount(dev, &I2CDevStats::ok);
+  winOps++;
+  failRun = 0;
+}
+
+static void i2cFail(uint8_t dev, uint32_t I2CDevStats::*field){
+  i2cCount(dev, field);
+  winOps++;
+  winErrs++;
+  if(failRun < 0xFF) failRun++;
+  //a device holding SDA low makes every later transaction fail, free it right away
+  if(digitalRead(hSda) == LOW) sdaStuck = true;
+}
+
+uint8_t i2cHealthWrite(uint8_t dev, uint8_t wireErr){
+  if(hWire == NULL) return wireErr == 0 ? I2C_RES_OK : I2C_RES_FAIL;
+  switch(wireErr){
+    case 0:  i2cOk(dev); return I2C_RES_OK;
+    case 2:
+    case 3:  i2cFail(dev, &I2CDevStats::nack);    break;
+    case 5:  i2cFail(dev, &I2CDevStats::timeout); break;
+    default: i2cFail(dev, &I2CDevStats::arbLost); break;
+  }
+  return I2C_RES_FAIL;
+}
+
+uint8_t i2cHealthRead(uint8_t dev, uint8_t got, uint8_t wanted, uint32_t elapsedMs, uint32_t slowMs){
+  if(hWire == NULL) return got >= wanted ? I2C_RES_OK : I2C_RES_FAIL;
+  if(got >= wanted && elapsedMs <= slowMs){
+    i2cOk(dev);
+    return I2C_RES_OK;
+  }
+
+  if(got >= wanted){
+    //the data is there but the peripheral dropped its speed, setting the clock again restores it
+    i2cFail(dev, &I2CDevStats::slow);
+    hWire->flush();
+    hWire->setClock(100000);
+    hWire->setClock(i2cClocks[clockStep]);
+    return I2C_RES_SLOW;
+  }
+
+  //the Wire driver only reports a byte count for reads, the duration and the
+  //SDA level tell the failures apart
+  if(elapsedMs >= I2C_TIMEOUT_MS)
+    i2cFail(dev, &I2CDevStats::timeout);
+  else if(digitalRead(hSda) == LOW)
+    i2cFail(dev, &I2CDevStats::arbLost);
+  else
+    i2cFail(dev, &I2CDevStats::nack);
+  return I2C_RES_FAIL;
+}
+
+void i2cHealthLockTimeout(uint8_t dev){
+  i2cCount(dev, &I2CDevStats::lockTimeout);
+}
+
+//Clocks out whatever a slave was sending, forces the PAC1943 SMBus timeout and
+//ends with a STOP. Returns true when SDA is released
+static bool i2cRecover(){
+  hWire->end();
+
+  pinMode(hSda, INPUT_PULLUP);
+  pinMode(hScl, OUTPUT_OPEN_DRAIN);
+  digitalWrite(hScl, HIGH);
+  delayMicroseconds(5);
+
+  for(int i=0; i<9 && digitalRead(hSda) == LOW; i++){
+    digitalWrite(hScl, LOW);
+    delayMicroseconds(5);
+    digitalWrite(hScl, HIGH);
+    delayMicroseconds(5);
+  }
+
+  digitalWrite(hScl, LOW);
+  vTaskDelay(pdMS_TO_TICKS(I2C_SMBUS_TIMEOUT_MS));
+
+  //STOP: SDA rises while SCL is high
+  pinMode(hSda, OUTPUT_OPEN_DRAIN);
+  digitalWrite(hSda, LOW);
+  delayMicroseconds(5);
+  digitalWrite(hScl, HIGH);
+  delayMicroseconds(5);
+  digitalWrite(hSda, HIGH);
+  delayMicroseconds(5);
+  bool released = digitalRead(hSda) == HIGH;
+
+  hWire->begin(hSda, hScl, i2cClocks[clockStep]);
+  hWire->setTimeOut(I2C_TIMEOUT_MS);
+  return released;
+}
+
+static void i2cSetClockStep(uint8_t step){
+  clockStep = step;
+  hWire->setClock(i2cClocks[clockStep]);
+  eventLogAdd(EVT_I2C_CLOCK, 0, i2cClocks[clockStep] / 10000, millis());
+  ESP_LOGW(TAG, "Bus clock %u Hz", i2cClocks[clockStep]);
+}
+
+void i2cHealthTick(){
+  if(hWire == NULL) return;
+
+  if(failRun >= I2C_RECOVER_FAILS || sdaStuck){
+    ESP_LOGE(TAG, "Recovering the bus after %u failures%s", failRun, sdaStuck ? ", SDA low" : "");
+    bool released = i2cRecover();
+    portENTER_CRITICAL(&statsMux);
+    recoveries++;
+    if(!released) recoverFails++;
+    portEXIT_CRITICAL(&statsMux);
+    eventLogAdd(EVT_I2C_RECOVER, 0, released ? 1 : 0, millis());
+    failRun  = 0;
+    sdaStuck = false;
+    busState = released ? (clockStep ? I2C_BUS_DEGRADED : I2C_BUS_OK) : I2C_BUS_STUCK;
+  }
+
+  uint32_t now = millis();
+  if(now - winStart < I2C_WINDOW_MS) return;
+
+  if(winErrs >= I2C_DEGRADE_MIN_ERRS && winErrs * 100 >= winOps * I2C_DEGRADE_PCT){
+    cleanWindows = 0;
+    if(clockStep + 1 < (int)I2C_CLOCK_STEPS){
+      i2cSetClockStep(clockStep + 1);
+      clockDowns++;
+    }
+  }
+  else if(winErrs == 0){
+    if(clockStep > 0 && ++cleanWindows >= I2C_RESTORE_WINDOWS){
+      cleanWindows = 0;
+      i2cSetClockStep(clockStep - 1);
+      clockUps++;
+    }
+  }
+  else {
+    cleanWindows = 0;
+  }
+
+  if(busState != I2C_BUS_STUCK || winErrs == 0)
+    busState = clockStep ? I2C_BUS_DEGRADED : I2C_BUS_OK;
+
+  winStart = now;
+  winOps   = 0;
+  winErrs  = 0;
+}
+
+void i2cHealthToJson(JsonObject obj){
+  I2CDevStats st[I2C_DEV_COUNT];
+  uint32_t rec, recFail;
+  portENTER_CRITICAL(&statsMux);
+  memcpy(st, devStats, sizeof(st));
+  rec     = recoveries;
+  recFail = recoverFails;
+  portEXIT_CRITICAL(&statsMux);
+
+  obj["state"]        = t_i2cBus[busState];
+  obj["clock"]        = i2cClocks[clockStep];
+  obj["recoveries"]   = rec;
+  obj["recoverFails"] = recFail;
+  obj["clockDowns"]   = clockDowns;
+  obj["clockUps"]     = clockUps;
+
+  for(int i=0; i<I2C_DEV_COUNT; i++){
+    JsonObject d = obj[t_i2cDev[i]].to<JsonObject>();
+    d["ok"]          = st[i].ok;
+    d["nack"]        = st[i].nack;
+    d["timeout"]     = st[i].timeout;
+    d["arbLost"]     = st[i].arbLost;
+    d["slow"]        = st[i].slow;
+    d["lockTimeout"] = st[i].lockTimeout;
+  }
+}
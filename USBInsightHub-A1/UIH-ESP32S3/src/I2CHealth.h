@@ -0,0 +1,70 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Health of the board to board I2C bus shared by the BaseMCU and the PAC1943.
+//The drivers report the result of every transaction; once per Intercomms cycle
+//i2cHealthTick() frees a stuck bus (9 SCL pulses, SMBus timeout and a STOP)
+//after repeated failures, lowers the clock while the error rate is high and
+//restores it after a quiet period. The bus mutex must be held for every call
+//except i2cHealthLockTimeout() and i2cHealthToJson().
+//Read from serial with {"action":"get","params":["i2c"]} and from /rest/i2cHealth
+
+#ifndef I2CHEALTH_H
+#define I2CHEALTH_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <ArduinoJson.h>
+
+#define I2C_DEV_BMCU   0
+#define I2C_DEV_METER  1
+#define I2C_DEV_COUNT  2
+
+//transaction results
+#define I2C_RES_OK     0
+#define I2C_RES_FAIL   1
+#define I2C_RES_SLOW   2 //completed late, see arduino-esp32 issue 8480
+
+#define I2C_TIMEOUT_MS         20
+#define I2C_RECOVER_FAILS      10   //consecutive failures before freeing the bus
+#define I2C_SMBUS_TIMEOUT_MS   26   //SCL low longer than 25 ms resets the PAC1943 interface
+#define I2C_WINDOW_MS          1000 //error rate window
+#define I2C_DEGRADE_PCT        5    //error rate that lowers the clock one step
+#define I2C_DEGRADE_MIN_ERRS   3
+#define I2C_RESTORE_WINDOWS    30   //clean windows before the clock goes one step up
+
+//bus states
+#define I2C_BUS_OK        0 //full clock
+#define I2C_BUS_DEGRADED  1 //reduced clock
+#define I2C_BUS_STUCK     2 //SDA still low after the last recovery
+
+struct I2CDevStats {
+  uint32_t ok;
+  uint32_t nack;
+  uint32_t timeout;
+  uint32_t arbLost;     //arbitration lost or the bus held low by another device
+  uint32_t slow;
+  uint32_t lockTimeout; //bus mutex not available in time
+};
+
+void i2cHealthInit(TwoWire *wire, uint8_t sda, uint8_t scl, uint32_t clock);
+//Result of an endTransmission() that sent a stop
+uint8_t i2cHealthWrite(uint8_t dev, uint8_t wireErr);
+//Result of a requestFrom(), elapsedMs is the duration of the call
+uint8_t i2cHealthRead(uint8_t dev, uint8_t got, uint8_t wanted, uint32_t elapsedMs, uint32_t slowMs);
+void i2cHealthLockTimeout(uint8_t dev);
+//Recovery and clock management, once per Intercomms cycle
+void i2cHealthTick();
+void i2cHealthToJson(JsonObject obj);
+
+#endif
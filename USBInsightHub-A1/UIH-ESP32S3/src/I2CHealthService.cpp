@@ -0,0 +1,41 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//REST access to the board I2C bus statistics
+
+#include "I2CHealthService.h"
+
+I2CHealthService::I2CHealthService(PsychicHttpServer *server,
+                                   SecurityManager *securityManager) : _server(server),
+                                                                       _securityManager(securityManager)
+{
+}
+
+void I2CHealthService::begin()
+{
+    _server->on(I2C_HEALTH_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&I2CHealthService::i2cHealth, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+
+    ESP_LOGV("I2CHealthService", "Registered GET endpoint: %s", I2C_HEALTH_SERVICE_PATH);
+}
+
+//{"state","clock","recoveries","recoverFails","clockDowns","clockUps",
+// "baseMCU":{"ok","nack","timeout","arbLost","slow","lockTimeout"},"meter":{...}}
+esp_err_t I2CHealthService::i2cHealth(PsychicRequest *request)
+{
+    PsychicJsonResponse response = PsychicJsonResponse(request, false);
+    i2cHealthToJson(response.getRoot());
+    return response.send();
+}
@@ -0,0 +1,38 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//REST access to the board I2C bus statistics. GET /rest/i2cHealth
+
+#ifndef I2CHealthService_h
+#define I2CHealthService_h
+
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+#include "I2CHealth.h"
+
+#define I2C_HEALTH_SERVICE_PATH "/rest/i2cHealth"
+
+class I2CHealthService
+{
+public:
+    I2CHealthService(PsychicHttpServer *server, SecurityManager *securityManager);
+
+    void begin();
+
+private:
+    PsychicHttpServer *_server;
+    SecurityManager *_securityManager;
+    esp_err_t i2cHealth(PsychicRequest *request);
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 
 #include "Intercomms.h"
+#include "TaskProfiler.h"
 
 static const char* TAG = "Intercoms";
 
@@ -41,6 +42,9 @@ uint8_t meterBoardMap[3]={2,0,1};
 //Route the board channels to power meter physical channels
 uint8_t boardMeterMap[3]={1,2,0};
 
+//millis() of the last PAC alert edge
+volatile uint32_t pacAlertMs = 0;
+
 //ADC
 //calibration
 esp_adc_cal_characteristics_t adc_chars;
@@ -48,17 +52,16 @@ uint32_t adc_samples[ADC_NUMSAMPLES];
 int adc_idx = 0;
 uint32_t adc_sum = 0;
 
-//Counts the number of I2C read fails of PAC1943 
-uint8_t i2cErrCnt = 0;
-
 //Internal functions
 void taskIntercomms(void *pvParameters);
 void interMcuWriteAll(void);
 void interMcuReadAll(void);
+void interMcuReadEvents(void);
 void interSetCurrentLimits(void);
 void interAvgMeterRead(void);
+void interArmVoltageAlerts(void);
+void interUpdatePowerAlerts(void);
 float read5Vrail(void);
-void forcePacTimeout();
 
 
 void interPacAlertInterruptHandler(void);
@@ -75,6 +78,8 @@ void iniIntercomms(GlobalState *globalState, GlobalConfig *globalConfig){
     pinMode(MCU_INT,INPUT_PULLUP);
 
     i2c_Semaphore = xSemaphoreCreateMutex();
+    eventLogInit();
+    powerSigInit();
 
     //memcpy(prevMCUConfig,glState->baseMCUOut,sizeof(prevMCUConfig));
     //memcpy(prevMeterConfig,glConfig->meter,sizeof(prevMeterConfig));
@@ -92,10 +97,11 @@ void iniIntercomms(GlobalState *globalState, GlobalConfig *globalConfig){
     if(xSemaphoreTake(i2c_Semaphore,( TickType_t ) 10 ) == pdTRUE)
     {
         I2CB2B.begin(B2B_SDA, B2B_SCL, I2CSPEED);
-        I2CB2B.setTimeOut(20);
+        I2CB2B.setTimeOut(I2C_TIMEOUT_MS);
+        i2cHealthInit(&I2CB2B, B2B_SDA, B2B_SCL, I2CSPEED);
         
             
-        delay(20);
+        bootDelayUntil(BMCU_POWERUP_MS);
         //if(bMCU.begin(&I2CB2B)) ESP_LOGI(TAG, "Base MCU initialized OK");
         if(bMCU.begin(&I2CB2B))
         {
@@ -115,7 +121,7 @@ void iniIntercomms(GlobalState *globalState, GlobalConfig *globalConfig){
         }
           
         
-        delay(30); //required time after powerup to write to meter
+        bootDelayUntil(METER_POWERUP_MS);
         if(bMeter.begin(&I2CB2B)) {
           ESP_LOGI(TAG, "Power Meter initialized OK. Interrupt pin: %s",bMeter.getIntTestResult() ? "OK": "FAIL");
           if(!bMeter.getIntTestResult()){            
@@ -131,7 +137,7 @@ void iniIntercomms(GlobalState *globalState, GlobalConfig *globalConfig){
           glState->system.internalErrFlags |= PAC_INIT_ERR;
         } 
         //clear any interrupt flag
-        uint8_t flags = bMeter.readInterruptFlags();
+        uint32_t flags = bMeter.readInterruptFlags();
         
         xSemaphoreGive(i2c_Semaphore);
 
@@ -170,6 +176,7 @@ void interMcuWriteAll(void){
     } 
     else{
       ESP_LOGE(TAG,"Timeout to write I2C mcu");
+      i2cHealthLockTimeout(I2C_DEV_BMCU);
     }
   }
 }
@@ -184,56 +191,105 @@ void interMcuReadAll(void){
     } 
     else{
       ESP_LOGE(TAG,"Timeout to read I2C mcu");
+      i2cHealthLockTimeout(I2C_DEV_BMCU);
     }
   }
 
 }
 
+//Move the BaseMCU timestamped events to the event log. Their 16 bit ms tick is
+//converted to ESP32 millis() with the BaseMCU tick read in the same burst
+void interMcuReadEvents(void){
+  BaseMCUEvent evt[EVT_FIFO_SIZE];
+  uint16_t now = 0;
+  uint8_t n = 0;
+  bool overflow = bMCU.evtOverflow;
+  uint32_t espNow = millis();
+
+  if(i2c_Semaphore != NULL){
+    if(xSemaphoreTake(i2c_Semaphore,pdMS_TO_TICKS(10)) == pdTRUE){
+      n = bMCU.readEvents(evt, &now);
+      espNow = millis();
+      xSemaphoreGive(i2c_Semaphore);
+    } 
+    else{
+      ESP_LOGE(TAG,"Timeout to read I2C mcu events");
+      i2cHealthLockTimeout(I2C_DEV_BMCU);
+      return;
+    }
+  }
+
+  for(int i=0; i<n; i++){
+    uint16_t age = now - evt[i].tick;
+    eventLogAdd(evt[i].type, evt[i].ch, evt[i].data, espNow - age);
+  }
+  if(overflow && n > 0) eventLogAdd(EVT_LOST, 0, 0, espNow);
+}
+
 void interAvgMeterRead(void){
   if(i2c_Semaphore != NULL){
     if(xSemaphoreTake(i2c_Semaphore,pdMS_TO_TICKS(10)) == pdTRUE){
 
-      //resets I2C bus if read errors persist
-      if(i2cErrCnt > 10){
-        ESP_LOGE(TAG,"Try reset I2C bus after %i PAC1943 read failures",i2cErrCnt);
-        forcePacTimeout();
-        i2cErrCnt = 0;
-      }
+      //frees the bus or changes its clock if errors persist
+      i2cHealthTick();
             
       delayMicroseconds(1000);
       bMeter.readAvgMeter();
+      interArmVoltageAlerts();
       bMeter.refresh(0);        
       xSemaphoreGive(i2c_Semaphore);
 
       if (bMeter.getError()==0){
         glState->system.meterInit = METER_INIT_OK;
-        i2cErrCnt = 0;
       } 
       else if (bMeter.getError()==1){
         glState->system.meterInit = METER_INIT_READ_ERR;
-        i2cErrCnt++;        
       } 
       else if (bMeter.getError()==2) glState->system.meterInit = METER_INIT_SLOW_ERR;
     } 
     else{
       ESP_LOGE(TAG,"Timeout to get access to I2C read meter");
+      i2cHealthLockTimeout(I2C_DEV_METER);
     }
   }  
 }
 
-void forcePacTimeout(){
-  I2CB2B.end();
-  pinMode(B2B_SCL, OUTPUT_OPEN_DRAIN);
-  pinMode(B2B_SDA, OUTPUT_OPEN_DRAIN);
-  digitalWrite(B2B_SDA, HIGH);
-  //delayMicroseconds(5);
-  digitalWrite(B2B_SCL, LOW);
-  vTaskDelay(pdMS_TO_TICKS(26));
-  
-  I2CB2B.begin(B2B_SDA, B2B_SCL, 400000);
-  I2CB2B.setTimeOut(20);  
+
+//UV/OV alerts are armed only on a powered port with VBUS inside the limits, so
+//a switched off port or a lasting fault doesn't keep the alert line low.
+//Called with the I2C lock, the refresh that follows applies the change
+void interArmVoltageAlerts(void){
+  if(bMeter.getError()!=0) return;
+  for(int i=0; i<3; i++){
+    int32_t uv = bMeter.chMeterArr[meterBoardMap[i]].AvgVoltageUv; //this cycle, unfiltered
+    bool on = bMCU.chArr[i].pwr_en;
+    bool armUv = on && glConfig->meter[i].uvLim != 0 &&
+                 uv > ((int32_t)glConfig->meter[i].uvLim + VLIM_ARM_HYST_MV) * 1000;
+    bool armOv = on && glConfig->meter[i].ovLim != 0 &&
+                 uv < ((int32_t)glConfig->meter[i].ovLim - VLIM_ARM_HYST_MV) * 1000;
+    bMeter.setVoltageAlerts(meterBoardMap[i], armUv, armOv);
+  }
 }
 
+//The shunt is wired reversed, the PAC power of a forward load is negative and
+//its OP limit can't trip on it, so over power is checked on the filtered power.
+//Voltage and power flags stay latched until the port is switched off
+void interUpdatePowerAlerts(void){
+  for(int i=0; i<3; i++){
+    MeterState &m = glState->meter[i];
+    if(!glState->baseMCUOut[i].pwr_en){
+      m.sagAlert = false;
+      m.ovAlert = false;
+      m.opAlert = false;
+      continue;
+    }
+    if(glConfig->meter[i].opLim != 0 && !m.opAlert && m.AvgPowerUw > (int32_t)glConfig->meter[i].opLim * 1000){
+      m.opAlert = true;
+      eventLogAdd(EVT_OVER_POWER, i, (uint8_t)min(m.AvgPowerUw / 100000, (int32_t)255), millis());
+      ESP_LOGI(TAG,"Over power on CH %d", i+1);
+    }
+  }
+}
 
 void interSetCurrentLimits(void){
   
@@ -253,12 +309,17 @@ void interSetCurrentLimits(void){
           bMeter.setCurrentLimit(glConfig->meter[i].backCLim, BACKWARD, meterBoardMap[i]);
           ESP_LOGV(TAG,"Back Current %i: %s",i,String(glConfig->meter[i].backCLim));
         }                         
+        if(prevMeterConfig[i].uvLim != glConfig->meter[i].uvLim)
+          bMeter.setVoltageLimit(glConfig->meter[i].uvLim, false, meterBoardMap[i]);
+        if(prevMeterConfig[i].ovLim != glConfig->meter[i].ovLim)
+          bMeter.setVoltageLimit(glConfig->meter[i].ovLim, true, meterBoardMap[i]);
       }
       bMeter.enableAlerts(true);
       xSemaphoreGive(i2c_Semaphore);
     } 
     else{
       ESP_LOGE(TAG,"Timeout I2C to set current on PAC1943");
+      i2cHealthLockTimeout(I2C_DEV_METER);
     }
   }  
 }
@@ -273,7 +334,8 @@ void taskIntercomms(void *pvParameters){
 
     //wait taskDefaultScreenLoop notification to synchronize DISPLAY_REFRESH_PERIOD
     //with actual sampling rate.
-    ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(100));
+    if(ulTaskNotifyTake(pdTRUE,pdMS_TO_TICKS(100)) > 0)
+      taskProfNotifyTaken(TASK_PROF_SCREEN_METER);
 
     timer = millis();
     //handle automatic selection of the hardware current limit based on forward current limit
@@ -332,6 +394,10 @@ void taskIntercomms(void *pvParameters){
     //read bMCU
     interMcuReadAll();  
 
+    //MCU_INT is only a hint, the pending count comes with every readAll
+    if(bMCU.evtPending > 0 || digitalRead(MCU_INT) == LOW)
+      interMcuReadEvents();
+
     //update globalState with bMCU readings only if is not first boot
     if(!bMCU.firstboot){
       for(int i=0; i<3; i++){
@@ -378,18 +444,24 @@ void taskIntercomms(void *pvParameters){
     //read Meter
     
     interAvgMeterRead();
-    //Serial.println("%.2f %.2f %.2f",bMeter.chMeterArr[0].AvgVoltage,bMeter.chMeterArr[1].AvgVoltage,bMeter.chMeterArr[2].AvgVoltage);
-    //Serial.println(String(bMeter.chMeterArr[0].AvgVoltage) +","+String(bMeter.chMeterArr[1].AvgVoltage)+","+String(bMeter.chMeterArr[2].AvgVoltage));
     
     //update globalState Meter IO
     for(int i=0; i<3; i++){
       //Meter Outputs->State 
-      glState->meter[i].AvgCurrent = bMeter.chAverager[meterBoardMap[i]].CurrentAveraged;
-      glState->meter[i].AvgVoltage = bMeter.chAverager[meterBoardMap[i]].VoltageAveraged;
+      glState->meter[i].AvgCurrentUa = bMeter.chAverager[meterBoardMap[i]].CurrentAveragedUa;
+      glState->meter[i].AvgVoltageUv = bMeter.chAverager[meterBoardMap[i]].VoltageAveragedUv;
+      glState->meter[i].AvgPowerUw   = bMeter.chAverager[meterBoardMap[i]].PowerAveragedUw;
       //State->Meter Inputs
       bMeter.chMeterArr[i].backAlertSet = glState->meter[i].backAlertSet;
       bMeter.chMeterArr[i].fwdAlertSet  = glState->meter[i].fwdAlertSet;    
     }    
+    interUpdatePowerAlerts();
+
+    //power signature works on the unfiltered sample of every cycle
+    if(bMeter.getError()==0){
+      for(int i=0; i<3; i++)
+        powerSigSample(glState, i, bMeter.chMeterArr[meterBoardMap[i]].AvgCurrentUa, timer);
+    }
     //ESP_LOGI("I2C","%u",millis()-timer); //----------------------------------
     //this task takes 2 ms
 
@@ -408,8 +480,10 @@ void taskIntercomms(void *pvParameters){
       glState->system.internalErrFlags &= ~VBUS_MONITOR_ERR;
     }
     
-    if(glState->system.taskDefaultScreenLoopHandle != NULL)
+    if(glState->system.taskDefaultScreenLoopHandle != NULL){
+      taskProfNotifyGive(TASK_PROF_METER_SCREEN);
       xTaskNotifyGive(glState->system.taskDefaultScreenLoopHandle);
+    }
     //vTaskDelayUntil(&xLastWakeTime,pdMS_TO_TICKS(INTERCOMMS_PERIOD));
   }
 }
@@ -418,6 +492,7 @@ void interPacAlertInterruptHandler(void){
   //ESP_LOGV(TAG,"PACI");
   BaseType_t xHigherPriorityTaskWoken;
   xHigherPriorityTaskWoken = pdFALSE;
+  pacAlertMs = millis();
   xTaskNotifyFromISR(inter_pac_alert_handle, 0,eNoAction, &xHigherPriorityTaskWoken);
   portYIELD_FROM_ISR( xHigherPriorityTaskWoken);
 }
@@ -440,29 +515,48 @@ void inter_pac_alert_handler_task(void *pvParameters)
           //but the function has not finished with the remaining tasks. 
           while(!digitalRead(PAC_ALERT) && ret_count < CLEAR_ALERT_RETRIES)
           {
-            uint8_t flags = bMeter.readInterruptFlags();
+            uint32_t flags = bMeter.readInterruptFlags();
+            uint32_t mask = bMeter.getAlertMask();
+            bool rearm = false;
             
             for(int i=0; i<3; i++)
             {
+              uint8_t ch = boardMeterMap[i];
               //Over Current flags in upper nibble - backward current
-              if(flags & 0x80){
+              if(flags & PAC_ALERT_OC(i)){
                 bMCU.chArr[boardMeterMap[i]].pwr_en = false;
                 bMeter.chMeterArr[boardMeterMap[i]].backAlertSet = true;
                 glState->meter[boardMeterMap[i]].backAlertSet = true;
+                eventLogAdd(EVT_BACK_ALERT, boardMeterMap[i], 1, millis());
                 ESP_LOGI(TAG,"Back current on CH %s", String(boardMeterMap[i]+1));
               }
               //Under Current flags in lower nibble - forward current
-              if(flags & 0x08){
+              if(flags & PAC_ALERT_UC(i)){
                 bMCU.chArr[boardMeterMap[i]].pwr_en = false;
                 bMeter.chMeterArr[boardMeterMap[i]].fwdAlertSet = true;
                 glState->meter[boardMeterMap[i]].fwdAlertSet = true;
+                eventLogAdd(EVT_FWD_ALERT, boardMeterMap[i], 1, millis());
                 ESP_LOGI(TAG,"Over current on CH %s", String(boardMeterMap[i]+1));
               }
-
-              flags = flags<<1;
+              //VBUS limits, the fired one stays disarmed until VBUS is back inside it.
+              //A port being switched off sags on its way down, that isn't logged
+              if(flags & (PAC_ALERT_UV(i) | PAC_ALERT_OV(i))){
+                bool uv = (flags & PAC_ALERT_UV(i)) != 0;
+                if(bMCU.chArr[ch].pwr_en){
+                  if(uv) glState->meter[ch].sagAlert = true;
+                  else glState->meter[ch].ovAlert = true;
+                  eventLogAdd(uv ? EVT_SAG : EVT_OVER_VOLT, ch,
+                              (uv ? glConfig->meter[ch].uvLim : glConfig->meter[ch].ovLim) / 100, pacAlertMs);
+                  ESP_LOGI(TAG,"%s on CH %d", uv ? "VBUS sag" : "VBUS over voltage", ch+1);
+                }
+                bMeter.setVoltageAlerts(i, (mask & PAC_ALERT_UV(i)) && !(flags & PAC_ALERT_UV(i)),
+                                           (mask & PAC_ALERT_OV(i)) && !(flags & PAC_ALERT_OV(i)));
+                rearm = true;
+              }
             }    
             //turn off affected channels
             bMCU.writeAll(); //Update the registers to take action in bMCU.
+            if(rearm) bMeter.refresh_v();
             //update higher level status
             ret_count++;
           }
@@ -471,7 +565,10 @@ void inter_pac_alert_handler_task(void *pvParameters)
           xSemaphoreGive(i2c_Semaphore);
         } 
         else{
-          ESP_LOGE(TAG,"Timeout to get access to I2C pac alert");
+          //never drop an alert, try again as soon as the bus is free
+          ESP_LOGE(TAG,"Timeout to get access to I2C pac alert, retrying");
+          i2cHealthLockTimeout(I2C_DEV_METER);
+          xTaskNotify(inter_pac_alert_handle, 0, eNoAction);
         }
       }           
     }
@@ -25,10 +25,15 @@ communitcaion between the Main MCU, the BaseMCU and the Power Meter
 #include "PAC194x.h"
 #include "datatypes.h"
 #include "GlobalStateManager.h"
+#include "EventLog.h"
+#include "PowerSignature.h"
+#include "Boot.h"
+#include "I2CHealth.h"
 
 //pin definitions in datatypes.h
 
 #define CLEAR_ALERT_RETRIES 3
+#define VLIM_ARM_HYST_MV 100 //UV/OV alerts are armed again once VBUS is this far inside the limit
 
 #define INTERCOMMS_PERIOD 50 //ms
 
@@ -36,6 +41,10 @@ communitcaion between the Main MCU, the BaseMCU and the Power Meter
 #define DIV5VRATIO 3.21 //22.1k|10.0k
 #define I2CSPEED 400000
 
+//time since power up before the first access, counted from boot and not after the previous stage
+#define BMCU_POWERUP_MS  20
+#define METER_POWERUP_MS 50 //required time after powerup to write to meter
+
 void iniIntercomms(GlobalState *globalState, GlobalConfig *globalConfig);
 
 float read5Vrail();
@@ -42,6 +42,8 @@ static const char *jsonDefault = R"rawliteral(
   "BaseMCU_usb3_mux_sel_pos": false,
   "BaseMCU_base_ver": 0,
   "system_resetToDefault": 0,
+  "system_updateState": 0,
+  "system_updateProgress": 0,
   "c1_startup_counter": 0,
   "c1_startup_conf_timer": 0,
   "c1_meter_voltage": 0,
@@ -50,6 +52,12 @@ static const char *jsonDefault = R"rawliteral(
   "c1_meter_backAlertSet": false,
   "c1_meter_conf_fwdCLim": 1000,
   "c1_meter_conf_backCLim": 20,
+  "c1_meter_sagAlert": false,
+  "c1_meter_ovAlert": false,
+  "c1_meter_opAlert": false,
+  "c1_meter_conf_uvLim": 4400,
+  "c1_meter_conf_ovLim": 5500,
+  "c1_meter_conf_opLim": 10000,
   "c1_USBInfo_numDev": 0,
   "c1_USBInfo_Dev1_Name": "",
   "c1_USBInfo_Dev2_Name": "",
@@ -66,6 +74,12 @@ static const char *jsonDefault = R"rawliteral(
   "c2_meter_backAlertSet": false,
   "c2_meter_conf_fwdCLim": 1000,
   "c2_meter_conf_backCLim": 20,
+  "c2_meter_sagAlert": false,
+  "c2_meter_ovAlert": false,
+  "c2_meter_opAlert": false,
+  "c2_meter_conf_uvLim": 4400,
+  "c2_meter_conf_ovLim": 5500,
+  "c2_meter_conf_opLim": 10000,
   "c2_USBInfo_numDev": 0,
   "c2_USBInfo_Dev1_Name": "",
   "c2_USBInfo_Dev2_Name": "",
@@ -82,6 +96,12 @@ static const char *jsonDefault = R"rawliteral(
   "c3_meter_backAlertSet": false,
   "c3_meter_conf_fwdCLim": 1000,
   "c3_meter_conf_backCLim": 20,
+  "c3_meter_sagAlert": false,
+  "c3_meter_ovAlert": false,
+  "c3_meter_opAlert": false,
+  "c3_meter_conf_uvLim": 4400,
+  "c3_meter_conf_ovLim": 5500,
+  "c3_meter_conf_opLim": 10000,
   "c3_USBInfo_numDev": 0,
   "c3_USBInfo_Dev1_Name": "",
   "c3_USBInfo_Dev2_Name": "",
@@ -170,6 +190,7 @@ void MasterStateService::taskMSS(){
         
         
         gState->system.updateState = _skit->getUpdateState(); //check if an OTA update is in progress
+        gState->system.updateProgress = _skit->getUpdateProgress();
         
         read(masterStateObj,MasterState::read);
         //check if there is a change in the front end controls
@@ -245,6 +266,13 @@ void MasterStateService::copyBackendToGlobal(JsonObject &root){
     gState->meter[i].backAlertSet   = root["c"+String(i+1)+"_meter_backAlertSet" ] | false;
     gConfig->meter[i].fwdCLim         = root["c"+String(i+1)+"_meter_conf_fwdCLim"].as<uint16_t>();
     gConfig->meter[i].backCLim        = root["c"+String(i+1)+"_meter_conf_backCLim"].as<uint16_t>();
+    //same check as the serial set, a value out of range keeps the current one
+    uint16_t uvLim = root["c"+String(i+1)+"_meter_conf_uvLim"] | gConfig->meter[i].uvLim;
+    uint16_t ovLim = root["c"+String(i+1)+"_meter_conf_ovLim"] | gConfig->meter[i].ovLim;
+    uint16_t opLim = root["c"+String(i+1)+"_meter_conf_opLim"] | gConfig->meter[i].opLim;
+    if(LIM_VALID(uvLim, UV_LIM_MIN, UV_LIM_MAX)) gConfig->meter[i].uvLim = uvLim;
+    if(LIM_VALID(ovLim, OV_LIM_MIN, OV_LIM_MAX)) gConfig->meter[i].ovLim = ovLim;
+    if(LIM_VALID(opLim, OP_LIM_MIN, OP_LIM_MAX)) gConfig->meter[i].opLim = opLim;
     //gState->usbInfo[i].numDev       = root["c"+String(i+1)+"_USBInfo_numDev"].as<int>();
     //gState->usbInfo[i].Dev1_Name    = root["c"+String(i+1)+"_USBInfo_Dev1_Name"].as<String>();
     //gState->usbInfo[i].Dev2_Name    = root["c"+String(i+1)+"_USBInfo_Dev2_Name"].as<String>();
@@ -278,6 +306,8 @@ void MasterStateService::copyGlobalToBackend(JsonObject &root){
   root["BaseMCU_usb3_mux_sel_pos"]  = gState->baseMCUExtra.usb3_mux_sel_pos;
   root["BaseMCU_base_ver"]          = gState->baseMCUExtra.base_ver;
   root["system_resetToDefault"]     = gState->system.resetToDefault;
+  root["system_updateState"]        = gState->system.updateState;
+  root["system_updateProgress"]     = gState->system.updateProgress;
   root["features_usbHostState"]     = gState->features.usbHostState;
 
   
@@ -285,12 +315,18 @@ void MasterStateService::copyGlobalToBackend(JsonObject &root){
       
     root["c"+String(i+1)+"_startup_counter"]    = gState->startup[i].startup_cnt;
     root["c"+String(i+1)+"_startup_conf_timer"] = gConfig->startup[i].startup_timer;
-    root["c"+String(i+1)+"_meter_voltage"]      = gState->meter[i].AvgVoltage;
-    root["c"+String(i+1)+"_meter_current"]      = gState->meter[i].AvgCurrent;
+    root["c"+String(i+1)+"_meter_voltage"]      = gState->meter[i].AvgVoltageUv / 1000.0f; //mV
+    root["c"+String(i+1)+"_meter_current"]      = gState->meter[i].AvgCurrentUa / 1000.0f; //mA
     root["c"+String(i+1)+"_meter_fwdAlertSet"]  = gState->meter[i].fwdAlertSet;
     root["c"+String(i+1)+"_meter_backAlertSet"] = gState->meter[i].backAlertSet;
     root["c"+String(i+1)+"_meter_conf_fwdCLim"] = gConfig->meter[i].fwdCLim;
     root["c"+String(i+1)+"_meter_conf_backCLim"] = gConfig->meter[i].backCLim;
+    root["c"+String(i+1)+"_meter_sagAlert"]     = gState->meter[i].sagAlert;
+    root["c"+String(i+1)+"_meter_ovAlert"]      = gState->meter[i].ovAlert;
+    root["c"+String(i+1)+"_meter_opAlert"]      = gState->meter[i].opAlert;
+    root["c"+String(i+1)+"_meter_conf_uvLim"]   = gConfig->meter[i].uvLim;
+    root["c"+String(i+1)+"_meter_conf_ovLim"]   = gConfig->meter[i].ovLim;
+    root["c"+String(i+1)+"_meter_conf_opLim"]   = gConfig->meter[i].opLim;
     root["c"+String(i+1)+"_USBInfo_numDev"]     = gState->usbInfo[i].numDev;
     root["c"+String(i+1)+"_USBInfo_Dev1_Name"]  = gState->usbInfo[i].Dev1_Name;
     root["c"+String(i+1)+"_USBInfo_Dev2_Name"]  = gState->usbInfo[i].Dev2_Name;
@@ -48,6 +48,12 @@ typedef struct
 	bool meter_backAlertSet;
 	uint16_t meter_conf_fwdCLim;
 	uint16_t meter_conf_backCLim;
+	bool meter_sagAlert;
+	bool meter_ovAlert;
+	bool meter_opAlert;
+	uint16_t meter_conf_uvLim;
+	uint16_t meter_conf_ovLim;
+	uint16_t meter_conf_opLim;
 	int USBInfo_numDev;
 	String USBInfo_Dev1_Name;
 	String USBInfo_Dev2_Name;
@@ -90,6 +96,8 @@ public:
     bool BaseMCU_usb3_mux_sel_pos;
     uint8_t BaseMCU_base_ver;
     uint8_t system_resetToDefault;
+    uint8_t system_updateState;
+    uint8_t system_updateProgress;
 
     static void read(MasterState &settings, JsonObject &root)
     {
@@ -114,6 +122,8 @@ public:
         root["BaseMCU_usb3_mux_sel_pos"]    = settings.BaseMCU_usb3_mux_sel_pos;
         root["BaseMCU_base_ver"]            = settings.BaseMCU_base_ver;
         root["system_resetToDefault"]       = settings.system_resetToDefault;
+        root["system_updateState"]          = settings.system_updateState;
+        root["system_updateProgress"]       = settings.system_updateProgress;
         
 
         for(int i =0; i<3; i++){
@@ -126,6 +136,12 @@ public:
             root["c"+String(i+1)+"_meter_backAlertSet"] = settings.chData[i].meter_backAlertSet;
             root["c"+String(i+1)+"_meter_conf_fwdCLim"] = settings.chData[i].meter_conf_fwdCLim;
             root["c"+String(i+1)+"_meter_conf_backCLim"] = settings.chData[i].meter_conf_backCLim;
+            root["c"+String(i+1)+"_meter_sagAlert"]     = settings.chData[i].meter_sagAlert;
+            root["c"+String(i+1)+"_meter_ovAlert"]      = settings.chData[i].meter_ovAlert;
+            root["c"+String(i+1)+"_meter_opAlert"]      = settings.chData[i].meter_opAlert;
+            root["c"+String(i+1)+"_meter_conf_uvLim"]   = settings.chData[i].meter_conf_uvLim;
+            root["c"+String(i+1)+"_meter_conf_ovLim"]   = settings.chData[i].meter_conf_ovLim;
+            root["c"+String(i+1)+"_meter_conf_opLim"]   = settings.chData[i].meter_conf_opLim;
             root["c"+String(i+1)+"_USBInfo_numDev"]     = settings.chData[i].USBInfo_numDev;
             root["c"+String(i+1)+"_USBInfo_Dev1_Name"]  = settings.chData[i].USBInfo_Dev1_Name;
             root["c"+String(i+1)+"_USBInfo_Dev2_Name"]  = settings.chData[i].USBInfo_Dev2_Name;
@@ -161,6 +177,8 @@ public:
         settings.BaseMCU_usb3_mux_sel_pos   = root["BaseMCU_usb3_mux_sel_pos"] | false;
         settings.BaseMCU_base_ver           = root["BaseMCU_base_ver"].as<uint8_t>(); 
         settings.system_resetToDefault      = root["system_resetToDefault"].as<uint8_t>();
+        settings.system_updateState         = root["system_updateState"].as<uint8_t>();
+        settings.system_updateProgress      = root["system_updateProgress"].as<uint8_t>();
         
 
         for(int i =0; i<3; i++){
@@ -173,6 +191,12 @@ public:
             settings.chData[i].meter_backAlertSet   = root["c"+String(i+1)+"_meter_backAlertSet" ] | false;
             settings.chData[i].meter_conf_fwdCLim   = root["c"+String(i+1)+"_meter_conf_fwdCLim"].as<uint16_t>();
             settings.chData[i].meter_conf_backCLim  = root["c"+String(i+1)+"_meter_conf_backCLim"].as<uint16_t>();
+            settings.chData[i].meter_sagAlert       = root["c"+String(i+1)+"_meter_sagAlert"] | false;
+            settings.chData[i].meter_ovAlert        = root["c"+String(i+1)+"_meter_ovAlert"] | false;
+            settings.chData[i].meter_opAlert        = root["c"+String(i+1)+"_meter_opAlert"] | false;
+            settings.chData[i].meter_conf_uvLim     = root["c"+String(i+1)+"_meter_conf_uvLim"].as<uint16_t>();
+            settings.chData[i].meter_conf_ovLim     = root["c"+String(i+1)+"_meter_conf_ovLim"].as<uint16_t>();
+            settings.chData[i].meter_conf_opLim     = root["c"+String(i+1)+"_meter_conf_opLim"].as<uint16_t>();
             settings.chData[i].USBInfo_numDev       = root["c"+String(i+1)+"_USBInfo_numDev"].as<int>();
             settings.chData[i].USBInfo_Dev1_Name    = root["c"+String(i+1)+"_USBInfo_Dev1_Name"].as<String>();
             settings.chData[i].USBInfo_Dev2_Name    = root["c"+String(i+1)+"_USBInfo_Dev2_Name"].as<String>();
@@ -26,84 +26,124 @@ uint8_t mIndex = 0; //menu Index (current pointed element)
 bool treeEnd = false;
 unsigned long lastButtonActivity;
 
-Menu* currentMenu;
-std::stack<Menu*> menuStack;
-
-Menu CH1Config = {
-    TYPE_ROOT,
-    "CH1 Config.",
-    {
-        {TYPE_RANGE,"Over Current",   {},{"100","2000","100"},"mA",{H_OC}},
-        {TYPE_RANGE,"Back Current",{},{"1","200","10"},"mA",{H_RC}},
-        {TYPE_RANGE,"Startup Timer",  {},{"1","100","5"},"s",{H_CHSTUP}}
-    },{"0"},"",{H_CHxCONF}
+const Menu* currentMenu;
+const Menu* menuStack[MENU_MAX_DEPTH];
+uint8_t menuDepth = 0;
+
+//Getters and setters bound to the menu items
+static uint16_t getOverCurrent(uint8_t ch)  { return (uint16_t)(gCon->meter[ch].fwdCLim); }
+static uint16_t getBackCurrent(uint8_t ch)  { return (uint16_t)(gCon->meter[ch].backCLim); }
+static uint16_t getUnderVoltage(uint8_t ch) { return gCon->meter[ch].uvLim; }
+static uint16_t getOverVoltage(uint8_t ch)  { return gCon->meter[ch].ovLim; }
+static uint16_t getOverPower(uint8_t ch)    { return gCon->meter[ch].opLim; }
+static uint16_t getStartupTimer(uint8_t ch) { return (uint16_t)(gCon->startup[ch].startup_timer); }
+static uint16_t getWiFiRecovery(uint8_t ch) { return (uint16_t)(gSte->features.wifiRecovery); }
+static uint16_t getWiFiReset(uint8_t ch)    { return (uint16_t)(gSte->features.wifiReset); }
+static uint16_t getWiFiEnable(uint8_t ch)   { return (uint16_t)(gCon->features.wifi_enabled); }
+static uint16_t getStartupMode(uint8_t ch)  { return (uint16_t)(gCon->features.startUpmode); }
+static uint16_t getRefreshRate(uint8_t ch)  { return (uint16_t)(gCon->features.refreshRate); }
+static uint16_t getFilterType(uint8_t ch)   { return (uint16_t)(gCon->features.filterType); }
+static uint16_t getRotation(uint8_t ch)     { return (uint16_t)(gCon->screen[ch].rotation); }
+static uint16_t getBrightness(uint8_t ch)   { return (uint16_t)(gCon->screen[ch].brightness); }
+static uint16_t getHubMode(uint8_t ch)      { return (uint16_t)(gCon->features.hubMode); }
+static uint16_t getRestoreDef(uint8_t ch)   { return (uint16_t)(gSte->system.resetToDefault); }
+
+static void setOverCurrent(uint8_t ch, uint16_t v)  { gCon->meter[ch].fwdCLim = v; }
+static void setBackCurrent(uint8_t ch, uint16_t v)  { gCon->meter[ch].backCLim = v; }
+static void setUnderVoltage(uint8_t ch, uint16_t v) { gCon->meter[ch].uvLim = v; }
+static void setOverVoltage(uint8_t ch, uint16_t v)  { gCon->meter[ch].ovLim = v; }
+static void setOverPower(uint8_t ch, uint16_t v)    { gCon->meter[ch].opLim = v; }
+static void setStartupTimer(uint8_t ch, uint16_t v) { gCon->startup[ch].startup_timer = (int)(v); }
+static void setWiFiRecovery(uint8_t ch, uint16_t v) { gSte->features.wifiRecovery = (uint8_t)(v); }
+static void setWiFiReset(uint8_t ch, uint16_t v)    { gSte->features.wifiReset = (uint8_t)(v); }
+static void setWiFiEnable(uint8_t ch, uint16_t v)   { gCon->features.wifi_enabled = (int)(v); }
+static void setStartupMode(uint8_t ch, uint16_t v)  { gCon->features.startUpmode = (uint8_t)(v); }
+static void setRefreshRate(uint8_t ch, uint16_t v)  { gCon->features.refreshRate = (uint8_t)(v); }
+static void setFilterType(uint8_t ch, uint16_t v)   { gCon->features.filterType = (uint8_t)(v); }
+static void setHubMode(uint8_t ch, uint16_t v)      { gCon->features.hubMode = (uint8_t)(v); }
+static void setRestoreDef(uint8_t ch, uint16_t v)   { gSte->system.resetToDefault = (uint8_t)(v); }
+static void setRotation(uint8_t ch, uint16_t v) {
+    gCon->screen[0].rotation = (uint8_t)(v);
+    gCon->screen[1].rotation = (uint8_t)(v);
+    gCon->screen[2].rotation = (uint8_t)(v);
+}
+static void setBrightness(uint8_t ch, uint16_t v) {
+    gCon->screen[0].brightness = v;
+    gCon->screen[1].brightness = v;
+    gCon->screen[2].brightness = v;
+}
+
+//Select options and their help texts
+static constexpr const char* optWiFiRecovery[] = {"No Action", "Recovery"};
+static constexpr const char* optWiFiReset[]    = {"No Action", "Reset"};
+static constexpr const char* optWiFiEnable[]   = {"Disable", "Enable"};
+static constexpr const char* optStartupMode[]  = {"Persistence", "On at startup", "Off at startup", "Timed"};
+static constexpr const char* optRefreshRate[]  = {"0.5s","1.0s"};
+static constexpr const char* optFilterType[]   = {"Moving Avg.","Median"};
+static constexpr const char* optRotation[]     = {"0","90","180","270"};
+static constexpr const char* optHubMode[]      = {"USB2 & USB3", "USB2 Only", "USB3 Only"};
+static constexpr const char* optRestoreDef[]   = {"No Action", "Restore Def"};
+
+static constexpr uint8_t hlpWiFiRecovery[] = {H_WIRExNA,H_WIRECREC};
+static constexpr uint8_t hlpWiFiReset[]    = {H_WIRExNA,H_WIRESRES};
+static constexpr uint8_t hlpWiFiEnable[]   = {H_WIENNO,H_WIENYES};
+static constexpr uint8_t hlpStartupMode[]  = {H_GLSTUPPER,H_GLSTUPON,H_GLSTUPOFF,H_GLSTUPTMR};
+static constexpr uint8_t hlpRefreshRate[]  = {H_METREF,H_METREF};
+static constexpr uint8_t hlpFilterType[]   = {H_METFILTMA,H_METFILTMED};
+static constexpr uint8_t hlpHubMode[]      = {H_USBTYP23,H_USBTYP2,H_USBTYP3};
+static constexpr uint8_t hlpRestoreDef[]   = {H_DEFxNA,H_DEFRES};
+
+//Channel settings, shared by the three CHx roots
+static constexpr Menu chConfigItems[] = {
+    menuRange("Over Current",  100, 2000, 100, "mA", H_OC,     MF_CHANNEL, getOverCurrent, setOverCurrent),
+    menuRange("Back Current",  1,   200,  10,  "mA", H_RC,     MF_CHANNEL, getBackCurrent, setBackCurrent),
+    menuRange("Under Voltage", UV_LIM_MIN, UV_LIM_MAX, 50, "mV", H_UV,     MF_CHANNEL | MF_OFF, getUnderVoltage, setUnderVoltage),
+    menuRange("Over Voltage",  OV_LIM_MIN, OV_LIM_MAX, 50, "mV", H_OV,     MF_CHANNEL | MF_OFF, getOverVoltage, setOverVoltage),
+    menuRange("Over Power",    OP_LIM_MIN, OP_LIM_MAX, 500, "mW", H_OP,    MF_CHANNEL | MF_OFF, getOverPower, setOverPower),
+    menuRange("Startup Timer", 1,   100,  5,   "s",  H_CHSTUP, MF_CHANNEL | MF_STARTUP_TMR, getStartupTimer, setStartupTimer)
+};
+
+static constexpr Menu wifiItems[] = {
+    menuInfo("WiFi Info", H_NONE),
+    MENU_SELECT("WiFi Recovery", optWiFiRecovery, "", H_WIREC, hlpWiFiRecovery, MF_NONE, getWiFiRecovery, setWiFiRecovery),
+    MENU_SELECT("WiFi Reset",    optWiFiReset,    "", H_WIRES, hlpWiFiReset,    MF_NONE, getWiFiReset,    setWiFiReset),
+    MENU_SELECT("WiFi Enable",   optWiFiEnable,   "", H_WIEN,  hlpWiFiEnable,   MF_NONE, getWiFiEnable,   setWiFiEnable)
 };
 
-Menu CH2Config = {
-    TYPE_ROOT,
-    "CH2 Config.",
-    {
-        {TYPE_RANGE,"Over Current",   {},{"100","2000","100"},"mA",{H_OC}},
-        {TYPE_RANGE,"Back Current",{},{"1","200","10"},"mA",{H_RC}},
-        {TYPE_RANGE,"Startup Timer",  {},{"1","100","5"},"s",{H_CHSTUP}}
-    },{"1"},"",{H_CHxCONF}
+static constexpr Menu meterItems[] = {
+    MENU_SELECT("Refresh Rate", optRefreshRate, "", H_METREF,  hlpRefreshRate, MF_NONE, getRefreshRate, setRefreshRate),
+    MENU_SELECT("Filter Type",  optFilterType,  "", H_METFILT, hlpFilterType,  MF_NONE, getFilterType,  setFilterType)
 };
 
-Menu CH3Config = {
-    TYPE_ROOT,
-    "CH3 Config.",
-    {
-        {TYPE_RANGE,"Over Current",   {},{"100","2000","100"},"mA",{H_OC}},
-        {TYPE_RANGE,"Back Current",{},{"1","200","10"},"mA",{H_RC}},
-        {TYPE_RANGE,"Startup Timer",  {},{"1","100","5"},"s",{H_CHSTUP}}
-    },{"2"},"",{H_CHxCONF}
+static constexpr Menu screenItems[] = {
+    MENU_SELECT("Rotation", optRotation, "DEG", H_SCRROT, nullptr, MF_ROTATION, getRotation, setRotation),
+    menuRange("Brightness", 50, 1000, 50, "%", H_SCRBRI, MF_BRIGHTNESS, getBrightness, setBrightness)
 };
 
-Menu generalConfig = {
-    TYPE_ROOT,
-    "Global Config.",
-    {
-        {TYPE_ROOT, "Wi-Fi",{
-            {TYPE_INFO,"WiFi Info",{},{},"",{H_NONE}},
-            {TYPE_SELECT,"WiFi Recovery",{},{"No Action", "Recovery"},"",{H_WIREC,H_WIRExNA,H_WIRECREC}},
-            {TYPE_SELECT,"WiFi Reset",{},{"No Action", "Reset"},"",{H_WIRES,H_WIRExNA,H_WIRESRES}},
-            {TYPE_SELECT,"WiFi Enable",{},{"Disable", "Enable"},"",{H_WIEN,H_WIENNO,H_WIENYES}}
-        },{},"",{H_WIGEN}},
-        {TYPE_SELECT, "Startup Mode",{},{"Persistence", "On at startup", "Off at startup", "Timed"},"",
-        {H_GLSTUP,H_GLSTUPPER,H_GLSTUPON,H_GLSTUPOFF,H_GLSTUPTMR}},
-        {TYPE_ROOT, "Meter",{
-            {TYPE_SELECT,"Refresh Rate",{},{"0.5s","1.0s"},"",{H_METREF,H_METREF,H_METREF}},
-            {TYPE_SELECT,"Filter Type",{},{"Moving Avg.","Median"},"",{H_METFILT,H_METFILTMA,H_METFILTMED}}
-        },{},"",{H_METER}},        
-        {TYPE_ROOT, "Screen",{
-            {TYPE_SELECT,"Rotation",{},{"0","90","180","270"},"DEG",{H_SCRROT,H_NONE,H_NONE,H_NONE,H_NONE}},
-            {TYPE_RANGE,"Brightness",{},{"50","1000","50"},"%",{H_SCRBRI}}
-        },{},"",{H_SCREEN}},
-        {TYPE_SELECT, "HUB Mode",{},{"USB2 & USB3", "USB2 Only", "USB3 Only"},"",
-        {H_USBTYP,H_USBTYP23,H_USBTYP2,H_USBTYP3}},
-        {TYPE_SELECT,"Restore Default",{},{"No Action", "Restore Def"},"",{H_DEF,H_DEFxNA,H_DEFRES}}        
-    },
-    {"0"},"", {H_GLOCONF}
+static constexpr Menu generalItems[] = {
+    MENU_ROOT("Wi-Fi", wifiItems, H_WIGEN, NO_CHANNEL),
+    MENU_SELECT("Startup Mode", optStartupMode, "", H_GLSTUP, hlpStartupMode, MF_NONE, getStartupMode, setStartupMode),
+    MENU_ROOT("Meter", meterItems, H_METER, NO_CHANNEL),
+    MENU_ROOT("Screen", screenItems, H_SCREEN, NO_CHANNEL),
+    MENU_SELECT("HUB Mode", optHubMode, "", H_USBTYP, hlpHubMode, MF_NONE, getHubMode, setHubMode),
+    MENU_SELECT("Restore Default", optRestoreDef, "", H_DEF, hlpRestoreDef, MF_NONE, getRestoreDef, setRestoreDef)
 };
 
-Menu mainMenu = {
-    TYPE_ROOT,
-    "Configurations",
-    {
-        CH1Config,
-        CH2Config,
-        CH3Config,
-        generalConfig
-    },
-    {"0"},"", {}
+static constexpr Menu mainItems[] = {
+    MENU_ROOT("CH1 Config.", chConfigItems, H_CHxCONF, 0),
+    MENU_ROOT("CH2 Config.", chConfigItems, H_CHxCONF, 1),
+    MENU_ROOT("CH3 Config.", chConfigItems, H_CHxCONF, 2),
+    MENU_ROOT("Global Config.", generalItems, H_GLOCONF, 0)
 };
 
-uint16_t  getParamValue(String parameter,String channel="0");
-void setParamValue(String param, uint16_t value, String channel="0");
+static constexpr Menu mainMenu = menuRoot("Configurations", mainItems, ARR_SIZE(mainItems), H_NONE, 0, MF_MAIN);
 
-void rootLayout(Menu* root, int index);
-void selectLayout(Menu* root, int index);
-void rangeLayout(Menu* root, String channel="0");
+uint16_t getParamValue(const Menu* m, uint8_t channel);
+void setParamValue(const Menu* m, uint16_t value, uint8_t channel);
+
+void rootLayout(const Menu* root, int index);
+void selectLayout(const Menu* root, int index, uint8_t channel);
+void rangeLayout(const Menu* root, uint8_t channel);
 void screenWiFiInfoRender(void);
 void resetAutoTimer();
 
@@ -128,23 +168,32 @@ void taskMenuViewLoop(void *pvParameters){
         mIndex=0;
         treeEnd = false;        
         currentMenu=&mainMenu;
-        String ch = "0";
+        menuDepth = 0;
+        uint8_t ch = 0;
         uint16_t sel;
         uint16_t step;
         uint16_t rmin;
         uint16_t rmax;
-        uint8_t loop = 0;
+        unsigned long lastInfoRefresh = millis();
+        BtnEvent evt;
         iScr->screenSetBackLight(0);
+        screenMenuInvalidate();
         rootLayout(currentMenu,mIndex);
         iScr->screenSetBackLight(800);
         gSte->system.menuIsActive = true;
+        btnClearAll(); //drop what is left of the press that opened the menu
 
         for(;;){
+            //wakes on every button event, MENU_VIEW_PERIOD bounds the periodic refreshes
+            bool got   = btnWaitEvent(&evt, pdMS_TO_TICKS(MENU_VIEW_PERIOD));
+            bool press = got && evt.type == BTN_SHORT;
+            //holding Move or a range Select keeps stepping, so long lists scroll
+            bool held  = got && (evt.type == BTN_LONG || evt.type == BTN_REPEAT);
 
-            if(btnShortCheck(0)){                
+            if(press && evt.btn == 0){                
                 
                 //Exit soft button
-                if(currentMenu->name == "Configurations"){
+                if(currentMenu == &mainMenu){
                     ESP_LOGI(TAG,"Exit button press");
                     xSemaphoreGive(screen_Semaphore);
                     btnClearAll();
@@ -154,46 +203,49 @@ void taskMenuViewLoop(void *pvParameters){
                     vTaskDelete(NULL);                    
                 }                
                 //Back soft button
-                if(!menuStack.empty()){
-                    currentMenu = menuStack.top();
-                    menuStack.pop();
+                if(menuDepth > 0){
+                    currentMenu = menuStack[--menuDepth];
                     mIndex = 0;
                     treeEnd = false;
-                    if(!currentMenu->params.empty()) ch = currentMenu->params[0];
+                    if(currentMenu->channel != NO_CHANNEL) ch = currentMenu->channel;
                     rootLayout(currentMenu,mIndex);
                 }
 
                 resetAutoTimer();
             }
-            if(btnShortCheck(1)){
+            if((press || held) && evt.btn == 1){
                 //Move
                 if(currentMenu->menuType == TYPE_ROOT)
                 {
-                    mIndex = (mIndex+1) % currentMenu->submenus.size();
+                    mIndex = (mIndex+1) % currentMenu->numSubmenus;
                     rootLayout(currentMenu,mIndex);
                 }
                 if(currentMenu->menuType == TYPE_SELECT)
                 {
-                    mIndex = (mIndex+1) % currentMenu->params.size();
-                    selectLayout(currentMenu,mIndex);
+                    mIndex = (mIndex+1) % currentMenu->numParams;
+                    selectLayout(currentMenu,mIndex,ch);
                 }
                 if(currentMenu->menuType == TYPE_RANGE){
                     
                     if(treeEnd){
-                        sel = getParamValue(currentMenu->name,ch);                        
-                        rmin = (uint16_t)(currentMenu->params[0].toInt());                        
-                        step = (uint16_t)(currentMenu->params[2].toInt());
-                        ESP_LOGI(TAG,"%s, %u, %u, %u",ch,sel,rmin,step);
+                        sel = getParamValue(currentMenu,ch);                        
+                        rmin = currentMenu->rmin;                        
+                        step = currentMenu->step;
+                        ESP_LOGI(TAG,"%u, %u, %u, %u",ch,sel,rmin,step);
 
-                        if(currentMenu->name == "Startup Timer" && sel == 5){
+                        if((currentMenu->flags & MF_STARTUP_TMR) && sel == 5){
                             sel = 1;
-                            setParamValue(currentMenu->name,sel,ch);
+                            setParamValue(currentMenu,sel,ch);
                         } 
                         if(sel - step >= rmin){
                             //round to the closes lower value factor of step                            
                             sel%step == 0 ? sel = sel - step : sel = (sel/step)*step;                            
-                            setParamValue(currentMenu->name,sel,ch);
-                        }                         
+                            setParamValue(currentMenu,sel,ch);
+                        }
+                        else if((currentMenu->flags & MF_OFF) && sel != 0){
+                            sel = 0;
+                            setParamValue(currentMenu,sel,ch);
+                        }
                     }                     
 
                     rangeLayout(currentMenu,ch);                     
@@ -201,13 +253,13 @@ void taskMenuViewLoop(void *pvParameters){
 
                 resetAutoTimer();                                
             }
-            if(btnShortCheck(2)){
+            if(evt.btn == 2 && (press || (held && treeEnd && currentMenu->menuType == TYPE_RANGE))){
                 //Select
                 
                 //if(!currentMenu->submenus.empty()){
-                if(!treeEnd && currentMenu->menuType != TYPE_INFO){
-                    menuStack.push(currentMenu);
-                    if(!currentMenu->params.empty()) ch=currentMenu->params[0];
+                if(!treeEnd && currentMenu->menuType == TYPE_ROOT && menuDepth < MENU_MAX_DEPTH){
+                    menuStack[menuDepth++] = currentMenu;
+                    if(currentMenu->channel != NO_CHANNEL) ch = currentMenu->channel;
                     currentMenu=&currentMenu->submenus[mIndex];                    
                     mIndex=0;
                 }                    
@@ -219,25 +271,29 @@ void taskMenuViewLoop(void *pvParameters){
                 if(currentMenu->menuType == TYPE_SELECT)
                 {                                           
                     if(treeEnd){
-                        setParamValue(currentMenu->name,(uint16_t)(mIndex));
+                        setParamValue(currentMenu,(uint16_t)(mIndex),ch);
                     }
-                    selectLayout(currentMenu,mIndex);
+                    selectLayout(currentMenu,mIndex,ch);
                     treeEnd = true;                    
                 }
                 if(currentMenu->menuType == TYPE_RANGE){
                     
                     if(treeEnd){
-                        sel = getParamValue(currentMenu->name,ch);                        
-                        rmax = (uint16_t)(currentMenu->params[1].toInt());
-                        step = (uint16_t)(currentMenu->params[2].toInt());
-                        //ESP_LOGI(TAG,"%s, %u, %u, %u",ch,sel,rmax,step);
-                        if(sel + step <= rmax) {
-                            if(currentMenu->name == "Startup Timer" && sel < 5) 
+                        sel = getParamValue(currentMenu,ch);                        
+                        rmax = currentMenu->rmax;
+                        step = currentMenu->step;
+                        //ESP_LOGI(TAG,"%u, %u, %u, %u",ch,sel,rmax,step);
+                        if((currentMenu->flags & MF_OFF) && sel < currentMenu->rmin){
+                            sel = currentMenu->rmin;
+                            setParamValue(currentMenu,sel,ch);
+                        }
+                        else if(sel + step <= rmax) {
+                            if((currentMenu->flags & MF_STARTUP_TMR) && sel < 5) 
                                 sel = 5;
                             else
                                 //round to the closes higher value factor of step 
                                 sel = (sel/step)*step + step;
-                            setParamValue(currentMenu->name,sel,ch);    
+                            setParamValue(currentMenu,sel,ch);    
                         }                        
                     }                   
 
@@ -248,12 +304,12 @@ void taskMenuViewLoop(void *pvParameters){
                 resetAutoTimer();
 
             }
-            if(btnShortCheck(3)){
+            if(press && evt.btn == 3){
                 ESP_LOGI(TAG,"Setup key");
                 resetAutoTimer();
             }
 
-            if (btnLongCheck(3) || (millis() - lastButtonActivity > AUTO_EXIT_TIMEOUT) ){
+            if ((got && evt.btn == 3 && evt.type == BTN_LONG) || (millis() - lastButtonActivity > AUTO_EXIT_TIMEOUT) ){
             
                 ESP_LOGI(TAG,"Setup button long press");
                 xSemaphoreGive(screen_Semaphore);
@@ -265,16 +321,13 @@ void taskMenuViewLoop(void *pvParameters){
             }
 
             //refresh wifi info every 1s
-            if(loop == (1000/MENU_VIEW_PERIOD -1) ){
+            if(millis() - lastInfoRefresh >= 1000){
                 if(currentMenu->menuType == TYPE_ROOT)
-                    if(currentMenu->submenus[mIndex].name == "WiFi Info"){
+                    if(currentMenu->submenus[mIndex].menuType == TYPE_INFO){
                         screenWiFiInfoRender();
                         resetAutoTimer(); //if in this view, disable auto exit
                     }                
-                loop = 0;     
-            }
-            else{
-                loop++;
+                lastInfoRefresh = millis();
             }
 
             //update displays if global configuration from backend changes
@@ -283,13 +336,11 @@ void taskMenuViewLoop(void *pvParameters){
                     rangeLayout(currentMenu,ch);
                 }
                 if(currentMenu->menuType == TYPE_SELECT){
-                    mIndex = getParamValue(currentMenu->name,ch);
-                    selectLayout(currentMenu,mIndex);
+                    mIndex = getParamValue(currentMenu,ch);
+                    selectLayout(currentMenu,mIndex,ch);
                 }
                 gSte->system.congigChangedToMenu = false;
             }
-
-            vTaskDelay(pdMS_TO_TICKS(MENU_VIEW_PERIOD));
         }    
     }
     else {
@@ -302,236 +353,142 @@ void taskMenuViewLoop(void *pvParameters){
 
 }
 
-void rootLayout(Menu* root, int index){
+void rootLayout(const Menu* root, int index){
     
     ESP_LOGI("","-------------");
-    ESP_LOGI("","%s",root->name.c_str());  
+    ESP_LOGI("","%s",root->name);  
     //ESP_LOGI("","Type: %u",root->menuType);
     screenMenuIntroRender(root,iScr,String(gSte->baseMCUExtra.base_ver));  
     ESP_LOGI("","-------------");
-    for(int i=0; i< root->submenus.size(); i++){
+    for(int i=0; i< root->numSubmenus; i++){
         if(index == i)
-            ESP_LOGI("","[%s]",root->submenus[i].name.c_str());
+            ESP_LOGI("","[%s]",root->submenus[i].name);
         else  
-            ESP_LOGI(""," %s",root->submenus[i].name.c_str());
+            ESP_LOGI(""," %s",root->submenus[i].name);
     }
     screenMenuListRender(root,iScr,index,-1);
 
     ESP_LOGI("","-------------");
-    ESP_LOGI("","Help Index: %u", root->submenus[index].helpReference[0]);
+    ESP_LOGI("","Help Index: %u", root->submenus[index].help);
 
-    if(root->submenus[index].name != "WiFi Info"){
+    if(root->submenus[index].menuType != TYPE_INFO){
         screenMenuInfoRender(root,iScr,0,index);
     }
+    else {
+        screenMenuInvalidate(MENU_SCR_INFO); //drawn by screenWiFiInfoRender
+    }
 }
 
-void selectLayout(Menu* root, int index){
+void selectLayout(const Menu* root, int index, uint8_t channel){
 
     ESP_LOGI("","-------------");
-    ESP_LOGI("","%s",root->name.c_str());
+    ESP_LOGI("","%s",root->name);
     screenMenuIntroRender(root,iScr);     
     ESP_LOGI("","-------------");
     if(root->menuType == TYPE_SELECT){
 
-        int sel = (int)(getParamValue(root->name));
-        String strm ="";
-        for(int i=0; i< root->params.size(); i++){            
-            strm=root->params[i];
-            if(sel == i) strm = strm + "*";
+        int sel = (int)(getParamValue(root,channel));
+        for(int i=0; i< root->numParams; i++){            
             if(index == i)                
-                ESP_LOGI("","[%s]", strm.c_str());
+                ESP_LOGI("","[%s]%s", root->params[i], sel == i ? "*" : "");
             else  
-                ESP_LOGI(""," %s" , strm.c_str());
+                ESP_LOGI(""," %s%s" , root->params[i], sel == i ? "*" : "");
         }
         screenMenuListRender(root,iScr,index,sel);
     }
 
     ESP_LOGI("","-------------");
-    ESP_LOGI("","Help Index: %u", root->helpReference[0]);
+    ESP_LOGI("","Help Index: %u", root->help);
 
     screenMenuInfoRender(root,iScr,0,index);
     
 }
 
-void rangeLayout(Menu* root, String channel){
+void rangeLayout(const Menu* root, uint8_t channel){
     
-    uint16_t sel = getParamValue(root->name, channel);
+    uint16_t sel = getParamValue(root, channel);
     ESP_LOGI("","-------------");
-    ESP_LOGI("","%s",root->name.c_str());
-    screenMenuIntroRender(root,iScr,channel);     
+    ESP_LOGI("","%s",root->name);
+    screenMenuIntroRender(root,iScr,String(channel));     
     ESP_LOGI("","-------------");
     ESP_LOGI("","<< %u >>",sel);
-    screenMenuRangeRender(sel,root->paramUnits,iScr);
+    screenMenuRangeRender(sel,root->paramUnits,root->flags,iScr);
     ESP_LOGI("","-------------");
-    ESP_LOGI("","Help Index: %u", root->helpReference[0]);
+    ESP_LOGI("","Help Index: %u", root->help);
     screenMenuInfoRender(root,iScr,sel);
 }
 
 
 void screenWiFiInfoRender(void){
     digitalWrite(iScr->dProp[2].cs_pin,LOW);
+    iScr->frameSelect(2);
     iScr->tft.setRotation(ROT_180_DEG);
-    iScr->img.fillScreen(TFT_BLACK); 
+    iScr->img->fillScreen(TFT_BLACK); 
     //header
-    iScr->img.fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
+    iScr->img->fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
 
-    iScr->img.loadFont(SMALLFONT);
-    iScr->img.setTextFont(2);
-    iScr->img.setTextColor(TFT_WHITE);
+    iScr->img->loadFont(SMALLFONT);
+    iScr->img->setTextFont(2);
+    iScr->img->setTextColor(TFT_WHITE);
     String mode;
     String status;
     switch(gSte->features.wifiState){
         case WIFI_OFFLINE:             
-            iScr->img.drawString("Mode: Offline",6,45,4);
-            iScr->img.drawString("Stat: -",6,85,4);
+            iScr->img->drawString("Mode: Offline",6,45,4);
+            iScr->img->drawString("Stat: -",6,85,4);
             break;
         case AP_NOCLIENT: 
         case AP_CONNECTED: 
-            iScr->img.drawString("Mode: AP",0,40,4);
+            iScr->img->drawString("Mode: AP",0,40,4);
             if(gSte->features.wifiState == AP_NOCLIENT){
-                iScr->img.drawString("Stat: No Clients",0,80,4);
+                iScr->img->drawString("Stat: No Clients",0,80,4);
             }
             else{
-                iScr->img.drawString("Stat: " +String(gSte->features.wifiClients)+ String(" Clients"),0,80,4);
+                iScr->img->drawString("Stat: " +String(gSte->features.wifiClients)+ String(" Clients"),0,80,4);
             }
-            iScr->img.drawString("AP Name ("+String(gSte->features.wifiRSSI)+String(" dB):"),0,120,4);
-            iScr->img.setTextColor(TFT_CYAN);
-            iScr->img.drawString(gSte->system.APSSID,0,145,4);
-            iScr->img.setTextColor(TFT_WHITE);
-            iScr->img.drawString("IP: "+ gSte->features.wifiAPIP,0,205,4);
+            iScr->img->drawString("AP Name ("+String(gSte->features.wifiRSSI)+String(" dB):"),0,120,4);
+            iScr->img->setTextColor(TFT_CYAN);
+            iScr->img->drawString(gSte->system.APSSID,0,145,4);
+            iScr->img->setTextColor(TFT_WHITE);
+            iScr->img->drawString("IP: "+ gSte->features.wifiAPIP,0,205,4);
             break;
         case STA_NOCLIENT:            
         case STA_CONNECTED:    
-            iScr->img.drawString("Mode: Station",0,40,4);
+            iScr->img->drawString("Mode: Station",0,40,4);
             if(gSte->features.wifiState == STA_NOCLIENT){
-                iScr->img.drawString("Stat: No Clients",0,80,4);
+                iScr->img->drawString("Stat: No Clients",0,80,4);
             }
             else{
-                iScr->img.drawString("Stat: " +String(gSte->features.wifiClients)+ String(" Clients"),0,80,4);
+                iScr->img->drawString("Stat: " +String(gSte->features.wifiClients)+ String(" Clients"),0,80,4);
             }            
-            iScr->img.drawString("SSID ("+String(gSte->features.wifiRSSI)+String(" dB):"),0,120,4);
-            iScr->img.setTextColor(TFT_CYAN);
-            iScr->img.drawString(gSte->features.ssid,0,145,4);
-            iScr->img.setTextColor(TFT_WHITE);            
-            iScr->img.drawString("IP: "+ gSte->features.wifiIP,0,205,4);             
+            iScr->img->drawString("SSID ("+String(gSte->features.wifiRSSI)+String(" dB):"),0,120,4);
+            iScr->img->setTextColor(TFT_CYAN);
+            iScr->img->drawString(gSte->features.ssid,0,145,4);
+            iScr->img->setTextColor(TFT_WHITE);            
+            iScr->img->drawString("IP: "+ gSte->features.wifiIP,0,205,4);             
             break;
         case WIFI_OFF: 
-            iScr->img.drawString("Mode: Wi-Fi Off",6,45,4);
-            iScr->img.drawString("Stat: -",6,85,4);
+            iScr->img->drawString("Mode: Wi-Fi Off",6,45,4);
+            iScr->img->drawString("Stat: -",6,85,4);
             break;
         default:
             break;
     }
    
-    iScr->img.unloadFont();
-    iScr->img.pushSprite(0,0);
+    iScr->img->unloadFont();
+    iScr->img->pushSprite(0,0);
     digitalWrite(iScr->dProp[2].cs_pin, HIGH);    
 
 }
 
-uint16_t getParamValue(String param, String channel){
-
-    if(param =="Over Current") {    
-        return ((uint16_t)(gCon->meter[channel.toInt()].fwdCLim));
-    }
-    if(param =="Back Current") {    
-        return ((uint16_t)(gCon->meter[channel.toInt()].backCLim));
-    }
-    if(param =="Startup Timer") {    
-        return ((uint16_t)(gCon->startup[channel.toInt()].startup_timer));
-    }
-    if(param == "WiFi Recovery") {    
-        return ((uint16_t)(gSte->features.wifiRecovery));
-    }
-    if(param == "WiFi Reset") {    
-        return ((uint16_t)(gSte->features.wifiReset));
-    }    
-    if(param =="WiFi Enable") {    
-        return ((uint16_t)(gCon->features.wifi_enabled));
-    }
-    if(param =="Startup Mode") {    
-        return ((uint16_t)(gCon->features.startUpmode));
-    }
-    if(param =="Refresh Rate") {    
-        return ((uint16_t)(gCon->features.refreshRate));
-    }
-    if(param =="Filter Type") {    
-        return ((uint16_t)(gCon->features.filterType));
-    }
-    if(param =="Rotation") {    
-        return ((uint16_t)(gCon->screen[channel.toInt()].rotation));
-    }
-    if(param =="Brightness") {    
-        return ((uint16_t)(gCon->screen[channel.toInt()].brightness));
-    }
-    if(param =="HUB Mode") {    
-        return ((uint16_t)(gCon->features.hubMode));
-    }
-    if(param =="Restore Default") {            
-        return ((uint16_t)(gSte->system.resetToDefault));
-    }
-    return (0);   
+uint16_t getParamValue(const Menu* m, uint8_t channel){
+    if(m->get == nullptr) return (0);
+    return m->get(channel);
 }
 
-void setParamValue(String param, uint16_t value, String channel){
+void setParamValue(const Menu* m, uint16_t value, uint8_t channel){
     gSte->system.configChangedFromMenu = true;
-    if(param =="Over Current") {    
-        gCon->meter[channel.toInt()].fwdCLim = value;
-        return;
-    }
-    if(param =="Back Current") {    
-        gCon->meter[channel.toInt()].backCLim = value;
-        return;
-    }
-    if(param =="Startup Timer") {    
-        gCon->startup[channel.toInt()].startup_timer = (int)(value);
-        return;
-    }
-    if(param =="WiFi Recovery") {    
-        gSte->features.wifiRecovery = (uint8_t)(value);
-        return; 
-    }
-    if(param =="WiFi Reset") {    
-        gSte->features.wifiReset = (uint8_t)(value);
-        return; 
-    }    
-    if(param =="WiFi Enable") {    
-        gCon->features.wifi_enabled = (int)(value);
-        return;
-    }
-    if(param =="Startup Mode") {    
-        gCon->features.startUpmode = (uint8_t)(value);
-        return;
-    }
-    if(param =="Refresh Rate") {    
-        gCon->features.refreshRate = (uint8_t)(value);
-        return;
-    }
-    if(param =="Filter Type") {    
-        gCon->features.filterType = (uint8_t)(value);
-        return;
-    }
-    if(param =="Rotation") {    
-        gCon->screen[0].rotation = (uint8_t)(value);
-        gCon->screen[1].rotation = (uint8_t)(value);
-        gCon->screen[2].rotation = (uint8_t)(value);
-        return;
-    }
-    if(param =="Brightness") {    
-        gCon->screen[0].brightness = value;
-        gCon->screen[1].brightness = value;
-        gCon->screen[2].brightness = value;
-        return;
-    }
-    if(param =="HUB Mode") {    
-        gCon->features.hubMode = (uint8_t)(value);
-        return;
-    }
-    if(param =="Restore Default") {    
-        gSte->system.resetToDefault = (uint8_t)(value);        
-        return;
-    }
-    return;
+    if(m->set != nullptr) m->set(channel, value);
 }
 
 void resetAutoTimer(){
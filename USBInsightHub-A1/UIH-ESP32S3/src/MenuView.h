@@ -23,12 +23,6 @@
 #include "DefaultView.h"
 #include "Extercomms.h"
 
-#include <vector>
-#include <string>
-#include <functional>
-#include <stack>
-#include <memory>
-
 #define MENU_VIEW_PERIOD      40 //in ms
 #define AUTO_EXIT_TIMEOUT     10000 //in ms. 0 dispables the auto timer 
 
@@ -46,6 +40,9 @@
 #define H_OC         3 //Over current Help
 #define H_RC         4 //Reverse current help
 #define H_CHSTUP     5 //Channel starup help
+#define H_UV         6 //Under voltage help
+#define H_OV         7 //Over voltage help
+#define H_OP         8 //Over power help
 
 #define H_WIGEN      10 //wifi general help
 #define H_WIREC      11 //wifi recovery info
@@ -82,24 +79,73 @@
 #define H_DEFxNA     46 //restore default no action
 #define H_DEFRES     47 //restore default action
 
+#define MENU_MAX_DEPTH 4 //deepest navigation path: main > global > screen > brightness
+#define NO_CHANNEL    -1 //root does not change the selected channel
+
+//Menu item flags
+#define MF_NONE        0x00
+#define MF_CHANNEL     0x01 //value belongs to the channel selected by the parent, header shows CHx
+#define MF_BRIGHTNESS  0x02 //preview the backlight while changing the value
+#define MF_ROTATION    0x04 //preview the rotation on the info screen
+#define MF_STARTUP_TMR 0x08 //allow the 0.1s value below the first step
+#define MF_MAIN        0x10 //top level: shows versions and the Exit button
+#define MF_OFF         0x20 //0 disables, one step below the range and shown as Off
+
+//Menu screens, used to invalidate what is drawn on them
+#define MENU_SCR_INTRO 0x01
+#define MENU_SCR_LIST  0x02
+#define MENU_SCR_INFO  0x04
+#define MENU_SCR_ALL   0x07
+
+typedef uint16_t (*MenuGetter)(uint8_t ch);
+typedef void (*MenuSetter)(uint8_t ch, uint16_t value);
+
+//Menu tree node. The whole tree is a constexpr table in flash, values are read and
+//written through the getter/setter bound to each item
 struct Menu {
-    int menuType;
-    String name;               //Menu name
-    std::vector<Menu> submenus;     //Submenus
-    std::vector<String> params;     //parameters
-    String paramUnits;    
-    std::vector<int> helpReference;              //index to a specific help text  
-    //std::function<void(String param)> setParam;
-    //std::function<String()> getparam;   
+    uint8_t menuType;
+    const char* name;                 //Menu name
+    const Menu* submenus;             //Submenus (TYPE_ROOT)
+    uint8_t numSubmenus;
+    const char* const* params;        //Options (TYPE_SELECT)
+    uint8_t numParams;
+    uint16_t rmin, rmax, step;        //Limits (TYPE_RANGE)
+    const char* paramUnits;
+    uint8_t help;                     //index to a specific help text
+    const uint8_t* optionHelp;        //help of each option (TYPE_SELECT), nullptr for none
+    int8_t channel;                   //channel selected when entering this root
+    uint8_t flags;
+    MenuGetter get;
+    MenuSetter set;
 };
 
+constexpr Menu menuRoot(const char* name, const Menu* sub, uint8_t numSub, uint8_t help, int8_t ch = NO_CHANNEL, uint8_t flags = MF_NONE){
+    return Menu{TYPE_ROOT, name, sub, numSub, nullptr, 0, 0, 0, 0, "", help, nullptr, ch, flags, nullptr, nullptr};
+}
+constexpr Menu menuSelect(const char* name, const char* const* opts, uint8_t numOpts, const char* units,
+                          uint8_t help, const uint8_t* optHelp, uint8_t flags, MenuGetter get, MenuSetter set){
+    return Menu{TYPE_SELECT, name, nullptr, 0, opts, numOpts, 0, 0, 0, units, help, optHelp, NO_CHANNEL, flags, get, set};
+}
+constexpr Menu menuRange(const char* name, uint16_t rmin, uint16_t rmax, uint16_t step, const char* units,
+                         uint8_t help, uint8_t flags, MenuGetter get, MenuSetter set){
+    return Menu{TYPE_RANGE, name, nullptr, 0, nullptr, 0, rmin, rmax, step, units, help, nullptr, NO_CHANNEL, flags, get, set};
+}
+constexpr Menu menuInfo(const char* name, uint8_t help){
+    return Menu{TYPE_INFO, name, nullptr, 0, nullptr, 0, 0, 0, 0, "", help, nullptr, NO_CHANNEL, MF_NONE, nullptr, nullptr};
+}
+
+#define MENU_ROOT(name, sub, help, ch) menuRoot(name, sub, ARR_SIZE(sub), help, ch)
+#define MENU_SELECT(name, opts, units, help, optHelp, flags, get, set) \
+    menuSelect(name, opts, ARR_SIZE(opts), units, help, optHelp, flags, get, set)
+
 
 void menuViewStart(GlobalState* globalState, GlobalConfig* globalConfig, Screen *screen);
 
-void screenMenuIntroRender(Menu* m, Screen* s, String channel ="0");
-void screenMenuListRender(Menu* m, Screen* s, int index,int type);
-void screenMenuRangeRender(uint16_t value, String units, Screen* s);
-void screenMenuInfoRender(Menu* m, Screen* s, uint16_t sel, int index=0);
+void screenMenuInvalidate(uint8_t screens = MENU_SCR_ALL);
+void screenMenuIntroRender(const Menu* m, Screen* s, String channel ="0");
+void screenMenuListRender(const Menu* m, Screen* s, int index,int type);
+void screenMenuRangeRender(uint16_t value, const char* units, uint8_t flags, Screen* s);
+void screenMenuInfoRender(const Menu* m, Screen* s, uint16_t sel, int index=0);
 void menuTextItemPlacer(String text, Screen* s, int pos, int selType, int tick);
 void menuButtonTextPlacer(Screen* s, String barText);
 void drawTextWithNewlines(Screen* s, const char* text, int startX, int startY, int textHeight);
@@ -0,0 +1,105 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Integer meter math from the PAC1943 codes to the display text. Voltages are kept
+//in uV, currents in uA and power in uW, floats only appear when the JSON outputs
+//are written. No Arduino dependency so the host benchmark (UIHHostControl
+//meterbench) runs the same code.
+
+#ifndef METERMATH_H
+#define METERMATH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define METER_MAX_WINDOW 20
+
+//VBUS unipolar 0 to 9 V FSR, 9 V / 65536 = 140625 / 1024 uV per LSB
+static inline int32_t meterVbusToUv(uint16_t raw){
+  return (int32_t)(((uint64_t)raw * 140625 + 512) >> 10);
+}
+
+//Inverse of meterVbusToUv, for the OV/UV limit registers that compare in VBUS format
+static inline uint16_t meterUvToVbus(int32_t uV){
+  if(uV <= 0) return 0;
+  uint64_t code = ((uint64_t)uV * 1024 + 70312) / 140625;
+  return code > 0xFFFF ? 0xFFFF : (uint16_t)code;
+}
+
+//VSENSE bipolar -50 to +50 mV FSR. The sense resistor is wired reversed, so a
+//negative code is forward current
+static inline int32_t meterVsenseToUa(uint16_t raw, uint32_t fullScaleMa){
+  int64_t v = -(int64_t)(int16_t)raw * fullScaleMa * 1000;
+  return (int32_t)((v + (v >= 0 ? 16384 : -16384)) / 32768);
+}
+
+static inline int32_t meterPowerUw(int32_t uV, int32_t uA){
+  return (int32_t)(((int64_t)uV * uA) / 1000000);
+}
+
+static inline int32_t meterMovingAverage(const int32_t *buf, uint8_t n){
+  int32_t sum = 0;
+  for(uint8_t i = 0; i < n; i++) sum += buf[i];
+  return (sum + (sum >= 0 ? n / 2 : -(n / 2))) / n;
+}
+
+//Median of the window, the window itself keeps its ring order
+static inline int32_t meterMedian(const int32_t *buf, uint8_t n){
+  int32_t s[METER_MAX_WINDOW];
+  if(n > METER_MAX_WINDOW) n = METER_MAX_WINDOW;
+  for(uint8_t i = 0; i < n; i++){
+    int32_t v = buf[i];
+    uint8_t j = i;
+    for(; j > 0 && s[j - 1] > v; j--) s[j] = s[j - 1];
+    s[j] = v;
+  }
+  if(n % 2) return s[n / 2];
+  return (int32_t)(((int64_t)s[n / 2 - 1] + s[n / 2]) / 2);
+}
+
+//Writes a micro unit value as base units with the given decimals (0 to 6), rounded
+//half away from zero: 5012345 uV with 3 decimals is "5.012". Returns the length.
+static inline size_t meterFormat(char *buf, size_t len, int32_t micro, uint8_t decimals){
+  static const uint32_t pow10[7] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  char tmp[16];
+  size_t n = 0;
+
+  if(decimals > 6) decimals = 6;
+  uint32_t scale = pow10[6 - decimals];
+  uint32_t mag   = micro < 0 ? (uint32_t)(-(int64_t)micro) : (uint32_t)micro;
+  mag = (mag + scale / 2) / scale;
+
+  //digits backwards, decimals first
+  for(uint8_t d = 0; d < decimals; d++){
+    tmp[n++] = '0' + mag % 10;
+    mag /= 10;
+  }
+  if(decimals) tmp[n++] = '.';
+  do {
+    tmp[n++] = '0' + mag % 10;
+    mag /= 10;
+  } while(mag);
+
+  bool zero = true;
+  for(size_t i = 0; i < n; i++)
+    if(tmp[i] != '0' && tmp[i] != '.') zero = false;
+  if(micro < 0 && !zero) tmp[n++] = '-';
+
+  if(len == 0) return 0;
+  size_t out = 0;
+  while(n && out < len - 1) buf[out++] = tmp[--n];
+  buf[out] = '\0';
+  return out;
+}
+
+#endif
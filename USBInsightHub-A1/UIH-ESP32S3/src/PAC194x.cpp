@@ -57,7 +57,9 @@ bool PAC194x::begin(TwoWire *theWire){
 
       write8(PAC194X_OC_LIMIT_N_SAMPLES,OC_SAMPLES); //Set consecutive samples to trigger OC alert
       write8(PAC194X_UC_LIMIT_N_SAMPLES,UC_SAMPLES); //Set consecutive samples to trigger UC alert
-      write24(PAC194X_SLOW_ALERT1_ADDR,0,0,ALERT1_INT_EN); //Alert1 interrupt sources
+      write8(PAC194X_OV_LIMIT_N_SAMPLES,OV_SAMPLES);
+      write8(PAC194X_UV_LIMIT_N_SAMPLES,UV_SAMPLES);
+      write24(PAC194X_SLOW_ALERT1_ADDR,0,ALERT1_V_INT_EN,ALERT1_INT_EN); //Alert1 interrupt sources
 
       for (int k=0; k<3; k++){
         setCurrentLimit(chMeterArr[k].fwdCLim,FORWARD,k); //reference value for test
@@ -67,24 +69,12 @@ bool PAC194x::begin(TwoWire *theWire){
       }
       
       //enableAlerts(true);
-      write24(PAC194X_ALERT_ENABLE_ADDR,0,0,ENABLEALERT);
+      write24(PAC194X_ALERT_ENABLE_ADDR,uint8_t(alertMask),uint8_t(alertMask>>8),uint8_t(alertMask>>16));
       //refresh();
       //delayMicroseconds(1000);; //wait refresh completion
 
       //initialize averager
-      for (int i=0; i<3; i++)
-      {
-        chAverager[i].VoltageTotal=0;
-        chAverager[i].CurrentTotal=0;
-        chAverager[i].VoltageAveraged=0;
-        chAverager[i].CurrentAveraged=0;
-
-        for (int j=0; j<MAX_FILTER_WINDOW_SIZE; j++)
-        {
-          chAverager[i].VoltageBuf[j]=0;
-          chAverager[i].CurrentBuf[j]=0;
-        }
-      }
+      memset(chAverager, 0, sizeof(chAverager));
       return true;
     }
   }
@@ -101,6 +91,7 @@ void PAC194x::write24(uint8_t reg_address,uint8_t lowByte, uint8_t midByte, uint
   I2C->write(midByte);
   I2C->write(lowByte);
   err = I2C->endTransmission();   
+  i2cHealthWrite(I2C_DEV_METER, err);
 }
 
 void PAC194x::write16(uint8_t reg_address,uint8_t lowByte, uint8_t highByte){
@@ -111,6 +102,7 @@ void PAC194x::write16(uint8_t reg_address,uint8_t lowByte, uint8_t highByte){
   I2C->write(highByte);
   I2C->write(lowByte);
   err = I2C->endTransmission();   
+  i2cHealthWrite(I2C_DEV_METER, err);
 }
 
 void PAC194x::write8(uint8_t reg_address,uint8_t data){
@@ -120,6 +112,7 @@ void PAC194x::write8(uint8_t reg_address,uint8_t data){
   I2C->write(reg_address); 
   I2C->write(data);      
   err = I2C->endTransmission();   
+  i2cHealthWrite(I2C_DEV_METER, err);
 }
 
 
@@ -131,6 +124,7 @@ void PAC194x::refresh_v(){
   I2C->write(PAC194X_REFRESH_V_CMD_ADDR);
   //I2C->write(0x01);     
   err = I2C->endTransmission();
+  i2cHealthWrite(I2C_DEV_METER, err);
   delayMicroseconds(1200); //required to update Meter registers after refresh command.    
 }
 
@@ -142,6 +136,7 @@ void PAC194x::refresh(uint32_t delay){
   I2C->write(PAC194X_REFRESH_CMD_ADDR);
   //I2C->write(0x01);     
   err = I2C->endTransmission();
+  i2cHealthWrite(I2C_DEV_METER, err);
   delayMicroseconds(delay); //required to update Meter registers after refresh command.   
 }
 
@@ -154,8 +149,6 @@ void PAC194x::readAvgMeter(){
 
   int err=0;
   int i=0;
-  uint16_t aux16=0;
-  int sign=1;
   unsigned long i2cwd_timer = 0;
 
   I2C->flush(); //start with the buffer empty
@@ -165,16 +158,13 @@ void PAC194x::readAvgMeter(){
   i2cwd_timer = millis(); //*probably this protection is not longer necessary
   err = I2C->requestFrom(PAC194x_ADDR,12); //*
   i2cwd_timer = millis()-i2cwd_timer;
-  if(i2cwd_timer > SLOWDOWN_TIMEOUT){ //*workaround for sudden drop in I2C speed, reported here https://github.com/espressif/arduino-esp32/issues/8480
-    //Serial.println("I2C Slow down on PAC detected!!"); //*
+  uint8_t res = i2cHealthRead(I2C_DEV_METER, err, 12, i2cwd_timer, SLOWDOWN_TIMEOUT);
+  if(res == I2C_RES_SLOW){ //*workaround for sudden drop in I2C speed, reported here https://github.com/espressif/arduino-esp32/issues/8480
     ESP_LOGV(TAG, "I2C Slow on PAC: %u!",i2cwd_timer);
-    I2C->flush(); //*
-    I2C->setClock(100000); //*
-    I2C->setClock(400000); //*
     error = 2;
     return; //*
   }
-  if(err==0) {
+  if(res == I2C_RES_FAIL) {
     //Serial.println("PAC Fail to read bytes");
     ESP_LOGW(TAG, "PAC Fail to read bytes!");
     error = 1;
@@ -186,10 +176,8 @@ void PAC194x::readAvgMeter(){
     msb=I2C->read();
     lsb=I2C->read();
     chMeterArr[i].AvgVoltageRaw = msb*256 + lsb;
-    chMeterArr[i].AvgVoltage = ((float)(chMeterArr[i].AvgVoltageRaw)/65536.0)*9000.0; //in mV
-    
-    if(chMeterArr[i].filterType == FILTER_TYPE_MOVING_AVG) voltageMovingAverageFilter(i);
-    if(chMeterArr[i].filterType == FILTER_TYPE_MEDIAN) voltageMedianFilter(i);    
+    chMeterArr[i].AvgVoltageUv = meterVbusToUv(chMeterArr[i].AvgVoltageRaw);
+    voltageFilter(i);
   }
   
   for(i =0; i < 3; i++)
@@ -197,32 +185,24 @@ void PAC194x::readAvgMeter(){
     msb=I2C->read();
     lsb=I2C->read();
     chMeterArr[i].AvgVsenseRaw = msb*256 + lsb;
-    if(chMeterArr[i].AvgVsenseRaw & 0x8000){
-      aux16 = (uint16_t)(~(chMeterArr[i].AvgVsenseRaw-1));
-      sign=1;  //sign inverted due to hardware connection
-    }
-    else {
-      aux16 = chMeterArr[i].AvgVsenseRaw;
-      sign=-1;
-    }
+    //sign inverted due to hardware connection, handled in the conversion
+    chMeterArr[i].AvgCurrentUa = meterVsenseToUa(chMeterArr[i].AvgVsenseRaw, chMeterArr[i].FullScale);
+    currentFilter(i);
 
-    chMeterArr[i].AvgCurrent = sign*((float)(aux16)/32768.0)*chMeterArr[i].FullScale;  //in mA
-
-    if(chMeterArr[i].filterType == FILTER_TYPE_MOVING_AVG) currentMovingAverageFilter(i);
-    if(chMeterArr[i].filterType == FILTER_TYPE_MEDIAN) currentMedianFilter(i);
+    chAverager[i].PowerAveragedUw = meterPowerUw(chAverager[i].VoltageAveragedUv, chAverager[i].CurrentAveragedUa);
   }
   
   filterIndex = (filterIndex+1) % filterWindowsize;
 }
 
-void PAC194x::setCurrentLimit(float climit, bool cdir, int ch){
+void PAC194x::setCurrentLimit(uint16_t climit, bool cdir, int ch){
   uint16_t aux16 = 0;
   if(!initiated || ch>=3 ) return;
   //alerts must be disabled before changing OC/UC limits according to PAC datasheet
   //enableAlerts(false);
   //Note that the current circulation is reversed: negative values are forward and positive values backwards
   //aux16 = (uint16_t)(round(climit/chMeterArr[ch].FullScale*32767)); //use for -100/+100mV FSR - convert the desired current limit to 16bit Hex
-  aux16 = (uint16_t)(round(climit/chMeterArr[ch].FullScale*16383)); //use for -50/+50mV FSR - convert the desired current limit to 16bit Hex
+  aux16 = (uint16_t)(((uint32_t)climit*16383 + chMeterArr[ch].FullScale/2)/chMeterArr[ch].FullScale); //use for -50/+50mV FSR - convert the desired current limit to 16bit Hex
   //Serial.println(String(aux16));
 
   if(cdir){
@@ -245,12 +225,31 @@ void PAC194x::setCurrentLimit(float climit, bool cdir, int ch){
 
 }
 
+//OV/UV limits compare against VBUS, so they use its unipolar code
+void PAC194x::setVoltageLimit(uint16_t vlimit, bool over, int ch){
+  uint16_t aux16 = 0;
+  if(!initiated || ch>=3 ) return;
+  aux16 = meterUvToVbus((int32_t)vlimit*1000);
+  write16((over ? PAC194X_OV_LIMIT1_ADDR : PAC194X_UV_LIMIT1_ADDR)+ch,uint8_t(aux16),uint8_t(aux16>>8));
+}
+
+//Arms or disarms the UV/OV alerts of a channel, the next refresh applies them
+void PAC194x::setVoltageAlerts(int ch, bool uv, bool ov){
+  if(!initiated || ch>=3 ) return;
+  uint32_t mask = alertMask & ~(PAC_ALERT_UV(ch) | PAC_ALERT_OV(ch));
+  if(uv) mask |= PAC_ALERT_UV(ch);
+  if(ov) mask |= PAC_ALERT_OV(ch);
+  if(mask == alertMask) return;
+  alertMask = mask;
+  write24(PAC194X_ALERT_ENABLE_ADDR,uint8_t(alertMask),uint8_t(alertMask>>8),uint8_t(alertMask>>16));
+}
+
 void PAC194x::enableAlerts(bool enable){
   
   if(!initiated) return;
 
   if(enable){
-    write24(PAC194X_ALERT_ENABLE_ADDR,0,0,ENABLEALERT);
+    write24(PAC194X_ALERT_ENABLE_ADDR,uint8_t(alertMask),uint8_t(alertMask>>8),uint8_t(alertMask>>16));
   }
   else {
     write24(PAC194X_ALERT_ENABLE_ADDR,0,0,DISABLEALERT);
@@ -279,21 +278,21 @@ bool PAC194x::readAndClearPORFlag(){
 }
 */
 
-uint8_t PAC194x::readInterruptFlags(){
+uint32_t PAC194x::readInterruptFlags(){
 
   //This function is used by an interrupt so it must be short as possible
   //Updating of meter.fwdAlertSet and backAlertSet flags should be updated in the calling interrupt
-  uint8_t flags;
-  uint8_t other;
+  uint32_t flags = 0;
   if(!initiated) return 0; 
   I2C->beginTransmission(PAC194x_ADDR);  
   I2C->write(PAC194X_ALERT_STATUS_ADDR); //Alert Status
   int err = I2C->endTransmission(false);
   //delayMicroseconds(20);  
+  uint32_t t = millis();
   err=I2C->requestFrom(PAC194x_ADDR,3);  
-  //OC and UC flags are in the first byte. Two last bytes are discarded
-  flags=I2C->read();
-  for (int i=0; i<2; i++) other=I2C->read();
+  i2cHealthRead(I2C_DEV_METER, err, 3, millis()-t, SLOWDOWN_TIMEOUT);
+  //OC|UC in the first byte, OV|UV in the second, OP and accumulator flags in the last
+  for (int i=0; i<3; i++) flags = (flags<<8) | (uint8_t)I2C->read();
   return flags; 
 
 }
@@ -304,7 +303,9 @@ uint16_t PAC194x::read16(uint8_t address){
   I2C->beginTransmission(PAC194x_ADDR);
   I2C->write(address); //Alert Status
   int err = I2C->endTransmission(false);
+  uint32_t t = millis();
   err = I2C->requestFrom(PAC194x_ADDR,2);
+  i2cHealthRead(I2C_DEV_METER, err, 2, millis()-t, SLOWDOWN_TIMEOUT);
   uint8_t msb=I2C->read();
   uint8_t lsb=I2C->read();
 
@@ -318,80 +319,35 @@ uint8_t PAC194x::read8(uint8_t address){
   I2C->beginTransmission(PAC194x_ADDR);
   I2C->write(address); //Alert Status
   int err = I2C->endTransmission(false);
+  uint32_t t = millis();
   err = I2C->requestFrom(PAC194x_ADDR,1);
+  i2cHealthRead(I2C_DEV_METER, err, 1, millis()-t, SLOWDOWN_TIMEOUT);
   val = I2C->read();
 
   return val;
 }
 
 
-void PAC194x::voltageMovingAverageFilter(int i){  
-  /* This moving average filter implementation is more efficient, but needs to start from 0.
-  chAverager[i].VoltageTotal = chAverager[i].VoltageTotal - chAverager[i].VoltageBuf[filterIndex]; // Remove the oldest entry from the sum    
-  chAverager[i].VoltageBuf[filterIndex] = chMeterArr[i].AvgVoltage; // Add the newest reading to the window
-  chAverager[i].VoltageTotal = chAverager[i].VoltageTotal + chMeterArr[i].AvgVoltage; // Add the newest reading to the sum
-  chAverager[i].VoltageAveraged = chAverager[i].VoltageTotal/filterWindowsize;  //Compute average
-  */
-  chAverager[i].VoltageBuf[filterIndex] = chMeterArr[i].AvgVoltage; // Add the newest reading to the window
-  chAverager[i].VoltageAveraged = movingAverage(chAverager[i].VoltageBuf, filterWindowsize);
-
-}
+void PAC194x::voltageFilter(int i){
 
-void PAC194x::currentMovingAverageFilter(int i){  
-  /* This moving average filter implementation is more efficient, but needs to start from 0.   
-  chAverager[i].CurrentTotal = chAverager[i].CurrentTotal - chAverager[i].CurrentBuf[filterIndex]; // Remove the oldest entry from the sum    
-  chAverager[i].CurrentBuf[filterIndex] = chMeterArr[i].AvgCurrent; // Add the newest reading to the window 
-  chAverager[i].CurrentTotal = chAverager[i].CurrentTotal + chMeterArr[i].AvgCurrent; // Add the newest reading to the sum
-  chAverager[i].CurrentAveraged = chAverager[i].CurrentTotal/filterWindowsize;  //Compute average
-  */
-  chAverager[i].CurrentBuf[filterIndex] = chMeterArr[i].AvgCurrent; // Add the newest reading to the window
-  chAverager[i].CurrentAveraged = movingAverage(chAverager[i].CurrentBuf, filterWindowsize);
+  chAverager[i].VoltageBuf[filterIndex] = chMeterArr[i].AvgVoltageUv; // Add the newest reading to the window
+  if(chMeterArr[i].filterType == FILTER_TYPE_MEDIAN)
+    chAverager[i].VoltageAveragedUv = meterMedian(chAverager[i].VoltageBuf, filterWindowsize);
+  else
+    chAverager[i].VoltageAveragedUv = meterMovingAverage(chAverager[i].VoltageBuf, filterWindowsize);
 
 }
 
-void PAC194x::voltageMedianFilter(int i){
-  
-  chAverager[i].VoltageBuf[filterIndex] = chMeterArr[i].AvgVoltage; // Add the newest reading to the window
-  chAverager[i].VoltageAveraged = medianFunction(chAverager[i].VoltageBuf, filterWindowsize);
-
-}
-
-void PAC194x::currentMedianFilter(int i){     
+void PAC194x::currentFilter(int i){
 
-  chAverager[i].CurrentBuf[filterIndex] = chMeterArr[i].AvgCurrent; // Add the newest reading to the window
-  chAverager[i].CurrentAveraged = medianFunction(chAverager[i].CurrentBuf, filterWindowsize);
+  chAverager[i].CurrentBuf[filterIndex] = chMeterArr[i].AvgCurrentUa; // Add the newest reading to the window
+  if(chMeterArr[i].filterType == FILTER_TYPE_MEDIAN)
+    chAverager[i].CurrentAveragedUa = meterMedian(chAverager[i].CurrentBuf, filterWindowsize);
+  else
+    chAverager[i].CurrentAveragedUa = meterMovingAverage(chAverager[i].CurrentBuf, filterWindowsize);
 
 }
 
-float PAC194x::movingAverage(float arr[], int n){
-    float sum = 0;
-    for(int i = 0; i < n; i++){
-      sum = sum + arr[i];
-    }
-    return sum/n;
-}
-
-float PAC194x::medianFunction(float arr[], int n){
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (arr[j] > arr[j + 1]) {
-                // Swap arr[j] and arr[j+1]
-                float temp = arr[j];
-                arr[j] = arr[j + 1];
-                arr[j + 1] = temp;
-            }
-        }
-    }
-
-    if(n%2==0){
-      return (arr[int(n/2)]+arr[int(n/2)+1])/2; //if even average between moddle points
-    }
-    else{
-      return arr[int(n/2)+1]; //if odd take the middle value
-    }  
-      
-}
-
 void PAC194x::setFilterLength(uint8_t length){
   if(length >= 1 && length <= MAX_FILTER_WINDOW_SIZE) 
     filterWindowsize = length;
@@ -19,6 +19,8 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "datatypes.h" //to know the pin numbers
+#include "MeterMath.h"
+#include "I2CHealth.h"
 
 #define SLOWDOWN_TIMEOUT 4
 
@@ -31,7 +33,7 @@
 
 #define FILTER_TYPE_MOVING_AVG 0
 #define FILTER_TYPE_MEDIAN 1
-#define MAX_FILTER_WINDOW_SIZE 20
+#define MAX_FILTER_WINDOW_SIZE METER_MAX_WINDOW
 
 //define configurations
 //Configuration control for enabling bidirectional current and bipolar voltage measurements Page 52
@@ -48,15 +50,24 @@
 //default refresh delay
 #define DEF_REFRESH_DELAY 1500 //ms
 //Software default current limits
-#define DEFAULT_FWD_C_LIM 2000.0 //this value is for a configuration of -50/+50 mV FSR
-#define DEFAULT_BACK_C_LIM 20.0 //this value is for a configuration of -50/+50 mV FSR
+#define DEFAULT_FWD_C_LIM 2000 //this value is for a configuration of -50/+50 mV FSR
+#define DEFAULT_BACK_C_LIM 20 //this value is for a configuration of -50/+50 mV FSR
 //These values must be higher than the deglitch timers of the power switches AP22653A (typ 6ms)
 #define UC_SAMPLES 0XA8 // 10 10 10 00 -> 10 = 8 samples ~ 8ms FORWARD 
 #define OC_SAMPLES 0XA8 // 10 10 10 00 -> 10 = 8 samples ~ 8ms BACKWARD 
+//A sag is caught on the first conversion, over voltage needs 4 in a row
+#define UV_SAMPLES 0x00 // 00 00 00 00 -> 00 = 1 sample
+#define OV_SAMPLES 0x54 // 01 01 01 00 -> 01 = 4 samples
 //Alerts configuration
 #define ENABLEALERT 0xEE 
 #define DISABLEALERT 0x00
 #define ALERT1_INT_EN 0xEE 
+#define ALERT1_V_INT_EN 0xEE //OV CH1-3 | UV CH1-3
+//ALERT_STATUS, ALERT_ENABLE and SLOW_ALERT1 bits of a meter channel (0-2)
+#define PAC_ALERT_OC(ch) (1UL << (23 - (ch)))
+#define PAC_ALERT_UC(ch) (1UL << (19 - (ch)))
+#define PAC_ALERT_OV(ch) (1UL << (15 - (ch)))
+#define PAC_ALERT_UV(ch) (1UL << (11 - (ch)))
 
 //Current limit direction
 #define FORWARD true
@@ -140,25 +151,24 @@
 #define PAC194X_REVISION_ID_ADDR            0xFF
 
 struct meter {
-  uint32_t FullScale;
-  float fwdCLim;
-  float backCLim;  
+  uint32_t FullScale; //mA
+  uint16_t fwdCLim;   //mA
+  uint16_t backCLim;  //mA
   uint16_t AvgVoltageRaw;
   uint16_t AvgVsenseRaw;
-  float AvgVoltage;
-  float AvgCurrent;
+  int32_t AvgVoltageUv;
+  int32_t AvgCurrentUa;
   bool fwdAlertSet;
   bool backAlertSet;
   int filterType;
 };
 
 struct meter_averager {
-  float VoltageBuf[MAX_FILTER_WINDOW_SIZE];
-  float VoltageTotal;
-  float VoltageAveraged;
-  float CurrentBuf[MAX_FILTER_WINDOW_SIZE];
-  float CurrentTotal;
-  float CurrentAveraged;
+  int32_t VoltageBuf[MAX_FILTER_WINDOW_SIZE];
+  int32_t VoltageAveragedUv;
+  int32_t CurrentBuf[MAX_FILTER_WINDOW_SIZE];
+  int32_t CurrentAveragedUa;
+  int32_t PowerAveragedUw;
 };
 
 
@@ -176,11 +186,14 @@ class PAC194x {
     void refresh_v();
     void refresh(uint32_t delay);
     void readAvgMeter();
-    void setCurrentLimit(float climit, bool cdir, int ch);
+    void setCurrentLimit(uint16_t climit, bool cdir, int ch);
+    void setVoltageLimit(uint16_t vlimit, bool over, int ch);
+    void setVoltageAlerts(int ch, bool uv, bool ov);
     void setFilterLength(uint8_t length);
     void enableAlerts(bool enable);
     //bool readAndClearPORFlag();
-    uint8_t readInterruptFlags();
+    uint32_t readInterruptFlags();
+    uint32_t getAlertMask() { return alertMask; }
     uint16_t read16(uint8_t address);
     uint8_t read8(uint8_t address);
     bool isInitiated() { return initiated; }
@@ -191,15 +204,12 @@ class PAC194x {
 
   private:
     uint8_t filterWindowsize = 10;
+    uint32_t alertMask = (uint32_t)ENABLEALERT << 16; //OC/UC always, OV/UV armed by the caller
     void write24(uint8_t reg_address,uint8_t lowByte, uint8_t midByte, uint8_t highByte);
     void write16(uint8_t reg_address,uint8_t lowByte, uint8_t highByte);
     void write8(uint8_t reg_address,uint8_t data);
-    void voltageMovingAverageFilter(int i);
-    void currentMovingAverageFilter(int i);
-    void voltageMedianFilter(int i);
-    void currentMedianFilter(int i);
-    float medianFunction(float arr[], int n);
-    float movingAverage(float arr[], int n);
+    void voltageFilter(int i);
+    void currentFilter(int i);
     void testInterruptPin();
 
     TwoWire *I2C;
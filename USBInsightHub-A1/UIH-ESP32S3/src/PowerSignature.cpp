@@ -0,0 +1,282 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+#include "PowerSignature.h"
+#include "GlobalStateManager.h"
+
+static const char* TAG = "PowerSig";
+
+enum captureState {
+  PSIG_IDLE = 0,
+  PSIG_SETTLING,
+  PSIG_BANDS,
+  PSIG_DONE
+};
+
+static const char* t_captureState[] = {"idle","settling","bands","done"};
+
+struct sigCapture {
+  uint8_t state;
+  uint32_t startMs;
+  uint32_t stableMs;
+  uint16_t peak;
+  uint16_t prev;
+  uint8_t stableRun;
+  uint8_t lowRun;
+  uint8_t nBand;
+  bool learned;
+  uint16_t band[PSIG_BAND_SAMPLES];
+  uint16_t feat[PSIG_FEATURES];
+};
+
+struct sigBlob {
+  uint8_t ver;
+  PowerSigEntry table[PSIG_TABLE_SIZE];
+};
+
+//differences below these are measurement noise: mA, ms (one sample is ~63 ms), mA, mA
+static const uint16_t featFloor[PSIG_FEATURES] = {20, 150, 5, 5};
+
+static PowerSigEntry sigTable[PSIG_TABLE_SIZE];
+static sigCapture cap[3];
+static SemaphoreHandle_t sigMutex = NULL;
+static Preferences sigStorage;
+
+static void sigClassify(GlobalState *st, uint8_t ch);
+static void sigLearn(GlobalState *st, uint8_t ch, const String &name);
+
+void powerSigInit(){
+  sigMutex = xSemaphoreCreateMutex();
+  memset(cap, 0, sizeof(cap));
+  memset(sigTable, 0, sizeof(sigTable));
+
+  sigBlob blob;
+  sigStorage.begin(UIH_NAMESPACE, true);
+  if(sigStorage.getBytes("SigBlob", &blob, sizeof(blob)) == sizeof(blob) && blob.ver == PSIG_BLOB_VER){
+    memcpy(sigTable, blob.table, sizeof(sigTable));
+    ESP_LOGI(TAG, "Signature table loaded");
+  }
+  sigStorage.end();
+}
+
+void powerSigSave(){
+  sigBlob blob;
+  blob.ver = PSIG_BLOB_VER;
+  xSemaphoreTake(sigMutex, portMAX_DELAY);
+  memcpy(blob.table, sigTable, sizeof(sigTable));
+  xSemaphoreGive(sigMutex);
+
+  sigStorage.begin(UIH_NAMESPACE, false);
+  sigStorage.putBytes("SigBlob", &blob, sizeof(blob));
+  sigStorage.end();
+  ESP_LOGI(TAG, "Save signature table");
+}
+
+//Sum of the relative feature differences, 256 per 100% of the pair mean
+static uint16_t sigDistance(const uint16_t *a, const uint16_t *b){
+  uint32_t d = 0;
+  for(int k=0; k<PSIG_FEATURES; k++){
+    uint32_t diff = a[k] > b[k] ? a[k] - b[k] : b[k] - a[k];
+    d += (diff << 8) / (((uint32_t)a[k] + b[k]) / 2 + featFloor[k]);
+  }
+  return d > 0xFFFF ? 0xFFFF : d;
+}
+
+static int sigFind(const char *name){
+  for(int i=0; i<PSIG_TABLE_SIZE; i++){
+    if(sigTable[i].count && strncmp(sigTable[i].name, name, PSIG_NAME_LEN) == 0) return i;
+  }
+  return -1;
+}
+
+static void sigBands(sigCapture &c){
+  //insertion sort, PSIG_BAND_SAMPLES is small
+  for(int i=1; i<PSIG_BAND_SAMPLES; i++){
+    uint16_t v = c.band[i];
+    int j = i - 1;
+    for(; j >= 0 && c.band[j] > v; j--) c.band[j+1] = c.band[j];
+    c.band[j+1] = v;
+  }
+  c.feat[0] = c.peak;
+  c.feat[1] = c.stableMs - c.startMs > 0xFFFF ? 0xFFFF : c.stableMs - c.startMs;
+  c.feat[2] = c.band[PSIG_BAND_SAMPLES / 10];                          //idle, 10th percentile
+  c.feat[3] = c.band[PSIG_BAND_SAMPLES - 1 - PSIG_BAND_SAMPLES / 10];  //active, 90th percentile
+}
+
+void powerSigSample(GlobalState *st, uint8_t ch, int32_t currentUa, uint32_t ms){
+  if(sigMutex == NULL || ch > 2) return;
+  sigCapture &c = cap[ch];
+  int32_t current = currentUa / 1000;
+  uint16_t mA = current <= 0 ? 0 : (current >= 0xFFFF ? 0xFFFF : (uint16_t)current);
+
+  //device removed or port switched off
+  if(c.state != PSIG_IDLE){
+    c.lowRun = mA < PSIG_DETACH_MA ? c.lowRun + 1 : 0;
+    if(c.lowRun >= PSIG_DETACH_SAMPLES){
+      c.state = PSIG_IDLE;
+      st->powerSig[ch].label[0] = '\0';
+      st->powerSig[ch].distance = 0xFFFF;
+      st->powerSig[ch].anomaly = false;
+      return;
+    }
+  }
+
+  switch(c.state){
+    case PSIG_IDLE:
+      if(mA > PSIG_ATTACH_MA){
+        c.state = PSIG_SETTLING;
+        c.startMs = ms;
+        c.stableMs = ms;
+        c.peak = mA;
+        c.prev = mA;
+        c.stableRun = 0;
+        c.lowRun = 0;
+        c.nBand = 0;
+        c.learned = false;
+      }
+      break;
+
+    case PSIG_SETTLING: {
+      if(mA > c.peak) c.peak = mA;
+      uint16_t tol = max(c.prev >> 3, 2);
+      if(abs((int)mA - (int)c.prev) <= tol){
+        if(c.stableRun == 0) c.stableMs = ms;
+        c.stableRun++;
+      }
+      else c.stableRun = 0;
+      c.prev = mA;
+
+      if(c.stableRun >= PSIG_STABLE_RUN || ms - c.startMs > PSIG_SETTLE_MAX_MS){
+        if(c.stableRun < PSIG_STABLE_RUN) c.stableMs = ms;
+        c.state = PSIG_BANDS;
+      }
+      break;
+    }
+
+    case PSIG_BANDS:
+      c.band[c.nBand++] = mA;
+      if(c.nBand >= PSIG_BAND_SAMPLES){
+        sigBands(c);
+        c.state = PSIG_DONE;
+        sigClassify(st, ch);
+        ESP_LOGI(TAG, "CH %u peak %u mA, settle %u ms, idle %u mA, active %u mA, match: %s (%u)", ch,
+                 c.feat[0], c.feat[1], c.feat[2], c.feat[3], st->powerSig[ch].label, st->powerSig[ch].distance);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  //learn once per plug, the agent name usually arrives after the capture is done
+  if(c.state == PSIG_DONE && !c.learned && st->features.pcConnected && st->usbInfo[ch].numDev == 1 &&
+     st->usbInfo[ch].Dev1_Name.length() > 1){
+    sigLearn(st, ch, st->usbInfo[ch].Dev1_Name);
+  }
+}
+
+//Nearest neighbour over the learned table
+static void sigClassify(GlobalState *st, uint8_t ch){
+  int best = -1;
+  uint16_t bestDist = 0xFFFF;
+
+  xSemaphoreTake(sigMutex, portMAX_DELAY);
+  for(int i=0; i<PSIG_TABLE_SIZE; i++){
+    if(!sigTable[i].count) continue;
+    uint16_t d = sigDistance(cap[ch].feat, sigTable[i].feat);
+    if(d < bestDist){
+      bestDist = d;
+      best = i;
+    }
+  }
+  PowerSigState &ps = st->powerSig[ch];
+  ps.distance = bestDist;
+  if(best >= 0 && bestDist <= PSIG_MATCH_DIST){
+    strlcpy(ps.label, sigTable[best].name, PSIG_NAME_LEN);
+    ps.anomaly = bestDist > PSIG_ANOMALY_DIST;
+  }
+  else{
+    ps.label[0] = '\0';
+    ps.anomaly = false;
+  }
+  xSemaphoreGive(sigMutex);
+}
+
+static void sigLearn(GlobalState *st, uint8_t ch, const String &name){
+  sigCapture &c = cap[ch];
+  PowerSigState &ps = st->powerSig[ch];
+  c.learned = true;
+
+  xSemaphoreTake(sigMutex, portMAX_DELAY);
+  int idx = sigFind(name.c_str());
+  if(idx >= 0){
+    PowerSigEntry &e = sigTable[idx];
+    ps.distance = sigDistance(c.feat, e.feat);
+    ps.anomaly = ps.distance > PSIG_ANOMALY_DIST;
+    //an anomalous plug is reported but kept out of the reference
+    if(!ps.anomaly){
+      uint8_t w = min(e.count, (uint8_t)(PSIG_MAX_WEIGHT - 1));
+      for(int k=0; k<PSIG_FEATURES; k++) e.feat[k] = ((uint32_t)e.feat[k] * w + c.feat[k]) / (w + 1);
+      if(e.count < 255) e.count++;
+    }
+  }
+  else{
+    //free slot, otherwise replace the least seen device
+    idx = 0;
+    for(int i=0; i<PSIG_TABLE_SIZE; i++){
+      if(sigTable[i].count < sigTable[idx].count) idx = i;
+      if(!sigTable[i].count) break;
+    }
+    PowerSigEntry &e = sigTable[idx];
+    strlcpy(e.name, name.c_str(), PSIG_NAME_LEN);
+    memcpy(e.feat, c.feat, sizeof(e.feat));
+    e.count = 1;
+    ps.distance = 0;
+    ps.anomaly = false;
+    ESP_LOGI(TAG, "CH %u learned \"%s\" in slot %d", ch, e.name, idx);
+  }
+  strlcpy(ps.label, name.c_str(), PSIG_NAME_LEN);
+  xSemaphoreGive(sigMutex);
+
+  st->system.savePowerSig = true;
+}
+
+void powerSigToJson(JsonObject obj){
+  if(sigMutex == NULL) return;
+
+  JsonArray table = obj["table"].to<JsonArray>();
+  xSemaphoreTake(sigMutex, portMAX_DELAY);
+  for(int i=0; i<PSIG_TABLE_SIZE; i++){
+    if(!sigTable[i].count) continue;
+    JsonObject e = table.add<JsonObject>();
+    e["name"]   = sigTable[i].name;
+    e["peak"]   = sigTable[i].feat[0];
+    e["settle"] = sigTable[i].feat[1];
+    e["idle"]   = sigTable[i].feat[2];
+    e["active"] = sigTable[i].feat[3];
+    e["count"]  = sigTable[i].count;
+  }
+  xSemaphoreGive(sigMutex);
+
+  JsonArray ports = obj["ports"].to<JsonArray>();
+  for(int ch=0; ch<3; ch++){
+    JsonObject p = ports.add<JsonObject>();
+    p["state"] = t_captureState[cap[ch].state];
+    if(cap[ch].state == PSIG_DONE){
+      p["peak"]   = cap[ch].feat[0];
+      p["settle"] = cap[ch].feat[1];
+      p["idle"]   = cap[ch].feat[2];
+      p["active"] = cap[ch].feat[3];
+    }
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Power signature of the device attached to each port, taken from the PAC1943
+//samples after a plug event: inrush peak, settle time and the idle/active current
+//bands. While the PC agent names a single device on the port the signature is
+//learned under that name; standalone the nearest learned signature gives the label.
+//The current is the PAC accumulated value of each Intercomms cycle (~63 ms), so the
+//inrush peak is the highest cycle average, not the true instantaneous peak.
+
+#ifndef POWERSIGNATURE_H
+#define POWERSIGNATURE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "datatypes.h"
+
+#define PSIG_TABLE_SIZE     16
+#define PSIG_FEATURES       4   //peak, settle, idle, active
+#define PSIG_BLOB_VER       1
+
+#define PSIG_ATTACH_MA      3   //current above this starts a capture
+#define PSIG_DETACH_MA      1   //current below this for PSIG_DETACH_SAMPLES ends the device
+#define PSIG_DETACH_SAMPLES 5
+#define PSIG_STABLE_RUN     3   //consecutive samples within the band to call it settled
+#define PSIG_SETTLE_MAX_MS  4000
+#define PSIG_BAND_SAMPLES   32  //samples after settling used for the idle/active bands
+
+//Distance is the sum of the relative differences of the features, 256 = 100% on one feature
+#define PSIG_MATCH_DIST     160 //above this the port stays unknown
+#define PSIG_ANOMALY_DIST   96  //above this a known device is flagged
+#define PSIG_MAX_WEIGHT     8   //learning keeps a running mean of up to this many plugs
+
+struct PowerSigEntry {
+  char name[PSIG_NAME_LEN];
+  uint16_t feat[PSIG_FEATURES]; //mA, ms, mA, mA
+  uint8_t count;
+};
+
+void powerSigInit();
+//Feeds one sample of a board channel, learns and matches when a capture completes
+void powerSigSample(GlobalState *st, uint8_t ch, int32_t currentUa, uint32_t ms);
+//Persists the table, called by the config autosave task when savePowerSig is set
+void powerSigSave();
+void powerSigToJson(JsonObject obj);
+
+#endif
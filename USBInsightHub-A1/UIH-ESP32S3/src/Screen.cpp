@@ -19,6 +19,14 @@
 
 #include "Screen.h"
 
+//UI palette shared by the three frames: every color used by the views plus
+//darker tones for the anti-aliased edges of the smooth fonts and icons
+static const uint16_t uiPalette[FRAME_PALETTE_SIZE] = {
+  TFT_BLACK,  TFT_WHITE, TFT_LIGHTGREY, DARKGREY,
+  0x4A69,     TFT_RED,   TFT_GREEN,     TFT_BLUE,
+  TFT_YELLOW, TFT_CYAN,  TFT_ORANGE,    0x03E0,   //dark green
+  0x03EF,     0x7800,    0x7BE0,        0x0A71    //dark cyan, maroon, olive, PC icon blue
+};
 
 void Screen::start(){
 
@@ -45,7 +53,7 @@ void Screen::start(){
     
 
   screenSetBackLight(0);
-  delay(50); //50ms wait after power up before reset
+  bootDelayUntil(50); //50ms wait after power up before reset
   //Reset Displays
   digitalWrite(DISPLAY_ALL_DRES, HIGH);
   delay(10); //10ms reset pulse
@@ -63,22 +71,13 @@ void Screen::start(){
   tft.writedata(0x00);
 
 
-  // Create the RGB332 palette (256 colors)
-  for (int i = 0; i < 256; i++) {
-      palette[i] = RGB332_to_RGB565(i);
+  //4 bit frames, 28.8kB each, so every display keeps its last frame
+  for (int i = 0; i < SCREEN_COUNT; i++) {
+    if (!frame[i].begin(240, 240, uiPalette))
+      ESP_LOGE("Screen","Frame %d allocation failed",i);
+    defaultValid[i] = false;
   }
-
-  img.setColorDepth(8); //use 8 bit color depth to save 57.6kB of SRAM
-  imgPtr = (uint16_t*)img.createSprite(240, 240); //imgPtr used for DMA transaction, only with 16bit color depth
-  //img.createPalette(palette);
-  
-  pcimg.createSprite(33, 29);
-  pcimg.setSwapBytes(true);
-  ibuff.createSprite(33, 30);
-  ibuff.setSwapBytes(true);
-  udata.createSprite(32,28);
-  udata.setSwapBytes(true);
-  udata.fillScreen(TFT_BLACK);
+  img = &frame[0];
   
   
   tft.setTextSize(2);
@@ -102,17 +101,25 @@ void Screen::screenSetBackLight(int pwm, uint8_t ch){
   else if (ch == 3) analogWrite(DLIT_3, pwm);      
 }
 
-uint16_t Screen::RGB332_to_RGB565(uint8_t rgb332) {
-    uint8_t r = (rgb332 >> 5) & 0x07;  // Extract 3-bit Red
-    uint8_t g = (rgb332 >> 2) & 0x07;  // Extract 3-bit Green
-    uint8_t b = (rgb332 >> 0) & 0x03;  // Extract 2-bit Blue
+//Select the frame of display idx for drawing. Views other than the default
+//one overwrite the frame, so its default view content is no longer valid.
+void Screen::frameSelect(uint8_t idx){
+  if (idx >= SCREEN_COUNT) return;
+  img = &frame[idx];
+  defaultValid[idx] = false;
+}
 
-    // Convert to full 8-bit values and then to RGB565 format
-    r = (r * 255) / 7;  
-    g = (g * 255) / 7;
-    b = (b * 255) / 3;
+//True when the default view would redraw something on this display
+bool Screen::screenDefaultChanged(const chScreenData &Screen){
+  uint64_t hash[BAND_COUNT];
+  defaultBandHashes(Screen, hash);
+  return defaultBandsChanged(screenIndex(Screen.dProp.cs_pin), hash) != 0;
+}
 
-    return tft.color565(r, g, b);
+uint8_t Screen::screenIndex(uint8_t cs_pin){
+  if (cs_pin == DISPLAY_CS_2) return 1;
+  if (cs_pin == DISPLAY_CS_3) return 2;
+  return 0;
 }
 
 void Screen::setCSPins(uint8_t state){
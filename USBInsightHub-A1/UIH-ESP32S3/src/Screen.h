@@ -19,13 +19,15 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include "TFT_eSPI.h" // Hardware-specific library
+#include "FrameSprite.h"
+#include "FlexLayout.h"
 //imported fonts to improve display quality
 #include "modenine50.h"
 #include "aptossb52l.h"
 #include "aptossb30l.h"
 #include "monofonto30.h"
-#include "icons.h"
 #include "datatypes.h"
+#include "Boot.h"
 #include "esp_clk.h"
 #include <ArduinoJson.h>
 
@@ -42,8 +44,23 @@
 #define BACKLIGHT_FREQ_240 290 //Hz. Higher frequencies cause flickering when WiFi is active
 #define BACKLIGHT_FREQ_160 193
 
+//The A1 board routes neither the panel TE outputs nor MISO, the panel refresh
+//phase can't be observed and pushes are not synced to it. Tearing is kept low
+//by pushing only the bands that changed.
+
 #define DARKGREY 0x7BF2
 
+#define SCREEN_COUNT 3
+
+//default view bands, redrawn and pushed independently
+#define BAND_HEADER 0x01 //power, icons          y 0..32
+#define BAND_DEVICE 0x02 //device box            y 33..137
+#define BAND_METER  0x04 //voltage, current, bar y 138..239
+#define BAND_ALL    0x07
+#define BAND_COUNT  3
+
+#define SCREEN_NAME_LEN 32 //device names and signature label, longer texts are cut
+
 #define SMALLFONT aptossb30l
 
 struct displayProp{
@@ -54,23 +71,30 @@ struct displayProp{
 };
 
 struct meterProp {
-  float AvgVoltage;
-  float AvgCurrent;
-  float fwdCLim;
-  float backCLim;
+  int32_t AvgVoltageUv;
+  int32_t AvgCurrentUa;
+  uint16_t fwdCLim;  //mA
+  uint16_t backCLim; //mA
   bool fwdAlertSet;
   bool backAlertSet;
+  bool sagAlert;
+  bool ovAlert;
+  bool opAlert;
 };
 
 struct txtProp{
-  int numDev;
-  String Dev1_Name;
-  String Dev2_Name;
-  int usbType;
+  int32_t numDev;
+  char Dev1_Name[SCREEN_NAME_LEN];
+  char Dev2_Name[SCREEN_NAME_LEN];
+  int32_t usbType;
   uint8_t imgBPP;
   uint16_t* imgBuffer;
+  uint16_t imgSeq;
+  FlexLayout flex;
+  uint8_t flexTop; //first visible flex line
 };
 
+//Plain data only, so the model is copied with memcpy and its bands hashed field by field
 struct chScreenData { 
   displayProp dProp;
   meterProp mProp;
@@ -80,18 +104,32 @@ struct chScreenData {
   bool pwr_en;
   uint8_t ilim;
   bool pconnected;
-  int startup_timer;
-  int startup_cnt;
+  int32_t startup_timer;
+  int32_t startup_cnt;
   uint8_t rssiBars;
   uint8_t wifiState;
   uint8_t hubMode;
   bool showMenuInfoSplash;
   bool showVersionChangeSplash;
   uint8_t updateState;
+  uint8_t updateProgress;
   uint8_t startUpmode;
   bool pwr_source;
   uint8_t usbHostState;
   uint8_t internalErrFlags;
+  char sigLabel[SCREEN_NAME_LEN];
+  bool sigAnomaly;
+};
+
+//64-bit FNV-1a fed field by field, padding and the unused tail of texts don't count
+struct ScreenHash {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  void bytes(const void* p, size_t n){
+    const uint8_t* b = (const uint8_t*)p;
+    while(n--){ h ^= *b++; h *= 0x100000001b3ULL; }
+  }
+  template<typename T> void add(const T &v){ bytes(&v, sizeof(v)); }
+  void text(const char* s, size_t max){ bytes(s, strnlen(s, max)); add((uint8_t)0); }
 };
 
 
@@ -99,26 +137,34 @@ class Screen{
   public:
     //void start(TFT_eSPI *r_tft, TFT_eSprite *r_img);
     void start();
-    void screenDefaultRender(chScreenData Screen);
+    void screenDefaultRender(const chScreenData &Screen);
     void screenSetBackLight(int pwm);
     void screenSetBackLight(int pwm, uint8_t ch);
     void usbIconDraw(uint8_t type, bool active,bool com);
-    void flexDevicePrint(String jsonStr, bool pcCon);
+    void iconDraw(uint8_t id, int32_t x, int32_t y);
+    void flexDevicePrint(const FlexLayout &flex, uint8_t top, bool pcCon);
     void imagePrint(uint16_t* imgBuffer, uint8_t bpp, uint32_t color_border);
+    void frameSelect(uint8_t idx);
+    bool screenDefaultChanged(const chScreenData &Screen);
+    void defaultBandHashes(const chScreenData &Screen, uint64_t hash[BAND_COUNT]);
 
     displayProp dProp[3];
     TFT_eSPI tft       = TFT_eSPI();       // Invoke custom library
-    TFT_eSprite img    = TFT_eSprite(&tft);
+    //one resident frame per display, img points to the one being drawn
+    FrameSprite frame[SCREEN_COUNT] = {FrameSprite(&tft), FrameSprite(&tft), FrameSprite(&tft)};
+    FrameSprite* img = &frame[0];
 
   private:    
 
-    TFT_eSprite pcimg  = TFT_eSprite(&tft);
-    TFT_eSprite ibuff  = TFT_eSprite(&tft);
-    TFT_eSprite udata = TFT_eSprite(&tft);
+    //band hashes of the content rendered by the default view on each frame
+    uint64_t defaultHash[SCREEN_COUNT][BAND_COUNT];
+    bool defaultValid[SCREEN_COUNT] = {false, false, false};
 
-    uint16_t* imgPtr;
-    uint16_t palette[256];
-    uint16_t RGB332_to_RGB565(uint8_t rgb332);
+    uint8_t screenIndex(uint8_t cs_pin);
+    uint8_t defaultBandsChanged(uint8_t idx, const uint64_t hash[BAND_COUNT]);
+    void defaultHeaderRender(const chScreenData &Screen, uint8_t faultType);
+    void defaultDeviceRender(const chScreenData &Screen, uint8_t faultType);
+    void defaultMeterRender(const chScreenData &Screen, uint8_t faultType);
     void setCSPins(uint8_t state);
 };
 
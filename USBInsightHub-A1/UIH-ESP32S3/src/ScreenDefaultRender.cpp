@@ -14,127 +14,210 @@
 //Default view rendering logic
 
 #include "Screen.h"
+#include "iconAtlas.h"
+#include "MeterMath.h"
 
-void Screen::screenDefaultRender(chScreenData Screen){
-  int cval = 0;
-  String aux = "";
-  long cbarmax = 2000;
-  String device = "*";
-  uint32_t color;
-  uint32_t color_border;
-  int faultType = 0;
-  
-  unsigned long timers=0;
-  unsigned long timere=0;
-  //Fault classification
-  timers=millis();
+static uint8_t defaultFaultType(const chScreenData &Screen){
+  if(Screen.pwr_en && Screen.fault) return 1;
+  if(Screen.mProp.fwdAlertSet||Screen.mProp.backAlertSet) return 2;
+  return 0;
+}
+
+//Hash of everything each band draws. Rotation, power and fault change every band
+void Screen::defaultBandHashes(const chScreenData &Screen, uint64_t hash[BAND_COUNT]){
+  ScreenHash common;
+  common.add(Screen.dProp.rotation);
+  common.add(defaultFaultType(Screen));
+  common.add(Screen.pwr_en);
+
+  ScreenHash hd = common;
+  hd.add(Screen.pconnected);
+  hd.add(Screen.usbHostState);
+  hd.add(Screen.internalErrFlags);
+  hd.add(Screen.startUpmode);
+  hd.add(Screen.pwr_source);
+  hd.add(Screen.wifiState);
+  hd.add(Screen.rssiBars);
+  hd.add(Screen.hubMode);
+  hd.add(Screen.tProp.usbType);
+  hd.add(Screen.data_en);
+
+  ScreenHash dv = common;
+  dv.add(Screen.pconnected);
+  dv.add(Screen.tProp.numDev);
+  dv.text(Screen.tProp.Dev1_Name, SCREEN_NAME_LEN);
+  dv.text(Screen.tProp.Dev2_Name, SCREEN_NAME_LEN);
+  dv.add(Screen.tProp.flex.seq);
+  dv.add(Screen.tProp.flexTop);
+  dv.add(Screen.tProp.imgBuffer);
+  dv.add(Screen.tProp.imgBPP);
+  dv.add(Screen.tProp.imgSeq);
+  dv.add(Screen.tProp.usbType);
+  dv.add(Screen.startup_cnt);
+  dv.add(Screen.startup_timer);
+  dv.add(Screen.showMenuInfoSplash);
+  dv.add(Screen.showVersionChangeSplash);
+  dv.add(Screen.updateState);
+  dv.add(Screen.updateProgress);
+  dv.text(Screen.sigLabel, SCREEN_NAME_LEN);
+  dv.add(Screen.sigAnomaly);
+
+  ScreenHash mt = common;
+  mt.add(Screen.mProp.AvgVoltageUv);
+  mt.add(Screen.mProp.AvgCurrentUa);
+  mt.add(Screen.mProp.fwdCLim);
+  mt.add(Screen.mProp.fwdAlertSet);
+  mt.add(Screen.mProp.sagAlert);
+  mt.add(Screen.mProp.ovAlert);
+  mt.add(Screen.mProp.opAlert);
+
+  hash[0] = hd.h;
+  hash[1] = dv.h;
+  hash[2] = mt.h;
+}
+
+//Bands whose content differs from what is already in the frame
+uint8_t Screen::defaultBandsChanged(uint8_t idx, const uint64_t hash[BAND_COUNT]){
+  uint8_t bands = 0;
+
+  if(!defaultValid[idx]) return BAND_ALL;
+  for(int b = 0; b < BAND_COUNT; b++)
+    if(defaultHash[idx][b] != hash[b]) bands |= 1 << b;
+
+  return bands;
+}
+
+//Each display keeps its frame, only the bands that changed since the last
+//render are cleared, redrawn and pushed
+void Screen::screenDefaultRender(const chScreenData &Screen){
+  uint8_t idx = screenIndex(Screen.dProp.cs_pin);
+  uint8_t bands;
+  uint8_t faultType;
+  uint64_t hash[BAND_COUNT];
 
   if (Screen.tProp.numDev == 11 && Screen.tProp.imgBPP == 0) {
-    return; // incomplete image, do not render
+    //incomplete image, do not render. The buffer is reused, so the next complete
+    //image must be redrawn even if it looks the same to the band check
+    defaultHash[idx][1] = 0;
+    return;
   }
 
-  if(Screen.pwr_en && Screen.fault) faultType = 1;
-  else if (Screen.mProp.fwdAlertSet||Screen.mProp.backAlertSet) faultType = 2;
-  else faultType = 0;
-  img.loadFont(SMALLFONT);
-  //analogWrite(Screen.dProp.dl_pin,Screen.dProp.brightness);
+  defaultBandHashes(Screen, hash);
+  bands = defaultBandsChanged(idx, hash);
+  if(bands == 0) return;
+
+  faultType = defaultFaultType(Screen);
+  img = &frame[idx];
 
   digitalWrite(Screen.dProp.cs_pin, LOW); 
   tft.setRotation(Screen.dProp.rotation);  
-  img.fillScreen(TFT_BLACK);
-  img.setTextColor(TFT_WHITE);  
-  img.setTextFont(1);  
+
+  if(bands & BAND_HEADER) defaultHeaderRender(Screen, faultType);
+  if(bands & BAND_DEVICE) defaultDeviceRender(Screen, faultType);
+  if(bands & BAND_METER)  defaultMeterRender(Screen, faultType);
+
+  if(bands == BAND_ALL){
+    img->pushSprite(0, 0);
+  } else {
+    if(bands & BAND_HEADER) img->pushSprite(0, 0, 0, 0, 240, 33);
+    if(bands & BAND_DEVICE) img->pushSprite(0, 33, 0, 33, 240, 105);
+    if(bands & BAND_METER)  img->pushSprite(0, 138, 0, 138, 240, 102);
+  }
+
+  digitalWrite(Screen.dProp.cs_pin, HIGH);
+
+  memcpy(defaultHash[idx], hash, sizeof(hash));
+  defaultValid[idx] = true;
+}
+
+//Power state, PC, startup, aux power, connection and data switch icons
+void Screen::defaultHeaderRender(const chScreenData &Screen, uint8_t faultType){
+  String aux = "";
+  uint32_t color;
+
+  img->fillRect(0, 0, 240, 33, TFT_BLACK);
+  img->loadFont(SMALLFONT);
+  img->setTextFont(1);  
 
   //power indicator
-  img.setTextSize(1); 
+  img->setTextSize(1); 
 
   if(!Screen.pwr_en){
     color = faultType == 2 ? TFT_YELLOW : TFT_LIGHTGREY; 
-    img.setTextColor(color);
-    //img.fillRect(60, 0, 45, 20, TFT_RED) ;
-    img.drawString("OFF", 2, 2, 4);
-    img.fillRoundRect(0, 33, 240, 104, 10, color);
+    img->setTextColor(color);
+    img->drawString("OFF", 2, 2, 4);
   }
   else{
-    //Screen.fault == true ? color=TFT_RED:color=TFT_GREEN;
     switch(faultType){
-      case 0:  color_border = TFT_GREEN;  break;
-      case 1:  color_border = TFT_RED;    break;
-      case 2:  color_border = TFT_YELLOW; break;
-      default: color_border = TFT_BLUE;   break;
+      case 0:  color = TFT_GREEN;  break;
+      case 1:  color = TFT_RED;    break;
+      case 2:  color = TFT_YELLOW; break;
+      default: color = TFT_BLUE;   break;
     } 
-    img.setTextColor(color_border);
-    //img.fillRect(60,0,45,20,color);
-    img.drawString("ON", 2, 2, 4);
+    img->setTextColor(color);
+    img->drawString("ON", 2, 2, 4);
   }
   
   //PC image  
   if(Screen.dProp.cs_pin == DISPLAY_CS_1 && Screen.usbHostState == USB_PLUGGED){
-    if(Screen.pconnected){
-      pcimg.pushImage(0, 0, 33, 29, PC);
-    } else {
-      pcimg.pushImage(0, 0, 33, 29, NOPC);
-    }
-    pcimg.pushToSprite(&img, 65, 0, TFT_WHITE);
+    iconDraw(Screen.pconnected ? ICON_PC : ICON_NOPC, 65, 0);
   }
 
   //Internal Error flag placer
   if(Screen.internalErrFlags != 0 && Screen.dProp.cs_pin == DISPLAY_CS_1)
   {
-    img.loadFont(SMALLFONT);
-    img.setTextColor(TFT_YELLOW);
+    img->setTextColor(TFT_YELLOW);
     aux = String(Screen.internalErrFlags, HEX);
     aux.toUpperCase();
     if(aux.length() < 2) aux = "0" + aux;    
     aux = "e" + aux;
-    img.drawString(aux, 110, 4, 4);
+    img->drawString(aux, 110, 4, 4);
   }
 
   //Startup timer indicator
   if(Screen.dProp.cs_pin == DISPLAY_CS_2 && Screen.startUpmode != PERSISTANCE){
     switch (Screen.startUpmode){      
-      case START_ON:    ibuff.pushImage(0, 0, 33, 30, ONSTART_ON);        break;
-      case START_OFF:   ibuff.pushImage(0, 0, 33, 30, ONSTART_OFF);       break;
-      case STARTUP_SEC: ibuff.pushImage(0, 0, 33, 30, ONSTART_TIMER);     break;
+      case START_ON:    iconDraw(ICON_ONSTART_ON, 75, 0);        break;
+      case START_OFF:   iconDraw(ICON_ONSTART_OFF, 75, 0);       break;
+      case STARTUP_SEC: iconDraw(ICON_ONSTART_TIMER, 75, 0);     break;
     }
-    ibuff.pushToSprite(&img, 75, 0, TFT_BLACK);    
   }
 
   //AUX power indicator
   if(Screen.dProp.cs_pin == DISPLAY_CS_2 && Screen.pwr_source == VEXT){
-    ibuff.pushImage(0, 0, 33, 30, AUXPWR);
-    ibuff.pushToSprite(&img, 120, 0, TFT_BLACK);
+    iconDraw(ICON_AUXPWR, 120, 0);
   }
 
-
   //connection icon
   if(Screen.dProp.cs_pin == DISPLAY_CS_3){
 
-    if(Screen.wifiState == WIFI_OFFLINE) ibuff.pushImage(0, 0, 33, 30, WIFIE);
+    uint8_t icon = ICON_COUNT; //no icon
+
+    if(Screen.wifiState == WIFI_OFFLINE) icon = ICON_WIFIE;
     else if(Screen.wifiState == STA_CONNECTED || Screen.wifiState == STA_NOCLIENT){
-      if(Screen.rssiBars == 0) ibuff.pushImage(0, 0, 33, 30, WIFI0_);
-      else if(Screen.rssiBars == 1) ibuff.pushImage(0, 0, 33, 30, WIFI1_);
-      else if(Screen.rssiBars == 2) ibuff.pushImage(0, 0, 33, 30, WIFI2_);
-      else if(Screen.rssiBars == 3) ibuff.pushImage(0, 0, 33, 30, WIFI3_);
-      else ibuff.pushImage(0, 0, 33, 30, WIFIE);
+      if(Screen.rssiBars == 0) icon = ICON_WIFI0;
+      else if(Screen.rssiBars == 1) icon = ICON_WIFI1;
+      else if(Screen.rssiBars == 2) icon = ICON_WIFI2;
+      else if(Screen.rssiBars == 3) icon = ICON_WIFI3;
+      else icon = ICON_WIFIE;
     }
     else if(Screen.wifiState == AP_CONNECTED  || Screen.wifiState == AP_NOCLIENT){
-      if(Screen.rssiBars == 0) ibuff.pushImage(0, 0, 33, 30, AP0);
-      else if(Screen.rssiBars == 1) ibuff.pushImage(0, 0, 33, 30, AP1);
-      else if(Screen.rssiBars == 2) ibuff.pushImage(0, 0, 33, 30, AP2);            
-      else if(Screen.rssiBars == 3 || Screen.wifiState == AP_NOCLIENT) ibuff.pushImage(0, 0, 33, 30, AP3);
+      if(Screen.rssiBars == 0) icon = ICON_AP0;
+      else if(Screen.rssiBars == 1) icon = ICON_AP1;
+      else if(Screen.rssiBars == 2) icon = ICON_AP2;
+      else if(Screen.rssiBars == 3 || Screen.wifiState == AP_NOCLIENT) icon = ICON_AP3;
     }
     else if(Screen.wifiState == WIFI_OFF)
-      ibuff.pushImage(0, 0, 33, 30, NOWIFI);
+      icon = ICON_NOWIFI;
 
     int dx = 115;
-    ibuff.pushToSprite(&img, dx, 0, TFT_BLACK);
+    iconDraw(icon, dx, 0);
    
     if(Screen.wifiState == STA_CONNECTED){
-      img.fillTriangle(dx+26,24,dx+32,30,dx+32,18,TFT_WHITE);
+      img->fillTriangle(dx+26,24,dx+32,30,dx+32,18,TFT_WHITE);
     }
     if(Screen.wifiState == AP_CONNECTED){
-      img.fillTriangle(dx+10,30,dx+16,23,dx+22,30,TFT_WHITE);
+      img->fillTriangle(dx+10,30,dx+16,23,dx+22,30,TFT_WHITE);
     }
      
   }  
@@ -149,125 +232,74 @@ void Screen::screenDefaultRender(chScreenData Screen){
   if(Screen.hubMode == USB2_3 || Screen.hubMode == USB2)
   {
     if(!Screen.data_en){
-      //img.setTextColor(TFT_RED);
-      //img.drawRightString("DATA", 238, 2, 4);
-      //img.fillRect(165, 10, 100, 2, TFT_RED) ;
       usbIconDraw(2,false,false);      
     }
     else{
-      //img.setTextColor(TFT_YELLOW);
-      //img.drawRightString("DATA", 238, 2, 4);
       Screen.tProp.usbType == 2 && Screen.pconnected ? usbIconDraw(2,true,true) : usbIconDraw(2,true,false);                  
     }
   }
   
-  
-  img.unloadFont();
-  
-  img.loadFont(aptossb52l);
-  //voltage print
-  img.setTextSize(2);
-  img.setTextColor(TFT_GREEN);
-
-  //ESP_LOGI("1","%u",millis()-timers); //----------------------------------------
-  
-  aux = String(Screen.mProp.AvgVoltage/1000, 3);
-  //aux = String(Screen.mProp.AvgVoltage,0);
-
-  aux.concat(" V");
-  img.drawRightString(aux, 235, 142, 4);
-
-  //current print
-  img.setTextSize(2);
-  switch(faultType){
-    case 0: color = TFT_CYAN;   break;
-    case 1: color = TFT_RED;    break;
-    case 2: color = TFT_YELLOW; break;
-    default : break;
-  }   
-  img.setTextColor(color);
-  aux = String(Screen.mProp.AvgCurrent/1000,3);  
-
-  //to avoid "dancing" negative sign
-  if (Screen.mProp.AvgCurrent <= 0.2 && Screen.mProp.AvgCurrent > -0.2){
-    aux= "0.000";
-  } 
-  //  cval= aux.toInt();
-  cval = int(Screen.mProp.AvgCurrent);
-  aux.concat(" A");
-  img.drawRightString(aux, 235, 182, 4);
-  img.unloadFont();
-
-  //ESP_LOGI("2","%u",millis()-timers); //----------------------------------------
-
-  img.loadFont(SMALLFONT);
-
-  //if(Screen.fault) img.drawCentreString("S",20,180,4);
+  img->unloadFont();
+}
 
-  //Ilim print
-  img.setTextSize(1);
-  img.setTextColor(TFT_LIGHTGREY);
+//Device name box, USB type, startup counter and splashes
+void Screen::defaultDeviceRender(const chScreenData &Screen, uint8_t faultType){
+  String aux = "";
+  String device = "*";
+  uint32_t color_border;
+  long cval = 0;
 
-  aux = String(Screen.mProp.fwdCLim/1000,1);
-  aux.concat("A");
-  if(Screen.mProp.fwdCLim != 0)
-    cbarmax = (long)(Screen.mProp.fwdCLim);
-  else
-    cbarmax = 1000;
- 
-  //current limit value
-  img.drawString(aux, 2, 220, 4);
+  img->fillRect(0, 33, 240, 105, TFT_BLACK);
 
-  //current bar
-  cval = (cval * 150) / cbarmax;
-  // HWSerial.println(cval);
-  img.fillRect(65, 222, cval, 18, TFT_CYAN) ;
+  if(!Screen.pwr_en){
+    color_border = faultType == 2 ? TFT_YELLOW : TFT_LIGHTGREY; 
+    img->fillRoundRect(0, 33, 240, 104, 10, color_border);
+  }
+  else{
+    switch(faultType){
+      case 0:  color_border = TFT_GREEN;  break;
+      case 1:  color_border = TFT_RED;    break;
+      case 2:  color_border = TFT_YELLOW; break;
+      default: color_border = TFT_BLUE;   break;
+    } 
+  }
 
   //Device name box
   if (Screen.tProp.numDev == 11) {
     imagePrint(Screen.tProp.imgBuffer, Screen.tProp.imgBPP, color_border);
   } else {
-    img.fillSmoothRoundRect(0, 33, 240, 104, 18, color_border, TFT_BLACK);
-    img.fillSmoothRoundRect(7, 40, 226, 90, 10, DARKGREY, color_border);
+    img->fillSmoothRoundRect(0, 33, 240, 104, 18, color_border, TFT_BLACK);
+    img->fillSmoothRoundRect(7, 40, 226, 90, 10, DARKGREY, color_border);
   }
 
   //Device text print
-  //img.setTextSize(2);
-  img.unloadFont();
-  img.loadFont(modenine50); 
-
-  //Screen.tProp.numDev=10;
+  img->loadFont(modenine50); 
 
   if(Screen.tProp.numDev==0){
-    img.setTextColor(TFT_LIGHTGREY);
-    device = "----";
-    img.drawCentreString(device, 120, 65, 4); //**
+    img->setTextColor(TFT_LIGHTGREY);
+    //no name from the PC, best guess from the learned power signatures
+    device = Screen.sigLabel[0] ? "~" + String(Screen.sigLabel) : "----";
+    img->drawCentreString(device, 120, 65, 4); //**
   } 
   else if(Screen.tProp.numDev == 1){
-    Screen.pconnected == true ? img.setTextColor(TFT_YELLOW) : img.setTextColor(TFT_LIGHTGREY);
-    //img.setTextColor(TFT_YELLOW);
+    Screen.pconnected == true ? img->setTextColor(TFT_YELLOW) : img->setTextColor(TFT_LIGHTGREY);
     device = Screen.tProp.Dev1_Name;
-    img.drawCentreString(device, 120, 65, 4); //**
+    img->drawCentreString(device, 120, 65, 4); //**
   } 
   else if(Screen.tProp.numDev == 2){
-    Screen.pconnected == true ? img.setTextColor(TFT_YELLOW) : img.setTextColor(TFT_LIGHTGREY);
-    //img.setTextColor(TFT_YELLOW);   
-    img.drawCentreString(Screen.tProp.Dev1_Name,120,45,4);
-    Screen.pconnected == true ? img.setTextColor(TFT_WHITE) : img.setTextColor(TFT_LIGHTGREY);
-    //img.setTextColor(TFT_ORANGE);
-    img.drawCentreString(Screen.tProp.Dev2_Name,120,85,4); //**
+    Screen.pconnected == true ? img->setTextColor(TFT_YELLOW) : img->setTextColor(TFT_LIGHTGREY);
+    img->drawCentreString(Screen.tProp.Dev1_Name,120,45,4);
+    Screen.pconnected == true ? img->setTextColor(TFT_WHITE) : img->setTextColor(TFT_LIGHTGREY);
+    img->drawCentreString(Screen.tProp.Dev2_Name,120,85,4); //**
   }
-  img.unloadFont();
-
+  img->unloadFont();
 
-  if(Screen.tProp.numDev == 10) flexDevicePrint(Screen.tProp.Dev1_Name,Screen.pconnected);
 
-
-  //ESP_LOGI("3","%u",millis()-timers); //----------------------------------------
+  if(Screen.tProp.numDev == 10) flexDevicePrint(Screen.tProp.flex,Screen.tProp.flexTop,Screen.pconnected);
 
   //USB type info
-  img.setTextSize(1);
-  img.setTextColor(TFT_WHITE);
+  img->setTextSize(1);
+  img->setTextColor(TFT_WHITE);
   
   int32_t tiw = 40;
   int32_t tit = 20;
@@ -275,247 +307,281 @@ void Screen::screenDefaultRender(chScreenData Screen){
   if(Screen.tProp.numDev >= 10) {tiw = 20; tit = 10;}
 
   if(Screen.tProp.usbType == 2) {    
-    img.fillRoundRect(0, 33, tiw, 22, 5, TFT_RED);
-    img.drawCentreString(Screen.tProp.numDev>=10 ? "2":"2.0", tit, 32, 4);
+    img->fillRoundRect(0, 33, tiw, 22, 5, TFT_RED);
+    img->drawCentreString(Screen.tProp.numDev>=10 ? "2":"2.0", tit, 32, 4);
   }
 
   if(Screen.tProp.usbType == 3) {
-    img.fillRoundRect(0, 33, tiw, 22, 5, TFT_BLUE);
-    img.drawCentreString(Screen.tProp.numDev>=10 ? "3":"3.0", tit, 32, 4);
+    img->fillRoundRect(0, 33, tiw, 22, 5, TFT_BLUE);
+    img->drawCentreString(Screen.tProp.numDev>=10 ? "3":"3.0", tit, 32, 4);
   }
 
-
-
-  //Fault indicator
-  int font=2;
-  int center=175;
-  switch(faultType)
-  {
-    case 1: 
-      color = TFT_RED;
-      aux   = "!";
-      break;
-    case 2: 
-      color  = TFT_YELLOW;
-      font   = 1;
-      center = 185;
-      aux    = Screen.mProp.fwdAlertSet == true ? "OC" : "BC"; 
-      break;
-    default:
-	  break;
-  } 
-
-  if(faultType != 0)
-  {
-    //warimg.pushImage(0,0,35,35,OCWARNING);
-    //warimg.pushToSprite(&img,2,180,TFT_WHITE);
-    //img.loadFont(modenine50);     
-    img.fillRoundRect(5, 175, 40, 40, 10, color);
-    img.setTextColor(TFT_BLACK);
-    img.setTextSize(font);
-    img.drawCentreString(aux, 25, center, 4);
+  //power signature unlike the learned one for this device
+  if(Screen.sigAnomaly) {
+    img->fillRoundRect(240 - tiw, 33, tiw, 22, 5, TFT_YELLOW);
+    img->setTextColor(TFT_BLACK);
+    img->drawCentreString("!", 240 - tit, 32, 4);
   }
 
   //startup counter
   if(Screen.startup_cnt > 0){
-    img.loadFont(aptossb52l);  
-    img.setTextSize(2);
-    img.setTextColor(TFT_GREEN);
-    img.fillRoundRect(7, 40, 226, 90, 10, TFT_BLACK);
+    img->loadFont(aptossb52l);  
+    img->setTextSize(2);
+    img->setTextColor(TFT_GREEN);
+    img->fillRoundRect(7, 40, 226, 90, 10, TFT_BLACK);
     cval = ((Screen.startup_timer-Screen.startup_cnt) * 226) / Screen.startup_timer;
-    img.fillRoundRect(7, 40, cval, 90, 10, DARKGREY);
+    img->fillRoundRect(7, 40, cval, 90, 10, DARKGREY);
     //aux = String((Screen.startup_cnt+9)/10) + "/" + String((Screen.startup_timer+10)/10);
     aux = String((float)(Screen.startup_cnt)/10) + "s";
-    img.drawCentreString(aux, 120, 65, 4); //**
-    img.unloadFont();
+    img->drawCentreString(aux, 120, 65, 4); //**
+    img->unloadFont();
   }
 
-
-
   //Menu access information splash
-
   if(Screen.dProp.cs_pin == DISPLAY_CS_3 && Screen.showMenuInfoSplash){
-    img.loadFont(SMALLFONT);
-    img.fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
-    img.fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
-    img.setTextColor(TFT_BLACK);
-    img.drawString("Long press to",10,50,4);
-    img.drawString("enter Setup",10,80,4);
-    img.fillTriangle(204,45,204,75,230,60,TFT_BLACK);
-    img.unloadFont();
+    img->loadFont(SMALLFONT);
+    img->fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
+    img->fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
+    img->setTextColor(TFT_BLACK);
+    img->drawString("Long press to",10,50,4);
+    img->drawString("enter Setup",10,80,4);
+    img->fillTriangle(204,45,204,75,230,60,TFT_BLACK);
+    img->unloadFont();
   }
 
   //Version update splash
   if(Screen.dProp.cs_pin == DISPLAY_CS_2 && Screen.showVersionChangeSplash){
-    img.loadFont(SMALLFONT);
-    img.fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
-    img.fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
-    img.setTextColor(TFT_BLACK);
-    img.drawString("Updated to ver.",10,50,4);
+    img->loadFont(SMALLFONT);
+    img->fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
+    img->fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
+    img->setTextColor(TFT_BLACK);
+    img->drawString("Updated to ver.",10,50,4);
     aux= String(APP_VERSION);
     aux.concat(" !");
-    img.drawString(aux,10,80,4);
-    img.unloadFont();
+    img->drawString(aux,10,80,4);
+    img->unloadFont();
   }
 
   //Update in progress splash
   if(Screen.dProp.cs_pin == DISPLAY_CS_2 && Screen.updateState != 0){
-    img.loadFont(SMALLFONT);
-    img.fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
-    img.fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
-    img.setTextColor(TFT_BLACK);
+    img->loadFont(SMALLFONT);
+    img->fillRoundRect(5, 40, 235, 80, 5, TFT_BLUE);
+    img->fillRoundRect(9, 44, 229, 76, 5, TFT_WHITE);
+    img->setTextColor(TFT_BLACK);
     if(Screen.updateState == 3)
     {
-      img.drawString("   DONE!",10,62,4);
+      img->drawString("   DONE!",10,62,4);
     }
     else{
-      img.drawString("Downloading",10,50,4);
-      img.drawString("Firmware ...",10,80,4);        
+      img->drawString("Downloading",10,50,4);
+      img->drawString("Firmware " + String(Screen.updateProgress) + "%",10,80,4);
+      img->fillRect(14, 108, (219 * Screen.updateProgress) / 100, 6, TFT_BLUE);
     }
-    img.unloadFont();
+    img->unloadFont();
   }
+}
 
-  /*
-  //Use for palette evaluation
-  int offset = 0;
-  if(Screen.dProp.cs_pin == DISPLAY_CS_2) offset = 40; 
-
-  img.fillScreen(TFT_BLACK);
-  img.fillRoundRect(offset, 0, 200, 25, 1, TFT_WHITE);
-  img.fillRoundRect(offset, 25, 200, 25, 1, TFT_YELLOW);
-  img.fillRoundRect(offset, 50, 200, 25, 1, TFT_GREEN);
-  img.fillRoundRect(offset, 75, 200, 25, 1, TFT_ORANGE);
-  img.fillRoundRect(offset, 100, 200, 25, 1, TFT_RED);
-  img.fillRoundRect(offset, 125, 200, 25, 1, TFT_CYAN);
-  img.fillRoundRect(offset, 150, 200, 25, 1, TFT_BLUE);
-  img.fillRoundRect(offset, 175, 200, 25, 1, TFT_LIGHTGREY);
-  img.fillRoundRect(offset, 200, 200, 25, 1, DARKGREY);
-  */  
-
-
-  //ESP_LOGI("4","%u",millis()-timers); //---------------------------------------- 
-  
-  //timers=millis();
-  img.pushSprite(0, 0);
-  //tft.pushImageDMA(0,0,240,240,imgPtr); // use only with 16bit color depth
-  //timere=millis();
-  //ESP_LOGI("P","%u",millis()-timers); //----------------------------------------- 
-  
-  /*
-  while(tft.dmaBusy()){
-    vTaskDelay(pdMS_TO_TICKS(5));    
-  }*/
-  
-  //ESP_LOGI("W","%u",millis()-timers); //---------------------------------------- 
+//Voltage, current, current limit bar and fault indicator
+void Screen::defaultMeterRender(const chScreenData &Screen, uint8_t faultType){
+  int cval = 0;
+  String aux = "";
+  char num[16];
+  long cbarmax = 2000;
+  uint32_t color = TFT_CYAN;
 
-  digitalWrite(Screen.dProp.cs_pin, HIGH);
+  img->fillRect(0, 138, 240, 102, TFT_BLACK);
+
+  img->loadFont(aptossb52l);
+  //voltage print
+  img->setTextSize(2);
+  img->setTextColor(TFT_GREEN);
   
+  meterFormat(num, sizeof(num) - 2, Screen.mProp.AvgVoltageUv, 3);
+  strcat(num, " V");
+  img->drawRightString(num, 235, 142, 4);
+
+  //current print
+  img->setTextSize(2);
+  switch(faultType){
+    case 0: color = TFT_CYAN;   break;
+    case 1: color = TFT_RED;    break;
+    case 2: color = TFT_YELLOW; break;
+    default : break;
+  }   
+  img->setTextColor(color);
+  //to avoid "dancing" negative sign
+  if (Screen.mProp.AvgCurrentUa <= 200 && Screen.mProp.AvgCurrentUa > -200)
+    strcpy(num, "0.000");
+  else
+    meterFormat(num, sizeof(num) - 2, Screen.mProp.AvgCurrentUa, 3);
+  cval = Screen.mProp.AvgCurrentUa / 1000;
+  strcat(num, " A");
+  img->drawRightString(num, 235, 182, 4);
+  img->unloadFont();
+
+  img->loadFont(SMALLFONT);
+
+  //Ilim print
+  img->setTextSize(1);
+  img->setTextColor(TFT_LIGHTGREY);
+
+  meterFormat(num, sizeof(num) - 1, (int32_t)Screen.mProp.fwdCLim * 1000, 1);
+  strcat(num, "A");
+  if(Screen.mProp.fwdCLim != 0)
+    cbarmax = (long)(Screen.mProp.fwdCLim);
+  else
+    cbarmax = 1000;
+ 
+  //current limit value
+  img->drawString(num, 2, 220, 4);
+
+  //current bar
+  cval = (cval * 150) / cbarmax;
+  img->fillRect(65, 222, cval, 18, TFT_CYAN) ;
+  img->unloadFont();
+
+  //Fault indicator
+  int font=2;
+  int center=175;
+  switch(faultType)
+  {
+    case 1: 
+      color = TFT_RED;
+      aux   = "!";
+      break;
+    case 2: 
+      color  = TFT_YELLOW;
+      font   = 1;
+      center = 185;
+      aux    = Screen.mProp.fwdAlertSet == true ? "OC" : "BC"; 
+      break;
+    default:
+	  break;
+  } 
+
+  if(faultType != 0)
+  {
+    img->fillRoundRect(5, 175, 40, 40, 10, color);
+    img->setTextColor(TFT_BLACK);
+    img->setTextSize(font);
+    img->drawCentreString(aux, 25, center, 4);
+  }
+
+  //VBUS and power alerts latched since the port was switched on
+  if(Screen.mProp.ovAlert || Screen.mProp.sagAlert || Screen.mProp.opAlert)
+  {
+    aux = Screen.mProp.ovAlert ? "OV" : (Screen.mProp.sagAlert ? "SAG" : "OP");
+    img->fillRoundRect(5, 142, 40, 28, 8, TFT_ORANGE);
+    img->setTextColor(TFT_BLACK);
+    img->setTextSize(1);
+    img->drawCentreString(aux, 25, 148, 2);
+  }
 }
 
 //------------------------------ HELPERS -------------------------------------
 
 void Screen::usbIconDraw(uint8_t type, bool active, bool com){
 
-  uint32_t x, y, w, h, color;
+  uint32_t x, color;
 
   if (type != 2 && type != 3) return;
 
-  udata.fillScreen(TFT_BLACK);
-
   if(type == 2){
-    udata.pushImage(0, 0, 12, 19, NARROW2);
-    if(active){
-      x=168; y=1; w=34; h=28; color=TFT_RED;
-    }
-    else{      
-      x=168; y=1; w=34; h=28; color=DARKGREY;
-    }
-  }
-  if(type == 3){
-    udata.pushImage(0, 0, 12, 19, NARROW3);
-    if(active){
-      x=206; y=1; w=34; h=28; color=TFT_BLUE;
-    }
-    else{
-      x=206; y=1; w=34; h=28; color=DARKGREY;
-    }
+    x = 168;
+    color = active ? TFT_RED : DARKGREY;
+  } else {
+    x = 206;
+    color = active ? TFT_BLUE : DARKGREY;
   }
 
-  img.fillRoundRect(x, y, w, h, 3, color);
+  img->fillRoundRect(x, 1, 34, 28, 3, color);
 
-  udata.pushToSprite(&img, x+20, 5, TFT_BLACK);
-  
-  udata.fillScreen(TFT_BLACK);
-  if(active){
-    if(com){
-      udata.pushImage(0, 0, 19, 21, COMARROW);
-      udata.pushToSprite(&img, x+1, 5, TFT_BLACK);
-    } else {
-      udata.pushImage(0, 0, 11, 26, CSWITCH);
-      udata.pushToSprite(&img, x+3, 1, TFT_BLACK);      
-    }
+  iconDraw(type == 2 ? ICON_NARROW2 : ICON_NARROW3, x+20, 5);
 
+  if(active){
+    if(com) iconDraw(ICON_COMARROW, x+1, 5);
+    else    iconDraw(ICON_CSWITCH, x+3, 1);
   } else {
-    udata.pushImage(0, 0, 11, 26, NOSWITCH);
-    udata.pushToSprite(&img, x+3, 1, TFT_BLACK);
+    iconDraw(ICON_NOSWITCH, x+3, 1);
   }
 
 }
 
+//Decodes an icon of the atlas straight into the frame sprite, RGB332 atlas colors
+//go through the frame palette table. Transparent runs are skipped, so no
+//intermediate sprite or color key compare is needed.
+void Screen::iconDraw(uint8_t id, int32_t x, int32_t y){
+
+  if (id >= ICON_COUNT) return;
+
+  const IconDesc &d = iconAtlas[id];
+  const uint8_t *src = iconAtlasData + d.offset;
+  const int32_t total = d.w * d.h;
+  int32_t px = 0;
+
+  if (!img->created()) return;
+
+  while (px < total) {
+    uint8_t op = pgm_read_byte(src++);
+    int32_t run;
+    bool literal = false;
+    uint8_t c = 0;
+
+    if (op & 0x80) {              //literal block
+      run = (op & 0x7F) + 1;
+      literal = true;
+    } else if (op & 0x40) {       //repeated color
+      run = (op & 0x3F) + 1;
+      c = img->color332Index(pgm_read_byte(src++));
+    } else {                      //transparent skip
+      px += (op & 0x3F) + 1;
+      continue;
+    }
+
+    for (int32_t i = 0; i < run; i++, px++) {
+      if (literal) c = img->color332Index(pgm_read_byte(src++));
+      img->writeIndex(x + px % d.w, y + px / d.w, c);
+    }
+  }
+}
+
 //This function is used to print variable length texts sent by the 
-//Enumeration extraction agent via serial
-void Screen::flexDevicePrint(String jsonStr, bool pcCon){
+//Enumeration extraction agent via serial, already parsed into lines at ingest
+void Screen::flexDevicePrint(const FlexLayout &flex, uint8_t top, bool pcCon){
 
-  JsonDocument doc;
+  static const uint16_t flexColors[] = {TFT_WHITE, TFT_YELLOW, TFT_ORANGE, TFT_BLACK, TFT_RED,
+                                        DARKGREY, TFT_CYAN, TFT_BLUE, TFT_GREEN};
+  //vertical text offsets by number of lines
+  static const int ty[FLEX_VISIBLE_LINES][FLEX_VISIBLE_LINES] = {{70,0,0}, {55,85,0}, {42,72,102}};
 
+  int lines = flex.numLines;
+  if(lines == 0) return;
+  if(lines > FLEX_VISIBLE_LINES) lines = FLEX_VISIBLE_LINES;
+  if(top + lines > flex.numLines) top = flex.numLines - lines;
 
-  u_int16_t color = TFT_WHITE;
-  int ty[3]= {70,0,0};
+  img->loadFont(monofonto30);
 
-  int lines = 1;
+  for (int i=0; i< lines; i++){
+    const FlexLine &l = flex.line[top+i];
+    int32_t x;
 
-  if(jsonStr != "")
-  {
-    DeserializationError error = deserializeJson(doc, jsonStr);  
-    if(!error){
-      img.loadFont(monofonto30);
-      //vertical text offsets by number of lines      
-      if(doc["T1"] && doc["T2"] && doc["T3"]) {ty[0] = 42; ty[1] = 72; ty[2] = 102; lines = 3;}   //three lines
-      if(doc["T1"] && doc["T2"] && !doc["T3"]) {ty[0] = 55; ty[1] = 85; lines = 2;}  //two lines
-      if(doc["T1"] && !doc["T2"] && !doc["T3"]) {ty[0] = 70; lines = 1;} //one line
-
-      for (int i=0; i< lines; i++){
-
-        String ind = "T"+String(i+1);
-
-        if(doc[ind]["color"] == "YELLOW") color = TFT_YELLOW;
-        else if(doc[ind]["color"] == "ORANGE")  color = TFT_ORANGE;
-        else if(doc[ind]["color"] == "BLACK")  color = TFT_BLACK;
-        else if(doc[ind]["color"] == "RED")  color = TFT_RED;
-        else if(doc[ind]["color"] == "DARKGREY")  color = DARKGREY;
-        else if(doc[ind]["color"] == "CYAN")  color = TFT_CYAN;
-        else if(doc[ind]["color"] == "BLUE")  color = TFT_BLUE;
-        else if(doc[ind]["color"] == "GREEN")  color = TFT_GREEN;
-
-        img.setTextColor(color);
-
-        if (!pcCon) img.setTextColor(TFT_LIGHTGREY);
-
-        String temp = String(doc[ind]["txt"].as<const char*>());
-        temp = temp.substring(0,14);
-
-        if(doc[ind]["align"] == "left"){
-          img.drawString(temp,15,ty[i],4);
-        } 
-        else if(doc[ind]["align"] == "right"){
-          img.drawRightString(temp, 230, ty[i], 4);
-        } 
-        else if(doc[ind]["txt"]){
-          img.drawCentreString(temp, 120, ty[i], 4);
-        }
-      }  
-      img.unloadFont();        
-    }
+    img->setTextColor(pcCon ? flexColors[l.color] : TFT_LIGHTGREY);
+
+    if(l.align == FLEX_ALIGN_LEFT) x = 15;
+    else if(l.align == FLEX_ALIGN_RIGHT) x = 230 - l.width;
+    else x = 120 - l.width/2;
+
+    img->drawString(l.txt, x, ty[lines-1][i]);
+  }
+  img->unloadFont();
+
+  //scroll position of longer lists
+  if(flex.numLines > FLEX_VISIBLE_LINES){
+    int32_t track = 82;
+    int32_t thumb = track * FLEX_VISIBLE_LINES / flex.numLines;
+    int32_t pos = (track - thumb) * top / (flex.numLines - FLEX_VISIBLE_LINES);
+    img->fillRect(229, 44, 2, track, TFT_BLACK);
+    img->fillRect(229, 44 + pos, 2, thumb, TFT_LIGHTGREY);
   }
 
 }
@@ -525,6 +591,6 @@ void Screen::imagePrint(uint16_t* imgBuffer, uint8_t bpp, uint32_t borderColor)
   if (imgBuffer == nullptr || bpp == 0) {
     return;
   }
-  img.pushImage(7, 40, 226, 90, imgBuffer, bpp);
-  img.drawSmoothRoundRect(0, 33, 18, 11, 240, 104, borderColor, TFT_BLACK);
+  img->pushImageMapped(7, 40, 226, 90, (const uint8_t*)imgBuffer, bpp);
+  img->drawSmoothRoundRect(0, 33, 18, 11, 240, 104, borderColor, TFT_BLACK);
 }
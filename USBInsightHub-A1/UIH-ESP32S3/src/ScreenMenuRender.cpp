@@ -20,14 +20,14 @@
 const char* helpArr[] = {
 /*   "Individual Channel"*/    
 /*0*/"",
-/*1*/"Individual CH:\n -Over Current\n -Back Current\n -Starup Timer",
+/*1*/"Individual CH:\n -Current limits\n -VBUS limits\n -Power limit\n -Starup Timer",
 /*2*/"Global settings:\n -Wi-Fi\n -Startup Mode\n -Meter\n -Screen\n -Hub Mode",
 /*3*/"Forward current\nlimit",
 /*4*/"Reverse current\nlimit",
 /*5*/"Delay time\nafter power up\nto turn on this\nchannel",
-/*6*/"",
-/*7*/"",
-/*8*/"",
+/*6*/"VBUS sag alert\nlevel, logged\nand shown as\nSAG",
+/*7*/"VBUS over\nvoltage alert\nlevel",
+/*8*/"Power alert\nlevel, the port\nstays on",
 /*9*/"",
 /*10*/" -Information\n -Recovery \n -Reset\n -Enable",
 /*11*/"Reset the current\nconnection,\nand force\nAccess Point\nmode",
@@ -69,24 +69,67 @@ const char* helpArr[] = {
 /*47*/"Restore to\nfactory\ndefaults.\nWi-Fi credentials\nare preserved"
 };
 
+#define LIST_MAX_ROWS   4
+#define LIST_ROW_H      40
 
-void screenMenuIntroRender(Menu* m, Screen* s, String channel){
+//What is currently drawn on each menu screen, to skip or narrow down redraws
+struct MenuIntroCache {
+    const Menu* menu;
+    String channel;
+};
+
+struct MenuListCache {
+    const Menu* menu;
+    int type;                       //<0 submenu list, otherwise selected option
+    int start;
+    int size;
+    int index;
+    bool arrow;
+};
+
+struct MenuInfoCache {
+    const Menu* menu;
+    int index;
+    uint16_t sel;
+};
+
+static MenuIntroCache introCache = {nullptr, ""};
+static MenuListCache listCache = {nullptr, 0, 0, 0, 0, false};
+static MenuInfoCache infoCache = {nullptr, 0, 0};
+
+static void menuListRowRender(const Menu* m, Screen* s, int item, int row, int index, int type, bool arrow);
+
+//Force a full redraw of the given menu screens (menu entry or screens drawn by other views)
+void screenMenuInvalidate(uint8_t screens){
+    if(screens & MENU_SCR_INTRO) introCache.menu = nullptr;
+    if(screens & MENU_SCR_LIST)  listCache.menu = nullptr;
+    if(screens & MENU_SCR_INFO)  infoCache.menu = nullptr;
+}
+
+
+void screenMenuIntroRender(const Menu* m, Screen* s, String channel){
 
     uint8_t ch=0;
 
+    //intro only depends on the menu level, nothing to do while moving inside it
+    if(introCache.menu == m && introCache.channel == channel) return;
+    introCache.menu = m;
+    introCache.channel = channel;
+
     digitalWrite(s->dProp[ch].cs_pin, LOW);     
+    s->frameSelect(ch);
     //s->tft.setRotation(s->dProp[ch].rotation);
     s->tft.setRotation(ROT_180_DEG);
-    s->img.fillScreen(TFT_BLACK);          
+    s->img->fillScreen(TFT_BLACK);          
 
     //header
-    s->img.fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
-    if(m->name =="Over Current" || m->name =="Back Current" ||m->name =="Startup Timer"){
+    s->img->fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
+    if(m->flags & MF_CHANNEL){
         menuTextItemPlacer("CH"+String(channel.toInt()+1),s,1,0,0);
         menuTextItemPlacer(m->name,s,2,0,0);
         menuButtonTextPlacer(s,"Return");
     }
-    else if(m->name == "Configurations"){
+    else if(m->flags & MF_MAIN){
         menuTextItemPlacer(m->name,s,1,0,0);
         menuTextItemPlacer("Ver: " + String(APP_VERSION) + "_" + channel,s,3,0,0);
         String mac = WiFi.macAddress();
@@ -99,116 +142,163 @@ void screenMenuIntroRender(Menu* m, Screen* s, String channel){
         menuButtonTextPlacer(s,"Return");
     }
 
-    s->img.pushSprite(0,0);
+    s->img->pushSprite(0,0);
     digitalWrite(s->dProp[ch].cs_pin, HIGH);
 }
 
-void screenMenuListRender(Menu* m, Screen* s, int index, int type){
+void screenMenuListRender(const Menu* m, Screen* s, int index, int type){
     uint8_t ch=1;
-    String txt="";
     bool downArrow = false;
 
+    int start = 0;
+    int size = 0;
+    type < 0 ? size = m->numSubmenus: size = m->numParams;
+
+    //down arrow if more items exist
+    if(size > LIST_MAX_ROWS && (index+1) != size) downArrow = true;   
+
+    if(size > LIST_MAX_ROWS) size = LIST_MAX_ROWS;
+    index < LIST_MAX_ROWS ? start = 0 : start = index -(LIST_MAX_ROWS-1);
+
     digitalWrite(s->dProp[ch].cs_pin, LOW);     
+    s->frameSelect(ch);
     //s->tft.setRotation(s->dProp[ch].rotation);
     s->tft.setRotation(ROT_180_DEG);
-    s->img.fillScreen(TFT_BLACK); 
 
-    //header
-    s->img.fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
+    //Same list and same window: repaint only the rows whose highlight, tick or arrow changed
+    if(listCache.menu == m && listCache.start == start && listCache.size == size &&
+       (listCache.type < 0) == (type < 0)){
+        for(int i=start; i < (start+size); i++){
+            int row = i-start+1;
+            bool last = (row == LIST_MAX_ROWS);
+            bool changed = (i == index) != (i == listCache.index) ||
+                           (type >= 0 && (i == type) != (i == listCache.type)) ||
+                           (last && downArrow != listCache.arrow);
+            if(changed) menuListRowRender(m,s,i,row,index,type,last && downArrow);
+        }
+        listCache.index = index;
+        listCache.type = type;
+        listCache.arrow = downArrow;
+        digitalWrite(s->dProp[ch].cs_pin, HIGH);
+        return;
+    }
 
-    int start = 0;
-    int size = 0;
-    type < 0 ? size = m->submenus.size(): size = m->params.size();
+    s->img->fillScreen(TFT_BLACK); 
 
-    //down arrow if more items exist
-    if(size > 4 && (index+1) != size) downArrow = true;   
+    //header
+    s->img->fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
 
-    if(size > 4) size = 4;
-    index < 4 ? start = 0 : start = index -3;
     //displace the list
     for(int i=start; i < (start+size); i++){
         if(type < 0){
-            txt = String(i+1) + "." + m->submenus[i].name;
-            menuTextItemPlacer(txt,s,(i-start+1),index==i ? 1:0,0);
+            menuTextItemPlacer(String(i+1) + "." + m->submenus[i].name,s,(i-start+1),index==i ? 1:0,0);
         } 
         else {
-            txt = String(i+1) + ". " + m->params[i];
-            menuTextItemPlacer(txt,s,(i-start+1),index==i ? 1:0, type==i ? 1:0);                
+            menuTextItemPlacer(String(i+1) + ". " + m->params[i],s,(i-start+1),index==i ? 1:0, type==i ? 1:0);                
         }
     }   
 
-    if(downArrow) s->img.fillTriangle(210,170,230,170,220,190,TFT_LIGHTGREY);
+    if(downArrow) s->img->fillTriangle(210,170,230,170,220,190,TFT_LIGHTGREY);
 
     menuButtonTextPlacer(s,"Move");
 
-    s->img.pushSprite(0,0);
+    s->img->pushSprite(0,0);
     digitalWrite(s->dProp[ch].cs_pin, HIGH);
+
+    listCache = {m, type, start, size, index, downArrow};
 }
 
+//Draw a single list row in its band of the sprite and push only that band
+static void menuListRowRender(const Menu* m, Screen* s, int item, int row, int index, int type, bool arrow){
+    int32_t y = LIST_ROW_H*row-4;
 
-void screenMenuRangeRender(uint16_t value, String units, Screen* s){
+    s->img->fillRect(0,y,240,LIST_ROW_H,TFT_BLACK);
+    if(type < 0)
+        menuTextItemPlacer(String(item+1) + "." + m->submenus[item].name,s,row,index==item ? 1:0,0);
+    else
+        menuTextItemPlacer(String(item+1) + ". " + m->params[item],s,row,index==item ? 1:0, type==item ? 1:0);
+    if(arrow) s->img->fillTriangle(210,170,230,170,220,190,TFT_LIGHTGREY);
+
+    s->img->pushSprite(0,y,0,y,240,LIST_ROW_H);
+}
+
+
+void screenMenuRangeRender(uint16_t value, const char* units, uint8_t flags, Screen* s){
     uint8_t ch=1;
 
+    listCache.menu = nullptr; //list screen replaced by the value
+
     digitalWrite(s->dProp[ch].cs_pin, LOW);     
+    s->frameSelect(ch);
     //s->tft.setRotation(s->dProp[ch].rotation);
     s->tft.setRotation(ROT_180_DEG);
-    s->img.fillScreen(TFT_BLACK); 
+    s->img->fillScreen(TFT_BLACK); 
 
     //header
-    s->img.fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
-
-    s->img.loadFont(aptossb52l);
-    s->img.setTextSize(2);
-    s->img.setTextColor(TFT_WHITE);
-    if(units =="s"){        
-        s->img.drawCentreString(String((float)(value)/10,1), 120, 80, 4);    
+    s->img->fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
+
+    s->img->loadFont(aptossb52l);
+    s->img->setTextSize(2);
+    s->img->setTextColor(TFT_WHITE);
+    if((flags & MF_OFF) && value == 0){
+        s->img->drawCentreString("Off", 120, 80, 4);
+        units = "";
     }
-    else if(units =="%"){
-        s->img.drawCentreString(String((float)(value)/10,0), 120, 80, 4); 
+    else if(strcmp(units,"s") == 0){        
+        s->img->drawCentreString(String((float)(value)/10,1), 120, 80, 4);    
+    }
+    else if(strcmp(units,"%") == 0){
+        s->img->drawCentreString(String((float)(value)/10,0), 120, 80, 4); 
     }
     else {
-        s->img.drawCentreString(String(value), 120, 80, 4);
+        s->img->drawCentreString(String(value), 120, 80, 4);
     }
     //aux.concat(" V");    
     
-    s->img.drawCentreString(String(units), 120, 120, 4);    
-    s->img.unloadFont();
+    s->img->drawCentreString(String(units), 120, 120, 4);    
+    s->img->unloadFont();
     
     menuButtonTextPlacer(s,"Down");
 
-    s->img.pushSprite(0,0);
+    s->img->pushSprite(0,0);
     digitalWrite(s->dProp[ch].cs_pin, HIGH);        
 }
 
-void screenMenuInfoRender(Menu* m, Screen* s, uint16_t sel ,int index){
+void screenMenuInfoRender(const Menu* m, Screen* s, uint16_t sel ,int index){
     uint8_t ch=2;
 
+    //help text of range items does not change with the value, only the brightness preview does
+    if(m->menuType == TYPE_RANGE && !(m->flags & MF_BRIGHTNESS)) sel = 0;
+    if(infoCache.menu == m && infoCache.index == index && infoCache.sel == sel) return;
+    infoCache = {m, index, sel};
+
     digitalWrite(s->dProp[ch].cs_pin, LOW);     
+    s->frameSelect(ch);
     //s->tft.setRotation(s->dProp[ch].rotation);
     s->tft.setRotation(ROT_180_DEG);
-    s->img.fillScreen(TFT_BLACK); 
+    s->img->fillScreen(TFT_BLACK); 
 
     //header
-    s->img.fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
+    s->img->fillRoundRect(5,17,230,6,1,TFT_LIGHTGREY);
 
-    s->img.loadFont(SMALLFONT);
-    s->img.setTextFont(2);
-    s->img.setTextColor(TFT_WHITE);
+    s->img->loadFont(SMALLFONT);
+    s->img->setTextFont(2);
+    s->img->setTextColor(TFT_WHITE);
 
     if(m->menuType == TYPE_ROOT){        
-        drawTextWithNewlines(s,helpArr[m->submenus[index].helpReference[0]],5,30,3);
+        drawTextWithNewlines(s,helpArr[m->submenus[index].help],5,30,3);
     }
     if(m->menuType == TYPE_RANGE){
-        drawTextWithNewlines(s,helpArr[m->helpReference[0]],5,30,3);
-        if(m->name == "Brightness"){
+        drawTextWithNewlines(s,helpArr[m->help],5,30,3);
+        if(m->flags & MF_BRIGHTNESS){
             s->screenSetBackLight(sel);
             renderDemoScreen(s, ch, ROT_180_DEG);
             digitalWrite(s->dProp[ch].cs_pin, LOW);
         }
     }
     if(m->menuType == TYPE_SELECT){        
-        drawTextWithNewlines(s,helpArr[m->helpReference[index+1]],5,30,3);
-        if(m->name == "Rotation"){
+        drawTextWithNewlines(s,helpArr[m->optionHelp ? m->optionHelp[index] : H_NONE],5,30,3);
+        if(m->flags & MF_ROTATION){
             renderDemoScreen(s, ch, index);
             digitalWrite(s->dProp[ch].cs_pin, LOW);
             //elements draw directly on screen to keep 
@@ -231,8 +321,8 @@ void screenMenuInfoRender(Menu* m, Screen* s, uint16_t sel ,int index){
     if(m->menuType == TYPE_RANGE)
         menuButtonTextPlacer(s,"Up");
 
-    s->img.unloadFont();
-    s->img.pushSprite(0,0);
+    s->img->unloadFont();
+    s->img->pushSprite(0,0);
     digitalWrite(s->dProp[ch].cs_pin, HIGH);
 }
 
@@ -244,45 +334,45 @@ void menuTextItemPlacer(String text, Screen* s, int pos, int selType, int tick){
     int32_t y = 40*pos+5;
 
     if(selType == 1){
-        s->img.fillRoundRect(2,40*pos-3,236,36,5,DARKGREY);
+        s->img->fillRoundRect(2,40*pos-3,236,36,5,DARKGREY);
     }
 
     if(tick == 1){
-        s->img.fillSmoothCircle(227,40*pos+15,9,TFT_LIGHTGREY,TFT_LIGHTGREY);
-        s->img.fillSmoothCircle(227,40*pos+15,5,TFT_WHITE,TFT_WHITE);
+        s->img->fillSmoothCircle(227,40*pos+15,9,TFT_LIGHTGREY,TFT_LIGHTGREY);
+        s->img->fillSmoothCircle(227,40*pos+15,5,TFT_WHITE,TFT_WHITE);
     }   
 
-    s->img.loadFont(SMALLFONT);
-    s->img.setTextFont(2);
-    s->img.setTextColor(TFT_WHITE);
+    s->img->loadFont(SMALLFONT);
+    s->img->setTextFont(2);
+    s->img->setTextColor(TFT_WHITE);
 
-    s->img.drawString(text,x,y,4);
-    s->img.unloadFont();
+    s->img->drawString(text,x,y,4);
+    s->img->unloadFont();
 
 }
 
 void menuButtonTextPlacer(Screen* s, String barText){
 
     //rectangle color    
-    s->img.fillRoundRect(0,200,240,40,5,TFT_LIGHTGREY);
-    s->img.fillRoundRect(2,202,236,36,5,DARKGREY);
-    s->img.loadFont(SMALLFONT);
-    s->img.setTextFont(2);
-    s->img.setTextColor(TFT_WHITE);        
-    s->img.drawCentreString(barText,120,210,4);
-    s->img.unloadFont();
+    s->img->fillRoundRect(0,200,240,40,5,TFT_LIGHTGREY);
+    s->img->fillRoundRect(2,202,236,36,5,DARKGREY);
+    s->img->loadFont(SMALLFONT);
+    s->img->setTextFont(2);
+    s->img->setTextColor(TFT_WHITE);        
+    s->img->drawCentreString(barText,120,210,4);
+    s->img->unloadFont();
 }
 
 void drawTextWithNewlines(Screen* s, const char* text, int startX, int startY, int textHeight) {
-  s->img.setCursor(startX, startY); // Set initial position
+  s->img->setCursor(startX, startY); // Set initial position
   const char* ptr = text;
 
   while (*ptr) {
     if (*ptr == '\n') {
       startY += textHeight * 9; // Adjust for line spacing (8 pixels per text size unit)
-      s->img.setCursor(startX, startY); // Move to the next line
+      s->img->setCursor(startX, startY); // Move to the next line
     } else {
-      s->img.print(*ptr); // Print the character
+      s->img->print(*ptr); // Print the character
     }
     ptr++;
   }
@@ -292,7 +382,7 @@ void drawTextWithNewlines(Screen* s, const char* text, int startX, int startY, i
 void renderDemoScreen(Screen* s, int ch, int index){
     chScreenData demosScr = {
         {},
-        {5000,725,1000,20,false,false},
+        {5000000,725000,1000,20,false,false},
         {1,"COMx","",3},
         false, true, true, ILIM_1_0, true, 0,0
     };
@@ -300,6 +390,9 @@ void renderDemoScreen(Screen* s, int ch, int index){
     demosScr.dProp.cs_pin = s->dProp[ch].cs_pin;
     demosScr.dProp.rotation = index;
 
+    //always a full render, the menu draws over the demo afterwards
+    s->frameSelect(ch);
     s->screenDefaultRender(demosScr);
+    s->frameSelect(ch);
 
 }
\ No newline at end of file
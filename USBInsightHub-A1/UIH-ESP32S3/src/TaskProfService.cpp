@@ -0,0 +1,58 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+
+//Task profiler access over REST and the event socket
+
+#include "TaskProfService.h"
+
+TaskProfService::TaskProfService(PsychicHttpServer *server,
+                                 EventSocket *socket,
+                                 SecurityManager *securityManager) : _server(server),
+                                                                     _socket(socket),
+                                                                     _securityManager(securityManager)
+{
+}
+
+void TaskProfService::begin()
+{
+    _server->on(TASK_PROF_SERVICE_PATH,
+                HTTP_GET,
+                _securityManager->wrapRequest(std::bind(&TaskProfService::tasks, this, std::placeholders::_1),
+                                              AuthenticationPredicates::IS_AUTHENTICATED));
+    _socket->registerEvent(EVENT_TASKS);
+    _started = true;
+
+    ESP_LOGV("TaskProfService", "Registered GET endpoint: %s", TASK_PROF_SERVICE_PATH);
+}
+
+//Called from the framework loop, emits once per profiler sample
+void TaskProfService::loop()
+{
+    uint32_t seq = taskProfSeq();
+    if (!_started || seq == _lastSeq)
+        return;
+    _lastSeq = seq;
+
+    JsonDocument doc;
+    JsonObject root = doc.to<JsonObject>();
+    taskProfToJson(root);
+    _socket->emitEvent(EVENT_TASKS, root);
+}
+
+esp_err_t TaskProfService::tasks(PsychicRequest *request)
+{
+    PsychicJsonResponse response = PsychicJsonResponse(request, false);
+    taskProfToJson(response.getRoot());
+    return response.send();
+}
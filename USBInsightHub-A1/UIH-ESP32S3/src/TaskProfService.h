@@ -0,0 +1,46 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped 
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+
+//Task profiler access. GET /rest/tasks and the "tasks" socket event, emitted
+//after every sample
+
+#ifndef TaskProfService_h
+#define TaskProfService_h
+
+#include <PsychicHttp.h>
+#include <SecurityManager.h>
+#include <EventSocket.h>
+#include "TaskProfiler.h"
+
+#define TASK_PROF_SERVICE_PATH "/rest/tasks"
+#define EVENT_TASKS "tasks"
+
+class TaskProfService
+{
+public:
+    TaskProfService(PsychicHttpServer *server, EventSocket *socket, SecurityManager *securityManager);
+
+    void begin();
+    void loop();
+
+private:
+    PsychicHttpServer *_server;
+    EventSocket *_socket;
+    SecurityManager *_securityManager;
+    bool _started = false;
+    uint32_t _lastSeq = 0;
+    esp_err_t tasks(PsychicRequest *request);
+};
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//FreeRTOS task CPU share, stack and notification latency sampling
+
+#include "TaskProfiler.h"
+#include "esp_timer.h"
+#include "esp_freertos_hooks.h"
+
+static const char* TAG = "TaskProfiler";
+
+static const char* t_profLink[TASK_PROF_LINK_COUNT] = {"meterToScreen","screenToMeter"};
+static const char* t_taskState[] = {"running","ready","blocked","suspended","deleted","invalid"};
+
+struct TaskProfEntry {
+  char name[configMAX_TASK_NAME_LEN];
+  int8_t core;        //-1 not pinned
+  uint8_t priority;
+  uint8_t state;      //eTaskState
+  int16_t cpu;        //tenths of percent of one core, -1 without run time stats
+  uint32_t stackFree; //bytes never used since the task started
+};
+
+struct TaskProfLink {
+  int64_t giveUs;   //0 when nothing is pending
+  uint32_t count;   //over the period
+  uint64_t sumUs;
+  uint32_t maxUs;   //over the period
+  uint32_t worstUs; //since boot
+};
+
+struct TaskProfLinkOut {
+  uint32_t count;
+  uint32_t avgUs;
+  uint32_t maxUs;
+  uint32_t worstUs;
+};
+
+//published sample
+static TaskProfEntry entries[TASK_PROF_MAX_TASKS];
+static uint8_t entryCount = 0;
+static int16_t coreLoad[portNUM_PROCESSORS];
+static TaskProfLinkOut linkOut[TASK_PROF_LINK_COUNT];
+static volatile uint32_t sampleSeq = 0;
+static portMUX_TYPE sampleMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskProfLink links[TASK_PROF_LINK_COUNT];
+static portMUX_TYPE linkMux = portMUX_INITIALIZER_UNLOCKED;
+
+//ticks of each core and the ones that interrupted its idle task
+static volatile uint32_t coreTicks[portNUM_PROCESSORS];
+static volatile uint32_t coreIdleTicks[portNUM_PROCESSORS];
+static uint32_t prevTicks[portNUM_PROCESSORS];
+static uint32_t prevIdleTicks[portNUM_PROCESSORS];
+static TaskHandle_t idleTask[portNUM_PROCESSORS];
+
+#if configUSE_TRACE_FACILITY
+static TaskStatus_t status[TASK_PROF_MAX_TASKS];
+//run time counters of the previous sample, by task handle
+static TaskHandle_t prevHandle[TASK_PROF_MAX_TASKS];
+static uint32_t prevRun[TASK_PROF_MAX_TASKS];
+static uint8_t prevCount = 0;
+static uint32_t prevTotal = 0;
+
+static void sampleTasks(){
+  TaskProfEntry sample[TASK_PROF_MAX_TASKS];
+  uint32_t total = 0;
+  UBaseType_t n = uxTaskGetSystemState(status, TASK_PROF_MAX_TASKS, &total);
+  if(n == 0){
+    ESP_LOGW(TAG, "More than %u tasks, not sampled", TASK_PROF_MAX_TASKS);
+    return;
+  }
+
+  uint32_t dTotal = total - prevTotal;
+  bool rates = configGENERATE_RUN_TIME_STATS && prevTotal != 0 && dTotal != 0;
+
+  for(UBaseType_t i=0; i<n; i++){
+    TaskProfEntry &e = sample[i];
+    strlcpy(e.name, status[i].pcTaskName, sizeof(e.name));
+    e.priority  = status[i].uxCurrentPriority;
+    e.state     = status[i].eCurrentState;
+    e.stackFree = status[i].usStackHighWaterMark;
+#if configTASKLIST_INCLUDE_COREID
+    e.core = status[i].xCoreID < portNUM_PROCESSORS ? status[i].xCoreID : -1;
+#else
+    e.core = -1;
+#endif
+    e.cpu = -1;
+    if(rates){
+      for(int p=0; p<prevCount; p++){
+        if(prevHandle[p] != status[i].xHandle) continue;
+        e.cpu = (int16_t)((uint64_t)(status[i].ulRunTimeCounter - prevRun[p]) * 1000 / dTotal);
+        break;
+      }
+    }
+  }
+
+  prevCount = n;
+  prevTotal = total;
+  for(UBaseType_t i=0; i<n; i++){
+    prevHandle[i] = status[i].xHandle;
+    prevRun[i]    = status[i].ulRunTimeCounter;
+  }
+
+  portENTER_CRITICAL(&sampleMux);
+  memcpy(entries, sample, n * sizeof(TaskProfEntry));
+  entryCount = n;
+  portEXIT_CRITICAL(&sampleMux);
+
+#ifdef TELEPLOT_TASKS
+  for(UBaseType_t i=0; i<n; i++)
+    Serial.printf(">%s_stack:%u\n>%s_cpu:%.1f\n", sample[i].name, sample[i].stackFree, sample[i].name, sample[i].cpu / 10.0f);
+#endif
+}
+#else
+static void sampleTasks(){
+  //without the trace facility there is no task list, only the core load is reported
+}
+#endif
+
+//Tick interrupt of each core, in IRAM as it also runs while the flash cache is off
+static void IRAM_ATTR tickHook(){
+  int c = xPortGetCoreID();
+  coreTicks[c]++;
+  if(xTaskGetCurrentTaskHandle() == idleTask[c]) coreIdleTicks[c]++;
+}
+
+//A core is as busy as the share of its ticks that did not land in its idle task.
+//Work shorter than a tick and started by it is mostly missed.
+static void sampleCores(){
+  int16_t load[portNUM_PROCESSORS];
+  for(int c=0; c<portNUM_PROCESSORS; c++){
+    uint32_t ticks = coreTicks[c];
+    uint32_t idle  = coreIdleTicks[c];
+    uint32_t dTicks = ticks - prevTicks[c];
+    uint32_t dIdle  = idle - prevIdleTicks[c];
+    prevTicks[c] = ticks;
+    prevIdleTicks[c] = idle;
+    if(dIdle > dTicks) dIdle = dTicks; //read while the other core ticks
+    load[c] = dTicks ? (int16_t)((uint64_t)(dTicks - dIdle) * 1000 / dTicks) : -1;
+  }
+
+  portENTER_CRITICAL(&sampleMux);
+  memcpy(coreLoad, load, sizeof(coreLoad));
+  portEXIT_CRITICAL(&sampleMux);
+}
+
+static void sampleLinks(){
+  TaskProfLinkOut out[TASK_PROF_LINK_COUNT];
+  portENTER_CRITICAL(&linkMux);
+  for(int l=0; l<TASK_PROF_LINK_COUNT; l++){
+    out[l].count   = links[l].count;
+    out[l].avgUs   = links[l].count ? links[l].sumUs / links[l].count : 0;
+    out[l].maxUs   = links[l].maxUs;
+    out[l].worstUs = links[l].worstUs;
+    links[l].count = 0;
+    links[l].sumUs = 0;
+    links[l].maxUs = 0;
+  }
+  portEXIT_CRITICAL(&linkMux);
+
+  portENTER_CRITICAL(&sampleMux);
+  memcpy(linkOut, out, sizeof(linkOut));
+  portEXIT_CRITICAL(&sampleMux);
+}
+
+static void taskProfiler(void *pvParameters){
+  TickType_t xLastWakeTime = xTaskGetTickCount();
+  for(;;){
+    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(TASK_PROF_PERIOD_MS));
+    sampleTasks();
+    sampleCores();
+    sampleLinks();
+    sampleSeq++;
+  }
+}
+
+void taskProfInit(){
+  memset(links, 0, sizeof(links));
+  for(int c=0; c<portNUM_PROCESSORS; c++){
+    coreLoad[c] = -1;
+    idleTask[c] = xTaskGetIdleTaskHandleForCPU(c);
+    if(esp_register_freertos_tick_hook_for_cpu(tickHook, c) != ESP_OK)
+      ESP_LOGE(TAG, "Couldn't register the tick hook of core %d", c);
+  }
+  if(xTaskCreatePinnedToCore(taskProfiler, "Task Profiler", 3072, NULL, TASK_PROF_PRIORITY, NULL, TASK_PROF_CORE) != pdPASS)
+    ESP_LOGE(TAG, "Couldn't create the profiler task");
+}
+
+void taskProfNotifyGive(uint8_t link){
+  if(link >= TASK_PROF_LINK_COUNT) return;
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&linkMux);
+  links[link].giveUs = now;
+  portEXIT_CRITICAL(&linkMux);
+}
+
+void taskProfNotifyTaken(uint8_t link){
+  if(link >= TASK_PROF_LINK_COUNT) return;
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&linkMux);
+  TaskProfLink &l = links[link];
+  if(l.giveUs != 0){
+    uint32_t us = (uint32_t)(now - l.giveUs);
+    l.giveUs = 0;
+    l.count++;
+    l.sumUs += us;
+    if(us > l.maxUs) l.maxUs = us;
+    if(us > l.worstUs) l.worstUs = us;
+  }
+  portEXIT_CRITICAL(&linkMux);
+}
+
+uint32_t taskProfSeq(){
+  return sampleSeq;
+}
+
+//{"period","cores":[load %],"tasks":[{"name","core","prio","state","cpu","stackFree"}],
+// "notify":{"meterToScreen":{"count","avgUs","maxUs","worstUs"},"screenToMeter":{...}}}
+void taskProfToJson(JsonObject obj){
+  TaskProfEntry e[TASK_PROF_MAX_TASKS];
+  TaskProfLinkOut lo[TASK_PROF_LINK_COUNT];
+  int16_t load[portNUM_PROCESSORS];
+  uint8_t n;
+
+  portENTER_CRITICAL(&sampleMux);
+  n = entryCount;
+  memcpy(e, entries, n * sizeof(TaskProfEntry));
+  memcpy(lo, linkOut, sizeof(lo));
+  memcpy(load, coreLoad, sizeof(load));
+  portEXIT_CRITICAL(&sampleMux);
+
+  obj["period"] = TASK_PROF_PERIOD_MS;
+  JsonArray cores = obj["cores"].to<JsonArray>();
+  for(int c=0; c<portNUM_PROCESSORS; c++){
+    if(load[c] >= 0) cores.add(serialized(String(load[c] / 10.0f, 1)));
+    else cores.add(nullptr);
+  }
+
+  JsonArray tasks = obj["tasks"].to<JsonArray>();
+  for(int i=0; i<n; i++){
+    JsonObject t = tasks.add<JsonObject>();
+    t["name"]      = e[i].name;
+    t["core"]      = e[i].core;
+    t["prio"]      = e[i].priority;
+    t["state"]     = t_taskState[e[i].state < 5 ? e[i].state : 5];
+    if(e[i].cpu >= 0)
+      t["cpu"]     = serialized(String(e[i].cpu / 10.0f, 1));
+    t["stackFree"] = e[i].stackFree;
+  }
+
+  JsonObject notify = obj["notify"].to<JsonObject>();
+  for(int l=0; l<TASK_PROF_LINK_COUNT; l++){
+    JsonObject k = notify[t_profLink[l]].to<JsonObject>();
+    k["count"]   = lo[l].count;
+    k["avgUs"]   = lo[l].avgUs;
+    k["maxUs"]   = lo[l].maxUs;
+    k["worstUs"] = lo[l].worstUs;
+  }
+}
@@ -0,0 +1,49 @@
+/**
+ *   USB Insight Hub
+ *
+ *   A USB supercharged interfacing tool for developers & tech enthusiasts wrapped
+ *   around ESP32 SvelteKit framework.
+ *   https://github.com/Aeriosolutions/USB-Insight-HUB-Software
+ *
+ *   Copyright (C) 2024 - 2025 Aeriosolutions
+ *   Copyright (C) 2024 - 2025 JoDaSa
+
+ * MIT License. Check full description on LICENSE file.
+ **/
+
+//Task profiler: every TASK_PROF_PERIOD_MS the FreeRTOS task list is sampled for
+//the CPU share of every task over the period (percent of one core), the load of
+//each core and the stack high water marks. The Intercomms <-> Default Screen
+//notifications are timed from the give to the wake up of the other task.
+//The core load is sampled on every FreeRTOS tick and works with the stock
+//framework config. The CPU share of each task needs its run time stats, without
+//them tasks report state and stack only.
+//Read from serial with {"action":"get","params":["tasks"]}, from /rest/tasks and
+//the "tasks" socket event
+
+#ifndef TASKPROFILER_H
+#define TASKPROFILER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define TASK_PROF_PERIOD_MS   1000
+#define TASK_PROF_MAX_TASKS   32
+#define TASK_PROF_PRIORITY    1
+#define TASK_PROF_CORE        0 //away from APP_CORE, where the profiled tasks run
+
+//notification links
+#define TASK_PROF_METER_SCREEN 0 //Intercomms sample ready -> Default Screen
+#define TASK_PROF_SCREEN_METER 1 //Default Screen period -> Intercomms
+#define TASK_PROF_LINK_COUNT   2
+
+void taskProfInit();
+//Right before the xTaskNotifyGive of a link
+void taskProfNotifyGive(uint8_t link);
+//When the notified task woke up by the notification, not by its timeout
+void taskProfNotifyTaken(uint8_t link);
+//Incremented on every sample
+uint32_t taskProfSeq();
+void taskProfToJson(JsonObject obj);
+
+#endif
@@ -21,15 +21,17 @@
 #include "BaseMCU.h"
 #include "PAC194x.h"
 #include "Screen.h"
+#include "FlexLayout.h"
                         
-#define DATATYPES_VER 4 //change this number every time globalconfig members are added
+#define DATATYPES_VER 5 //change this number every time globalconfig members are added
 
 #define APP_CORE 1
 
-#define COMPATIBLE_BMCU_VER 4
+#define COMPATIBLE_BMCU_VER 5
 
 
-#define DISPLAY_REFRESH_PERIOD    63 //note that for each screen the effective rate is 189ms
+#define DISPLAY_REFRESH_PERIOD    63 //a changed screen is updated on the next period
+#define DISPLAY_RENDER_BUDGET     40 //ms of each period spent rendering
 #define SLOW_DATA_DOWNSAMPLES_0_5  8 //504ms //multiples of DISPLAY_REFRESH_PERIOD 
 #define SLOW_DATA_DOWNSAMPLES_1_0 16 //1008ms //multiples of DISPLAY_REFRESH_PERIOD 
 
@@ -170,6 +172,7 @@ struct System {
   TaskHandle_t taskIntercommHandle;
   TaskHandle_t taskDefaultScreenLoopHandle;
   bool saveMCUState;
+  bool savePowerSig;
   String APSSID;
   bool congigChangedToMenu;
   bool configChangedFromMenu;
@@ -184,6 +187,7 @@ struct System {
   uint8_t pacRevisionID;
   String prevESPVersion;
   uint8_t updateState;
+  uint8_t updateProgress; //OTA pipeline bytes written, percent
   uint8_t internalErrFlags; //bitmask of error flags  
 };
 
@@ -226,15 +230,31 @@ struct ScreenConfig {
 };
 
 struct MeterState {
-  float AvgVoltage;
-  float AvgCurrent;
+  int32_t AvgVoltageUv;
+  int32_t AvgCurrentUa;
+  int32_t AvgPowerUw;
   bool fwdAlertSet;
   bool backAlertSet;
+  bool sagAlert;  //VBUS went under uvLim, latched until the port is switched off
+  bool ovAlert;   //VBUS went over ovLim, latched until the port is switched off
+  bool opAlert;   //power went over opLim, latched until the port is switched off
 };
 
+//VBUS and power alert limits, 0 or within the range
+#define UV_LIM_MIN 3000 //mV
+#define UV_LIM_MAX 5000
+#define OV_LIM_MIN 5000 //mV
+#define OV_LIM_MAX 6000
+#define OP_LIM_MIN 500  //mW
+#define OP_LIM_MAX 15000
+#define LIM_VALID(v, min, max) ((v) == 0 || ((v) >= (min) && (v) <= (max)))
+
 struct MeterConfig {
   uint16_t fwdCLim;
   uint16_t backCLim;
+  uint16_t uvLim; //mV, 0 disables
+  uint16_t ovLim; //mV, 0 disables
+  uint16_t opLim; //mW, 0 disables
 };
 
 struct USBInfoState {
@@ -244,6 +264,17 @@ struct USBInfoState {
   int usbType;
   uint8_t imgBPP;
   uint16_t* imgBuffer;
+  uint16_t imgSeq;  //incremented on every image, the buffer is reused for the same depth
+  FlexLayout flex; //numDev 10 rich text, parsed from Dev1_Name at ingest
+};
+
+#define PSIG_NAME_LEN 24
+
+//written by Intercomms, read by the views without a lock, so no heap String
+struct PowerSigState {
+  char label[PSIG_NAME_LEN]; //best learned match, empty if unknown
+  uint16_t distance; //to the best match, 0xFFFF without one
+  bool anomaly;      //known device drawing unlike its learned signature
 };
 
 struct BaseMCUStateIn {
@@ -275,6 +306,7 @@ struct GlobalState {
     StartupState startup[3];
     MeterState meter[3];
     USBInfoState usbInfo[3];
+    PowerSigState powerSig[3];
     BaseMCUStateIn baseMCUIn[3];    
     BaseMCUStateOut baseMCUOut[3];    
     BaseMCUExtraState baseMCUExtra;
@@ -18,6 +18,10 @@
 #include <ESP32SvelteKit.h>
 #include <PsychicHttpServer.h>
 #include <MasterStateService.h>
+#include "EventLogService.h"
+#include "I2CHealthService.h"
+#include "CdcCaptureService.h"
+#include "TaskProfService.h"
 
 #include "datatypes.h"
 #include "GlobalStateManager.h"
@@ -25,6 +29,7 @@
 #include "Extercomms.h"
 #include "DefaultView.h"
 #include "Powerstartup.h"
+#include "Boot.h"
 
 
 #include <ArduinoJson.h>
@@ -43,32 +48,70 @@ MasterStateService masterStateService = MasterStateService(&server,
                                                         esp32sveltekit.getSocket(),
                                                         esp32sveltekit.getSecurityManager());                                                        
 
+EventLogService eventLogService = EventLogService(&server, esp32sveltekit.getSecurityManager());
+I2CHealthService i2cHealthService = I2CHealthService(&server, esp32sveltekit.getSecurityManager());
+CdcCaptureService cdcCaptureService = CdcCaptureService(&server, esp32sveltekit.getSecurityManager());
+TaskProfService taskProfService = TaskProfService(&server,
+                                                  esp32sveltekit.getSocket(),
+                                                  esp32sveltekit.getSecurityManager());
+
+enum bootStageId {
+    BS_STATE,
+    BS_INTERCOMMS,
+    BS_POWERSTARTUP,
+    BS_EXTERCOMMS,
+    BS_BUTTONS,
+    BS_DISPLAY,
+    BS_VIEW,
+    BS_WEB,
+    BS_SERVICES,
+    BS_COUNT
+};
+
+// start ESP32-SvelteKit if WiFi is enabled
+void bootWeb(){
+    if(globalConfig.features.wifi_enabled == ENABLE){
+        //before begin(), the framework loop task iterates the list from then on
+        esp32sveltekit.addLoopFunction(std::bind(&TaskProfService::loop, &taskProfService));
+        esp32sveltekit.begin();
+    }
+}
+
+void bootServices(){
+    if(globalConfig.features.wifi_enabled == ENABLE){
+        masterStateService.begin(&globalState,&globalConfig,&esp32sveltekit);
+        eventLogService.begin();
+        i2cHealthService.begin();
+        cdcCaptureService.begin();
+        taskProfService.begin();
+    }
+}
+
+//Stages attaching interrupts stay on APP_CORE, the GPIO ISRs are served on the core that attached them
+static const BootStage bootStages[BS_COUNT] = {
+    {"state",        []{ globalStateInitializer(&globalState,&globalConfig); },  0,                                              4096, APP_CORE},
+    {"intercomms",   []{ iniIntercomms(&globalState, &globalConfig); },          BOOT_DEP(BS_STATE),                             4096, APP_CORE},
+    {"powerStartUp", []{ iniPowerStartUp(&globalState,&globalConfig); },         BOOT_DEP(BS_STATE),                             3072, APP_CORE},
+    {"extercomms",   []{ iniExtercomms(&globalState,&globalConfig); },           BOOT_DEP(BS_STATE),                             4096, APP_CORE},
+    {"buttons",      []{ iniButtons(); },                                        0,                                              2048, APP_CORE},
+    {"display",      []{ iniDisplay(&globalState,&globalConfig, &screen); },     BOOT_DEP(BS_STATE),                             8192, APP_CORE},
+    {"view",         iniDefaultView,                                             BOOT_DEP(BS_DISPLAY) | BOOT_DEP(BS_INTERCOMMS), 8192, APP_CORE},
+    {"web",          bootWeb,                                                    BOOT_DEP(BS_STATE),                             8192, 0},
+    {"services",     bootServices,                                               BOOT_DEP(BS_WEB) | BOOT_DEP(BS_INTERCOMMS),     4096, 0},
+};
 
 void setup()
 {
 
     // start serial and filesystem
     //Serial.begin(SERIAL_BAUD_RATE); 
-      
-    globalStateInitializer(&globalState,&globalConfig);
-    iniIntercomms(&globalState, &globalConfig);
-    delay(10);
-    iniPowerStartUp(&globalState,&globalConfig);     
-    iniExtercomms(&globalState,&globalConfig);
-    delay(40); //to give time to print
+
     ESP_LOGI("Main","Running Firmware Version: %s", APP_VERSION);
     //ESP_LOGI("Main","Previous Firmware Version: %s\n", globalState.system.prevESPVersion.c_str());
 
-    iniButtons();    
-    iniDefaultView(&globalState,&globalConfig, &screen);
-    //delay(10); //to give time to print
-    
-    // start ESP32-SvelteKit if WiFi is enabled
-    if(globalConfig.features.wifi_enabled == ENABLE){
-        esp32sveltekit.begin();    
-        masterStateService.begin(&globalState,&globalConfig,&esp32sveltekit);
-    }
-    
+    //first, so the boot is sampled as well
+    taskProfInit();
+    bootRun(bootStages, BS_COUNT);
 }
 
 void loop()
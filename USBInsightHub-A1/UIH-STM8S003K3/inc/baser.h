@@ -9,6 +9,8 @@
 
  * MIT License. Check full description on LICENSE file.
  **/
+#ifndef __BASER_H
+#define __BASER_H
 #include "stm8s_adc1.h"
 
 //define MCU digital IOs 
@@ -43,6 +45,10 @@
 #define VEXT_CC1_AIN2 GPIOB,GPIO_PIN_2
 #define VEXT_CC2_AIN3 GPIOB,GPIO_PIN_3
 
+//Open drain event request line to the ESP32 MCU_INT (active low). Define it with
+//the STM8 pin routed to MCU_INT on the board revision; the ESP32 also polls EVTCNT
+//#define BMCU_INT GPIOD,GPIO_PIN_5
+
 
 #define ILIMG_MASK 0x01
 #define ILIMH_MASK 0x02
@@ -58,6 +64,21 @@
 #define Host_CC1_pin ADC1_CHANNEL_0
 #define Host_CC2_pin ADC1_CHANNEL_1
 
+//CC lines are sampled in one ADC scan (AIN0..AIN3), buffer index = channel
+#define CC_SCAN_LAST ADC1_CHANNEL_3
+#define CC_SCAN_CHANNELS 4
+#define CC_OVERSAMPLE 8 //scans averaged per CC value, one scan per ms
+#define CC_OVERSAMPLE_SHIFT 3
+
+//Event FIFO. Each event is 4 bytes: type<<4 | channel, data, tick L, tick H
+//tick is the lower 16 bits of millis() when the change was detected
+#define EVT_FIFO_SIZE 8
+#define EVT_FIFO_OVF 0x80 //EVTCNT flag, events were discarded because the FIFO was full
+
+#define EVT_FAULT  1 //data: 1 fault asserted, 0 fault released
+#define EVT_PWRSRC 2 //data: AUXREG bits 0..1 (VHOSTP, VEXTP)
+#define EVT_CCSUM  3 //data: new CCSUM value
+
 #define NOPULLL 0
 #define NOPULLH 47
 #define DEFLTL 78
@@ -73,5 +94,19 @@
 
 void BaseR_GPIO_Init(void);
 void Update_GPIO_from_I2CRegisters(void);
-unsigned int ADC_Read(ADC1_Channel_TypeDef ADC_Channel_Number);
+void CC_ADC_Init(void);
+void CC_ADC_Start(void);
 void Update_CC_signals(void);
+void Event_Push(u8 type, u8 ch, u8 data);
+u8 Event_Fifo_Count(void);
+u8 Event_Fifo_Read(u8 offset);
+void Event_Fifo_Ack(u8 n);
+
+#ifdef _RAISONANCE_
+	void CC_ADC_check_event(void) interrupt 22;
+#endif
+#ifdef _COSMIC_ 
+		@far @interrupt void CC_ADC_check_event(void);
+#endif
+
+#endif /*__BASER_H*/
@@ -63,6 +63,7 @@ void main(void)
   TIM4_init(); //already setup f_Master = HSI/1 = 16MHz
 	//CLK_PeripheralClockConfig(CLK_PERIPHERAL_ADC, ENABLE); //Enable Peripheral Clock for ADC
 	CLK->PCKENR2 |= 0x08; //Enable Peripheral Clock for ADC
+	CC_ADC_Init(); //CC lines scanned in background, started by the TIM4 tick
 	/* Initialise I2C for communication */
 	Init_I2C();
 	
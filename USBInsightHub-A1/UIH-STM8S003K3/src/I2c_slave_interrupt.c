@@ -10,10 +10,11 @@
  * MIT License. Check full description on LICENSE file.
  **/
 #include "I2c_slave_interrupt.h"
+#include "baser.h"
 
 #define MAX_BUFFER  32
 #define WHOAMI_ID 0x35
-#define VERNUM 0x04
+#define VERNUM 0x05
 
 //registers
 #define WHOAMI 0x10
@@ -23,6 +24,7 @@
 #define CH3REG 0x22
 #define CCSUM 0x23
 #define AUXREG 0x24
+#define EVTCNT 0x25 //add on version 5
 #define MUXOECTR 0x26 //add on version 3
 
 #define VEXTCC1L 0x30
@@ -34,6 +36,9 @@
 #define VHOSTCC2L 0x36
 #define VHOSTCC2H 0x37
 
+#define EVTFIFO 0x40 //add on version 5
+#define EVTFIFO_END (EVTFIFO + 2 + 4*EVT_FIFO_SIZE)
+
 
 
   u8 MessageBegin;
@@ -108,6 +113,7 @@
 			firstPowerFlag = FALSE;
 			return r24_AUXREG;
 		} 		
+		else if(reg_address == EVTCNT) 		return Event_Fifo_Count();
 		else if(reg_address == MUXOECTR) 	return r26_MUXOECTR;
 		else if(reg_address == VEXTCC1L) 	return r30_VEXTCC1L;
 		else if(reg_address == VEXTCC1H) 	return r31_VEXTCC1H;
@@ -117,6 +123,8 @@
 		else if(reg_address == VHOSTCC1H) return r35_VHOSTCC1H;
 		else if(reg_address == VHOSTCC2L) return r36_VHOSTCC2L;
 		else if(reg_address == VHOSTCC2H) return r37_VHOSTCC2H;		
+		else if(reg_address >= EVTFIFO && reg_address < EVTFIFO_END)
+			return Event_Fifo_Read(reg_address - EVTFIFO);
 		else return 0x00;
 	}
 
@@ -136,6 +144,9 @@
 			r26_MUXOECTR = 0x01 & u8_RxData;
 			muxoeReceived = TRUE;
 		}
+		else if(reg_address == EVTCNT){
+			Event_Fifo_Ack(u8_RxData);
+		}
 	}
 
 // ********************** Data link interrupt handler *******************
@@ -13,6 +13,7 @@
 #include "baser.h"
 #include "stm8s.h"
 #include "stm8s_adc1.h"
+#include "tim4millis.h"
 
 extern u8 r10_WHOAMI;
 extern u8 r12_VERSION;
@@ -40,6 +41,23 @@ u8 hostdebcc2 = 0;
 
 extern bool firstPowerFlag;
 
+//CC line sampling state, shared with the ADC1 and TIM4 interrupts
+static volatile unsigned int ccAcc[CC_SCAN_CHANNELS];
+static volatile unsigned int ccAvg[CC_SCAN_CHANNELS];
+static volatile u8 ccAccCount = 0;
+static volatile bool ccAvgReady = FALSE;
+static volatile bool ccScanBusy = FALSE;
+static volatile bool ccScanOn = FALSE;
+
+//Event FIFO, written by the main loop and consumed from the I2C interrupt
+static u8 evtBuf[EVT_FIFO_SIZE][4];
+static volatile u8 evtHead = 0;
+static volatile u8 evtCount = 0;
+static volatile bool evtOverflow = FALSE;
+static u16 evtNowLatch = 0;
+static u8 evtPrevFault = 0;
+static u8 evtPrevPwr = 0;
+
 
 void BaseR_GPIO_Init(void){
 	
@@ -85,10 +103,17 @@ void BaseR_GPIO_Init(void){
 	GPIO_Init(VHOST_CC2_AIN1, GPIO_MODE_IN_FL_NO_IT);
 	GPIO_Init(VEXT_CC1_AIN2, GPIO_MODE_IN_FL_NO_IT);
 	GPIO_Init(VEXT_CC2_AIN3, GPIO_MODE_IN_FL_NO_IT);
+
+#ifdef BMCU_INT
+	GPIO_Init(BMCU_INT, GPIO_MODE_OUT_OD_HIZ_SLOW);
+#endif
 }
 
 void Update_GPIO_from_I2CRegisters(void){
 
+	u8 faults;
+	u8 i;
+
 	//First version does not use Ignore flags. The master MCU is fully responsible 
 	//Map register fields to GPIOs
 	
@@ -140,17 +165,39 @@ void Update_GPIO_from_I2CRegisters(void){
 	if(firstPowerFlag) r24_AUXREG 	|= 0x10;
 	else r24_AUXREG &= 0xEF;
 	
+	//Queue fault and power source changes, the ESP32 only samples every 50 ms
+	faults = ((r20_CH1REG >> 7) & 0x01) | ((r21_CH2REG >> 6) & 0x02) | ((r22_CH3REG >> 5) & 0x04);
+	if(faults != evtPrevFault){
+		for(i = 0; i < 3; i++)
+			if((faults ^ evtPrevFault) & (1 << i)) Event_Push(EVT_FAULT, i, (faults >> i) & 0x01);
+		evtPrevFault = faults;
+	}
+	if((r24_AUXREG & 0x03) != evtPrevPwr){
+		evtPrevPwr = r24_AUXREG & 0x03;
+		Event_Push(EVT_PWRSRC, 0, evtPrevPwr);
+	}
 }
 
 void Update_CC_signals(void) {
 
-	unsigned int ADC_Ext_CC1 = ADC_Read(Ext_CC1_pin);
-	unsigned int ADC_Ext_CC2 = ADC_Read(Ext_CC2_pin);
-	unsigned int ADC_Host_CC1 = ADC_Read(Host_CC1_pin);
-	unsigned int ADC_Host_CC2 = ADC_Read(Host_CC2_pin);
+	unsigned int ADC_Ext_CC1;
+	unsigned int ADC_Ext_CC2;
+	unsigned int ADC_Host_CC1;
+	unsigned int ADC_Host_CC2;
 	u8 ccsumtemp = 0xff;
 	unsigned int ccActive = 0;
 	
+	//keep the previous values until the first averaged window is complete
+	if(!ccAvgReady) return;
+	
+	//the ISR publishes 16 bit values, copy them atomically
+	disableInterrupts();
+	ADC_Ext_CC1 = ccAvg[Ext_CC1_pin];
+	ADC_Ext_CC2 = ccAvg[Ext_CC2_pin];
+	ADC_Host_CC1 = ccAvg[Host_CC1_pin];
+	ADC_Host_CC2 = ccAvg[Host_CC2_pin];
+	enableInterrupts();
+	
 	//update I2C registers with the voltage values of CC pins
 	r30_VEXTCC1L = ADC_Ext_CC1&(0xff);
 	r31_VEXTCC1H = (ADC_Ext_CC1>>8)&(0xff);
@@ -198,28 +245,121 @@ void Update_CC_signals(void) {
 		else ccsumtemp &= 0xCF;		
 	}		
 
+	if(ccsumtemp != r23_CCSUM) Event_Push(EVT_CCSUM, 0, ccsumtemp);
 	r23_CCSUM=ccsumtemp;
 	
 }
 
 
-unsigned int ADC_Read(ADC1_Channel_TypeDef ADC_Channel_Number){
-   unsigned int result = 0;
-	 ADC1_DeInit();
-	 ADC1_Init(ADC1_CONVERSIONMODE_CONTINUOUS, 
-							 ADC_Channel_Number, 
-							 ADC1_PRESSEL_FCPU_D18, 
-							 ADC1_EXTTRIG_TIM, 
-							 DISABLE, 
-							 ADC1_ALIGN_RIGHT, 
-							 ADC1_SCHMITTTRIG_ALL, 
-							 DISABLE);
-	ADC1_Cmd(ENABLE);
-	ADC1_StartConversion();
-	while(ADC1_GetFlagStatus(ADC1_FLAG_EOC) == FALSE);
-	result = ADC1_GetConversionValue();
-	ADC1_ClearFlag(ADC1_FLAG_EOC);
+//One time ADC1 setup: single scan of AIN0..AIN3 into the data buffer
+//registers, end of scan interrupt. Scans are started from the 1 ms tick
+void CC_ADC_Init(void){
 	ADC1_DeInit();
-	return result;
+	ADC1_Init(ADC1_CONVERSIONMODE_SINGLE, 
+						CC_SCAN_LAST, 
+						ADC1_PRESSEL_FCPU_D18, 
+						ADC1_EXTTRIG_TIM, 
+						DISABLE, 
+						ADC1_ALIGN_RIGHT, 
+						ADC1_SCHMITTTRIG_ALL, 
+						DISABLE);
+	ADC1_ScanModeCmd(ENABLE);
+	ADC1_DataBufferCmd(ENABLE);
+	ADC1_ClearITPendingBit(ADC1_IT_EOC);
+	ADC1_ITConfig(ADC1_IT_EOCIE, ENABLE);
+	ADC1_Cmd(ENABLE); //first ADON only wakes up the ADC, stabilization < 1 tick
+	ccScanBusy = FALSE;
+	ccScanOn = TRUE;
+}
+
+//Called from the TIM4 1 ms interrupt. A scan takes ~63 us (4 x 14 ADC clocks at 16MHz/18)
+void CC_ADC_Start(void){
+	if(!ccScanOn || ccScanBusy) return;
+	ccScanBusy = TRUE;
+	ADC1->CR1 |= ADC1_CR1_ADON;
+}
+
+//End of scan interrupt, accumulate CC_OVERSAMPLE scans and publish the average
+#ifdef _RAISONANCE_
+void CC_ADC_check_event(void) interrupt 22 {
+#endif
+#ifdef _COSMIC_
+@far @interrupt void CC_ADC_check_event(void) {
+#endif
+	u8 i;
+	
+	for(i = 0; i < CC_SCAN_CHANNELS; i++)
+		ccAcc[i] += ADC1_GetBufferValue(i);
+	
+	if(++ccAccCount >= CC_OVERSAMPLE){
+		for(i = 0; i < CC_SCAN_CHANNELS; i++){
+			ccAvg[i] = ccAcc[i] >> CC_OVERSAMPLE_SHIFT;
+			ccAcc[i] = 0;
+		}
+		ccAccCount = 0;
+		ccAvgReady = TRUE;
+	}
+	
+	ADC1->CR3 &= (uint8_t)(~ADC1_CR3_OVR);
+	ADC1_ClearITPendingBit(ADC1_IT_EOC);
+	ccScanBusy = FALSE;
+}
+
+//Queue an event stamped with the current tick. When the FIFO is full the new
+//event is discarded so a burst read in progress is never shifted
+void Event_Push(u8 type, u8 ch, u8 data){
+	u16 tick = (u16)millis();
+	u8 idx;
+	
+	disableInterrupts();
+	if(evtCount >= EVT_FIFO_SIZE){
+		evtOverflow = TRUE;
+	}
+	else {
+		idx = (evtHead + evtCount) % EVT_FIFO_SIZE;
+		evtBuf[idx][0] = (u8)((type << 4) | (ch & 0x0F));
+		evtBuf[idx][1] = data;
+		evtBuf[idx][2] = (u8)(tick & 0xFF);
+		evtBuf[idx][3] = (u8)(tick >> 8);
+		evtCount++;
+	}
+	enableInterrupts();
+	
+#ifdef BMCU_INT
+	GPIO_WriteLow(BMCU_INT);
+#endif
+}
+
+//EVTCNT register value, called from the I2C interrupt
+u8 Event_Fifo_Count(void){
+	return evtOverflow ? (evtCount | EVT_FIFO_OVF) : evtCount;
 }
 
+//EVTFIFO window byte, called from the I2C interrupt. Offsets 0-1 are the current
+//tick latched when offset 0 is read, then EVT_FIFO_SIZE records from the oldest
+u8 Event_Fifo_Read(u8 offset){
+	u8 idx;
+	
+	if(offset == 0){
+		evtNowLatch = (u16)millis();
+		return (u8)(evtNowLatch & 0xFF);
+	}
+	if(offset == 1) return (u8)(evtNowLatch >> 8);
+	
+	offset -= 2;
+	idx = offset >> 2;
+	if(idx >= evtCount) return 0x00;
+	return evtBuf[(evtHead + idx) % EVT_FIFO_SIZE][offset & 0x03];
+}
+
+//Drop the n oldest events after the master has read them, called from the I2C interrupt
+void Event_Fifo_Ack(u8 n){
+	if(n > evtCount) n = evtCount;
+	evtHead = (evtHead + n) % EVT_FIFO_SIZE;
+	evtCount -= n;
+	evtOverflow = FALSE;
+	
+#ifdef BMCU_INT
+	if(evtCount == 0) GPIO_WriteHigh(BMCU_INT);
+#endif
+}
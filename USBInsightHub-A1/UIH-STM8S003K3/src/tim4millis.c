@@ -19,6 +19,7 @@ Brief guide:
 */
 
 #include "tim4millis.h"
+#include "baser.h"
 
 __IO uint32_t current_millis = 0; //--IO: volatile read/write 
 
@@ -91,5 +92,8 @@ void TIM4_check_event(void) interrupt 23 {
 	//increase 1, for millis() function
 	current_millis ++;
 	
+	//start the next CC lines ADC scan
+	CC_ADC_Start();
+	
 	TIM4_ClearITPendingBit(TIM4_IT_UPDATE);
 }
\ No newline at end of file
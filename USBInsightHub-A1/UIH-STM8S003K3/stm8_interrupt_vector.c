@@ -3,6 +3,7 @@
  */
 #include "I2c_slave_interrupt.h"
 #include "tim4millis.h"
+#include "baser.h"
 
 typedef void @far (*interrupt_handler_t)(void);
 
@@ -46,7 +47,7 @@ struct interrupt_vector const _vectab[] = {
 	{0x82, (interrupt_handler_t) I2C_Slave_check_event}, /* irq19 */
 	{0x82, NonHandledInterrupt}, /* irq20 */ 
 	{0x82, NonHandledInterrupt}, /* irq21 */  
-	{0x82, NonHandledInterrupt}, /* irq22 */
+	{0x82, (interrupt_handler_t) CC_ADC_check_event}, /* irq22 */
 	{0x82, (interrupt_handler_t) TIM4_check_event}, /* irq23 */
 	{0x82, NonHandledInterrupt}, /* irq24 */
 	{0x82, NonHandledInterrupt}, /* irq25 */